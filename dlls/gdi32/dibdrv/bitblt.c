@@ -21,6 +21,7 @@
 #include <assert.h>
 
 #include "gdi_private.h"
+#include "winreg.h"
 #include "dibdrv.h"
 
 #include "wine/debug.h"
@@ -431,6 +432,179 @@ static const unsigned char BITBLT_Opcodes[256][MAX_OP_LEN] =
     { OP(PAT,DST,R2_WHITE) }                                        /* 0xff  1              */
 };
 
+/* Large operations can optionally be split into horizontal bands that are
+ * processed in parallel on thread pool threads.  This is disabled by default,
+ * set the "Threads" value under HKCU\Software\Wine\DIB Engine to the total
+ * number of threads to use (including the calling thread) to enable it. */
+
+#define MAX_BAND_THREADS   16
+#define MIN_BAND_HEIGHT    16
+#define DEF_BAND_THRESHOLD (1024 * 1024)  /* in pixels */
+
+static int band_threads = -1;
+static DWORD band_threshold = DEF_BAND_THRESHOLD;
+
+struct band_work
+{
+    LONG    refcount;
+    LONG    next;       /* next band to process */
+    LONG    remaining;  /* number of bands not finished yet */
+    int     count;
+    HANDLE  done;       /* signaled once all the bands are finished */
+    void  (*func)( void *context, int index );
+    void   *context;
+};
+
+static DWORD get_config_dword( HKEY key, const char *name, DWORD def )
+{
+    char buffer[16];
+    DWORD type, size = sizeof(buffer) - 1;
+
+    if (RegQueryValueExA( key, name, NULL, &type, (BYTE *)buffer, &size )) return def;
+    if (type == REG_DWORD && size == sizeof(DWORD)) return *(DWORD *)buffer;
+    if (type != REG_SZ) return def;
+    buffer[size] = 0;
+    return strtoul( buffer, NULL, 0 );
+}
+
+static void init_band_config(void)
+{
+    HKEY key;
+    DWORD threads = 0, threshold = DEF_BAND_THRESHOLD;
+
+    if (!RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\DIB Engine", &key ))
+    {
+        threads = get_config_dword( key, "Threads", 0 );
+        threshold = get_config_dword( key, "ThreadThreshold", DEF_BAND_THRESHOLD );
+        RegCloseKey( key );
+    }
+    if (threads > MAX_BAND_THREADS) threads = MAX_BAND_THREADS;
+    if (threads > 1) TRACE( "using %u threads for operations above %u pixels\n", threads, threshold );
+    band_threshold = threshold;
+    band_threads = max( threads, 1 );
+}
+
+/* return the number of bands to split an operation covering the specified area into */
+static int get_band_count_for_size( int width, int height )
+{
+    if (band_threads == -1) init_band_config();
+    if (band_threads == 1) return 1;
+    if ((ULONGLONG)width * height < band_threshold) return 1;
+    return max( 1, min( band_threads * 2, height / MIN_BAND_HEIGHT ));
+}
+
+int get_band_count( const RECT *rect )
+{
+    return get_band_count_for_size( rect->right - rect->left, rect->bottom - rect->top );
+}
+
+static void process_bands( struct band_work *work )
+{
+    LONG index;
+
+    while ((index = InterlockedIncrement( &work->next ) - 1) < work->count)
+    {
+        work->func( work->context, index );
+        if (!InterlockedDecrement( &work->remaining )) SetEvent( work->done );
+    }
+}
+
+static void release_band_work( struct band_work *work )
+{
+    if (InterlockedDecrement( &work->refcount )) return;
+    CloseHandle( work->done );
+    HeapFree( GetProcessHeap(), 0, work );
+}
+
+static DWORD CALLBACK band_worker( void *arg )
+{
+    struct band_work *work = arg;
+
+    /* the context may be gone once all the bands are taken, process_bands doesn't touch it then */
+    process_bands( work );
+    release_band_work( work );
+    return 0;
+}
+
+/* call func for each band index, using the thread pool to run several of them at once */
+static void run_bands( int count, void (*func)( void *context, int index ), void *context )
+{
+    struct band_work *work = NULL;
+    int i, threads = min( count, band_threads ) - 1;
+
+    if (threads > 0 && (work = HeapAlloc( GetProcessHeap(), 0, sizeof(*work) )))
+    {
+        if (!(work->done = CreateEventW( NULL, TRUE, FALSE, NULL )))
+        {
+            HeapFree( GetProcessHeap(), 0, work );
+            work = NULL;
+        }
+    }
+
+    if (!work)
+    {
+        for (i = 0; i < count; i++) func( context, i );
+        return;
+    }
+
+    work->refcount  = 1;
+    work->next      = 0;
+    work->remaining = count;
+    work->count     = count;
+    work->func      = func;
+    work->context   = context;
+
+    for (i = 0; i < threads; i++)
+    {
+        InterlockedIncrement( &work->refcount );
+        if (QueueUserWorkItem( band_worker, work, WT_EXECUTEDEFAULT )) continue;
+        InterlockedDecrement( &work->refcount );
+        break;
+    }
+
+    /* the calling thread processes bands too, so this completes even if no worker ever runs */
+    process_bands( work );
+    WaitForSingleObject( work->done, INFINITE );
+    release_band_work( work );
+}
+
+struct rect_bands
+{
+    const RECT *rect;
+    int         count;
+    void      (*func)( void *context, const RECT *band );
+    void       *context;
+};
+
+static void rect_band_proc( void *arg, int index )
+{
+    const struct rect_bands *bands = arg;
+    LONGLONG height = bands->rect->bottom - bands->rect->top;
+    RECT band = *bands->rect;
+
+    band.top    = bands->rect->top + height * index / bands->count;
+    band.bottom = bands->rect->top + height * (index + 1) / bands->count;
+    bands->func( bands->context, &band );
+}
+
+/* split a rectangle into count bands of rows and call func on each of them */
+void run_rect_bands( const RECT *rect, int count, void (*func)( void *context, const RECT *band ),
+                     void *context )
+{
+    struct rect_bands bands;
+
+    if (count <= 1)
+    {
+        func( context, rect );
+        return;
+    }
+    bands.rect    = rect;
+    bands.count   = count;
+    bands.func    = func;
+    bands.context = context;
+    run_bands( count, rect_band_proc, &bands );
+}
+
 static int get_overlap( const dib_info *dst, const RECT *dst_rect,
                         const dib_info *src, const RECT *src_rect )
 {
@@ -552,20 +726,40 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     }
 }
 
+struct blend_band
+{
+    const dib_info *dst;
+    const dib_info *src;
+    POINT           offset;  /* offset from destination to source coordinates */
+    BLENDFUNCTION   blend;
+};
+
+static void blend_band_proc( void *arg, const RECT *band )
+{
+    const struct blend_band *ctx = arg;
+    POINT origin;
+
+    origin.x = band->left + ctx->offset.x;
+    origin.y = band->top  + ctx->offset.y;
+    ctx->dst->funcs->blend_rect( ctx->dst, band, ctx->src, &origin, ctx->blend );
+}
+
 static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                          HRGN clip, BLENDFUNCTION blend )
 {
-    POINT origin;
+    struct blend_band ctx;
     struct clipped_rects clipped_rects;
     int i;
 
     if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
+    ctx.dst = dst;
+    ctx.src = src;
+    ctx.offset.x = src_rect->left - dst_rect->left;
+    ctx.offset.y = src_rect->top  - dst_rect->top;
+    ctx.blend = blend;
     for (i = 0; i < clipped_rects.count; i++)
-    {
-        origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
-        origin.y = src_rect->top  + clipped_rects.rects[i].top  - dst_rect->top;
-        dst->funcs->blend_rect( dst, &clipped_rects.rects[i], src, &origin, blend );
-    }
+        run_rect_bands( &clipped_rects.rects[i], get_band_count( &clipped_rects.rects[i] ),
+                        blend_band_proc, &ctx );
     free_clipped_rects( &clipped_rects );
     return ERROR_SUCCESS;
 }
@@ -649,19 +843,38 @@ static void get_gradient_triangle_vertices( const GRADIENT_TRIANGLE *tri, const
     bounds->bottom = v[2].y;
 }
 
+struct gradient_band
+{
+    const dib_info  *dib;
+    const TRIVERTEX *v;
+    int              mode;
+    LONG             ret;
+};
+
+static void gradient_band_proc( void *arg, const RECT *band )
+{
+    struct gradient_band *ctx = arg;
+
+    if (!ctx->dib->funcs->gradient_rect( ctx->dib, band, ctx->v, ctx->mode ))
+        InterlockedExchange( &ctx->ret, FALSE );
+}
+
 static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
 {
     int i;
     struct clipped_rects clipped_rects;
-    BOOL ret = TRUE;
+    struct gradient_band ctx;
 
     if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
-    for (i = 0; i < clipped_rects.count; i++)
-    {
-        if (!(ret = dib->funcs->gradient_rect( dib, &clipped_rects.rects[i], v, mode ))) break;
-    }
+    ctx.dib  = dib;
+    ctx.v    = v;
+    ctx.mode = mode;
+    ctx.ret  = TRUE;
+    for (i = 0; i < clipped_rects.count && ctx.ret; i++)
+        run_rect_bands( &clipped_rects.rects[i], get_band_count( &clipped_rects.rects[i] ),
+                        gradient_band_proc, &ctx );
     free_clipped_rects( &clipped_rects );
-    return ret;
+    return ctx.ret;
 }
 
 static DWORD copy_src_bits( dib_info *src, RECT *src_rect )
@@ -1142,6 +1355,330 @@ static DWORD calc_1d_stretch_params( INT dst_start, INT dst_length, INT dst_vis_
 }
 
 
+/* state of the vertical stretch at the start of a band */
+struct stretch_band_state
+{
+    POINT dst_start;
+    POINT src_start;
+    int   err;
+    int   length;
+};
+
+struct stretch_band
+{
+    dib_info                     *dst_dib;
+    const dib_info               *src_dib;
+    const struct stretch_params  *v_params;
+    const struct stretch_params  *h_params;
+    int                           mode;
+    int                           width;
+    BOOL                          vstretch;
+    struct stretch_band_state    *states;
+    void (* row_fn)(const dib_info *dst_dib, const POINT *dst_start,
+                    const dib_info *src_dib, const POINT *src_start,
+                    const struct stretch_params *params, int mode, BOOL keep_dst);
+};
+
+static void stretch_rows( const struct stretch_band *ctx, const struct stretch_band_state *state )
+{
+    const struct stretch_params *v_params = ctx->v_params;
+    POINT dst_start = state->dst_start, src_start = state->src_start;
+    int err = state->err, length = state->length;
+    BOOL need_row = TRUE;
+    RECT last_row, this_row;
+
+    last_row.left = 0;
+    last_row.right = ctx->width;
+
+    while (length--)
+    {
+        if (need_row)
+        {
+            ctx->row_fn( ctx->dst_dib, &dst_start, ctx->src_dib, &src_start, ctx->h_params, ctx->mode, FALSE );
+            need_row = FALSE;
+        }
+        else
+        {
+            last_row.top = dst_start.y - v_params->dst_inc;
+            last_row.bottom = last_row.top + 1;
+            this_row = last_row;
+            offset_rect( &this_row, 0, v_params->dst_inc );
+            copy_rect( ctx->dst_dib, &this_row, ctx->dst_dib, &last_row, NULL, R2_COPYPEN );
+        }
+
+        if (err > 0)
+        {
+            src_start.y += v_params->src_inc;
+            need_row = TRUE;
+            err += v_params->err_add_1;
+        }
+        else err += v_params->err_add_2;
+        dst_start.y += v_params->dst_inc;
+    }
+}
+
+static void shrink_rows( const struct stretch_band *ctx, const struct stretch_band_state *state )
+{
+    const struct stretch_params *v_params = ctx->v_params;
+    POINT dst_start = state->dst_start, src_start = state->src_start;
+    int err = state->err, length = state->length;
+    int merged_rows = 0;
+
+    while (length--)
+    {
+        if (ctx->mode != STRETCH_DELETESCANS || !merged_rows)
+            ctx->row_fn( ctx->dst_dib, &dst_start, ctx->src_dib, &src_start, ctx->h_params, ctx->mode, merged_rows != 0 );
+        merged_rows++;
+
+        if (err > 0)
+        {
+            dst_start.y += v_params->dst_inc;
+            merged_rows = 0;
+            err += v_params->err_add_1;
+        }
+        else err += v_params->err_add_2;
+        src_start.y += v_params->src_inc;
+    }
+}
+
+/* compute the state at the start of each band, when shrinking the bands
+ * can only start where a new destination row is started */
+static int get_stretch_band_states( const struct stretch_band *ctx, POINT dst_start, POINT src_start,
+                                    int count, struct stretch_band_state *states )
+{
+    const struct stretch_params *v_params = ctx->v_params;
+    int i, band = 0, err = v_params->err_start;
+    BOOL row_start = TRUE;
+
+    for (i = 0; i < v_params->length; i++)
+    {
+        if (band < count && row_start && i >= (LONGLONG)v_params->length * band / count)
+        {
+            states[band].dst_start = dst_start;
+            states[band].src_start = src_start;
+            states[band].err = err;
+            states[band].length = i;  /* start row for now */
+            band++;
+        }
+        if (err > 0)
+        {
+            if (ctx->vstretch) src_start.y += v_params->src_inc;
+            else dst_start.y += v_params->dst_inc;
+            row_start = TRUE;
+            err += v_params->err_add_1;
+        }
+        else
+        {
+            row_start = ctx->vstretch;
+            err += v_params->err_add_2;
+        }
+        if (ctx->vstretch) dst_start.y += v_params->dst_inc;
+        else src_start.y += v_params->src_inc;
+    }
+
+    for (i = 0; i < band; i++)
+        states[i].length = (i + 1 < band ? states[i + 1].length : v_params->length) - states[i].length;
+    return band;
+}
+
+static void stretch_band_proc( void *arg, int index )
+{
+    const struct stretch_band *ctx = arg;
+
+    if (ctx->vstretch) stretch_rows( ctx, &ctx->states[index] );
+    else shrink_rows( ctx, &ctx->states[index] );
+}
+
+static inline void add_filter_tap( struct filter_taps *taps, int *count, int pos,
+                                   int vis_start, int vis_end, int weight )
+{
+    if (!weight) return;
+    taps->pos[*count] = max( vis_start, min( vis_end - 1, pos ));
+    taps->weight[*count] = weight;
+    (*count)++;
+}
+
+static void free_filter_taps( struct filter_taps *taps )
+{
+    HeapFree( GetProcessHeap(), 0, taps->start );
+    HeapFree( GetProcessHeap(), 0, taps->pos );
+    HeapFree( GetProcessHeap(), 0, taps->weight );
+}
+
+/***********************************************************************
+ *               calc_filter_taps   (helper for stretch_filtered)
+ *
+ * Compute the source pixels and weights contributing to each visible
+ * destination pixel along one axis.  When shrinking this is a box filter
+ * averaging all the source pixels covered by the destination pixel, when
+ * stretching the two nearest source pixels are interpolated linearly.
+ * Source pixels outside of the visible source area are replaced by the
+ * nearest visible one.
+ */
+static BOOL calc_filter_taps( INT dst_start, INT dst_length, INT dst_vis_start, INT dst_vis_end,
+                              INT src_start, INT src_length, INT src_vis_start, INT src_vis_end,
+                              struct filter_taps *taps )
+{
+    LONGLONG dst_len = abs( dst_length ), src_len = abs( src_length );
+    int i, j, k, n = 0, max_taps, src_inc = src_length > 0 ? 1 : -1;
+
+    taps->count = dst_vis_end - dst_vis_start;
+    max_taps = src_len > dst_len ? (src_len + dst_len - 1) / dst_len + 1 : 2;
+    taps->start  = HeapAlloc( GetProcessHeap(), 0, (taps->count + 1) * sizeof(*taps->start) );
+    taps->pos    = HeapAlloc( GetProcessHeap(), 0, taps->count * max_taps * sizeof(*taps->pos) );
+    taps->weight = HeapAlloc( GetProcessHeap(), 0, taps->count * max_taps * sizeof(*taps->weight) );
+    if (!taps->start || !taps->pos || !taps->weight)
+    {
+        free_filter_taps( taps );
+        return FALSE;
+    }
+
+    for (i = 0; i < taps->count; i++)
+    {
+        taps->start[i] = n;
+        k = dst_length > 0 ? dst_vis_start + i - dst_start : dst_start - dst_vis_start - i;
+
+        if (src_len > dst_len)
+        {
+            /* coordinates in units of 1 / dst_len source pixels */
+            LONGLONG left = k * src_len, right = left + src_len;
+            int weight, prev = 0;
+
+            for (j = left / dst_len; j * dst_len < right; j++)
+            {
+                LONGLONG end = min( (j + 1) * dst_len, right ) - left;
+                weight = ((end << (FILTER_SHIFT + 1)) + src_len) / (2 * src_len);
+                add_filter_tap( taps, &n, src_start + j * src_inc, src_vis_start, src_vis_end, weight - prev );
+                prev = weight;
+            }
+        }
+        else
+        {
+            /* pixel centre in units of 1 / (2 * dst_len) source pixels */
+            LONGLONG centre = (2 * k + 1) * src_len - dst_len;
+            int frac, weight;
+
+            j = centre >= 0 ? centre / (2 * dst_len) : -((2 * dst_len - 1 - centre) / (2 * dst_len));
+            frac = centre - j * 2 * dst_len;
+            weight = (((LONGLONG)frac << (FILTER_SHIFT + 1)) + 2 * dst_len) / (4 * dst_len);
+            add_filter_tap( taps, &n, src_start + j * src_inc, src_vis_start, src_vis_end,
+                            (1 << FILTER_SHIFT) - weight );
+            add_filter_tap( taps, &n, src_start + (j + 1) * src_inc, src_vis_start, src_vis_end, weight );
+        }
+    }
+    taps->start[i] = n;
+
+    return TRUE;
+}
+
+struct filter_band
+{
+    dib_info           *dst_dib;
+    const dib_info     *src_dib;
+    struct filter_taps  h_taps;
+    struct filter_taps  v_taps;
+    int                 rows_per_band;
+    LONG                failed;
+};
+
+/* return the horizontally filtered source row y, without evicting the row keep from the cache */
+static const short *get_filtered_row( const struct filter_band *ctx, short *rows[2], int cached[2],
+                                      int y, int keep )
+{
+    int slot;
+
+    if (cached[0] == y) return rows[0];
+    if (cached[1] == y) return rows[1];
+    slot = (cached[0] == keep) ? 1 : 0;
+    ctx->src_dib->funcs->filter_row( ctx->src_dib, y, &ctx->h_taps, rows[slot] );
+    cached[slot] = y;
+    return rows[slot];
+}
+
+static void filter_band_proc( void *arg, int index )
+{
+    struct filter_band *ctx = arg;
+    const struct filter_taps *v_taps = &ctx->v_taps;
+    int len = 4 * ctx->h_taps.count, cached[2] = { INT_MIN, INT_MIN };
+    int y, j, end = min( (index + 1) * ctx->rows_per_band, v_taps->count );
+    const short *row0, *row1;
+    short *rows[2];
+    int *acc;
+
+    rows[0] = HeapAlloc( GetProcessHeap(), 0, 2 * len * sizeof(short) );
+    acc = HeapAlloc( GetProcessHeap(), 0, len * sizeof(int) );
+    if (!rows[0] || !acc)
+    {
+        InterlockedExchange( &ctx->failed, TRUE );
+        goto done;
+    }
+    rows[1] = rows[0] + len;
+
+    for (y = index * ctx->rows_per_band; y < end; y++)
+    {
+        memset( acc, 0, len * sizeof(int) );
+        for (j = v_taps->start[y]; j < v_taps->start[y + 1]; j += 2)
+        {
+            if (j + 1 < v_taps->start[y + 1])
+            {
+                row0 = get_filtered_row( ctx, rows, cached, v_taps->pos[j], v_taps->pos[j + 1] );
+                row1 = get_filtered_row( ctx, rows, cached, v_taps->pos[j + 1], v_taps->pos[j] );
+                accumulate_filtered_rows( acc, row0, v_taps->weight[j], row1, v_taps->weight[j + 1], len );
+            }
+            else
+            {
+                row0 = get_filtered_row( ctx, rows, cached, v_taps->pos[j], INT_MIN );
+                accumulate_filtered_rows( acc, row0, v_taps->weight[j], row0, 0, len );
+            }
+        }
+        ctx->dst_dib->funcs->store_filtered_row( ctx->dst_dib, 0, y, ctx->h_taps.count, acc );
+    }
+
+done:
+    HeapFree( GetProcessHeap(), 0, rows[0] );
+    HeapFree( GetProcessHeap(), 0, acc );
+}
+
+static BOOL can_filter_stretch( const dib_info *dib )
+{
+    if (dib->bit_count == 24) return TRUE;
+    if (dib->bit_count != 32) return FALSE;
+    if (dib->funcs == &funcs_8888) return TRUE;
+    return dib->red_len == 8 && dib->green_len == 8 && dib->blue_len == 8 &&
+           !((dib->red_shift | dib->green_shift | dib->blue_shift) & 7);
+}
+
+/* HALFTONE stretching of 24 and 32-bpp dibs, the rows are filtered one at a time */
+static BOOL stretch_filtered( dib_info *dst_dib, const struct bitblt_coords *dst,
+                              const dib_info *src_dib, const struct bitblt_coords *src )
+{
+    struct filter_band ctx;
+    int count;
+
+    if (!can_filter_stretch( dst_dib ) || !can_filter_stretch( src_dib )) return FALSE;
+
+    if (!calc_filter_taps( dst->x, dst->width, dst->visrect.left, dst->visrect.right,
+                           src->x, src->width, src->visrect.left, src->visrect.right, &ctx.h_taps ))
+        return FALSE;
+    if (!calc_filter_taps( dst->y, dst->height, dst->visrect.top, dst->visrect.bottom,
+                           src->y, src->height, src->visrect.top, src->visrect.bottom, &ctx.v_taps ))
+    {
+        free_filter_taps( &ctx.h_taps );
+        return FALSE;
+    }
+
+    ctx.dst_dib = dst_dib;
+    ctx.src_dib = src_dib;
+    ctx.failed  = FALSE;
+    count = get_band_count( &dst->visrect );
+    ctx.rows_per_band = max( 1, (ctx.v_taps.count + count - 1) / count );
+    run_bands( (ctx.v_taps.count + ctx.rows_per_band - 1) / ctx.rows_per_band, filter_band_proc, &ctx );
+
+    free_filter_taps( &ctx.h_taps );
+    free_filter_taps( &ctx.v_taps );
+    return !ctx.failed;
+}
+
 DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
                           const BITMAPINFO *dst_info, void *dst_bits, struct bitblt_coords *dst,
                           INT mode )
@@ -1151,11 +1688,10 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     RECT rect;
     BOOL hstretch, vstretch;
     struct stretch_params v_params, h_params;
-    int err;
+    struct stretch_band ctx;
+    struct stretch_band_state state;
+    int count;
     DWORD ret;
-    void (* row_fn)(const dib_info *dst_dib, const POINT *dst_start,
-                    const dib_info *src_dib, const POINT *src_start,
-                    const struct stretch_params *params, int mode, BOOL keep_dst);
 
     TRACE("dst %d, %d - %d x %d visrect %s src %d, %d - %d x %d visrect %s\n",
           dst->x, dst->y, dst->width, dst->height, wine_dbgstr_rect(&dst->visrect),
@@ -1189,65 +1725,38 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     dst_start.x -= dst->visrect.left;
     dst_start.y -= dst->visrect.top;
 
-    err = v_params.err_start;
+    /* HALFTONE filters the same visible area, the row functions are used for unsupported formats */
+    if (mode == HALFTONE && stretch_filtered( &dst_dib, dst, &src_dib, src )) goto done;
 
-    row_fn = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
+    if (vstretch && hstretch) mode = STRETCH_DELETESCANS;
 
-    if (vstretch)
-    {
-        BOOL need_row = TRUE;
-        RECT last_row, this_row;
-        if (hstretch) mode = STRETCH_DELETESCANS;
-        last_row.left = 0;
-        last_row.right = dst->visrect.right - dst->visrect.left;
+    ctx.dst_dib  = &dst_dib;
+    ctx.src_dib  = &src_dib;
+    ctx.v_params = &v_params;
+    ctx.h_params = &h_params;
+    ctx.mode     = mode;
+    ctx.width    = dst->visrect.right - dst->visrect.left;
+    ctx.vstretch = vstretch;
+    ctx.row_fn   = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
 
-        while (v_params.length--)
-        {
-            if (need_row)
-            {
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, FALSE );
-                need_row = FALSE;
-            }
-            else
-            {
-                last_row.top = dst_start.y - v_params.dst_inc;
-                last_row.bottom = last_row.top + 1;
-                this_row = last_row;
-                offset_rect( &this_row, 0, v_params.dst_inc );
-                copy_rect( &dst_dib, &this_row, &dst_dib, &last_row, NULL, R2_COPYPEN );
-            }
-
-            if (err > 0)
-            {
-                src_start.y += v_params.src_inc;
-                need_row = TRUE;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            dst_start.y += v_params.dst_inc;
-        }
+    count = get_band_count_for_size( h_params.length, v_params.length );
+    if (count > 1 && (ctx.states = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*ctx.states) )))
+    {
+        count = get_stretch_band_states( &ctx, dst_start, src_start, count, ctx.states );
+        run_bands( count, stretch_band_proc, &ctx );
+        HeapFree( GetProcessHeap(), 0, ctx.states );
     }
     else
     {
-        int merged_rows = 0;
-
-        while (v_params.length--)
-        {
-            if (mode != STRETCH_DELETESCANS || !merged_rows)
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, merged_rows != 0 );
-            merged_rows++;
-
-            if (err > 0)
-            {
-                dst_start.y += v_params.dst_inc;
-                merged_rows = 0;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            src_start.y += v_params.src_inc;
-        }
+        state.dst_start = dst_start;
+        state.src_start = src_start;
+        state.err       = v_params.err_start;
+        state.length    = v_params.length;
+        ctx.states      = &state;
+        stretch_band_proc( &ctx, 0 );
     }
 
+done:
     /* update coordinates, the destination rectangle is always stored at 0,0 */
     *src = *dst;
     src->x -= src->visrect.left;
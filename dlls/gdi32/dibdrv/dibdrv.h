@@ -172,6 +172,16 @@ struct stretch_params
     int dst_inc, src_inc;
 };
 
+#define FILTER_SHIFT 14  /* precision of the filter weights */
+
+struct filter_taps
+{
+    int    count;   /* number of destination pixels */
+    int   *start;   /* first tap of each destination pixel, count + 1 entries */
+    int   *pos;     /* source pixel of each tap */
+    short *weight;  /* weight of each tap, the weights of a pixel add up to 1 << FILTER_SHIFT */
+};
+
 typedef struct primitive_funcs
 {
     void            (* solid_rects)(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor);
@@ -201,6 +211,8 @@ typedef struct primitive_funcs
     void             (* shrink_row)(const dib_info *dst_dib, const POINT *dst_start,
                                     const dib_info *src_dib, const POINT *src_start,
                                     const struct stretch_params *params, int mode, BOOL keep_dst);
+    void             (* filter_row)(const dib_info *dib, int y, const struct filter_taps *taps, short *row);
+    void     (* store_filtered_row)(const dib_info *dib, int x, int y, int width, const int *acc);
 } primitive_funcs;
 
 extern const primitive_funcs funcs_8888 DECLSPEC_HIDDEN;
@@ -249,6 +261,11 @@ extern DWORD get_pixel_color( HDC hdc, const dib_info *dib, COLORREF color, BOOL
 extern int clip_rect_to_dib( const dib_info *dib, RECT *rc ) DECLSPEC_HIDDEN;
 extern int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct clipped_rects *clip_rects ) DECLSPEC_HIDDEN;
 extern void add_clipped_bounds( dibdrv_physdev *dev, const RECT *rect, HRGN clip ) DECLSPEC_HIDDEN;
+extern void accumulate_filtered_rows( int *acc, const short *row0, int weight0,
+                                      const short *row1, int weight1, int count ) DECLSPEC_HIDDEN;
+extern int get_band_count( const RECT *rect ) DECLSPEC_HIDDEN;
+extern void run_rect_bands( const RECT *rect, int count, void (*func)( void *context, const RECT *band ),
+                            void *context ) DECLSPEC_HIDDEN;
 extern int clip_line(const POINT *start, const POINT *end, const RECT *clip,
                      const bres_params *params, POINT *pt1, POINT *pt2) DECLSPEC_HIDDEN;
 extern void release_cached_font( struct cached_font *font ) DECLSPEC_HIDDEN;
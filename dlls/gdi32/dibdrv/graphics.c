@@ -43,6 +43,20 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+/* glyph bitmaps are packed into atlas pages, which are freed together with the font glyphs */
+#define GLYPH_ATLAS_PAGE_SIZE  0x10000
+/* soft limit: beyond this, glyphs of unused fonts get freed; fonts that are still selected keep
+ * theirs, since other threads may be drawing from their atlas pages without holding the lock */
+#define GLYPH_CACHE_MAX_SIZE   (4 * 1024 * 1024)
+#define GLYPH_CACHE_STATS_PERIOD 0x10000  /* glyph lookups between statistics traces */
+
+struct glyph_atlas_page
+{
+    struct list           entry;
+    SIZE_T                size;
+    SIZE_T                used;
+};
+
 struct cached_font
 {
     struct list           entry;
@@ -51,10 +65,15 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    struct list           atlas;       /* atlas pages, the current one first */
+    SIZE_T                atlas_size;  /* total size of the atlas pages */
+    LONG                  hits;        /* glyph cache statistics */
+    LONG                  misses;
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static SIZE_T glyph_cache_size;  /* total size of the atlas pages of all fonts */
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -482,10 +501,46 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+/* free all the cached glyphs of a font, font_cache_cs must be held */
+static void free_font_glyphs( struct cached_font *font )
+{
+    struct glyph_atlas_page *page, *next;
+    UINT i, j;
+
+    if (font->hits || font->misses)
+        TRACE( "%p %d %s: %u hits %u misses, %lu bytes\n", font, font->lf.lfHeight,
+               debugstr_w(font->lf.lfFaceName), font->hits, font->misses, font->atlas_size );
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+    memset( font->glyphs, 0, sizeof(font->glyphs) );
+
+    LIST_FOR_EACH_ENTRY_SAFE( page, next, &font->atlas, struct glyph_atlas_page, entry )
+        HeapFree( GetProcessHeap(), 0, page );
+    list_init( &font->atlas );
+    glyph_cache_size -= font->atlas_size;
+    font->atlas_size = 0;
+    font->hits = font->misses = 0;
+}
+
+/* free the glyphs of the least recently used fonts that aren't selected anywhere,
+ * the cache may stay above the limit if all the fonts are in use */
+static void trim_glyph_cache( SIZE_T needed )
+{
+    struct cached_font *font, *prev;
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV( font, prev, &font_cache, struct cached_font, entry )
+    {
+        if (glyph_cache_size + needed <= GLYPH_CACHE_MAX_SIZE) break;
+        if (!font->ref && font->atlas_size) free_font_glyphs( font );
+    }
+}
+
 static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags )
 {
     struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    UINT i = 0;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     GetTransform( hdc, 0x204, &font.xform );
@@ -516,19 +571,11 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
         }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
+    /* keep some of the most-recently used fonts around, the memory used by their glyphs is bounded separately */
+    if (i > 32)
     {
         ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
+        free_font_glyphs( ptr );
         list_remove( &ptr->entry );
     }
     else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
@@ -539,6 +586,9 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
 
     *ptr = font;
     ptr->ref = 1;
+    list_init( &ptr->atlas );
+    ptr->atlas_size = 0;
+    ptr->hits = ptr->misses = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -552,6 +602,55 @@ void release_cached_font( struct cached_font *font )
     if (font) InterlockedDecrement( &font->ref );
 }
 
+/* allocate space for a glyph from the font atlas, the font must be referenced */
+static struct cached_glyph *alloc_cached_glyph( struct cached_font *font, SIZE_T size )
+{
+    struct glyph_atlas_page *page = NULL;
+    struct cached_glyph *glyph;
+    SIZE_T page_size;
+
+    size = (size + 7) & ~7;
+    EnterCriticalSection( &font_cache_cs );
+    if (!list_empty( &font->atlas ))
+    {
+        page = LIST_ENTRY( list_head( &font->atlas ), struct glyph_atlas_page, entry );
+        if (page->size - page->used < size) page = NULL;
+    }
+    if (!page)
+    {
+        /* start with small pages, most fonts only ever use a few glyphs */
+        page_size = min( max( font->atlas_size, 0x1000 ), GLYPH_ATLAS_PAGE_SIZE );
+        page_size = max( page_size, sizeof(*page) + size );
+        trim_glyph_cache( page_size );
+        if (!(page = HeapAlloc( GetProcessHeap(), 0, page_size )))
+        {
+            LeaveCriticalSection( &font_cache_cs );
+            return NULL;
+        }
+        page->size = page_size;
+        page->used = sizeof(*page);
+        list_add_head( &font->atlas, &page->entry );
+        font->atlas_size += page_size;
+        glyph_cache_size += page_size;
+    }
+    glyph = (struct cached_glyph *)((BYTE *)page + page->used);
+    page->used += size;
+    LeaveCriticalSection( &font_cache_cs );
+    return glyph;
+}
+
+/* give back the space of a glyph that couldn't be filled, unless other glyphs were allocated after it */
+static void free_cached_glyph( struct cached_font *font, struct cached_glyph *glyph, SIZE_T size )
+{
+    struct glyph_atlas_page *page;
+
+    size = (size + 7) & ~7;
+    EnterCriticalSection( &font_cache_cs );
+    page = LIST_ENTRY( list_head( &font->atlas ), struct glyph_atlas_page, entry );
+    if ((BYTE *)glyph + size == (BYTE *)page + page->used) page->used -= size;
+    LeaveCriticalSection( &font_cache_cs );
+}
+
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
                                               struct cached_glyph *glyph )
 {
@@ -565,18 +664,27 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
         struct cached_glyph **ptr;
 
         ptr = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
-        if (!ptr)
-        {
-            HeapFree( GetProcessHeap(), 0, glyph );
-            return NULL;
-        }
+        if (!ptr) return NULL;
         if (InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page], ptr, NULL ))
             HeapFree( GetProcessHeap(), 0, ptr );
     }
+    /* if another thread got there first, our copy simply stays unused in the atlas */
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
-    else HeapFree( GetProcessHeap(), 0, glyph );
-    return ret;
+    return ret ? ret : glyph;
+}
+
+static void update_glyph_cache_stats( struct cached_font *font, UINT count, UINT misses )
+{
+    LONG total_hits, total_misses, total;
+
+    total_misses = InterlockedExchangeAdd( &font->misses, misses ) + misses;
+    total_hits = InterlockedExchangeAdd( &font->hits, count - misses ) + count - misses;
+    total = total_hits + total_misses;
+
+    /* report the hit rate every now and then, not only when the font is dropped */
+    if (TRACE_ON(dib) && total / GLYPH_CACHE_STATS_PERIOD != (total - count) / GLYPH_CACHE_STATS_PERIOD)
+        TRACE( "%p %d %s: %u hits %u misses, %lu bytes, %lu bytes total\n", font, font->lf.lfHeight,
+               debugstr_w(font->lf.lfFaceName), total_hits, total_misses, font->atlas_size, glyph_cache_size );
 }
 
 static struct cached_glyph *get_cached_glyph( struct cached_font *font, UINT index, UINT flags )
@@ -698,7 +806,7 @@ static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *fon
     bit_count = get_glyph_depth( font->aa_flags );
     stride = get_dib_stride( metrics.gmBlackBoxX, bit_count );
     size = metrics.gmBlackBoxY * stride;
-    glyph = HeapAlloc( GetProcessHeap(), 0, FIELD_OFFSET( struct cached_glyph, bits[size] ));
+    glyph = alloc_cached_glyph( font, FIELD_OFFSET( struct cached_glyph, bits[size] ));
     if (!glyph) return NULL;
     if (!ret) goto done;  /* zero-size glyph */
 
@@ -707,7 +815,7 @@ static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *fon
     ret = GetGlyphOutlineW( hdc, index, ggo_flags, &metrics, size, glyph->bits, &identity );
     if (ret == GDI_ERROR)
     {
-        HeapFree( GetProcessHeap(), 0, glyph );
+        free_cached_glyph( font, glyph, FIELD_OFFSET( struct cached_glyph, bits[size] ));
         return NULL;
     }
     assert( ret <= size );
@@ -739,8 +847,8 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
                            UINT flags, const WCHAR *str, UINT count, const INT *dx,
                            const struct clipped_rects *clipped_rects, RECT *bounds )
 {
-    UINT i;
-    struct cached_glyph *glyph;
+    UINT i, j, batch, misses = 0;
+    struct cached_glyph *glyph, *glyphs[64];
     dib_info glyph_dib;
     DWORD text_color;
     struct intensity_range ranges[17];
@@ -756,36 +864,50 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
     if (glyph_dib.bit_count == 8)
         get_aa_ranges( dib->funcs->pixel_to_colorref( dib, text_color ), ranges );
 
-    for (i = 0; i < count; i++)
+    for (i = 0; i < count; i += batch)
     {
-        if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( hdc, font, str[i], flags ))) continue;
+        batch = min( count - i, sizeof(glyphs) / sizeof(glyphs[0]) );
 
-        glyph_dib.width       = glyph->metrics.gmBlackBoxX;
-        glyph_dib.height      = glyph->metrics.gmBlackBoxY;
-        glyph_dib.rect.right  = glyph->metrics.gmBlackBoxX;
-        glyph_dib.rect.bottom = glyph->metrics.gmBlackBoxY;
-        glyph_dib.stride      = get_dib_stride( glyph->metrics.gmBlackBoxX, glyph_dib.bit_count );
-        glyph_dib.bits.ptr    = glyph->bits;
-
-        draw_glyph( dib, x, y, &glyph->metrics, &glyph_dib, text_color, ranges, clipped_rects, bounds );
+        /* look up the whole batch first, so that the drawing loop only deals with cached bitmaps */
+        for (j = 0; j < batch; j++)
+        {
+            if ((glyphs[j] = get_cached_glyph( font, str[i + j], flags ))) continue;
+            glyphs[j] = cache_glyph_bitmap( hdc, font, str[i + j], flags );
+            misses++;
+        }
 
-        if (dx)
+        for (j = 0; j < batch; j++)
         {
-            if (flags & ETO_PDY)
+            if (!(glyph = glyphs[j])) continue;
+
+            glyph_dib.width       = glyph->metrics.gmBlackBoxX;
+            glyph_dib.height      = glyph->metrics.gmBlackBoxY;
+            glyph_dib.rect.right  = glyph->metrics.gmBlackBoxX;
+            glyph_dib.rect.bottom = glyph->metrics.gmBlackBoxY;
+            glyph_dib.stride      = get_dib_stride( glyph->metrics.gmBlackBoxX, glyph_dib.bit_count );
+            glyph_dib.bits.ptr    = glyph->bits;
+
+            draw_glyph( dib, x, y, &glyph->metrics, &glyph_dib, text_color, ranges, clipped_rects, bounds );
+
+            if (dx)
             {
-                x += dx[ i * 2 ];
-                y += dx[ i * 2 + 1];
+                if (flags & ETO_PDY)
+                {
+                    x += dx[ (i + j) * 2 ];
+                    y += dx[ (i + j) * 2 + 1];
+                }
+                else
+                    x += dx[ i + j ];
             }
             else
-                x += dx[ i ];
-        }
-        else
-        {
-            x += glyph->metrics.gmCellIncX;
-            y += glyph->metrics.gmCellIncY;
+            {
+                x += glyph->metrics.gmCellIncX;
+                y += glyph->metrics.gmCellIncY;
+            }
         }
     }
+
+    update_glyph_cache_stats( font, count, misses );
 }
 
 BOOL render_aa_text_bitmapinfo( HDC hdc, BITMAPINFO *info, struct gdi_image_bits *bits,
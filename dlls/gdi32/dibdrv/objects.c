@@ -1751,6 +1751,20 @@ COLORREF dibdrv_SetDCPenColor( PHYSDEV dev, COLORREF color )
     return color;
 }
 
+struct solid_band
+{
+    const dib_info *dib;
+    DWORD           and;
+    DWORD           xor;
+};
+
+static void solid_band_proc( void *arg, const RECT *band )
+{
+    const struct solid_band *ctx = arg;
+
+    ctx->dib->funcs->solid_rects( ctx->dib, 1, band, ctx->and, ctx->xor );
+}
+
 /**********************************************************************
  *             solid_brush
  *
@@ -1761,9 +1775,23 @@ static BOOL solid_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
 {
     rop_mask brush_color;
     DWORD color = get_pixel_color( pdev->dev.hdc, &pdev->dib, brush->colorref, TRUE );
+    struct solid_band ctx;
+    int i, start, count;
 
     calc_rop_masks( rop, color, &brush_color );
-    dib->funcs->solid_rects( dib, num, rects, brush_color.and, brush_color.xor );
+    ctx.dib = dib;
+    ctx.and = brush_color.and;
+    ctx.xor = brush_color.xor;
+
+    /* large rectangles are filled in bands, the others are passed through together */
+    for (i = start = 0; i < num; i++)
+    {
+        if ((count = get_band_count( &rects[i] )) <= 1) continue;
+        if (i > start) dib->funcs->solid_rects( dib, i - start, rects + start, ctx.and, ctx.xor );
+        run_rect_bands( &rects[i], count, solid_band_proc, &ctx );
+        start = i + 1;
+    }
+    if (num > start) dib->funcs->solid_rects( dib, num - start, rects + start, ctx.and, ctx.xor );
     return TRUE;
 }
 
@@ -1975,6 +2003,21 @@ static BOOL select_pattern_brush( dibdrv_physdev *pdev, dib_brush *brush, BOOL *
     return TRUE;
 }
 
+struct pattern_band
+{
+    const dib_info      *dib;
+    const POINT         *origin;
+    const dib_info      *brush;
+    const rop_mask_bits *bits;
+};
+
+static void pattern_band_proc( void *arg, const RECT *band )
+{
+    const struct pattern_band *ctx = arg;
+
+    ctx->dib->funcs->pattern_rects( ctx->dib, 1, band, ctx->origin, ctx->brush, ctx->bits );
+}
+
 /**********************************************************************
  *             pattern_brush
  *
@@ -1986,6 +2029,8 @@ static BOOL pattern_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
 {
     POINT origin;
     BOOL needs_reselect = FALSE;
+    struct pattern_band ctx;
+    int i, start, count;
 
     if (rop != brush->rop)
     {
@@ -2023,7 +2068,20 @@ static BOOL pattern_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
 
     GetBrushOrgEx(pdev->dev.hdc, &origin);
 
-    dib->funcs->pattern_rects( dib, num, rects, &origin, &brush->dib, &brush->masks );
+    ctx.dib    = dib;
+    ctx.origin = &origin;
+    ctx.brush  = &brush->dib;
+    ctx.bits   = &brush->masks;
+
+    /* large rectangles are filled in bands, the others are passed through together */
+    for (i = start = 0; i < num; i++)
+    {
+        if ((count = get_band_count( &rects[i] )) <= 1) continue;
+        if (i > start) dib->funcs->pattern_rects( dib, i - start, rects + start, &origin, &brush->dib, &brush->masks );
+        run_rect_bands( &rects[i], count, pattern_band_proc, &ctx );
+        start = i + 1;
+    }
+    if (num > start) dib->funcs->pattern_rects( dib, num - start, rects + start, &origin, &brush->dib, &brush->masks );
 
     if (needs_reselect) free_pattern_brush( brush );
     return TRUE;
@@ -19,6 +19,9 @@
  */
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "gdi_private.h"
 #include "dibdrv.h"
@@ -147,35 +150,198 @@ static inline void do_rop_codes_mask_8(BYTE *dst, BYTE src, struct rop_codes *co
     do_rop_mask_8( dst, (src & codes->a1) ^ codes->a2, (src & codes->x1) ^ codes->x2, mask );
 }
 
+#ifdef __SSE2__
+
+static inline __m128i load16( const void *ptr )
+{
+    return _mm_loadu_si128( (const __m128i *)ptr );
+}
+
+static inline void store16( void *ptr, __m128i val )
+{
+    _mm_storeu_si128( (__m128i *)ptr, val );
+}
+
+static inline __m128i do_rop_sse2( __m128i dst, __m128i and, __m128i xor )
+{
+    return _mm_xor_si128( _mm_and_si128( dst, and ), xor );
+}
+
+/* apply the and/xor masks to the first len bytes, 16 at a time; returns the number of bytes done */
+static inline int do_rop_bytes_sse2( BYTE *ptr, __m128i and, __m128i xor, int len )
+{
+    int i;
+
+    for (i = 0; i + 16 <= len; i += 16) store16( ptr + i, do_rop_sse2( load16( ptr + i ), and, xor ));
+    return i;
+}
+
+/* the rop codes are either 0 or ~0, so they apply byte-wise at any depth */
+static inline __m128i do_rop_codes_sse2( __m128i dst, __m128i src, const struct rop_codes *codes )
+{
+    return do_rop_sse2( dst, _mm_xor_si128( _mm_and_si128( src, _mm_set1_epi32( codes->a1 )),
+                                            _mm_set1_epi32( codes->a2 )),
+                        _mm_xor_si128( _mm_and_si128( src, _mm_set1_epi32( codes->x1 )),
+                                       _mm_set1_epi32( codes->x2 )));
+}
+
+/* Each block is loaded before it is stored and the blocks are walked in the
+ * same direction as the scalar loops, so overlapping lines give the same result.
+ * Both return the number of bytes done, at the start or at the end of the line. */
+static inline int do_rop_codes_bytes_sse2( BYTE *dst, const BYTE *src, const struct rop_codes *codes, int len )
+{
+    int i;
+
+    for (i = 0; i + 16 <= len; i += 16)
+        store16( dst + i, do_rop_codes_sse2( load16( dst + i ), load16( src + i ), codes ));
+    return i;
+}
+
+static inline int do_rop_codes_bytes_rev_sse2( BYTE *dst, const BYTE *src, const struct rop_codes *codes, int len )
+{
+    int i;
+
+    for (i = len; i >= 16; i -= 16)
+        store16( dst + i - 16, do_rop_codes_sse2( load16( dst + i - 16 ), load16( src + i - 16 ), codes ));
+    return len - i;
+}
+
+#endif  /* __SSE2__ */
+
+static inline void do_rop_line_32(DWORD *ptr, DWORD and, DWORD xor, int len)
+{
+#ifdef __SSE2__
+    int done = do_rop_bytes_sse2( (BYTE *)ptr, _mm_set1_epi32( and ), _mm_set1_epi32( xor ), len * 4 ) / 4;
+    ptr += done;
+    len -= done;
+#endif
+    for (; len > 0; len--) do_rop_32( ptr++, and, xor );
+}
+
+static inline void do_rop_line_16(WORD *ptr, WORD and, WORD xor, int len)
+{
+#ifdef __SSE2__
+    int done = do_rop_bytes_sse2( (BYTE *)ptr, _mm_set1_epi16( and ), _mm_set1_epi16( xor ), len * 2 ) / 2;
+    ptr += done;
+    len -= done;
+#endif
+    for (; len > 0; len--) do_rop_16( ptr++, and, xor );
+}
+
+static inline void do_rop_line_8(BYTE *ptr, BYTE and, BYTE xor, int len)
+{
+#ifdef __SSE2__
+    int done = do_rop_bytes_sse2( ptr, _mm_set1_epi8( and ), _mm_set1_epi8( xor ), len );
+    ptr += done;
+    len -= done;
+#endif
+    for (; len > 0; len--) do_rop_8( ptr++, and, xor );
+}
+
+/* apply the masks to count DWORD triplets, i.e. groups of four 24-bpp pixels */
+static inline void do_rop_triplets_24(DWORD *ptr, const DWORD *and_masks, const DWORD *xor_masks, int count)
+{
+#ifdef __SSE2__
+    const __m128i and0 = _mm_setr_epi32( and_masks[0], and_masks[1], and_masks[2], and_masks[0] );
+    const __m128i and1 = _mm_setr_epi32( and_masks[1], and_masks[2], and_masks[0], and_masks[1] );
+    const __m128i and2 = _mm_setr_epi32( and_masks[2], and_masks[0], and_masks[1], and_masks[2] );
+    const __m128i xor0 = _mm_setr_epi32( xor_masks[0], xor_masks[1], xor_masks[2], xor_masks[0] );
+    const __m128i xor1 = _mm_setr_epi32( xor_masks[1], xor_masks[2], xor_masks[0], xor_masks[1] );
+    const __m128i xor2 = _mm_setr_epi32( xor_masks[2], xor_masks[0], xor_masks[1], xor_masks[2] );
+
+    for (; count >= 4; count -= 4, ptr += 12)
+    {
+        store16( ptr,     do_rop_sse2( load16( ptr ),     and0, xor0 ));
+        store16( ptr + 4, do_rop_sse2( load16( ptr + 4 ), and1, xor1 ));
+        store16( ptr + 8, do_rop_sse2( load16( ptr + 8 ), and2, xor2 ));
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        do_rop_32(ptr++, and_masks[0], xor_masks[0]);
+        do_rop_32(ptr++, and_masks[1], xor_masks[1]);
+        do_rop_32(ptr++, and_masks[2], xor_masks[2]);
+    }
+}
+
+static inline void memset_triplets_24(DWORD *ptr, const DWORD *xor_masks, int count)
+{
+#ifdef __SSE2__
+    const __m128i xor0 = _mm_setr_epi32( xor_masks[0], xor_masks[1], xor_masks[2], xor_masks[0] );
+    const __m128i xor1 = _mm_setr_epi32( xor_masks[1], xor_masks[2], xor_masks[0], xor_masks[1] );
+    const __m128i xor2 = _mm_setr_epi32( xor_masks[2], xor_masks[0], xor_masks[1], xor_masks[2] );
+
+    for (; count >= 4; count -= 4, ptr += 12)
+    {
+        store16( ptr,     xor0 );
+        store16( ptr + 4, xor1 );
+        store16( ptr + 8, xor2 );
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        *ptr++ = xor_masks[0];
+        *ptr++ = xor_masks[1];
+        *ptr++ = xor_masks[2];
+    }
+}
+
 static inline void do_rop_codes_line_32(DWORD *dst, const DWORD *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    int done = do_rop_codes_bytes_sse2( (BYTE *)dst, (const BYTE *)src, codes, len * 4 ) / 4;
+    dst += done;
+    src += done;
+    len -= done;
+#endif
     for (; len > 0; len--, src++, dst++) do_rop_codes_32( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_rev_32(DWORD *dst, const DWORD *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    len -= do_rop_codes_bytes_rev_sse2( (BYTE *)dst, (const BYTE *)src, codes, len * 4 ) / 4;
+#endif
     for (src += len - 1, dst += len - 1; len > 0; len--, src--, dst--)
         do_rop_codes_32( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_16(WORD *dst, const WORD *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    int done = do_rop_codes_bytes_sse2( (BYTE *)dst, (const BYTE *)src, codes, len * 2 ) / 2;
+    dst += done;
+    src += done;
+    len -= done;
+#endif
     for (; len > 0; len--, src++, dst++) do_rop_codes_16( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_rev_16(WORD *dst, const WORD *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    len -= do_rop_codes_bytes_rev_sse2( (BYTE *)dst, (const BYTE *)src, codes, len * 2 ) / 2;
+#endif
     for (src += len - 1, dst += len - 1; len > 0; len--, src--, dst--)
         do_rop_codes_16( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_8(BYTE *dst, const BYTE *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    int done = do_rop_codes_bytes_sse2( dst, src, codes, len );
+    dst += done;
+    src += done;
+    len -= done;
+#endif
     for (; len > 0; len--, src++, dst++) do_rop_codes_8( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_rev_8(BYTE *dst, const BYTE *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    len -= do_rop_codes_bytes_rev_sse2( dst, src, codes, len );
+#endif
     for (src += len - 1, dst += len - 1; len > 0; len--, src--, dst--)
         do_rop_codes_8( dst, *src, codes );
 }
@@ -282,8 +448,8 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -292,8 +458,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_line_32( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -357,12 +522,9 @@ static void solid_rects_24(const dib_info *dib, int num, const RECT *rc, DWORD a
                     break;
                 }
 
-                for(x = (left + 3) & ~3; x < (right & ~3); x += 4)
-                {
-                    do_rop_32(ptr++, and_masks[0], xor_masks[0]);
-                    do_rop_32(ptr++, and_masks[1], xor_masks[1]);
-                    do_rop_32(ptr++, and_masks[2], xor_masks[2]);
-                }
+                x = (left + 3) & ~3;
+                do_rop_triplets_24( ptr, and_masks, xor_masks, ((right & ~3) - x) / 4 );
+                ptr += ((right & ~3) - x) / 4 * 3;
 
                 switch(right & 3)
                 {
@@ -404,12 +566,9 @@ static void solid_rects_24(const dib_info *dib, int num, const RECT *rc, DWORD a
                     break;
                 }
 
-                for(x = (left + 3) & ~3; x < (right & ~3); x += 4)
-                {
-                    *ptr++ = xor_masks[0];
-                    *ptr++ = xor_masks[1];
-                    *ptr++ = xor_masks[2];
-                }
+                x = (left + 3) & ~3;
+                memset_triplets_24( ptr, xor_masks, ((right & ~3) - x) / 4 );
+                ptr += ((right & ~3) - x) / 4 * 3;
 
                 switch(right & 3)
                 {
@@ -433,8 +592,8 @@ static void solid_rects_24(const dib_info *dib, int num, const RECT *rc, DWORD a
 
 static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    WORD *ptr, *start;
-    int x, y, i;
+    WORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -443,8 +602,7 @@ static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_16(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_16(ptr++, and, xor);
+                do_rop_line_16( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
                 memset_16( start, xor, rc->right - rc->left );
@@ -453,8 +611,8 @@ static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD a
 
 static void solid_rects_8(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    BYTE *ptr, *start;
-    int x, y, i;
+    BYTE *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -463,8 +621,7 @@ static void solid_rects_8(const dib_info *dib, int num, const RECT *rc, DWORD an
         start = get_pixel_ptr_8(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_8(ptr++, and, xor);
+                do_rop_line_8( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride)
                 memset( start, xor, rc->right - rc->left );
@@ -1801,6 +1958,194 @@ static inline BOOL bit_fields_match(const dib_info *d1, const dib_info *d2)
            d1->blue_mask  == d2->blue_mask;
 }
 
+#ifdef __SSE2__
+
+/* pack the low words of two vectors of dwords, truncating like the scalar code does */
+static inline __m128i pack_dwords_sse2( __m128i lo, __m128i hi )
+{
+    return _mm_packs_epi32( _mm_srai_epi32( _mm_slli_epi32( lo, 16 ), 16 ),
+                            _mm_srai_epi32( _mm_slli_epi32( hi, 16 ), 16 ));
+}
+
+static inline __m128i put_field_sse2( __m128i field, int shift, int len )
+{
+    shift = shift - (8 - len);
+    field = _mm_and_si128( field, _mm_set1_epi32( field_masks[len] ));
+    if (shift < 0)
+        return _mm_srl_epi32( field, _mm_cvtsi32_si128( -shift ));
+    return _mm_sll_epi32( field, _mm_cvtsi32_si128( shift ));
+}
+
+static inline __m128i srl_sse2( __m128i val, int shift )
+{
+    return _mm_srl_epi32( val, _mm_cvtsi32_si128( shift ));
+}
+
+static inline __m128i and_sse2( __m128i val, DWORD mask )
+{
+    return _mm_and_si128( val, _mm_set1_epi32( mask ));
+}
+
+static inline __m128i rgb_555_to_8888_sse2( __m128i val )
+{
+    val = _mm_or_si128( _mm_or_si128( and_sse2( _mm_slli_epi32( val, 9 ), 0xf80000 ),
+                                      and_sse2( _mm_slli_epi32( val, 6 ), 0x00f800 )),
+                        and_sse2( _mm_slli_epi32( val, 3 ), 0x0000f8 ));
+    /* replicate the top bits of each component into the low ones */
+    return _mm_or_si128( val, and_sse2( _mm_srli_epi32( val, 5 ), 0x070707 ));
+}
+
+static inline __m128i rgb_565_to_8888_sse2( __m128i val, const dib_info *dib )
+{
+    val = _mm_or_si128( _mm_or_si128( and_sse2( _mm_slli_epi32( srl_sse2( val, dib->red_shift ), 19 ), 0xf80000 ),
+                                      and_sse2( _mm_slli_epi32( srl_sse2( val, dib->green_shift ), 10 ), 0x00fc00 )),
+                        and_sse2( _mm_slli_epi32( srl_sse2( val, dib->blue_shift ), 3 ), 0x0000f8 ));
+    return _mm_or_si128( _mm_or_si128( val, and_sse2( _mm_srli_epi32( val, 5 ), 0x070007 )),
+                         and_sse2( _mm_srli_epi32( val, 6 ), 0x000300 ));
+}
+
+#endif  /* __SSE2__ */
+
+static inline void convert_line_24_to_8888( DWORD *dst, const BYTE *src, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    /* four pixels per block, but 16 bytes are read so two more have to follow */
+    for (; x + 6 <= len; x += 4, src += 12)
+    {
+        __m128i val = load16( src );
+        __m128i p01 = _mm_unpacklo_epi32( val, _mm_srli_si128( val, 3 ));
+        __m128i p23 = _mm_unpacklo_epi32( _mm_srli_si128( val, 6 ), _mm_srli_si128( val, 9 ));
+        store16( dst + x, and_sse2( _mm_unpacklo_epi64( p01, p23 ), 0x00ffffff ));
+    }
+#endif
+    for (; x < len; x++, src += 3) dst[x] = (src[2] << 16) | (src[1] << 8) | src[0];
+}
+
+static inline void convert_line_8888_to_24( BYTE *dst, const DWORD *src, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i even = _mm_set_epi32( 0, 0x00ffffff, 0, 0x00ffffff );
+    const __m128i odd = _mm_set_epi32( 0x00ffffff, 0, 0x00ffffff, 0 );
+    const __m128i low = _mm_set_epi32( 0, 0, 0x0000ffff, 0xffffffff );
+
+    for (; x + 4 <= len; x += 4, dst += 12)
+    {
+        __m128i val = load16( src + x );
+
+        /* pack each pair of pixels into the low 6 bytes of its qword, then join the qwords */
+        val = _mm_or_si128( _mm_and_si128( val, even ), _mm_srli_epi64( _mm_and_si128( val, odd ), 8 ));
+        val = _mm_or_si128( _mm_and_si128( val, low ), _mm_andnot_si128( low, _mm_srli_si128( val, 2 )));
+        _mm_storel_epi64( (__m128i *)dst, val );
+        *(DWORD *)(dst + 8) = _mm_cvtsi128_si32( _mm_srli_si128( val, 8 ));
+    }
+#endif
+    for (; x < len; x++)
+    {
+        *dst++ =  src[x]        & 0xff;
+        *dst++ = (src[x] >>  8) & 0xff;
+        *dst++ = (src[x] >> 16) & 0xff;
+    }
+}
+
+static inline void convert_line_555_to_8888( DWORD *dst, const WORD *src, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + 8 <= len; x += 8)
+    {
+        __m128i val = load16( src + x );
+        store16( dst + x,     rgb_555_to_8888_sse2( _mm_unpacklo_epi16( val, zero )));
+        store16( dst + x + 4, rgb_555_to_8888_sse2( _mm_unpackhi_epi16( val, zero )));
+    }
+#endif
+    for (; x < len; x++)
+    {
+        DWORD src_val = src[x];
+        dst[x] = ((src_val << 9) & 0xf80000) | ((src_val << 4) & 0x070000) |
+                 ((src_val << 6) & 0x00f800) | ((src_val << 1) & 0x000700) |
+                 ((src_val << 3) & 0x0000f8) | ((src_val >> 2) & 0x000007);
+    }
+}
+
+static inline void convert_line_565_to_8888( DWORD *dst, const WORD *src, int len, const dib_info *dib )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + 8 <= len; x += 8)
+    {
+        __m128i val = load16( src + x );
+        store16( dst + x,     rgb_565_to_8888_sse2( _mm_unpacklo_epi16( val, zero ), dib ));
+        store16( dst + x + 4, rgb_565_to_8888_sse2( _mm_unpackhi_epi16( val, zero ), dib ));
+    }
+#endif
+    for (; x < len; x++)
+    {
+        DWORD src_val = src[x];
+        dst[x] = (((src_val >> dib->red_shift)   << 19) & 0xf80000) |
+                 (((src_val >> dib->red_shift)   << 14) & 0x070000) |
+                 (((src_val >> dib->green_shift) << 10) & 0x00fc00) |
+                 (((src_val >> dib->green_shift) <<  4) & 0x000300) |
+                 (((src_val >> dib->blue_shift)  <<  3) & 0x0000f8) |
+                 (((src_val >> dib->blue_shift)  >>  2) & 0x000007);
+    }
+}
+
+static inline void convert_line_8888_to_555( WORD *dst, const DWORD *src, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 8 <= len; x += 8)
+    {
+        __m128i lo = load16( src + x ), hi = load16( src + x + 4 );
+
+        lo = _mm_or_si128( _mm_or_si128( and_sse2( _mm_srli_epi32( lo, 9 ), 0x7c00 ),
+                                         and_sse2( _mm_srli_epi32( lo, 6 ), 0x03e0 )),
+                           and_sse2( _mm_srli_epi32( lo, 3 ), 0x001f ));
+        hi = _mm_or_si128( _mm_or_si128( and_sse2( _mm_srli_epi32( hi, 9 ), 0x7c00 ),
+                                         and_sse2( _mm_srli_epi32( hi, 6 ), 0x03e0 )),
+                           and_sse2( _mm_srli_epi32( hi, 3 ), 0x001f ));
+        store16( dst + x, pack_dwords_sse2( lo, hi ));
+    }
+#endif
+    for (; x < len; x++)
+        dst[x] = ((src[x] >> 9) & 0x7c00) | ((src[x] >> 6) & 0x03e0) | ((src[x] >> 3) & 0x001f);
+}
+
+static inline void convert_line_8888_to_masks_16( WORD *dst, const DWORD *src, int len, const dib_info *dib )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 8 <= len; x += 8)
+    {
+        __m128i lo = load16( src + x ), hi = load16( src + x + 4 );
+
+        lo = _mm_or_si128( _mm_or_si128( put_field_sse2( _mm_srli_epi32( lo, 16 ), dib->red_shift, dib->red_len ),
+                                         put_field_sse2( _mm_srli_epi32( lo, 8 ), dib->green_shift, dib->green_len )),
+                           put_field_sse2( lo, dib->blue_shift, dib->blue_len ));
+        hi = _mm_or_si128( _mm_or_si128( put_field_sse2( _mm_srli_epi32( hi, 16 ), dib->red_shift, dib->red_len ),
+                                         put_field_sse2( _mm_srli_epi32( hi, 8 ), dib->green_shift, dib->green_len )),
+                           put_field_sse2( hi, dib->blue_shift, dib->blue_len ));
+        store16( dst + x, pack_dwords_sse2( lo, hi ));
+    }
+#endif
+    for (; x < len; x++)
+        dst[x] = put_field(src[x] >> 16, dib->red_shift,   dib->red_len)   |
+                 put_field(src[x] >>  8, dib->green_shift, dib->green_len) |
+                 put_field(src[x],       dib->blue_shift,  dib->blue_len);
+}
+
 static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_rect, BOOL dither)
 {
     DWORD *dst_start = get_pixel_ptr_32(dst, 0, 0), *dst_pixel, src_val;
@@ -1867,22 +2212,12 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
 
     case 24:
     {
-        BYTE *src_start = get_pixel_ptr_24(src, src_rect->left, src_rect->top), *src_pixel;
+        BYTE *src_start = get_pixel_ptr_24(src, src_rect->left, src_rect->top);
 
         for(y = src_rect->top; y < src_rect->bottom; y++)
         {
-            dst_pixel = dst_start;
-            src_pixel = src_start;
-            for(x = src_rect->left; x < src_rect->right; x++)
-            {
-                RGBQUAD rgb;
-                rgb.rgbBlue  = *src_pixel++;
-                rgb.rgbGreen = *src_pixel++;
-                rgb.rgbRed   = *src_pixel++;
-
-                *dst_pixel++ = ((rgb.rgbRed << 16) & 0xff0000) | ((rgb.rgbGreen << 8) & 0x00ff00) | (rgb.rgbBlue & 0x0000ff);
-            }
-            if(pad_size) memset(dst_pixel, 0, pad_size);
+            convert_line_24_to_8888(dst_start, src_start, src_rect->right - src_rect->left);
+            if(pad_size) memset(dst_start + (src_rect->right - src_rect->left), 0, pad_size);
             dst_start += dst->stride / 4;
             src_start += src->stride;
         }
@@ -1896,16 +2231,8 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
-                {
-                    src_val = *src_pixel++;
-                    *dst_pixel++ = ((src_val << 9) & 0xf80000) | ((src_val << 4) & 0x070000) |
-                                   ((src_val << 6) & 0x00f800) | ((src_val << 1) & 0x000700) |
-                                   ((src_val << 3) & 0x0000f8) | ((src_val >> 2) & 0x000007);
-                }
-                if(pad_size) memset(dst_pixel, 0, pad_size);
+                convert_line_555_to_8888(dst_start, src_start, src_rect->right - src_rect->left);
+                if(pad_size) memset(dst_start + (src_rect->right - src_rect->left), 0, pad_size);
                 dst_start += dst->stride / 4;
                 src_start += src->stride / 2;
             }
@@ -1937,17 +2264,8 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
             {
                 dst_pixel = dst_start;
                 src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
-                {
-                    src_val = *src_pixel++;
-                    *dst_pixel++ = (((src_val >> src->red_shift)   << 19) & 0xf80000) |
-                                   (((src_val >> src->red_shift)   << 14) & 0x070000) |
-                                   (((src_val >> src->green_shift) << 10) & 0x00fc00) |
-                                   (((src_val >> src->green_shift) <<  4) & 0x000300) |
-                                   (((src_val >> src->blue_shift)  <<  3) & 0x0000f8) |
-                                   (((src_val >> src->blue_shift)  >>  2) & 0x000007);
-                }
-                if(pad_size) memset(dst_pixel, 0, pad_size);
+                convert_line_565_to_8888(dst_start, src_start, src_rect->right - src_rect->left, src);
+                if(pad_size) memset(dst_start + (src_rect->right - src_rect->left), 0, pad_size);
                 dst_start += dst->stride / 4;
                 src_start += src->stride / 2;
             }
@@ -2322,16 +2640,8 @@ static void convert_to_24(dib_info *dst, const dib_info *src, const RECT *src_re
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
-                {
-                    src_val = *src_pixel++;
-                    *dst_pixel++ =  src_val        & 0xff;
-                    *dst_pixel++ = (src_val >>  8) & 0xff;
-                    *dst_pixel++ = (src_val >> 16) & 0xff;
-                }
-                if(pad_size) memset(dst_pixel, 0, pad_size);
+                convert_line_8888_to_24(dst_start, src_start, src_rect->right - src_rect->left);
+                if(pad_size) memset(dst_start + (src_rect->right - src_rect->left) * 3, 0, pad_size);
                 dst_start += dst->stride;
                 src_start += src->stride / 4;
             }
@@ -2569,14 +2879,8 @@ static void convert_to_555(dib_info *dst, const dib_info *src, const RECT *src_r
             {
                 dst_pixel = dst_start;
                 src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
-                {
-                    src_val = *src_pixel++;
-                    *dst_pixel++ = ((src_val >> 9) & 0x7c00) |
-                                   ((src_val >> 6) & 0x03e0) |
-                                   ((src_val >> 3) & 0x001f);
-                }
-                if(pad_size) memset(dst_pixel, 0, pad_size);
+                convert_line_8888_to_555(dst_start, src_start, src_rect->right - src_rect->left);
+                if(pad_size) memset(dst_start + (src_rect->right - src_rect->left), 0, pad_size);
                 dst_start += dst->stride / 2;
                 src_start += src->stride / 4;
             }
@@ -2812,14 +3116,8 @@ static void convert_to_16(dib_info *dst, const dib_info *src, const RECT *src_re
             {
                 dst_pixel = dst_start;
                 src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
-                {
-                    src_val = *src_pixel++;
-                    *dst_pixel++ = put_field(src_val >> 16, dst->red_shift,   dst->red_len)   |
-                                   put_field(src_val >>  8, dst->green_shift, dst->green_len) |
-                                   put_field(src_val,       dst->blue_shift,  dst->blue_len);
-                }
-                if(pad_size) memset(dst_pixel, 0, pad_size);
+                convert_line_8888_to_masks_16(dst_start, src_start, src_rect->right - src_rect->left, dst);
+                if(pad_size) memset(dst_start + (src_rect->right - src_rect->left), 0, pad_size);
                 dst_start += dst->stride / 2;
                 src_start += src->stride / 4;
             }
@@ -4132,14 +4430,6 @@ static inline DWORD blend_argb_constant_alpha( DWORD dst, DWORD src, DWORD alpha
             blend_color( dst >> 24, src >> 24, alpha ) << 24);
 }
 
-static inline DWORD blend_argb_no_src_alpha( DWORD dst, DWORD src, DWORD alpha )
-{
-    return (blend_color( dst, src, alpha ) |
-            blend_color( dst >> 8, src >> 8, alpha ) << 8 |
-            blend_color( dst >> 16, src >> 16, alpha ) << 16 |
-            blend_color( dst >> 24, 255, alpha ) << 24);
-}
-
 static inline DWORD blend_argb( DWORD dst, DWORD src )
 {
     BYTE b = (BYTE)src;
@@ -4182,32 +4472,137 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef __SSE2__
+
+/* (val + 127) / 255 on each 16-bit component, exact for val <= 255 * 255 */
+static inline __m128i div255_sse2( __m128i val )
+{
+    val = _mm_add_epi16( val, _mm_set1_epi16( 127 ));
+    return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( val, _mm_set1_epi16( 1 )),
+                                          _mm_srli_epi16( val, 8 )), 8 );
+}
+
+/* spread the alpha of two unpacked pixels to all their components */
+static inline __m128i get_alpha_sse2( __m128i val )
+{
+    return _mm_shufflehi_epi16( _mm_shufflelo_epi16( val, 0xff ), 0xff );
+}
+
+/* blend_argb() on two unpacked pixels, the sums can exceed 255 if the source isn't premultiplied */
+static inline __m128i blend_argb_sse2( __m128i dst, __m128i src )
+{
+    __m128i inv_alpha = _mm_sub_epi16( _mm_set1_epi16( 255 ), get_alpha_sse2( src ));
+    return _mm_add_epi16( src, div255_sse2( _mm_mullo_epi16( dst, inv_alpha )));
+}
+
+/* Blend four pixels at a time; returns the number of pixels done. Blocks where
+ * a component overflows go through the scalar code, which lets the carry spill
+ * into the next component. */
+static inline int blend_argb_line_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128(), max = _mm_set1_epi16( 255 );
+    const __m128i alpha_mask = _mm_set1_epi32( 0xff000000 ), const_alpha = _mm_set1_epi16( alpha );
+    int x, i;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = load16( src + x ), d, lo, hi;
+
+        if (_mm_movemask_epi8( _mm_cmpeq_epi32( s, zero )) == 0xffff) continue;
+        if (alpha == 255 && _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( s, alpha_mask ),
+                                                                alpha_mask )) == 0xffff)
+        {
+            store16( dst + x, s );
+            continue;
+        }
+
+        d  = load16( dst + x );
+        lo = _mm_unpacklo_epi8( s, zero );
+        hi = _mm_unpackhi_epi8( s, zero );
+        if (alpha != 255)
+        {
+            lo = div255_sse2( _mm_mullo_epi16( lo, const_alpha ));
+            hi = div255_sse2( _mm_mullo_epi16( hi, const_alpha ));
+        }
+        lo = blend_argb_sse2( _mm_unpacklo_epi8( d, zero ), lo );
+        hi = blend_argb_sse2( _mm_unpackhi_epi8( d, zero ), hi );
+
+        if (_mm_movemask_epi8( _mm_cmpgt_epi16( _mm_or_si128( lo, hi ), max )))
+        {
+            for (i = x; i < x + 4; i++)
+                dst[i] = alpha == 255 ? blend_argb( dst[i], src[i] ) : blend_argb_alpha( dst[i], src[i], alpha );
+            continue;
+        }
+        store16( dst + x, _mm_packus_epi16( lo, hi ));
+    }
+    return x;
+}
+
+/* blend_argb_constant_alpha() on four pixels at a time; returns the number of pixels done */
+static inline int blend_argb_constant_alpha_line_sse2( DWORD *dst, const DWORD *src, int len,
+                                                       DWORD alpha, DWORD src_or )
+{
+    const __m128i zero = _mm_setzero_si128(), bits = _mm_set1_epi32( src_or );
+    const __m128i src_alpha = _mm_set1_epi16( alpha ), dst_alpha = _mm_set1_epi16( 255 - alpha );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_or_si128( load16( src + x ), bits ), d = load16( dst + x ), lo, hi;
+
+        lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), src_alpha ),
+                            _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), dst_alpha ));
+        hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), src_alpha ),
+                            _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), dst_alpha ));
+        store16( dst + x, _mm_packus_epi16( div255_sse2( lo ), div255_sse2( hi )));
+    }
+    return x;
+}
+
+#endif  /* __SSE2__ */
+
+static inline void blend_argb_line( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    x = blend_argb_line_sse2( dst, src, len, alpha );
+#endif
+    if (alpha == 255)
+        for (; x < len; x++) dst[x] = blend_argb( dst[x], src[x] );
+    else
+        for (; x < len; x++) dst[x] = blend_argb_alpha( dst[x], src[x], alpha );
+}
+
+static inline void blend_argb_constant_alpha_line( DWORD *dst, const DWORD *src, int len,
+                                                   DWORD alpha, DWORD src_or )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    x = blend_argb_constant_alpha_line_sse2( dst, src, len, alpha, src_or );
+#endif
+    for (; x < len; x++) dst[x] = blend_argb_constant_alpha( dst[x], src[x] | src_or, alpha );
+}
+
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
                             const dib_info *src, const POINT *origin, BLENDFUNCTION blend)
 {
     DWORD *src_ptr = get_pixel_ptr_32( src, origin->x, origin->y );
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
-    int x, y;
+    int y;
 
     if (blend.AlphaFormat & AC_SRC_ALPHA)
-    {
-	if (blend.SourceConstantAlpha == 255)
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
-        else
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-    }
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_argb_line( dst_ptr, src_ptr, rc->right - rc->left, blend.SourceConstantAlpha );
     else if (src->compression == BI_RGB)
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_argb_constant_alpha_line( dst_ptr, src_ptr, rc->right - rc->left,
+                                            blend.SourceConstantAlpha, 0 );
     else
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_argb_constant_alpha_line( dst_ptr, src_ptr, rc->right - rc->left,
+                                            blend.SourceConstantAlpha, 0xff000000 );
 }
 
 static void blend_rect_32(const dib_info *dst, const RECT *rc,
@@ -6225,6 +6620,160 @@ static void shrink_row_null(const dib_info *dst_dib, const POINT *dst_start,
     return;
 }
 
+/* Filtered stretching for the HALFTONE mode.  Source rows are first filtered
+ * horizontally into 4 shorts per pixel with 7 bits of fraction, the rows are
+ * then accumulated vertically and the result is rounded back to 8 bits per
+ * channel.  The SSE2 and C versions produce identical results. */
+
+#define FILTER_ROW_SHIFT 7
+#define FILTER_ACC_SHIFT (FILTER_ROW_SHIFT + FILTER_SHIFT)
+
+static inline DWORD get_filter_pixel( const BYTE *ptr, int x, int bytes )
+{
+    if (bytes == 4) return ((const DWORD *)ptr)[x];
+    ptr += x * 3;
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16);
+}
+
+static inline void filter_row_bytes( const BYTE *ptr, int bytes, const struct filter_taps *taps, short *row )
+{
+    int i, j;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32( 1 << (FILTER_ROW_SHIFT - 1) );
+
+    for (i = 0; i < taps->count; i++, row += 4)
+    {
+        __m128i sum = round, p0, p1;
+
+        for (j = taps->start[i]; j + 1 < taps->start[i + 1]; j += 2)
+        {
+            p0 = _mm_unpacklo_epi8( _mm_cvtsi32_si128( get_filter_pixel( ptr, taps->pos[j], bytes )), zero );
+            p1 = _mm_unpacklo_epi8( _mm_cvtsi32_si128( get_filter_pixel( ptr, taps->pos[j + 1], bytes )), zero );
+            sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_unpacklo_epi16( p0, p1 ),
+                                                      _mm_set1_epi32( (WORD)taps->weight[j] |
+                                                                      ((DWORD)taps->weight[j + 1] << 16) )));
+        }
+        if (j < taps->start[i + 1])
+        {
+            p0 = _mm_unpacklo_epi8( _mm_cvtsi32_si128( get_filter_pixel( ptr, taps->pos[j], bytes )), zero );
+            sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_unpacklo_epi16( p0, zero ),
+                                                      _mm_set1_epi32( (WORD)taps->weight[j] )));
+        }
+        sum = _mm_srai_epi32( sum, FILTER_ROW_SHIFT );
+        _mm_storel_epi64( (__m128i *)row, _mm_packs_epi32( sum, sum ));
+    }
+#else
+    for (i = 0; i < taps->count; i++, row += 4)
+    {
+        int b, g, r, a;
+
+        b = g = r = a = 1 << (FILTER_ROW_SHIFT - 1);
+        for (j = taps->start[i]; j < taps->start[i + 1]; j++)
+        {
+            DWORD pixel = get_filter_pixel( ptr, taps->pos[j], bytes );
+            b += (pixel & 0xff) * taps->weight[j];
+            g += ((pixel >> 8) & 0xff) * taps->weight[j];
+            r += ((pixel >> 16) & 0xff) * taps->weight[j];
+            a += (pixel >> 24) * taps->weight[j];
+        }
+        row[0] = b >> FILTER_ROW_SHIFT;
+        row[1] = g >> FILTER_ROW_SHIFT;
+        row[2] = r >> FILTER_ROW_SHIFT;
+        row[3] = a >> FILTER_ROW_SHIFT;
+    }
+#endif
+}
+
+static void filter_row_32(const dib_info *dib, int y, const struct filter_taps *taps, short *row)
+{
+    filter_row_bytes( (const BYTE *)get_pixel_ptr_32( dib, 0, y ), 4, taps, row );
+}
+
+static void filter_row_24(const dib_info *dib, int y, const struct filter_taps *taps, short *row)
+{
+    filter_row_bytes( get_pixel_ptr_24( dib, 0, y ), 3, taps, row );
+}
+
+static void filter_row_null(const dib_info *dib, int y, const struct filter_taps *taps, short *row)
+{
+    FIXME("bit count %d\n", dib->bit_count);
+}
+
+/* add two horizontally filtered rows with their weights to the accumulator */
+void accumulate_filtered_rows( int *acc, const short *row0, int weight0,
+                               const short *row1, int weight1, int count )
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i weights = _mm_set1_epi32( (WORD)weight0 | ((DWORD)weight1 << 16) );
+
+    for ( ; i + 8 <= count; i += 8)
+    {
+        __m128i r0 = load16( row0 + i ), r1 = load16( row1 + i );
+
+        store16( acc + i, _mm_add_epi32( load16( acc + i ),
+                                         _mm_madd_epi16( _mm_unpacklo_epi16( r0, r1 ), weights )));
+        store16( acc + i + 4, _mm_add_epi32( load16( acc + i + 4 ),
+                                             _mm_madd_epi16( _mm_unpackhi_epi16( r0, r1 ), weights )));
+    }
+#endif
+    for ( ; i < count; i++) acc[i] += row0[i] * weight0 + row1[i] * weight1;
+}
+
+static inline void store_filtered_bytes( BYTE *ptr, int bytes, int width, const int *acc )
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i round = _mm_set1_epi32( 1 << (FILTER_ACC_SHIFT - 1) );
+
+    for ( ; i + 4 <= width; i += 4, acc += 16)
+    {
+        __m128i v0 = _mm_srai_epi32( _mm_add_epi32( load16( acc ), round ), FILTER_ACC_SHIFT );
+        __m128i v1 = _mm_srai_epi32( _mm_add_epi32( load16( acc + 4 ), round ), FILTER_ACC_SHIFT );
+        __m128i v2 = _mm_srai_epi32( _mm_add_epi32( load16( acc + 8 ), round ), FILTER_ACC_SHIFT );
+        __m128i v3 = _mm_srai_epi32( _mm_add_epi32( load16( acc + 12 ), round ), FILTER_ACC_SHIFT );
+        __m128i pixels = _mm_packus_epi16( _mm_packs_epi32( v0, v1 ), _mm_packs_epi32( v2, v3 ));
+
+        if (bytes == 4) store16( ptr + i * 4, pixels );
+        else
+        {
+            DWORD buf[4];
+            int j;
+
+            store16( buf, pixels );
+            for (j = 0; j < 4; j++)
+            {
+                ptr[(i + j) * 3]     = buf[j];
+                ptr[(i + j) * 3 + 1] = buf[j] >> 8;
+                ptr[(i + j) * 3 + 2] = buf[j] >> 16;
+            }
+        }
+    }
+#endif
+    for ( ; i < width; i++, acc += 4)
+    {
+        ptr[i * bytes]     = (acc[0] + (1 << (FILTER_ACC_SHIFT - 1))) >> FILTER_ACC_SHIFT;
+        ptr[i * bytes + 1] = (acc[1] + (1 << (FILTER_ACC_SHIFT - 1))) >> FILTER_ACC_SHIFT;
+        ptr[i * bytes + 2] = (acc[2] + (1 << (FILTER_ACC_SHIFT - 1))) >> FILTER_ACC_SHIFT;
+        if (bytes == 4) ptr[i * 4 + 3] = (acc[3] + (1 << (FILTER_ACC_SHIFT - 1))) >> FILTER_ACC_SHIFT;
+    }
+}
+
+static void store_filtered_row_32(const dib_info *dib, int x, int y, int width, const int *acc)
+{
+    store_filtered_bytes( (BYTE *)get_pixel_ptr_32( dib, x, y ), 4, width, acc );
+}
+
+static void store_filtered_row_24(const dib_info *dib, int x, int y, int width, const int *acc)
+{
+    store_filtered_bytes( get_pixel_ptr_24( dib, x, y ), 3, width, acc );
+}
+
+static void store_filtered_row_null(const dib_info *dib, int x, int y, int width, const int *acc)
+{
+    FIXME("bit count %d\n", dib->bit_count);
+}
+
 const primitive_funcs funcs_8888 =
 {
     solid_rects_32,
@@ -6242,7 +6791,9 @@ const primitive_funcs funcs_8888 =
     create_rop_masks_32,
     create_dither_masks_null,
     stretch_row_32,
-    shrink_row_32
+    shrink_row_32,
+    filter_row_32,
+    store_filtered_row_32
 };
 
 const primitive_funcs funcs_32 =
@@ -6262,7 +6813,9 @@ const primitive_funcs funcs_32 =
     create_rop_masks_32,
     create_dither_masks_null,
     stretch_row_32,
-    shrink_row_32
+    shrink_row_32,
+    filter_row_32,
+    store_filtered_row_32
 };
 
 const primitive_funcs funcs_24 =
@@ -6282,7 +6835,9 @@ const primitive_funcs funcs_24 =
     create_rop_masks_24,
     create_dither_masks_null,
     stretch_row_24,
-    shrink_row_24
+    shrink_row_24,
+    filter_row_24,
+    store_filtered_row_24
 };
 
 const primitive_funcs funcs_555 =
@@ -6302,7 +6857,9 @@ const primitive_funcs funcs_555 =
     create_rop_masks_16,
     create_dither_masks_null,
     stretch_row_16,
-    shrink_row_16
+    shrink_row_16,
+    filter_row_null,
+    store_filtered_row_null
 };
 
 const primitive_funcs funcs_16 =
@@ -6322,7 +6879,9 @@ const primitive_funcs funcs_16 =
     create_rop_masks_16,
     create_dither_masks_null,
     stretch_row_16,
-    shrink_row_16
+    shrink_row_16,
+    filter_row_null,
+    store_filtered_row_null
 };
 
 const primitive_funcs funcs_8 =
@@ -6342,7 +6901,9 @@ const primitive_funcs funcs_8 =
     create_rop_masks_8,
     create_dither_masks_8,
     stretch_row_8,
-    shrink_row_8
+    shrink_row_8,
+    filter_row_null,
+    store_filtered_row_null
 };
 
 const primitive_funcs funcs_4 =
@@ -6362,7 +6923,9 @@ const primitive_funcs funcs_4 =
     create_rop_masks_4,
     create_dither_masks_4,
     stretch_row_4,
-    shrink_row_4
+    shrink_row_4,
+    filter_row_null,
+    store_filtered_row_null
 };
 
 const primitive_funcs funcs_1 =
@@ -6382,7 +6945,9 @@ const primitive_funcs funcs_1 =
     create_rop_masks_1,
     create_dither_masks_1,
     stretch_row_1,
-    shrink_row_1
+    shrink_row_1,
+    filter_row_null,
+    store_filtered_row_null
 };
 
 const primitive_funcs funcs_null =
@@ -6402,5 +6967,7 @@ const primitive_funcs funcs_null =
     create_rop_masks_null,
     create_dither_masks_null,
     stretch_row_null,
-    shrink_row_null
+    shrink_row_null,
+    filter_row_null,
+    store_filtered_row_null
 };
@@ -259,6 +259,7 @@ struct enum_data
 
 typedef struct tagFace {
     struct list entry;
+    struct list full_name_entry;
     unsigned int refcount;
     WCHAR *StyleName;
     WCHAR *FullName;
@@ -288,6 +289,8 @@ typedef struct tagFace {
 
 typedef struct tagFamily {
     struct list entry;
+    struct list name_entry;
+    struct list english_entry;
     unsigned int refcount;
     WCHAR *FamilyName;
     WCHAR *EnglishName;
@@ -315,6 +318,24 @@ typedef struct {
 
 typedef struct tagGdiFont GdiFont;
 
+/* glyph metrics, shared between all the fonts using the same face file at the same size and transform */
+struct glyph_metrics {
+    struct list entry;
+    unsigned int refcount;
+    dev_t dev;
+    ino_t ino;
+    FT_Long face_index;
+    FT_UShort x_ppem, y_ppem;
+    LONG ppem, aveWidth;
+    double scale_y;
+    FMAT2 matrix;
+    INT orientation;
+    BOOL fake_italic;
+    BOOL vertical;
+    GM **gm;
+    DWORD gmsize;
+};
+
 typedef struct {
     struct list entry;
     Face *face;
@@ -325,8 +346,7 @@ struct tagGdiFont {
     struct list entry;
     struct list unused_entry;
     unsigned int refcount;
-    GM **gm;
-    DWORD gmsize;
+    struct glyph_metrics *metrics;
     OUTLINETEXTMETRICW *potm;
     DWORD total_kern_pairs;
     KERNINGPAIR *kern_pairs;
@@ -377,18 +397,27 @@ struct enum_charset_list {
 };
 
 #define GM_BLOCK_SIZE 128
-#define FONT_GM(font,idx) (&(font)->gm[(idx) / GM_BLOCK_SIZE][(idx) % GM_BLOCK_SIZE])
+#define FONT_GM(font,idx) (&(font)->metrics->gm[(idx) / GM_BLOCK_SIZE][(idx) % GM_BLOCK_SIZE])
 
 static struct list gdi_font_list = LIST_INIT(gdi_font_list);
 static struct list unused_gdi_font_list = LIST_INIT(unused_gdi_font_list);
 static unsigned int unused_font_count;
 #define UNUSED_CACHE_SIZE 10
+static struct list glyph_metrics_list = LIST_INIT(glyph_metrics_list);
+static unsigned int unused_glyph_metrics_count;
+#define UNUSED_GLYPH_METRICS_SIZE 8
 static struct list system_links = LIST_INIT(system_links);
 
 static struct list font_subst_list = LIST_INIT(font_subst_list);
 
 static struct list font_list = LIST_INIT(font_list);
 
+/* hash tables indexing families by name and English name, and faces by full name */
+#define NAME_HASH_SIZE 256
+static struct list family_names[NAME_HASH_SIZE];
+static struct list family_english_names[NAME_HASH_SIZE];
+static struct list face_full_names[NAME_HASH_SIZE];
+
 struct freetype_physdev
 {
     struct gdi_physdev dev;
@@ -985,11 +1014,31 @@ static Face *find_face_from_filename(const WCHAR *file_name, const WCHAR *face_n
     return NULL;
 }
 
+static void init_name_tables(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < NAME_HASH_SIZE; i++)
+    {
+        list_init( &family_names[i] );
+        list_init( &family_english_names[i] );
+        list_init( &face_full_names[i] );
+    }
+}
+
+static struct list *get_name_bucket( struct list *table, const WCHAR *name )
+{
+    unsigned int hash = 0;
+
+    while (*name) hash = hash * 31 + tolowerW( *name++ );
+    return &table[hash % NAME_HASH_SIZE];
+}
+
 static Family *find_family_from_name(const WCHAR *name)
 {
     Family *family;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    LIST_FOR_EACH_ENTRY(family, get_name_bucket( family_names, name ), Family, name_entry)
     {
         if(!strcmpiW(family->FamilyName, name))
             return family;
@@ -1002,11 +1051,11 @@ static Family *find_family_from_any_name(const WCHAR *name)
 {
     Family *family;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    if ((family = find_family_from_name( name ))) return family;
+
+    LIST_FOR_EACH_ENTRY(family, get_name_bucket( family_english_names, name ), Family, english_entry)
     {
-        if(!strcmpiW(family->FamilyName, name))
-            return family;
-        if(family->EnglishName && !strcmpiW(family->EnglishName, name))
+        if(!strcmpiW(family->EnglishName, name))
             return family;
     }
 
@@ -1418,6 +1467,8 @@ static void release_family( Family *family )
     if (--family->refcount) return;
     assert( list_empty( &family->faces ));
     list_remove( &family->entry );
+    list_remove( &family->name_entry );
+    list_remove( &family->english_entry );
     HeapFree( GetProcessHeap(), 0, family->FamilyName );
     HeapFree( GetProcessHeap(), 0, family->EnglishName );
     HeapFree( GetProcessHeap(), 0, family );
@@ -1430,6 +1481,7 @@ static void release_face( Face *face )
     {
         if (face->flags & ADDFONT_ADD_TO_CACHE) remove_face_from_cache( face );
         list_remove( &face->entry );
+        list_remove( &face->full_name_entry );
         release_family( face->family );
     }
     HeapFree( GetProcessHeap(), 0, face->file );
@@ -1460,6 +1512,14 @@ static inline int style_order(const Face *face)
     }
 }
 
+static void add_face_to_name_table( Face *face )
+{
+    if (face->FullName)
+        list_add_tail( get_name_bucket( face_full_names, face->FullName ), &face->full_name_entry );
+    else
+        list_init( &face->full_name_entry );
+}
+
 static BOOL insert_face_in_family_list( Face *face, Family *family )
 {
     Face *cursor;
@@ -1490,6 +1550,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
                 TRACE("Replacing original %s with %s\n",
                       debugstr_w(cursor->file), debugstr_w(face->file));
                 list_add_before( &cursor->entry, &face->entry );
+                add_face_to_name_table( face );
                 face->family = family;
                 family->refcount++;
                 face->refcount++;
@@ -1504,6 +1565,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
     }
 
     list_add_before( &cursor->entry, &face->entry );
+    add_face_to_name_table( face );
     face->family = family;
     family->refcount++;
     face->refcount++;
@@ -1523,6 +1585,11 @@ static Family *create_family( WCHAR *name, WCHAR *english_name )
     list_init( &family->faces );
     family->replacement = &family->faces;
     list_add_tail( &font_list, &family->entry );
+    list_add_tail( get_name_bucket( family_names, name ), &family->name_entry );
+    if (english_name)
+        list_add_tail( get_name_bucket( family_english_names, english_name ), &family->english_entry );
+    else
+        list_init( &family->english_entry );
 
     return family;
 }
@@ -2278,16 +2345,9 @@ static void LoadReplaceList(void)
                 Family * const family = find_family_from_any_name(data);
                 if (family != NULL)
                 {
-                    Family * const new_family = HeapAlloc(GetProcessHeap(), 0, sizeof(*new_family));
-                    if (new_family != NULL)
-                    {
-                        TRACE("mapping %s to %s\n", debugstr_w(data), debugstr_w(value));
-                        new_family->FamilyName = strdupW(value);
-                        new_family->EnglishName = NULL;
-                        list_init(&new_family->faces);
-                        new_family->replacement = &family->faces;
-                        list_add_tail(&font_list, &new_family->entry);
-                    }
+                    Family * const new_family = create_family(strdupW(value), NULL);
+                    TRACE("mapping %s to %s\n", debugstr_w(data), debugstr_w(value));
+                    new_family->replacement = &family->faces;
                 }
                 else
                 {
@@ -4090,17 +4150,12 @@ static void init_font_list(void)
 
 static BOOL move_to_front(const WCHAR *name)
 {
-    Family *family, *cursor2;
-    LIST_FOR_EACH_ENTRY_SAFE(family, cursor2, &font_list, Family, entry)
-    {
-        if(!strcmpiW(family->FamilyName, name))
-        {
-            list_remove(&family->entry);
-            list_add_head(&font_list, &family->entry);
-            return TRUE;
-        }
-    }
-    return FALSE;
+    Family *family = find_family_from_name(name);
+
+    if (!family) return FALSE;
+    list_remove(&family->entry);
+    list_add_head(&font_list, &family->entry);
+    return TRUE;
 }
 
 static BOOL set_default(const WCHAR **name_list)
@@ -4136,6 +4191,8 @@ BOOL WineEngInit(void)
 
     if(!init_freetype()) return FALSE;
 
+    init_name_tables();
+
 #ifdef SONAME_LIBFONTCONFIG
     init_fontconfig();
 #endif
@@ -4374,9 +4431,6 @@ static GdiFont *alloc_font(void)
 {
     GdiFont *ret = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*ret));
     ret->refcount = 1;
-    ret->gmsize = 1;
-    ret->gm = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(GM*));
-    ret->gm[0] = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(GM) * GM_BLOCK_SIZE);
     ret->potm = NULL;
     ret->font_desc.matrix.eM11 = ret->font_desc.matrix.eM22 = 1.0;
     ret->total_kern_pairs = (DWORD)-1;
@@ -4385,10 +4439,98 @@ static GdiFont *alloc_font(void)
     return ret;
 }
 
+static void free_glyph_metrics( struct glyph_metrics *metrics )
+{
+    DWORD i;
+
+    list_remove( &metrics->entry );
+    for (i = 0; i < metrics->gmsize; i++)
+        HeapFree( GetProcessHeap(), 0, metrics->gm[i] );
+    HeapFree( GetProcessHeap(), 0, metrics->gm );
+    HeapFree( GetProcessHeap(), 0, metrics );
+}
+
+static void release_glyph_metrics( struct glyph_metrics *metrics )
+{
+    if (--metrics->refcount) return;
+
+    /* fonts that can't be shared are not in the list */
+    if (list_empty( &metrics->entry ))
+    {
+        free_glyph_metrics( metrics );
+        return;
+    }
+
+    /* keep a few unused tables around, most recently released first */
+    list_remove( &metrics->entry );
+    list_add_head( &glyph_metrics_list, &metrics->entry );
+    if (++unused_glyph_metrics_count > UNUSED_GLYPH_METRICS_SIZE)
+    {
+        LIST_FOR_EACH_ENTRY_REV( metrics, &glyph_metrics_list, struct glyph_metrics, entry )
+        {
+            if (metrics->refcount) continue;
+            TRACE( "freeing glyph metrics %p\n", metrics );
+            free_glyph_metrics( metrics );
+            unused_glyph_metrics_count--;
+            break;
+        }
+    }
+}
+
+static struct glyph_metrics *get_glyph_metrics( GdiFont *font )
+{
+    struct glyph_metrics *metrics;
+    const FT_Size_Metrics *size = &font->ft_face->size->metrics;
+    BOOL vertical = (font->name[0] == '@');
+
+    /* child fonts compute their metrics relative to the base font, and memory fonts
+     * have no file to identify them, so these get a private table */
+    if (font->mapping && !font->base_font)
+    {
+        LIST_FOR_EACH_ENTRY( metrics, &glyph_metrics_list, struct glyph_metrics, entry )
+        {
+            if (metrics->dev != font->mapping->dev || metrics->ino != font->mapping->ino) continue;
+            if (metrics->face_index != font->ft_face->face_index) continue;
+            if (metrics->x_ppem != size->x_ppem || metrics->y_ppem != size->y_ppem) continue;
+            if (metrics->ppem != font->ppem || metrics->aveWidth != font->aveWidth) continue;
+            if (metrics->scale_y != font->scale_y) continue;
+            if (memcmp( &metrics->matrix, &font->font_desc.matrix, sizeof(metrics->matrix) )) continue;
+            if (metrics->orientation != font->orientation) continue;
+            if (!metrics->fake_italic != !font->fake_italic || metrics->vertical != vertical) continue;
+
+            if (!metrics->refcount++) unused_glyph_metrics_count--;
+            TRACE( "font %p sharing glyph metrics %p\n", font, metrics );
+            return metrics;
+        }
+    }
+
+    metrics = HeapAlloc( GetProcessHeap(), 0, sizeof(*metrics) );
+    metrics->refcount = 1;
+    metrics->dev = font->mapping ? font->mapping->dev : 0;
+    metrics->ino = font->mapping ? font->mapping->ino : 0;
+    metrics->face_index = font->ft_face->face_index;
+    metrics->x_ppem = size->x_ppem;
+    metrics->y_ppem = size->y_ppem;
+    metrics->ppem = font->ppem;
+    metrics->aveWidth = font->aveWidth;
+    metrics->scale_y = font->scale_y;
+    metrics->matrix = font->font_desc.matrix;
+    metrics->orientation = font->orientation;
+    metrics->fake_italic = font->fake_italic;
+    metrics->vertical = vertical;
+    metrics->gmsize = 1;
+    metrics->gm = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(GM*) );
+    metrics->gm[0] = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(GM) * GM_BLOCK_SIZE );
+    if (font->mapping && !font->base_font)
+        list_add_head( &glyph_metrics_list, &metrics->entry );
+    else
+        list_init( &metrics->entry );
+    return metrics;
+}
+
 static void free_font(GdiFont *font)
 {
     CHILD_FONT *child, *child_next;
-    DWORD i;
 
     LIST_FOR_EACH_ENTRY_SAFE( child, child_next, &font->child_fonts, CHILD_FONT, entry )
     {
@@ -4404,9 +4546,7 @@ static void free_font(GdiFont *font)
     HeapFree(GetProcessHeap(), 0, font->kern_pairs);
     HeapFree(GetProcessHeap(), 0, font->potm);
     HeapFree(GetProcessHeap(), 0, font->name);
-    for (i = 0; i < font->gmsize; i++)
-        HeapFree(GetProcessHeap(),0,font->gm[i]);
-    HeapFree(GetProcessHeap(), 0, font->gm);
+    if (font->metrics) release_glyph_metrics( font->metrics );
     HeapFree(GetProcessHeap(), 0, font->GSUB_Table);
     HeapFree(GetProcessHeap(), 0, font);
 }
@@ -5127,6 +5267,7 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
     if(lf.lfFaceName[0] != '\0') {
         CHILD_FONT *font_link_entry;
         LPWSTR FaceName = lf.lfFaceName;
+        int i;
 
         psub = get_font_subst(&font_subst_list, FaceName, lf.lfCharSet);
 
@@ -5143,40 +5284,37 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
 	   where we'll either use the charset of the current ansi codepage
 	   or if that's unavailable the first charset that the font supports.
 	*/
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            if (!strcmpiW(family->FamilyName, FaceName) ||
-                (psub && !strcmpiW(family->FamilyName, psub->to.name)))
-            {
-                font_link = find_font_link(family->FamilyName);
-                face_list = get_face_list_from_family(family);
-                LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                    if (!(face->scalable || can_use_bitmap))
-                        continue;
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                        goto found;
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found;
-                    if (!csi.fs.fsCsb[0])
-                        goto found;
-                }
+        for (i = 0; i < 2; i++) {
+            const WCHAR *name = i ? (psub ? psub->to.name : NULL) : FaceName;
+
+            if (!name || !(family = find_family_from_name(name))) continue;
+            font_link = find_font_link(family->FamilyName);
+            face_list = get_face_list_from_family(family);
+            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
+                if (!(face->scalable || can_use_bitmap))
+                    continue;
+                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
+                    goto found;
+                if (font_link != NULL &&
+                    csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                    goto found;
+                if (!csi.fs.fsCsb[0])
+                    goto found;
             }
 	}
 
         /* Search by full face name. */
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if(face->FullName && !strcmpiW(face->FullName, FaceName) &&
-                   (face->scalable || can_use_bitmap))
-                {
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
-                        goto found_face;
-                    font_link = find_font_link(family->FamilyName);
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found_face;
-                }
+        LIST_FOR_EACH_ENTRY( face, get_name_bucket( face_full_names, FaceName ), Face, full_name_entry ) {
+            if(!strcmpiW(face->FullName, FaceName) &&
+               (face->scalable || can_use_bitmap))
+            {
+                family = face->family;
+                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
+                    goto found_face;
+                font_link = find_font_link(family->FamilyName);
+                if (font_link != NULL &&
+                    csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                    goto found_face;
             }
         }
 
@@ -5236,18 +5374,16 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
         strcpyW(lf.lfFaceName, defSans);
     else
         strcpyW(lf.lfFaceName, defSans);
-    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-        if(!strcmpiW(family->FamilyName, lf.lfFaceName)) {
-            font_link = find_font_link(family->FamilyName);
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if (!(face->scalable || can_use_bitmap))
-                    continue;
-                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                    goto found;
-                if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                    goto found;
-            }
+    if ((family = find_family_from_name(lf.lfFaceName))) {
+        font_link = find_font_link(family->FamilyName);
+        face_list = get_face_list_from_family(family);
+        LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
+            if (!(face->scalable || can_use_bitmap))
+                continue;
+            if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
+                goto found;
+            if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                goto found;
         }
     }
 
@@ -6203,12 +6339,21 @@ static DWORD get_glyph_outline(GdiFont *incoming_font, UINT glyph, UINT format,
         format &= ~GGO_UNHINTED;
     }
 
-    if(original_index >= font->gmsize * GM_BLOCK_SIZE) {
-	font->gmsize = (original_index / GM_BLOCK_SIZE + 1);
-	font->gm = HeapReAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, font->gm,
-			       font->gmsize * sizeof(GM*));
+    if (!font->metrics)
+    {
+        TEXTMETRICW tm;
+
+        /* this may reset aveWidth, do it before it is used as a key */
+        get_text_metrics(font, &tm);
+        font->metrics = get_glyph_metrics(font);
+    }
+
+    if(original_index >= font->metrics->gmsize * GM_BLOCK_SIZE) {
+	font->metrics->gmsize = (original_index / GM_BLOCK_SIZE + 1);
+	font->metrics->gm = HeapReAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, font->metrics->gm,
+			                font->metrics->gmsize * sizeof(GM*));
     } else {
-        if (format == GGO_METRICS && font->gm[original_index / GM_BLOCK_SIZE] != NULL &&
+        if (format == GGO_METRICS && font->metrics->gm[original_index / GM_BLOCK_SIZE] != NULL &&
             FONT_GM(font,original_index)->init && is_identity_MAT2(lpmat))
         {
             *lpgm = FONT_GM(font,original_index)->gm;
@@ -6220,8 +6365,8 @@ static DWORD get_glyph_outline(GdiFont *incoming_font, UINT glyph, UINT format,
 	}
     }
 
-    if (!font->gm[original_index / GM_BLOCK_SIZE])
-        font->gm[original_index / GM_BLOCK_SIZE] = HeapAlloc(GetProcessHeap(),HEAP_ZERO_MEMORY, sizeof(GM) * GM_BLOCK_SIZE);
+    if (!font->metrics->gm[original_index / GM_BLOCK_SIZE])
+        font->metrics->gm[original_index / GM_BLOCK_SIZE] = HeapAlloc(GetProcessHeap(),HEAP_ZERO_MEMORY, sizeof(GM) * GM_BLOCK_SIZE);
 
     /* Scaling factor */
     if (font->aveWidth)
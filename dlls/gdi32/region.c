@@ -149,6 +149,18 @@ static inline void empty_region( WINEREGION *reg )
     reg->extents.left = reg->extents.top = reg->extents.right = reg->extents.bottom = 0;
 }
 
+/* make sure the region can hold at least count rectangles */
+static BOOL grow_region( WINEREGION *reg, INT count )
+{
+    RECT *new_rects;
+
+    if (count <= reg->size) return TRUE;
+    if (!(new_rects = HeapReAlloc( GetProcessHeap(), 0, reg->rects, count * sizeof(RECT) ))) return FALSE;
+    reg->rects = new_rects;
+    reg->size = count;
+    return TRUE;
+}
+
 static inline BOOL is_in_rect( const RECT *rect, int x, int y )
 {
     return (rect->right > x && rect->left <= x && rect->bottom > y && rect->top <= y);
@@ -432,6 +444,62 @@ static void REGION_DumpRegion(WINEREGION *pReg)
 }
 
 
+/* a spare rectangle array, to save a heap allocation in most region operations */
+#define MAX_SPARE_RECTS 1024
+static RECT *spare_rects;
+static INT spare_size;
+
+static CRITICAL_SECTION spare_rects_cs;
+static CRITICAL_SECTION_DEBUG critsect_debug =
+{
+    0, 0, &spare_rects_cs,
+    { &critsect_debug.ProcessLocksList, &critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": spare_rects_cs") }
+};
+static CRITICAL_SECTION spare_rects_cs = { &critsect_debug, -1, 0, 0, 0, 0 };
+
+/***********************************************************************
+ *            get_spare_rects
+ *
+ * Get the spare array if it can hold at least count rectangles.
+ */
+static RECT *get_spare_rects( INT count, INT *size )
+{
+    RECT *rects = NULL;
+
+    EnterCriticalSection( &spare_rects_cs );
+    if (spare_rects && spare_size >= count)
+    {
+        rects = spare_rects;
+        *size = spare_size;
+        spare_rects = NULL;
+    }
+    LeaveCriticalSection( &spare_rects_cs );
+    return rects;
+}
+
+/***********************************************************************
+ *            free_rects
+ *
+ * Free a rectangle array, or keep it as the spare if it's larger.
+ */
+static void free_rects( RECT *rects, INT size )
+{
+    if (size <= MAX_SPARE_RECTS)
+    {
+        EnterCriticalSection( &spare_rects_cs );
+        if (!spare_rects || spare_size < size)
+        {
+            RECT *old = spare_rects;
+            spare_rects = rects;
+            spare_size = size;
+            rects = old;
+        }
+        LeaveCriticalSection( &spare_rects_cs );
+    }
+    HeapFree( GetProcessHeap(), 0, rects );
+}
+
 /***********************************************************************
  *            init_region
  *
@@ -450,7 +518,7 @@ static BOOL init_region( WINEREGION *pReg, INT n )
  */
 static void destroy_region( WINEREGION *pReg )
 {
-    HeapFree( GetProcessHeap(), 0, pReg->rects );
+    free_rects( pReg->rects, pReg->size );
 }
 
 /***********************************************************************
@@ -461,7 +529,7 @@ static BOOL REGION_DeleteObject( HGDIOBJ handle )
     WINEREGION *rgn = free_gdi_handle( handle );
 
     if (!rgn) return FALSE;
-    HeapFree( GetProcessHeap(), 0, rgn->rects );
+    free_rects( rgn->rects, rgn->size );
     HeapFree( GetProcessHeap(), 0, rgn );
     return TRUE;
 }
@@ -1650,6 +1718,8 @@ static BOOL REGION_RegionOp(
     RECT *r2BandEnd;                  /* End of current band in r2 */
     INT top;                          /* Top of non-overlapping band */
     INT bot;                          /* Bottom of non-overlapping band */
+    INT size;                         /* Initial size of the new region */
+    BOOL in_place;                    /* Are we using destReg's rect array */
 
     /*
      * Initialization:
@@ -1670,7 +1740,21 @@ static BOOL REGION_RegionOp(
      * have to worry about using too much memory. I hope to be able to
      * nuke the Xrealloc() at the end of this function eventually.
      */
-    if (!init_region( &newReg, max(reg1->numRects,reg2->numRects) * 2 )) return FALSE;
+    size = max(reg1->numRects,reg2->numRects) * 2;
+
+    /*
+     * If the destination isn't one of the sources and already has enough room,
+     * we can build the result directly in its array and save an allocation.
+     */
+    in_place = (destReg != reg1 && destReg != reg2 && destReg->size >= size);
+    if (in_place)
+    {
+        newReg.rects = destReg->rects;
+        newReg.size = destReg->size;
+        empty_region( &newReg );
+    }
+    else if ((newReg.rects = get_spare_rects( size, &newReg.size ))) empty_region( &newReg );
+    else if (!init_region( &newReg, size )) return FALSE;
 
     /*
      * Initialize ybot and ytop.
@@ -1739,7 +1823,7 @@ static BOOL REGION_RegionOp(
 
             if ((top != bot) && (nonOverlap1Func != NULL))
 	    {
-		if (!nonOverlap1Func(&newReg, r1, r1BandEnd, top, bot)) return FALSE;
+		if (!nonOverlap1Func(&newReg, r1, r1BandEnd, top, bot)) goto failed;
 	    }
 
 	    ytop = r2->top;
@@ -1751,7 +1835,7 @@ static BOOL REGION_RegionOp(
 
             if ((top != bot) && (nonOverlap2Func != NULL))
 	    {
-		if (!nonOverlap2Func(&newReg, r2, r2BandEnd, top, bot)) return FALSE;
+		if (!nonOverlap2Func(&newReg, r2, r2BandEnd, top, bot)) goto failed;
 	    }
 
 	    ytop = r1->top;
@@ -1780,7 +1864,7 @@ static BOOL REGION_RegionOp(
 	curBand = newReg.numRects;
 	if (ybot > ytop)
 	{
-	    if (!overlapFunc(&newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot)) return FALSE;
+	    if (!overlapFunc(&newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot)) goto failed;
 	}
 
 	if (newReg.numRects != curBand)
@@ -1818,7 +1902,7 @@ static BOOL REGION_RegionOp(
 		    r1BandEnd++;
 		}
 		if (!nonOverlap1Func(&newReg, r1, r1BandEnd, max(r1->top,ybot), r1->bottom))
-                    return FALSE;
+                    goto failed;
 		r1 = r1BandEnd;
 	    } while (r1 != r1End);
 	}
@@ -1833,7 +1917,7 @@ static BOOL REGION_RegionOp(
 		 r2BandEnd++;
 	    }
 	    if (!nonOverlap2Func(&newReg, r2, r2BandEnd, max(r2->top,ybot), r2->bottom))
-                return FALSE;
+                goto failed;
 	    r2 = r2BandEnd;
 	} while (r2 != r2End);
     }
@@ -1860,11 +1944,22 @@ static BOOL REGION_RegionOp(
             newReg.size = newReg.numRects;
         }
     }
-    HeapFree( GetProcessHeap(), 0, destReg->rects );
+    if (!in_place) free_rects( destReg->rects, destReg->size );
     destReg->rects    = newReg.rects;
     destReg->size     = newReg.size;
     destReg->numRects = newReg.numRects;
     return TRUE;
+
+failed:
+    if (in_place)
+    {
+        /* the array may have been reallocated, leave the destination valid and empty */
+        destReg->rects = newReg.rects;
+        destReg->size  = newReg.size;
+        empty_region( destReg );
+    }
+    else free_rects( newReg.rects, newReg.size );
+    return FALSE;
 }
 
 /***********************************************************************
@@ -1929,6 +2024,73 @@ static BOOL REGION_IntersectO(WINEREGION *pReg,  RECT *r1, RECT *r1End,
     return TRUE;
 }
 
+/***********************************************************************
+ *	     merge_band
+ *
+ * Merge the band [start,end) into the previous band [prev,start) if
+ * they line up, the same way REGION_Coalesce does.
+ */
+static BOOL merge_band( RECT *rects, INT prev, INT start, INT end )
+{
+    INT i;
+
+    if (prev < 0 || start - prev != end - start) return FALSE;
+    if (rects[prev].bottom != rects[start].top) return FALSE;
+    for (i = 0; i < end - start; i++)
+        if (rects[prev + i].left != rects[start + i].left ||
+            rects[prev + i].right != rects[start + i].right) return FALSE;
+    for (i = prev; i < start; i++) rects[i].bottom = rects[end - 1].bottom;
+    return TRUE;
+}
+
+/***********************************************************************
+ *	     REGION_ClipRegion
+ *
+ * Intersect a region with a single rectangle. This is the common case, and
+ * it can be done in a single pass without any temporary storage, even when
+ * the destination is the source region.
+ */
+static BOOL REGION_ClipRegion( WINEREGION *dst, WINEREGION *src, const RECT *clip )
+{
+    RECT rc = *clip;
+    INT i, j, band_end, count = src->numRects, prev = -1, start, n = 0;
+    INT left, right, top, bottom;
+
+    if (dst != src && !grow_region( dst, count )) return FALSE;
+
+    for (i = 0; i < count; i = band_end)
+    {
+        top = src->rects[i].top;
+        bottom = src->rects[i].bottom;
+        for (band_end = i + 1; band_end < count && src->rects[band_end].top == top; band_end++) ;
+
+        if (bottom <= rc.top) continue;
+        if (top >= rc.bottom) break;
+        top = max( top, rc.top );
+        bottom = min( bottom, rc.bottom );
+
+        /* at most one output rectangle per input one, so we never overwrite unread input */
+        start = n;
+        for (j = i; j < band_end; j++)
+        {
+            left = max( src->rects[j].left, rc.left );
+            right = min( src->rects[j].right, rc.right );
+            if (left >= right) continue;
+            dst->rects[n].left = left;
+            dst->rects[n].top = top;
+            dst->rects[n].right = right;
+            dst->rects[n].bottom = bottom;
+            n++;
+        }
+        if (n == start) continue;
+        if (merge_band( dst->rects, prev, start, n )) n = start;
+        else prev = start;
+    }
+    dst->numRects = n;
+    REGION_SetExtents( dst );
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_IntersectRegion
  */
@@ -1939,6 +2101,10 @@ static BOOL REGION_IntersectRegion(WINEREGION *newReg, WINEREGION *reg1,
     if ( (!(reg1->numRects)) || (!(reg2->numRects))  ||
 	(!overlapping(&reg1->extents, &reg2->extents)))
 	newReg->numRects = 0;
+    else if (reg2->numRects == 1)
+        return REGION_ClipRegion( newReg, reg1, &reg2->extents );
+    else if (reg1->numRects == 1)
+        return REGION_ClipRegion( newReg, reg2, &reg1->extents );
     else
 	if (!REGION_RegionOp (newReg, reg1, reg2, REGION_IntersectO, NULL, NULL)) return FALSE;
 
@@ -2041,6 +2207,59 @@ static BOOL REGION_UnionO (WINEREGION *pReg, RECT *r1, RECT *r1End,
 #undef MERGERECT
 }
 
+/***********************************************************************
+ *	     REGION_AppendRegion
+ *
+ *      Union of two regions when the upper one is completely above the
+ *      lower one. The bands only need to be concatenated, and the last band
+ *      of the upper region possibly merged with the first band of the lower
+ *      one. This is typically the case when a region is built by adding
+ *      rectangles from top to bottom, and is done in place in that case.
+ */
+static BOOL REGION_AppendRegion(WINEREGION *newReg, WINEREGION *upper, WINEREGION *lower)
+{
+    INT count = upper->numRects + lower->numRects, i, band_end, n = 0, prev = -1;
+    RECT *rects, extents;
+
+    extents.left = min(upper->extents.left, lower->extents.left);
+    extents.top = upper->extents.top;
+    extents.right = max(upper->extents.right, lower->extents.right);
+    extents.bottom = lower->extents.bottom;
+
+    if (newReg == lower)
+    {
+        if (!grow_region( newReg, count )) return FALSE;
+        memmove( newReg->rects + upper->numRects, newReg->rects, lower->numRects * sizeof(RECT) );
+        memcpy( newReg->rects, upper->rects, upper->numRects * sizeof(RECT) );
+    }
+    else
+    {
+        if (newReg != upper && !REGION_CopyRegion( newReg, upper )) return FALSE;
+        if (!grow_region( newReg, count )) return FALSE;
+        memcpy( newReg->rects + upper->numRects, lower->rects, lower->numRects * sizeof(RECT) );
+    }
+
+    /*
+     * REGION_RegionOp would coalesce the bands of the upper region one at a
+     * time, and then the remaining lower region with the last band only.
+     */
+    rects = newReg->rects;
+    for (i = 0; i < upper->numRects; i = band_end)
+    {
+        for (band_end = i + 1; band_end < upper->numRects && rects[band_end].top == rects[i].top; band_end++) ;
+        if (n != i) memmove( rects + n, rects + i, (band_end - i) * sizeof(RECT) );
+        if (merge_band( rects, prev, n, n + band_end - i )) continue;
+        prev = n;
+        n += band_end - i;
+    }
+    if (n != upper->numRects)
+        memmove( rects + n, rects + upper->numRects, lower->numRects * sizeof(RECT) );
+    newReg->numRects = n + lower->numRects;
+    REGION_Coalesce( newReg, prev, n );
+    newReg->extents = extents;
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_UnionRegion
  */
@@ -2098,6 +2317,14 @@ static BOOL REGION_UnionRegion(WINEREGION *newReg, WINEREGION *reg1, WINEREGION
 	return ret;
     }
 
+    /*
+     * One region is entirely above the other
+     */
+    if (reg1->extents.bottom <= reg2->extents.top)
+        return REGION_AppendRegion(newReg, reg1, reg2);
+    if (reg2->extents.bottom <= reg1->extents.top)
+        return REGION_AppendRegion(newReg, reg2, reg1);
+
     if ((ret = REGION_RegionOp (newReg, reg1, reg2, REGION_UnionO, REGION_UnionNonO, REGION_UnionNonO)))
     {
         newReg->extents.left = min(reg1->extents.left, reg2->extents.left);
@@ -2263,6 +2490,32 @@ static BOOL REGION_SubtractRegion(WINEREGION *regD, WINEREGION *regM, WINEREGION
 	(!overlapping(&regM->extents, &regS->extents)) )
 	return REGION_CopyRegion(regD, regM);
 
+    if (regS->numRects == 1 &&
+        regS->extents.left <= regM->extents.left && regS->extents.top <= regM->extents.top &&
+        regS->extents.right >= regM->extents.right && regS->extents.bottom >= regM->extents.bottom)
+    {
+        /* subtrahend covers the whole minuend */
+        empty_region( regD );
+        return TRUE;
+    }
+
+    if (regM->numRects == 1 && regS->numRects == 1)
+    {
+        /* rectangle minus rectangle: at most one band above, one with up to
+         * two rectangles in the middle and one below */
+        RECT m = regM->extents, s = regS->extents;
+        INT top = max( m.top, s.top ), bottom = min( m.bottom, s.bottom );
+
+        if (!grow_region( regD, 4 )) return FALSE;
+        regD->numRects = 0;
+        if (m.top < s.top) add_rect( regD, m.left, m.top, m.right, s.top );
+        if (m.left < s.left) add_rect( regD, m.left, top, s.left, bottom );
+        if (s.right < m.right) add_rect( regD, s.right, top, m.right, bottom );
+        if (s.bottom < m.bottom) add_rect( regD, m.left, s.bottom, m.right, m.bottom );
+        REGION_SetExtents( regD );
+        return TRUE;
+    }
+
     if (!REGION_RegionOp (regD, regM, regS, REGION_SubtractO, REGION_SubtractNonO1, NULL))
         return FALSE;
 
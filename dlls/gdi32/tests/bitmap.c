@@ -20,12 +20,14 @@
  */
 
 #include <stdarg.h>
+#include <stdio.h>
 #include <assert.h>
 #include <string.h>
 
 #include "windef.h"
 #include "winbase.h"
 #include "winerror.h"
+#include "winreg.h"
 #include "wingdi.h"
 #include "winuser.h"
 #include "mmsystem.h"
@@ -2998,6 +3000,150 @@ static void test_BitBlt(void)
     DeleteDC(hdcScreen);
 }
 
+static void test_BitBlt_lines(void)
+{
+    static const DWORD rops[] = { SRCINVERT, SRCAND, SRCPAINT, NOTSRCCOPY, DSTINVERT };
+    static const int widths[] = { 1, 3, 4, 5, 15, 16, 17, 31, 33, 47 };
+    static const WORD bpps[] = { 32, 24, 16 };
+    BITMAPINFO *bmi = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, FIELD_OFFSET( BITMAPINFO, bmiColors[3] ));
+    DWORD *masks = (DWORD *)bmi->bmiColors;
+    HDC hdc_dst = CreateCompatibleDC( 0 ), hdc_src = CreateCompatibleDC( 0 );
+    BYTE *dst_bits, *src_bits, expect[64 * 4];
+    HBITMAP dst_bmp, src_bmp, old_dst, old_src;
+    int i, j, k, x, bytes;
+
+    bmi->bmiHeader.biSize = sizeof(bmi->bmiHeader);
+    bmi->bmiHeader.biWidth = 64;
+    bmi->bmiHeader.biHeight = -1;
+    bmi->bmiHeader.biPlanes = 1;
+
+    for (i = 0; i < sizeof(bpps) / sizeof(bpps[0]); i++)
+    {
+        bmi->bmiHeader.biBitCount = bpps[i];
+        bmi->bmiHeader.biCompression = bpps[i] == 16 ? BI_BITFIELDS : BI_RGB;
+        masks[0] = 0xf800;
+        masks[1] = 0x07e0;
+        masks[2] = 0x001f;
+        bytes = bpps[i] / 8;
+
+        dst_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+        src_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+        old_dst = SelectObject( hdc_dst, dst_bmp );
+        old_src = SelectObject( hdc_src, src_bmp );
+
+        for (j = 0; j < sizeof(rops) / sizeof(rops[0]); j++)
+        {
+            for (k = 0; k < sizeof(widths) / sizeof(widths[0]); k++)
+            {
+                for (x = 0; x < 64 * bytes; x++)
+                {
+                    src_bits[x] = x * 7 + 3;
+                    dst_bits[x] = expect[x] = x * 13 + 5;
+                }
+                /* destination starts at pixel 3, source at pixel 1 */
+                for (x = 3 * bytes; x < (3 + widths[k]) * bytes; x++)
+                {
+                    BYTE src = src_bits[x - 2 * bytes], dst = dst_bits[x];
+                    switch (rops[j])
+                    {
+                    case SRCINVERT:  expect[x] = dst ^ src; break;
+                    case SRCAND:     expect[x] = dst & src; break;
+                    case SRCPAINT:   expect[x] = dst | src; break;
+                    case NOTSRCCOPY: expect[x] = ~src; break;
+                    case DSTINVERT:  expect[x] = ~dst; break;
+                    }
+                }
+                BitBlt( hdc_dst, 3, 0, widths[k], 1, hdc_src, 1, 0, rops[j] );
+                ok( !memcmp( dst_bits, expect, 64 * bytes ),
+                    "%u bpp, rop %06x, width %d: wrong bits\n", bpps[i], rops[j], widths[k] );
+            }
+        }
+
+        SelectObject( hdc_dst, old_dst );
+        SelectObject( hdc_src, old_src );
+        DeleteObject( dst_bmp );
+        DeleteObject( src_bmp );
+    }
+
+    DeleteDC( hdc_dst );
+    DeleteDC( hdc_src );
+    HeapFree( GetProcessHeap(), 0, bmi );
+}
+
+static void test_GdiAlphaBlend_lines(void)
+{
+    static const int widths[] = { 1, 3, 4, 5, 15, 16, 17, 33 };
+    static const BYTE alphas[] = { 255, 128, 0 };
+    BITMAPINFO bmi;
+    HDC hdc_dst = CreateCompatibleDC( 0 ), hdc_src = CreateCompatibleDC( 0 );
+    DWORD *dst_bits, *src_bits;
+    HBITMAP dst_bmp, src_bmp, old_dst, old_src;
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    int i, j, x;
+
+    if (!pGdiAlphaBlend)
+    {
+        win_skip( "GdiAlphaBlend() is not implemented\n" );
+        return;
+    }
+
+    memset( &bmi, 0, sizeof(bmi) );
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 64;
+    bmi.bmiHeader.biHeight = -1;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    dst_bmp = CreateDIBSection( 0, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    src_bmp = CreateDIBSection( 0, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    old_dst = SelectObject( hdc_dst, dst_bmp );
+    old_src = SelectObject( hdc_src, src_bmp );
+
+    for (i = 0; i < sizeof(widths) / sizeof(widths[0]); i++)
+    {
+        for (j = 0; j < sizeof(alphas) / sizeof(alphas[0]); j++)
+        {
+            /* premultiplied source with a mix of opaque, transparent and partial pixels */
+            for (x = 0; x < 64; x++)
+            {
+                BYTE alpha = x % 3 ? (x % 3 == 1 ? 0xff : x * 4) : 0;
+                src_bits[x] = alpha << 24 | (alpha / 2) << 16 | (alpha / 3) << 8 | alpha / 4;
+                dst_bits[x] = 0xff000000 | x * 0x030507;
+            }
+            blend.SourceConstantAlpha = alphas[j];
+            pGdiAlphaBlend( hdc_dst, 3, 0, widths[i], 1, hdc_src, 1, 0, widths[i], 1, blend );
+            for (x = 0; x < 64; x++)
+            {
+                DWORD dst = 0xff000000 | x * 0x030507, expect = dst;
+                int c;
+
+                if (x >= 3 && x < 3 + widths[i])
+                {
+                    DWORD src = src_bits[x - 2];
+                    expect = 0;
+                    for (c = 0; c < 32; c += 8)
+                    {
+                        BYTE s = (((src >> c) & 0xff) * alphas[j] + 127) / 255;
+                        BYTE a = ((src >> 24) * alphas[j] + 127) / 255;
+                        expect |= (s + (((dst >> c) & 0xff) * (255 - a) + 127) / 255) << c;
+                    }
+                }
+                for (c = 0; c < 32; c += 8)
+                    if (abs( (int)((dst_bits[x] >> c) & 0xff) - (int)((expect >> c) & 0xff) ) > 1) break;
+                ok( c == 32, "width %d, alpha %u: pixel %d is %08x, expected %08x\n",
+                    widths[i], alphas[j], x, dst_bits[x], expect );
+            }
+        }
+    }
+
+    SelectObject( hdc_dst, old_dst );
+    SelectObject( hdc_src, old_src );
+    DeleteObject( dst_bmp );
+    DeleteObject( src_bmp );
+    DeleteDC( hdc_dst );
+    DeleteDC( hdc_src );
+}
+
 static void check_StretchBlt_pixel(HDC hdcDst, HDC hdcSrc, UINT32 *dstBuffer, UINT32 *srcBuffer,
                                    DWORD dwRop, UINT32 expected, int line)
 {
@@ -3330,6 +3476,123 @@ static void test_StretchBlt(void)
     DeleteDC(hdcScreen);
 }
 
+static void test_StretchBlt_halftone(void)
+{
+    static const int bpps[] = { 32, 24 };
+    BITMAPINFO info;
+    HBITMAP bmp_src, bmp_dst, old_src, old_dst;
+    HDC hdc_src, hdc_dst;
+    BYTE *src_bits, *dst_bits;
+    int i, x, y, c, bpp, src_stride, dst_stride, diff, max_diff;
+    BYTE prev;
+    BOOL ret;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+
+    for (i = 0; i < sizeof(bpps) / sizeof(bpps[0]); i++)
+    {
+        bpp = bpps[i];
+        memset( &info, 0, sizeof(info) );
+        info.bmiHeader.biSize = sizeof(info.bmiHeader);
+        info.bmiHeader.biWidth = 48;
+        info.bmiHeader.biHeight = -48;
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = bpp;
+        info.bmiHeader.biCompression = BI_RGB;
+        bmp_src = CreateDIBSection( 0, &info, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+        bmp_dst = CreateDIBSection( 0, &info, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+        ok( bmp_src && bmp_dst, "failed to create %u-bpp dibs\n", bpp );
+        old_src = SelectObject( hdc_src, bmp_src );
+        old_dst = SelectObject( hdc_dst, bmp_dst );
+        src_stride = dst_stride = (48 * bpp / 8 + 3) & ~3;
+        SetStretchBltMode( hdc_dst, HALFTONE );
+
+        /* halving a black and white checkerboard averages to grey */
+        for (y = 0; y < 48; y++)
+            for (x = 0; x < 48 * bpp / 8; x++)
+                src_bits[y * src_stride + x] = ((x / (bpp / 8)) ^ y) & 1 ? 0xff : 0x00;
+        memset( dst_bits, 0xcc, dst_stride * 48 );
+        ret = StretchBlt( hdc_dst, 0, 0, 24, 24, hdc_src, 0, 0, 48, 48, SRCCOPY );
+        ok( ret, "StretchBlt failed\n" );
+        max_diff = 0;
+        for (y = 0; y < 24; y++)
+            for (x = 0; x < 24; x++)
+                for (c = 0; c < 3; c++)
+                {
+                    diff = abs( dst_bits[y * dst_stride + x * bpp / 8 + c] - 0x80 );
+                    if (diff > max_diff) max_diff = diff;
+                }
+        ok( max_diff <= 2, "%u-bpp: checkerboard not averaged, max diff %d\n", bpp, max_diff );
+        ok( dst_bits[24 * dst_stride] == 0xcc, "%u-bpp: wrote outside of the destination\n", bpp );
+
+        /* a solid color stays exact when shrinking and stretching */
+        for (y = 0; y < 48; y++)
+            for (x = 0; x < 48; x++)
+            {
+                src_bits[y * src_stride + x * bpp / 8]     = 0x12;
+                src_bits[y * src_stride + x * bpp / 8 + 1] = 0x9a;
+                src_bits[y * src_stride + x * bpp / 8 + 2] = 0xef;
+            }
+        memset( dst_bits, 0, dst_stride * 48 );
+        ret = StretchBlt( hdc_dst, 0, 0, 17, 13, hdc_src, 0, 0, 48, 48, SRCCOPY );
+        ok( ret, "StretchBlt failed\n" );
+        ret = StretchBlt( hdc_dst, 0, 20, 47, 28, hdc_src, 3, 5, 11, 7, SRCCOPY );
+        ok( ret, "StretchBlt failed\n" );
+        for (y = 0; y < 48; y++)
+        {
+            if (y >= 13 && y < 20) continue;
+            for (x = 0; x < (y < 13 ? 17 : 47); x++)
+                if (dst_bits[y * dst_stride + x * bpp / 8] != 0x12 ||
+                    dst_bits[y * dst_stride + x * bpp / 8 + 1] != 0x9a ||
+                    dst_bits[y * dst_stride + x * bpp / 8 + 2] != 0xef) break;
+            ok( x == (y < 13 ? 17 : 47), "%u-bpp: wrong color at %d,%d\n", bpp, x, y );
+            if (x != (y < 13 ? 17 : 47)) break;
+        }
+
+        /* stretching a ramp gives a smooth ramp */
+        for (y = 0; y < 48; y++)
+            for (x = 0; x < 48 * bpp / 8; x++)
+                src_bits[y * src_stride + x] = (x / (bpp / 8)) * 32;
+        ret = StretchBlt( hdc_dst, 0, 0, 48, 4, hdc_src, 0, 0, 8, 4, SRCCOPY );
+        ok( ret, "StretchBlt failed\n" );
+        prev = 0;
+        max_diff = 0;
+        for (x = 0; x < 48; x++)
+        {
+            BYTE val = dst_bits[x * bpp / 8];
+            ok( val >= prev, "%u-bpp: ramp not increasing at %d: %02x < %02x\n", bpp, x, val, prev );
+            if (val - prev > max_diff) max_diff = val - prev;
+            prev = val;
+        }
+        ok( max_diff <= 16, "%u-bpp: ramp not interpolated, max step %d\n", bpp, max_diff );
+
+        /* other modes still pick source pixels */
+        for (y = 0; y < 48; y++)
+            for (x = 0; x < 48 * bpp / 8; x++)
+                src_bits[y * src_stride + x] = ((x / (bpp / 8)) ^ y) & 1 ? 0xff : 0x00;
+        SetStretchBltMode( hdc_dst, COLORONCOLOR );
+        ret = StretchBlt( hdc_dst, 0, 0, 24, 24, hdc_src, 0, 0, 48, 48, SRCCOPY );
+        ok( ret, "StretchBlt failed\n" );
+        for (y = 0; y < 24; y++)
+        {
+            for (x = 0; x < 24; x++)
+                if (dst_bits[y * dst_stride + x * bpp / 8] != 0x00 &&
+                    dst_bits[y * dst_stride + x * bpp / 8] != 0xff) break;
+            ok( x == 24, "%u-bpp: COLORONCOLOR blended pixel %d,%d\n", bpp, x, y );
+            if (x != 24) break;
+        }
+
+        SelectObject( hdc_src, old_src );
+        SelectObject( hdc_dst, old_dst );
+        DeleteObject( bmp_src );
+        DeleteObject( bmp_dst );
+    }
+
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+}
+
 static void check_StretchDIBits_pixel(HDC hdcDst, UINT32 *dstBuffer, UINT32 *srcBuffer,
                                       DWORD dwRop, UINT32 expected, int line)
 {
@@ -5573,15 +5836,276 @@ static void test_SetDIBitsToDevice_RLE8(void)
     HeapFree( GetProcessHeap(), 0, info );
 }
 
+#define BAND_DST_WIDTH  200
+#define BAND_DST_HEIGHT 160
+#define BAND_SRC_SIZE   320
+#define BAND_OPS        8
+
+static const int band_bpps[] = { 32, 24, 16 };
+
+static int get_band_results_size(void)
+{
+    int i, size = 0;
+
+    for (i = 0; i < sizeof(band_bpps) / sizeof(band_bpps[0]); i++)
+        size += BAND_OPS * get_bitmap_stride( BAND_DST_WIDTH, band_bpps[i] ) * BAND_DST_HEIGHT;
+    return size;
+}
+
+/* draw large stretch, blend, gradient and fill operations and store the resulting bits */
+static void draw_band_operations( BYTE *results )
+{
+    static const BLENDFUNCTION blend = { AC_SRC_OVER, 0, 0xc0, AC_SRC_ALPHA };
+    static const GRADIENT_RECT rect = { 0, 1 };
+    static const GRADIENT_TRIANGLE tri = { 0, 1, 2 };
+    TRIVERTEX vert[3] =
+    {
+        { 0, 0, 0xff00, 0x8000, 0x0000, 0x0000 },
+        { BAND_DST_WIDTH, BAND_DST_HEIGHT, 0x0000, 0x4000, 0xff00, 0x0000 },
+        { 0, BAND_DST_HEIGHT, 0x8000, 0xff00, 0x2000, 0x0000 }
+    };
+    static const WORD hatch_bits[8] = { 0x11, 0x22, 0x44, 0x88, 0x11, 0x22, 0x44, 0x88 };
+    BITMAPINFO info;
+    HBITMAP bmp_src, bmp_dst, pattern, old_src, old_dst;
+    HBRUSH brush, old_brush;
+    HDC hdc_src, hdc_dst;
+    DWORD *src_bits;
+    BYTE *dst_bits;
+    int i, op, x, y, size;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+
+    memset( &info, 0, sizeof(info) );
+    info.bmiHeader.biSize = sizeof(info.bmiHeader);
+    info.bmiHeader.biWidth = BAND_SRC_SIZE;
+    info.bmiHeader.biHeight = -BAND_SRC_SIZE;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    bmp_src = CreateDIBSection( 0, &info, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    ok( bmp_src != NULL, "failed to create source dib\n" );
+    old_src = SelectObject( hdc_src, bmp_src );
+    for (y = 0; y < BAND_SRC_SIZE; y++)
+        for (x = 0; x < BAND_SRC_SIZE; x++)
+        {
+            BYTE alpha = (x * 3 + y) & 0xff;
+            /* premultiplied so that per-pixel alpha blending is well defined */
+            src_bits[y * BAND_SRC_SIZE + x] = (alpha << 24) | ((((x * 7) & 0xff) * alpha / 255) << 16) |
+                                              ((((y * 5) & 0xff) * alpha / 255) << 8) |
+                                              (((x ^ y) & 0xff) * alpha / 255);
+        }
+
+    pattern = CreateBitmap( 8, 8, 1, 1, hatch_bits );
+
+    for (i = 0; i < sizeof(band_bpps) / sizeof(band_bpps[0]); i++)
+    {
+        info.bmiHeader.biWidth = BAND_DST_WIDTH;
+        info.bmiHeader.biHeight = -BAND_DST_HEIGHT;
+        info.bmiHeader.biBitCount = band_bpps[i];
+        bmp_dst = CreateDIBSection( 0, &info, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+        ok( bmp_dst != NULL, "failed to create %u-bpp dib\n", band_bpps[i] );
+        old_dst = SelectObject( hdc_dst, bmp_dst );
+        size = get_bitmap_stride( BAND_DST_WIDTH, band_bpps[i] ) * BAND_DST_HEIGHT;
+
+        for (op = 0; op < BAND_OPS; op++)
+        {
+            for (x = 0; x < size; x++) dst_bits[x] = x * 11;
+            SetStretchBltMode( hdc_dst, COLORONCOLOR );
+
+            switch (op)
+            {
+            case 0:  /* stretching */
+                StretchBlt( hdc_dst, 3, 1, BAND_DST_WIDTH - 5, BAND_DST_HEIGHT - 2,
+                            hdc_src, 10, 7, 61, 47, SRCCOPY );
+                break;
+            case 1:  /* shrinking, mirrored */
+                StretchBlt( hdc_dst, BAND_DST_WIDTH - 1, 0, -BAND_DST_WIDTH + 1, BAND_DST_HEIGHT,
+                            hdc_src, 0, 0, BAND_SRC_SIZE, BAND_SRC_SIZE - 3, SRCCOPY );
+                break;
+            case 2:  /* filtered stretching */
+                SetStretchBltMode( hdc_dst, HALFTONE );
+                StretchBlt( hdc_dst, 0, 0, BAND_DST_WIDTH, BAND_DST_HEIGHT,
+                            hdc_src, 0, 0, BAND_SRC_SIZE, BAND_SRC_SIZE, SRCCOPY );
+                StretchBlt( hdc_dst, 20, 10, 150, 140, hdc_src, 5, 5, 41, 37, SRCCOPY );
+                break;
+            case 3:  /* per-pixel alpha blending */
+                pGdiAlphaBlend( hdc_dst, 0, 0, BAND_DST_WIDTH, BAND_DST_HEIGHT,
+                                hdc_src, 0, 0, BAND_SRC_SIZE, BAND_SRC_SIZE, blend );
+                pGdiAlphaBlend( hdc_dst, 7, 3, 180, 150, hdc_src, 2, 9, 180, 150, blend );
+                break;
+            case 4:  /* gradients */
+                pGdiGradientFill( hdc_dst, vert, 2, (void *)&rect, 1, GRADIENT_FILL_RECT_V );
+                break;
+            case 5:
+                pGdiGradientFill( hdc_dst, vert, 3, (void *)&tri, 1, GRADIENT_FILL_TRIANGLE );
+                break;
+            case 6:  /* solid fills */
+                brush = CreateSolidBrush( RGB( 0x12, 0x9a, 0xef ));
+                old_brush = SelectObject( hdc_dst, brush );
+                PatBlt( hdc_dst, 0, 0, BAND_DST_WIDTH, BAND_DST_HEIGHT, PATINVERT );
+                PatBlt( hdc_dst, 5, 9, 150, 130, PATCOPY );
+                DeleteObject( SelectObject( hdc_dst, old_brush ));
+                break;
+            case 7:  /* pattern fills */
+                brush = CreatePatternBrush( pattern );
+                old_brush = SelectObject( hdc_dst, brush );
+                SetBrushOrgEx( hdc_dst, 3, 5, NULL );
+                PatBlt( hdc_dst, 0, 0, BAND_DST_WIDTH, BAND_DST_HEIGHT, PATINVERT );
+                PatBlt( hdc_dst, 1, 2, 190, 150, PATCOPY );
+                DeleteObject( SelectObject( hdc_dst, old_brush ));
+                SetBrushOrgEx( hdc_dst, 0, 0, NULL );
+                break;
+            }
+            GdiFlush();
+            memcpy( results, dst_bits, size );
+            results += size;
+        }
+
+        SelectObject( hdc_dst, old_dst );
+        DeleteObject( bmp_dst );
+    }
+
+    DeleteObject( pattern );
+    SelectObject( hdc_src, old_src );
+    DeleteObject( bmp_src );
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+}
+
+static void test_banded_operations_child( const char *filename )
+{
+    int size = get_band_results_size();
+    BYTE *results = HeapAlloc( GetProcessHeap(), 0, size );
+    HANDLE file;
+    DWORD written;
+
+    draw_band_operations( results );
+    file = CreateFileA( filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0 );
+    ok( file != INVALID_HANDLE_VALUE, "failed to create %s, error %u\n", filename, GetLastError() );
+    WriteFile( file, results, size, &written, NULL );
+    ok( written == size, "wrote %u bytes\n", written );
+    CloseHandle( file );
+    HeapFree( GetProcessHeap(), 0, results );
+}
+
+/* The DIB engine can optionally split large operations into bands drawn by
+ * several threads. The configuration is read once, so the banded results
+ * come from a child process and are compared to the serial ones. */
+static void test_banded_operations(void)
+{
+    static const DWORD threads = 4, threshold = 1;
+    static const char * const names[] = { "Threads", "ThreadThreshold" };
+    struct
+    {
+        LONG  error;
+        DWORD type, size;
+        BYTE  data[MAX_PATH];
+    } saved[2];
+    char path[MAX_PATH], filename[MAX_PATH], cmdline[MAX_PATH * 2], **argv;
+    STARTUPINFOA startup;
+    PROCESS_INFORMATION pi;
+    BYTE *serial, *banded;
+    HANDLE file;
+    HKEY key;
+    DWORD disp, read;
+    int i, op, offset, size, stride;
+    BOOL ret;
+
+    if (!pGdiAlphaBlend || !pGdiGradientFill)
+    {
+        win_skip( "GdiAlphaBlend or GdiGradientFill not supported\n" );
+        return;
+    }
+
+    size = get_band_results_size();
+    serial = HeapAlloc( GetProcessHeap(), 0, size );
+    banded = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, size );
+    draw_band_operations( serial );
+
+    if (RegCreateKeyExA( HKEY_CURRENT_USER, "Software\\Wine\\DIB Engine", 0, NULL, 0,
+                         KEY_ALL_ACCESS, NULL, &key, &disp ))
+    {
+        skip( "can't create the DIB engine key\n" );
+        HeapFree( GetProcessHeap(), 0, serial );
+        HeapFree( GetProcessHeap(), 0, banded );
+        return;
+    }
+    /* the user may have configured the threads already, put their settings back afterwards */
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        saved[i].size = sizeof(saved[i].data);
+        saved[i].error = RegQueryValueExA( key, names[i], NULL, &saved[i].type, saved[i].data, &saved[i].size );
+    }
+    RegSetValueExA( key, "Threads", 0, REG_DWORD, (const BYTE *)&threads, sizeof(threads) );
+    RegSetValueExA( key, "ThreadThreshold", 0, REG_DWORD, (const BYTE *)&threshold, sizeof(threshold) );
+
+    GetTempPathA( sizeof(path), path );
+    GetTempFileNameA( path, "gdi", 0, filename );
+    winetest_get_mainargs( &argv );
+    sprintf( cmdline, "\"%s\" bitmap bands \"%s\"", argv[0], filename );
+    memset( &startup, 0, sizeof(startup) );
+    startup.cb = sizeof(startup);
+    ret = CreateProcessA( NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &pi );
+    ok( ret, "CreateProcess failed, error %u\n", GetLastError() );
+    if (ret)
+    {
+        winetest_wait_child_process( pi.hProcess );
+        CloseHandle( pi.hProcess );
+        CloseHandle( pi.hThread );
+    }
+
+    if (disp == REG_CREATED_NEW_KEY)
+        RegDeleteKeyA( HKEY_CURRENT_USER, "Software\\Wine\\DIB Engine" );
+    else
+    {
+        for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        {
+            if (!saved[i].error)
+                RegSetValueExA( key, names[i], 0, saved[i].type, saved[i].data, saved[i].size );
+            else
+                RegDeleteValueA( key, names[i] );
+        }
+    }
+    RegCloseKey( key );
+
+    file = CreateFileA( filename, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, 0 );
+    ok( file != INVALID_HANDLE_VALUE, "failed to open %s, error %u\n", filename, GetLastError() );
+    ReadFile( file, banded, size, &read, NULL );
+    ok( read == size, "read %u bytes\n", read );
+    CloseHandle( file );
+    DeleteFileA( filename );
+
+    for (i = offset = 0; i < sizeof(band_bpps) / sizeof(band_bpps[0]); i++)
+    {
+        stride = get_bitmap_stride( BAND_DST_WIDTH, band_bpps[i] );
+        for (op = 0; op < BAND_OPS; op++, offset += stride * BAND_DST_HEIGHT)
+            ok( !memcmp( serial + offset, banded + offset, stride * BAND_DST_HEIGHT ),
+                "%u-bpp: operation %d differs when drawn in bands\n", band_bpps[i], op );
+    }
+
+    HeapFree( GetProcessHeap(), 0, serial );
+    HeapFree( GetProcessHeap(), 0, banded );
+}
+
 START_TEST(bitmap)
 {
     HMODULE hdll;
+    char **argv;
+    int argc;
 
     hdll = GetModuleHandle("gdi32.dll");
     pGdiAlphaBlend   = (void*)GetProcAddress(hdll, "GdiAlphaBlend");
     pGdiGradientFill = (void*)GetProcAddress(hdll, "GdiGradientFill");
     pSetLayout       = (void*)GetProcAddress(hdll, "SetLayout");
 
+    argc = winetest_get_mainargs( &argv );
+    if (argc >= 4 && !strcmp( argv[2], "bands" ))
+    {
+        test_banded_operations_child( argv[3] );
+        return;
+    }
+
     test_createdibitmap();
     test_dibsections();
     test_dib_formats();
@@ -5599,9 +6123,12 @@ START_TEST(bitmap)
     test_select_object();
     test_CreateBitmap();
     test_BitBlt();
+    test_BitBlt_lines();
     test_StretchBlt();
+    test_StretchBlt_halftone();
     test_StretchDIBits();
     test_GdiAlphaBlend();
+    test_GdiAlphaBlend_lines();
     test_GdiGradientFill();
     test_32bit_ddb();
     test_bitmapinfoheadersize();
@@ -5617,4 +6144,5 @@ START_TEST(bitmap)
     test_SetDIBits_RLE8();
     test_SetDIBitsToDevice();
     test_SetDIBitsToDevice_RLE8();
+    test_banded_operations();
 }
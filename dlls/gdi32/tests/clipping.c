@@ -269,6 +269,96 @@ static void test_ExtCreateRegion(void)
     DeleteObject(hrgn);
 }
 
+static void verify_region_rects(HRGN hrgn, const RECT *rects, DWORD count, int line)
+{
+    union
+    {
+        RGNDATA data;
+        char buf[sizeof(RGNDATAHEADER) + 8 * sizeof(RECT)];
+    } rgn;
+    const RECT *rect = (const RECT *)rgn.data.Buffer;
+    DWORD ret, i;
+
+    ret = GetRegionData(hrgn, sizeof(rgn), &rgn.data);
+    ok_(__FILE__, line)(ret == sizeof(rgn.data.rdh) + count * sizeof(RECT), "got size %u\n", ret);
+    if (!ret) return;
+    ok_(__FILE__, line)(rgn.data.rdh.nCount == count, "expected %u rects, got %u\n", count, rgn.data.rdh.nCount);
+    for (i = 0; i < min(count, rgn.data.rdh.nCount); i++)
+        ok_(__FILE__, line)(EqualRect(&rect[i], &rects[i]), "%u: expected (%d,%d-%d,%d), got (%d,%d-%d,%d)\n", i,
+                            rects[i].left, rects[i].top, rects[i].right, rects[i].bottom,
+                            rect[i].left, rect[i].top, rect[i].right, rect[i].bottom);
+}
+
+static void test_CombineRgn(void)
+{
+    static const RECT and_rects[] = { { 20, 20, 50, 50 } };
+    static const RECT diff_rects[] = { { 0, 0, 100, 20 }, { 0, 20, 20, 50 }, { 50, 20, 100, 50 }, { 0, 50, 100, 100 } };
+    static const RECT clip_rects[] = { { 10, 10, 20, 40 } };
+    static const RECT append_rects[] = { { 0, 0, 10, 30 }, { 0, 30, 10, 40 }, { 20, 30, 30, 40 } };
+    static const RECT xor_rects[] = { { 0, 0, 10, 10 }, { 0, 10, 5, 20 }, { 10, 10, 20, 20 }, { 5, 20, 20, 25 } };
+    HRGN rgn1, rgn2, rgn3, dst;
+    INT ret;
+
+    rgn1 = CreateRectRgn(0, 0, 100, 100);
+    rgn2 = CreateRectRgn(20, 20, 50, 50);
+    dst = CreateRectRgn(0, 0, 0, 0);
+
+    ret = CombineRgn(dst, rgn1, rgn2, RGN_AND);
+    ok(ret == SIMPLEREGION, "got %d\n", ret);
+    verify_region_rects(dst, and_rects, 1, __LINE__);
+
+    ret = CombineRgn(dst, rgn1, rgn2, RGN_DIFF);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, diff_rects, 4, __LINE__);
+
+    /* in place, the destination is one of the sources */
+    ret = CombineRgn(rgn2, rgn2, rgn1, RGN_DIFF);
+    ok(ret == NULLREGION, "got %d\n", ret);
+    verify_region_rects(rgn2, NULL, 0, __LINE__);
+
+    SetRectRgn(rgn2, 20, 20, 50, 50);
+    ret = CombineRgn(rgn1, rgn1, rgn2, RGN_DIFF);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(rgn1, diff_rects, 4, __LINE__);
+
+    /* clipping a complex region to a rectangle coalesces the resulting bands */
+    SetRectRgn(rgn2, 10, 10, 20, 40);
+    ret = CombineRgn(rgn1, rgn1, rgn2, RGN_AND);
+    ok(ret == SIMPLEREGION, "got %d\n", ret);
+    verify_region_rects(rgn1, clip_rects, 1, __LINE__);
+
+    /* union of regions above each other */
+    SetRectRgn(rgn1, 0, 0, 10, 30);
+    rgn3 = CreateRectRgn(20, 30, 30, 40);
+    SetRectRgn(rgn2, 0, 30, 10, 40);
+    ret = CombineRgn(rgn2, rgn2, rgn3, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    ret = CombineRgn(dst, rgn2, rgn1, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, append_rects, 3, __LINE__);
+    ret = CombineRgn(rgn1, rgn1, rgn2, RGN_OR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(rgn1, append_rects, 3, __LINE__);
+
+    SetRectRgn(rgn1, 0, 0, 10, 10);
+    SetRectRgn(rgn2, 0, 10, 10, 20);
+    ret = CombineRgn(rgn2, rgn1, rgn2, RGN_OR);
+    ok(ret == SIMPLEREGION, "got %d\n", ret);
+    SetRectRgn(rgn1, 0, 0, 10, 20);
+    ok(EqualRgn(rgn1, rgn2), "regions should be equal\n");
+
+    SetRectRgn(rgn1, 0, 0, 10, 20);
+    SetRectRgn(rgn2, 5, 10, 20, 25);
+    ret = CombineRgn(dst, rgn1, rgn2, RGN_XOR);
+    ok(ret == COMPLEXREGION, "got %d\n", ret);
+    verify_region_rects(dst, xor_rects, 4, __LINE__);
+
+    DeleteObject(rgn1);
+    DeleteObject(rgn2);
+    DeleteObject(rgn3);
+    DeleteObject(dst);
+}
+
 static void test_GetClipRgn(void)
 {
     HDC hdc;
@@ -516,6 +606,7 @@ START_TEST(clipping)
 {
     test_GetRandomRgn();
     test_ExtCreateRegion();
+    test_CombineRgn();
     test_GetClipRgn();
     test_memory_dc_clipping();
     test_window_dc_clipping();
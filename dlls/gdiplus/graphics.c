@@ -938,6 +938,374 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
 }
 
+/* Image resampling for GdipDrawImagePointsRect.
+ *
+ * The source position of each destination pixel is computed from a table of
+ * per-column positions plus a per-row offset, which gives exactly the same
+ * values as transforming every pixel. When the transformation doesn't rotate
+ * or skew, the image is resampled a row at a time: the horizontal pass of the
+ * bilinear filter is only done once for each source row a band needs and then
+ * shared by all the destination rows using it. Large images are split into
+ * bands of rows processed on thread pool threads. */
+
+#define SAMPLE_OUTSIDE -1  /* outside of the bitmap, use the outside color */
+#define SAMPLE_INVALID -2  /* outside of the locked source area */
+
+#define MAX_RESAMPLE_THREADS 8
+#define MIN_RESAMPLE_BAND_PIXELS (256 * 1024)
+
+struct resample_tap
+{
+    INT  index[2];  /* source column or row for both neighbours, or one of the SAMPLE_ values */
+    REAL position;  /* weight of the second neighbour */
+    BOOL inside;    /* within the source rectangle */
+    BOOL single;    /* exactly on a source pixel */
+};
+
+struct resample_params
+{
+    const GpRect *src_area;
+    const ARGB *src_bits;
+    UINT width, height;
+    const GpImageAttributes *attributes;
+    InterpolationMode interpolation;
+    PixelOffsetMode offset_mode;
+    REAL srcx, srcy, srcwidth, srcheight;
+    RECT dst_area;
+    ARGB *dst_bits;
+    const GpPointF *columns;  /* source position of each destination column on row 0 */
+    REAL y_dx, y_dy;          /* source step for each destination row */
+    struct resample_tap *x_taps;  /* only for scaling without rotation */
+    int band_count;
+};
+
+/* Map a source coordinate like sample_bitmap_pixel does, for a single axis. */
+static INT map_sample_coord(INT x, UINT size, INT area_start, INT area_size, WrapMode wrap, int flip)
+{
+    if (wrap == WrapModeClamp)
+    {
+        if (x < 0 || x >= size)
+            return SAMPLE_OUTSIDE;
+    }
+    else
+    {
+        if (x < 0)
+            x = size*2 + x % (size * 2);
+
+        if ((wrap & flip) == flip)
+        {
+            if ((x / size) % 2 == 0)
+                x = x % size;
+            else
+                x = size - 1 - x % size;
+        }
+        else
+            x = x % size;
+    }
+
+    if (x < area_start || x >= area_start + area_size)
+        return SAMPLE_INVALID;
+
+    return x - area_start;
+}
+
+static inline ARGB fetch_sample(const struct resample_params *params, INT x, INT y)
+{
+    if (x >= 0 && y >= 0)
+        return params->src_bits[x + y * params->src_area->Width];
+
+    if (x == SAMPLE_OUTSIDE || y == SAMPLE_OUTSIDE)
+        return params->attributes->outside_color;
+
+    ERR("out of range pixel requested\n");
+    return 0xffcd0084;
+}
+
+static void get_resample_tap(const struct resample_params *params, REAL pos, REAL start, REAL size,
+    UINT bitmap_size, INT area_start, INT area_size, int flip, struct resample_tap *tap)
+{
+    WrapMode wrap = params->attributes->wrap;
+
+    tap->inside = pos >= start && pos < start + size;
+
+    if (params->interpolation == InterpolationModeNearestNeighbor)
+    {
+        FLOAT pixel_offset;
+        switch (params->offset_mode)
+        {
+        default:
+        case PixelOffsetModeNone:
+        case PixelOffsetModeHighSpeed:
+            pixel_offset = 0.5;
+            break;
+
+        case PixelOffsetModeHalf:
+        case PixelOffsetModeHighQuality:
+            pixel_offset = 0.0;
+            break;
+        }
+        tap->index[0] = tap->index[1] = map_sample_coord(floorf(pos + pixel_offset), bitmap_size,
+                                                         area_start, area_size, wrap, flip);
+        tap->position = 0.0;
+        tap->single = TRUE;
+    }
+    else
+    {
+        REAL posf = floorf(pos);
+        INT first = (INT)posf, second = (INT)ceilf(pos);
+
+        tap->index[0] = map_sample_coord(first, bitmap_size, area_start, area_size, wrap, flip);
+        tap->index[1] = map_sample_coord(second, bitmap_size, area_start, area_size, wrap, flip);
+        tap->position = pos - posf;
+        tap->single = first == second;
+    }
+}
+
+/* Blend two lines of pixels with a constant weight, computing the same values as blend_colors. */
+static void blend_color_line(ARGB *dst, const ARGB *start, const ARGB *end, REAL position, int count)
+{
+    REAL inv = 1.0f - position;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        ARGB s = start[i], e = end[i];
+
+        dst[i] = ((INT)((s >> 24) * inv + (e >> 24) * position) << 24) |
+                 ((INT)(((s >> 16) & 0xff) * inv + ((e >> 16) & 0xff) * position) << 16) |
+                 ((INT)(((s >> 8) & 0xff) * inv + ((e >> 8) & 0xff) * position) << 8) |
+                 (INT)((s & 0xff) * inv + (e & 0xff) * position);
+    }
+}
+
+/* Apply the horizontal pass of the filter to a source row. */
+static void resample_row(const struct resample_params *params, INT row, ARGB *dst)
+{
+    int i, count = params->dst_area.right - params->dst_area.left;
+
+    for (i = 0; i < count; i++)
+    {
+        const struct resample_tap *tap = &params->x_taps[i];
+
+        if (!tap->inside)
+            dst[i] = 0;
+        else if (tap->single)
+            dst[i] = fetch_sample(params, tap->index[0], row);
+        else
+            dst[i] = blend_colors(fetch_sample(params, tap->index[0], row),
+                                  fetch_sample(params, tap->index[1], row), tap->position);
+    }
+}
+
+/* Resample the rows of a band when there is no rotation or skew. */
+static BOOL resample_band_scaled(const struct resample_params *params, INT top, INT bottom)
+{
+    int i, y, width = params->dst_area.right - params->dst_area.left;
+    ARGB *buffer = NULL, *rows[2];
+    INT keys[2] = {INT_MIN, INT_MIN};
+
+    if (params->interpolation != InterpolationModeNearestNeighbor)
+    {
+        if (!(buffer = GdipAlloc(2 * width * sizeof(ARGB))))
+            return FALSE;
+        rows[0] = buffer;
+        rows[1] = buffer + width;
+    }
+
+    for (y = top; y < bottom; y++)
+    {
+        ARGB *dst = params->dst_bits + (y - params->dst_area.top) * width;
+        struct resample_tap y_tap;
+        const ARGB *first, *second;
+
+        get_resample_tap(params, params->columns[0].Y + y * params->y_dy, params->srcy, params->srcheight,
+                         params->height, params->src_area->Y, params->src_area->Height, 2, &y_tap);
+
+        if (!y_tap.inside)
+        {
+            memset(dst, 0, width * sizeof(ARGB));
+            continue;
+        }
+
+        if (!buffer)
+        {
+            for (i = 0; i < width; i++)
+                dst[i] = params->x_taps[i].inside ?
+                    fetch_sample(params, params->x_taps[i].index[0], y_tap.index[0]) : 0;
+            continue;
+        }
+
+        /* reuse the rows already resampled for the previous destination row */
+        if (keys[0] != y_tap.index[0] && keys[1] != y_tap.index[0])
+        {
+            int slot = (keys[0] == y_tap.index[1] && !y_tap.single) ? 1 : 0;
+            resample_row(params, y_tap.index[0], rows[slot]);
+            keys[slot] = y_tap.index[0];
+        }
+        first = rows[keys[0] == y_tap.index[0] ? 0 : 1];
+
+        if (y_tap.single)
+        {
+            memcpy(dst, first, width * sizeof(ARGB));
+        }
+        else
+        {
+            if (keys[0] != y_tap.index[1] && keys[1] != y_tap.index[1])
+            {
+                int slot = first == rows[0] ? 1 : 0;
+                resample_row(params, y_tap.index[1], rows[slot]);
+                keys[slot] = y_tap.index[1];
+            }
+            second = rows[keys[0] == y_tap.index[1] ? 0 : 1];
+            blend_color_line(dst, first, second, y_tap.position, width);
+        }
+    }
+
+    GdipFree(buffer);
+    return TRUE;
+}
+
+static void resample_band(const struct resample_params *params, INT top, INT bottom)
+{
+    int x, y, width = params->dst_area.right - params->dst_area.left;
+
+    if (params->x_taps && resample_band_scaled(params, top, bottom))
+        return;
+
+    for (y = top; y < bottom; y++)
+    {
+        ARGB *dst = params->dst_bits + (y - params->dst_area.top) * width;
+        REAL offset_x = y * params->y_dx, offset_y = y * params->y_dy;
+
+        for (x = 0; x < width; x++)
+        {
+            GpPointF src_pointf;
+
+            src_pointf.X = params->columns[x].X + offset_x;
+            src_pointf.Y = params->columns[x].Y + offset_y;
+
+            if (src_pointf.X >= params->srcx && src_pointf.X < params->srcx + params->srcwidth &&
+                src_pointf.Y >= params->srcy && src_pointf.Y < params->srcy + params->srcheight)
+                dst[x] = resample_bitmap_pixel(params->src_area, (BYTE *)params->src_bits,
+                    params->width, params->height, &src_pointf, params->attributes,
+                    params->interpolation, params->offset_mode);
+            else
+                dst[x] = 0;
+        }
+    }
+}
+
+static void resample_band_index(const struct resample_params *params, int index)
+{
+    LONGLONG height = params->dst_area.bottom - params->dst_area.top;
+
+    resample_band(params, params->dst_area.top + height * index / params->band_count,
+                  params->dst_area.top + height * (index + 1) / params->band_count);
+}
+
+struct resample_work
+{
+    LONG refcount;
+    LONG next;       /* next band to process */
+    LONG remaining;  /* number of bands not finished yet */
+    int count;
+    HANDLE done;     /* signaled once all the bands are finished */
+    const struct resample_params *params;
+};
+
+static void process_resample_bands(struct resample_work *work)
+{
+    LONG index;
+
+    while ((index = InterlockedIncrement(&work->next) - 1) < work->count)
+    {
+        resample_band_index(work->params, index);
+        if (!InterlockedDecrement(&work->remaining))
+            SetEvent(work->done);
+    }
+}
+
+static void release_resample_work(struct resample_work *work)
+{
+    if (InterlockedDecrement(&work->refcount))
+        return;
+    CloseHandle(work->done);
+    GdipFree(work);
+}
+
+static DWORD CALLBACK resample_worker(void *arg)
+{
+    struct resample_work *work = arg;
+
+    /* the parameters may be gone once all the bands are taken, process_resample_bands doesn't touch them then */
+    process_resample_bands(work);
+    release_resample_work(work);
+    return 0;
+}
+
+static int get_resample_band_count(const RECT *rect)
+{
+    static int cpus;
+    LONGLONG pixels = (LONGLONG)(rect->right - rect->left) * (rect->bottom - rect->top);
+
+    if (!cpus)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        cpus = max(1, min(info.dwNumberOfProcessors, MAX_RESAMPLE_THREADS));
+    }
+
+    if (cpus == 1 || pixels < 2 * MIN_RESAMPLE_BAND_PIXELS)
+        return 1;
+
+    return max(1, min(min(cpus, pixels / MIN_RESAMPLE_BAND_PIXELS), rect->bottom - rect->top));
+}
+
+static void resample_bitmap(struct resample_params *params)
+{
+    struct resample_work *work = NULL;
+    int i;
+
+    params->band_count = get_resample_band_count(&params->dst_area);
+
+    TRACE("%s in %d bands\n", wine_dbgstr_rect(&params->dst_area), params->band_count);
+
+    if (params->band_count > 1 && (work = GdipAlloc(sizeof(*work))))
+    {
+        if (!(work->done = CreateEventW(NULL, TRUE, FALSE, NULL)))
+        {
+            GdipFree(work);
+            work = NULL;
+        }
+    }
+
+    if (!work)
+    {
+        resample_band(params, params->dst_area.top, params->dst_area.bottom);
+        return;
+    }
+
+    work->refcount = 1;
+    work->next = 0;
+    work->remaining = params->band_count;
+    work->count = params->band_count;
+    work->params = params;
+
+    for (i = 1; i < params->band_count; i++)
+    {
+        InterlockedIncrement(&work->refcount);
+        if (QueueUserWorkItem(resample_worker, work, WT_EXECUTEDEFAULT))
+            continue;
+        InterlockedDecrement(&work->refcount);
+        break;
+    }
+
+    /* the calling thread processes bands too, so this completes even if no worker ever runs */
+    process_resample_bands(work);
+    WaitForSingleObject(work->done, INFINITE);
+    release_resample_work(work);
+}
+
 static REAL intersect_line_scanline(const GpPointF *p1, const GpPointF *p2, REAL y)
 {
     return (p1->X - p2->X) * (p2->Y - y) / (p2->Y - p1->Y) + p2->X;
@@ -2942,7 +3310,7 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
         {
             RECT dst_area;
             GpRect src_area;
-            int i, x, y, src_stride, dst_stride;
+            int i, x, src_stride, dst_stride;
             GpMatrix dst_to_src;
             REAL m11, m12, m21, m22, mdx, mdy;
             LPBYTE src_data, dst_data;
@@ -2951,6 +3319,9 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             PixelOffsetMode offset_mode = graphics->pixeloffset;
             GpPointF dst_to_src_points[3] = {{0.0, 0.0}, {1.0, 0.0}, {0.0, 1.0}};
             REAL x_dx, x_dy, y_dx, y_dy;
+            struct resample_params params;
+            struct resample_tap *x_taps = NULL;
+            GpPointF *columns;
             static const GpImageAttributes defaultImageAttributes = {WrapModeClamp, 0, FALSE};
 
             if (!imageAttributes)
@@ -3031,26 +3402,59 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
             y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
 
-            for (x=dst_area.left; x<dst_area.right; x++)
+            columns = GdipAlloc(sizeof(*columns) * (dst_area.right - dst_area.left));
+            if (!columns)
             {
-                for (y=dst_area.top; y<dst_area.bottom; y++)
-                {
-                    GpPointF src_pointf;
-                    ARGB *dst_color;
+                GdipFree(src_data);
+                GdipFree(dst_data);
+                return OutOfMemory;
+            }
 
-                    src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
-                    src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
+            params.src_area = &src_area;
+            params.src_bits = (const ARGB *)src_data;
+            params.width = bitmap->width;
+            params.height = bitmap->height;
+            params.attributes = imageAttributes;
+            params.interpolation = interpolation;
+            params.offset_mode = offset_mode;
+            params.srcx = srcx;
+            params.srcy = srcy;
+            params.srcwidth = srcwidth;
+            params.srcheight = srcheight;
+            params.dst_area = dst_area;
+            params.dst_bits = (ARGB *)dst_data;
+            params.columns = columns;
+            params.y_dx = y_dx;
+            params.y_dy = y_dy;
+            params.x_taps = NULL;
 
-                    dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
+            for (x=dst_area.left; x<dst_area.right; x++)
+            {
+                columns[x - dst_area.left].X = dst_to_src_points[0].X + x * x_dx;
+                columns[x - dst_area.left].Y = dst_to_src_points[0].Y + x * x_dy;
+            }
 
-                    if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
-                        *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                           imageAttributes, interpolation, offset_mode);
-                    else
-                        *dst_color = 0;
+            /* without rotation the filter can be applied separately to rows and columns */
+            if (x_dy == 0.0 && y_dx == 0.0 &&
+                (x_taps = GdipAlloc(sizeof(*x_taps) * (dst_area.right - dst_area.left))))
+            {
+                if (interpolation != InterpolationModeNearestNeighbor && interpolation != InterpolationModeBilinear)
+                {
+                    static int fixme;
+                    if (!fixme++)
+                        FIXME("Unimplemented interpolation %i\n", interpolation);
                 }
+
+                for (x=0; x<dst_area.right - dst_area.left; x++)
+                    get_resample_tap(&params, columns[x].X, srcx, srcwidth, bitmap->width,
+                                     src_area.X, src_area.Width, 1, &x_taps[x]);
+                params.x_taps = x_taps;
             }
 
+            resample_bitmap(&params);
+
+            GdipFree(x_taps);
+            GdipFree(columns);
             GdipFree(src_data);
 
             stat = alpha_blend_pixels(graphics, dst_area.left, dst_area.top,
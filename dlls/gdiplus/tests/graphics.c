@@ -36,6 +36,18 @@ static const REAL mm_per_inch = 25.4;
 static const REAL point_per_inch = 72.0;
 static HWND hwnd;
 
+static BOOL color_match(ARGB c1, ARGB c2, BYTE max_diff)
+{
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    return TRUE;
+}
+
 static void set_rect_empty(RectF *rc)
 {
     rc->X = 0.0;
@@ -1296,6 +1308,119 @@ static void test_GdipDrawImagePointsRect(void)
     ReleaseDC(hwnd, hdc);
 }
 
+/* value of the source gradient at a position, with bilinear interpolation */
+static UINT gradient_value(REAL pos)
+{
+    return 0x10 + 0x20 * min(pos, 7.0);
+}
+
+static void test_GdipDrawImagePointsRect_scaled(void)
+{
+    static const ARGB src_colors[4] = { 0xffff0000, 0xff00ff00, 0xff0000ff, 0xffffffff };
+    /* upscaling, downscaling, and a size big enough to be split into bands */
+    static const UINT sizes[][2] = { { 12, 20 }, { 3, 5 }, { 1024, 512 } };
+    GpStatus status;
+    GpGraphics *graphics;
+    GpBitmap *src, *dst;
+    GpImageAttributes *attributes;
+    GpPointF ptf[3];
+    ARGB color;
+    int i, x, y;
+
+    status = GdipCreateBitmapFromScan0(2, 2, 0, PixelFormat32bppARGB, NULL, &src);
+    expect(Ok, status);
+    for (y = 0; y < 2; y++)
+        for (x = 0; x < 2; x++)
+            GdipBitmapSetPixel(src, x, y, src_colors[x + y * 2]);
+
+    status = GdipCreateBitmapFromScan0(4, 4, 0, PixelFormat32bppARGB, NULL, &dst);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage*)dst, &graphics);
+    expect(Ok, status);
+    status = GdipSetInterpolationMode(graphics, InterpolationModeNearestNeighbor);
+    expect(Ok, status);
+    status = GdipSetPixelOffsetMode(graphics, PixelOffsetModeHalf);
+    expect(Ok, status);
+
+    ptf[0].X = 0;
+    ptf[0].Y = 0;
+    ptf[1].X = 4;
+    ptf[1].Y = 0;
+    ptf[2].X = 0;
+    ptf[2].Y = 4;
+    status = GdipDrawImagePointsRect(graphics, (GpImage*)src, ptf, 3, 0, 0, 2, 2, UnitPixel, NULL, NULL, NULL);
+    expect(Ok, status);
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 4; x++)
+        {
+            color = 0;
+            GdipBitmapGetPixel(dst, x, y, &color);
+            ok(color == src_colors[x / 2 + (y / 2) * 2], "(%d,%d): expected %08x, got %08x\n",
+               x, y, src_colors[x / 2 + (y / 2) * 2], color);
+        }
+
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage*)dst);
+    GdipDisposeImage((GpImage*)src);
+
+    /* bilinear scaling of a gradient, red increases along x and green along y; flipping
+     * at the edges keeps the image opaque, so the gradient just stops at the last pixel */
+    status = GdipCreateBitmapFromScan0(8, 8, 0, PixelFormat32bppARGB, NULL, &src);
+    expect(Ok, status);
+    for (y = 0; y < 8; y++)
+        for (x = 0; x < 8; x++)
+            GdipBitmapSetPixel(src, x, y, 0xff000080 | (gradient_value(x) << 16) | (gradient_value(y) << 8));
+
+    status = GdipCreateImageAttributes(&attributes);
+    expect(Ok, status);
+    status = GdipSetImageAttributesWrapMode(attributes, WrapModeTileFlipXY, 0, FALSE);
+    expect(Ok, status);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        UINT width = sizes[i][0], height = sizes[i][1], errors = 0;
+        BitmapData data;
+
+        status = GdipCreateBitmapFromScan0(width, height, 0, PixelFormat32bppARGB, NULL, &dst);
+        expect(Ok, status);
+        status = GdipGetImageGraphicsContext((GpImage*)dst, &graphics);
+        expect(Ok, status);
+        status = GdipSetInterpolationMode(graphics, InterpolationModeBilinear);
+        expect(Ok, status);
+
+        ptf[0].X = 0;
+        ptf[0].Y = 0;
+        ptf[1].X = width;
+        ptf[1].Y = 0;
+        ptf[2].X = 0;
+        ptf[2].Y = height;
+        status = GdipDrawImagePointsRect(graphics, (GpImage*)src, ptf, 3, 0, 0, 8, 8, UnitPixel, attributes, NULL, NULL);
+        expect(Ok, status);
+
+        status = GdipBitmapLockBits(dst, NULL, ImageLockModeRead, PixelFormat32bppARGB, &data);
+        expect(Ok, status);
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+            {
+                ARGB expected = 0xff000080 | (gradient_value(x * 8.0 / width) << 16) |
+                                (gradient_value(y * 8.0 / height) << 8);
+
+                color = ((ARGB *)((BYTE *)data.Scan0 + y * data.Stride))[x];
+                if (!color_match(color, expected, 1) && !errors++)
+                    ok(0, "%ux%u: (%d,%d): expected %08x, got %08x\n", width, height, x, y, expected, color);
+            }
+        ok(!errors, "%ux%u: %u pixels differ\n", width, height, errors);
+        GdipBitmapUnlockBits(dst, &data);
+
+        GdipDeleteGraphics(graphics);
+        GdipDisposeImage((GpImage*)dst);
+    }
+
+    GdipDisposeImageAttributes(attributes);
+    GdipDisposeImage((GpImage*)src);
+}
+
 static void test_GdipDrawLinesI(void)
 {
     GpStatus status;
@@ -4867,6 +4992,7 @@ START_TEST(graphics)
     test_GdipDrawLineI();
     test_GdipDrawLinesI();
     test_GdipDrawImagePointsRect();
+    test_GdipDrawImagePointsRect_scaled();
     test_GdipFillClosedCurve();
     test_GdipFillClosedCurveI();
     test_GdipDrawString();
@@ -31,6 +31,15 @@ typedef struct {
     jsdisp_t dispex;
 
     DWORD length;
+
+    /*
+     * Unless the array is sparse, elements 0..elems_cnt-1 are kept in the elems
+     * vector and there are no other indexed properties in the property table.
+     */
+    jsval_t *elems;
+    DWORD elems_cnt;
+    DWORD elems_size;
+    BOOL sparse;
 } ArrayInstance;
 
 static const WCHAR lengthW[] = {'l','e','n','g','t','h',0};
@@ -59,6 +68,16 @@ static inline ArrayInstance *array_this(vdisp_t *jsthis)
     return is_vclass(jsthis, JSCLASS_ARRAY) ? array_from_vdisp(jsthis) : NULL;
 }
 
+static inline ArrayInstance *array_from_jsdisp(jsdisp_t *jsdisp)
+{
+    return (ArrayInstance*)jsdisp;
+}
+
+static inline ArrayInstance *dense_array(jsdisp_t *jsdisp)
+{
+    return is_class(jsdisp, JSCLASS_ARRAY) && !array_from_jsdisp(jsdisp)->sparse ? array_from_jsdisp(jsdisp) : NULL;
+}
+
 static HRESULT get_length(script_ctx_t *ctx, vdisp_t *vdisp, jsdisp_t **jsthis, DWORD *ret)
 {
     ArrayInstance *array;
@@ -113,6 +132,167 @@ static WCHAR *idx_to_str(DWORD idx, WCHAR *ptr)
     return ptr+1;
 }
 
+BOOL is_dense_array(jsdisp_t *jsdisp)
+{
+    return dense_array(jsdisp) != NULL;
+}
+
+jsval_t *array_get_elem(jsdisp_t *jsdisp, DWORD idx)
+{
+    ArrayInstance *array = dense_array(jsdisp);
+
+    return array && idx < array->elems_cnt ? array->elems+idx : NULL;
+}
+
+HRESULT array_make_sparse(jsdisp_t *jsdisp)
+{
+    ArrayInstance *array = dense_array(jsdisp);
+    DWORD i, length;
+    HRESULT hres = S_OK;
+
+    if(!array)
+        return S_OK;
+
+    TRACE("%p %u\n", array, array->elems_cnt);
+
+    array->sparse = TRUE;
+
+    /* Elements created by fdexNameEnsure don't change length until assigned. */
+    length = array->length;
+    for(i=0; i < array->elems_cnt; i++) {
+        if(SUCCEEDED(hres))
+            hres = jsdisp_propput_idx(&array->dispex, i, array->elems[i]);
+        jsval_release(array->elems[i]);
+    }
+    array->length = length;
+
+    heap_free(array->elems);
+    array->elems = NULL;
+    array->elems_cnt = array->elems_size = 0;
+    return hres;
+}
+
+static HRESULT reserve_elems(ArrayInstance *array, DWORD size)
+{
+    DWORD new_size;
+    jsval_t *new_elems;
+
+    if(size <= array->elems_size)
+        return S_OK;
+
+    new_size = array->elems_size ? array->elems_size : 4;
+    while(new_size < size)
+        new_size *= 2;
+
+    if(array->elems)
+        new_elems = heap_realloc(array->elems, new_size*sizeof(*new_elems));
+    else
+        new_elems = heap_alloc(new_size*sizeof(*new_elems));
+    if(!new_elems)
+        return E_OUTOFMEMORY;
+
+    array->elems = new_elems;
+    array->elems_size = new_size;
+    return S_OK;
+}
+
+static HRESULT append_elem(ArrayInstance *array, jsval_t val)
+{
+    HRESULT hres;
+
+    hres = reserve_elems(array, array->elems_cnt+1);
+    if(FAILED(hres))
+        return hres;
+
+    hres = jsval_copy(val, array->elems+array->elems_cnt);
+    if(FAILED(hres))
+        return hres;
+
+    array->elems_cnt++;
+    return S_OK;
+}
+
+/*
+ * Stores an element in the dense vector. Returns S_FALSE if the element can't be
+ * stored there, in which case the array is converted to a sparse one and the caller
+ * should store it as a named property.
+ */
+HRESULT array_put_elem(jsdisp_t *jsdisp, DWORD idx, jsval_t val)
+{
+    ArrayInstance *array = dense_array(jsdisp);
+    HRESULT hres;
+
+    if(!array)
+        return S_FALSE;
+
+    if(idx < array->elems_cnt) {
+        jsval_t tmp;
+
+        hres = jsval_copy(val, &tmp);
+        if(FAILED(hres))
+            return hres;
+
+        jsval_release(array->elems[idx]);
+        array->elems[idx] = tmp;
+    }else if(idx == array->elems_cnt && idx < ARRAY_DENSE_MAX_LENGTH) {
+        hres = append_elem(array, val);
+        if(FAILED(hres))
+            return hres;
+    }else {
+        hres = array_make_sparse(jsdisp);
+        return FAILED(hres) ? hres : S_FALSE;
+    }
+
+    if(idx >= array->length)
+        array->length = idx+1;
+    return S_OK;
+}
+
+/* Like array_put_elem, but creates an undefined element without changing length. */
+HRESULT array_ensure_elem(jsdisp_t *jsdisp, DWORD idx)
+{
+    ArrayInstance *array = dense_array(jsdisp);
+    HRESULT hres;
+
+    if(!array)
+        return S_FALSE;
+
+    if(idx < array->elems_cnt)
+        return S_OK;
+    if(idx == array->elems_cnt && idx < ARRAY_DENSE_MAX_LENGTH)
+        return append_elem(array, jsval_undefined());
+
+    hres = array_make_sparse(jsdisp);
+    return FAILED(hres) ? hres : S_FALSE;
+}
+
+/* Returns S_FALSE if the array had to be converted to a sparse one. */
+HRESULT array_delete_elem(jsdisp_t *jsdisp, DWORD idx)
+{
+    ArrayInstance *array = dense_array(jsdisp);
+    HRESULT hres;
+
+    if(!array)
+        return S_FALSE;
+
+    if(idx >= array->elems_cnt)
+        return S_OK;
+
+    if(idx == array->elems_cnt-1) {
+        jsval_release(array->elems[--array->elems_cnt]);
+        return S_OK;
+    }
+
+    hres = array_make_sparse(jsdisp);
+    return FAILED(hres) ? hres : S_FALSE;
+}
+
+static void truncate_elems(ArrayInstance *array, DWORD cnt)
+{
+    while(array->elems_cnt > cnt)
+        jsval_release(array->elems[--array->elems_cnt]);
+}
+
 static HRESULT Array_length(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
@@ -137,10 +317,14 @@ static HRESULT Array_length(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags, unsi
         if(len!=(DWORD)len)
             return throw_range_error(ctx, JS_E_INVALID_LENGTH, NULL);
 
-        for(i=len; i<This->length; i++) {
-            hres = jsdisp_delete_idx(&This->dispex, i);
-            if(FAILED(hres))
-                return hres;
+        if(!This->sparse) {
+            truncate_elems(This, len);
+        }else {
+            for(i=len; i<This->length; i++) {
+                hres = jsdisp_delete_idx(&This->dispex, i);
+                if(FAILED(hres))
+                    return hres;
+            }
         }
 
         This->length = len;
@@ -490,6 +674,7 @@ static HRESULT Array_reverse(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsi
 static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *jsthis;
     DWORD length = 0, i;
     jsval_t v, ret;
@@ -513,6 +698,20 @@ static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsign
         return S_OK;
     }
 
+    array = dense_array(jsthis);
+    if(array && array->elems_cnt == length) {
+        ret = array->elems[0];
+        memmove(array->elems, array->elems+1, (length-1)*sizeof(*array->elems));
+        array->elems_cnt--;
+        array->length--;
+
+        if(r)
+            *r = ret;
+        else
+            jsval_release(ret);
+        return S_OK;
+    }
+
     hres = jsdisp_get_idx(jsthis, 0, &ret);
     if(hres == DISP_E_UNKNOWNNAME) {
         ret = jsval_undefined();
@@ -523,8 +722,10 @@ static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsign
         hres = jsdisp_get_idx(jsthis, i, &v);
         if(hres == DISP_E_UNKNOWNNAME)
             hres = jsdisp_delete_idx(jsthis, i-1);
-        else if(SUCCEEDED(hres))
+        else if(SUCCEEDED(hres)) {
             hres = jsdisp_propput_idx(jsthis, i-1, v);
+            jsval_release(v);
+        }
     }
 
     if(SUCCEEDED(hres)) {
@@ -812,11 +1013,34 @@ static HRESULT Array_sort(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigne
 }
 
 /* ECMA-262 3rd Edition    15.4.4.12 */
+/* Replaces delete_cnt elements at start with add_cnt undefined elements. */
+static HRESULT splice_elems(ArrayInstance *array, DWORD start, DWORD delete_cnt, DWORD add_cnt)
+{
+    DWORD i, tail = array->elems_cnt-start-delete_cnt;
+    HRESULT hres;
+
+    if(add_cnt > delete_cnt) {
+        hres = reserve_elems(array, array->elems_cnt-delete_cnt+add_cnt);
+        if(FAILED(hres))
+            return hres;
+    }
+
+    for(i=start; i < start+delete_cnt; i++)
+        jsval_release(array->elems[i]);
+    memmove(array->elems+start+add_cnt, array->elems+start+delete_cnt, tail*sizeof(*array->elems));
+    for(i=start; i < start+add_cnt; i++)
+        array->elems[i] = jsval_undefined();
+
+    array->elems_cnt = array->elems_cnt-delete_cnt+add_cnt;
+    return S_OK;
+}
+
 static HRESULT Array_splice(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
     DWORD length, start=0, delete_cnt=0, i, add_args = 0;
     jsdisp_t *ret_array = NULL, *jsthis;
+    ArrayInstance *array;
     jsval_t val;
     double d;
     int n;
@@ -877,7 +1101,11 @@ static HRESULT Array_splice(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsig
             hres = jsdisp_propput_name(ret_array, lengthW, jsval_number(delete_cnt));
     }
 
-    if(add_args < delete_cnt) {
+    array = dense_array(jsthis);
+    if(SUCCEEDED(hres) && array && array->elems_cnt == length
+       && length-delete_cnt+add_args < ARRAY_DENSE_MAX_LENGTH) {
+        hres = splice_elems(array, start, delete_cnt, add_args);
+    }else if(add_args < delete_cnt) {
         for(i = start; SUCCEEDED(hres) && i < length-delete_cnt; i++) {
             hres = jsdisp_get_idx(jsthis, i+delete_cnt, &val);
             if(hres == DISP_E_UNKNOWNNAME) {
@@ -945,6 +1173,7 @@ static HRESULT Array_toLocaleString(script_ctx_t *ctx, vdisp_t *vthis, WORD flag
 static HRESULT Array_unshift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *jsthis;
     WCHAR buf[14], *buf_end, *str;
     DWORD i, length;
@@ -958,6 +1187,29 @@ static HRESULT Array_unshift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsi
     if(FAILED(hres))
         return hres;
 
+    array = dense_array(jsthis);
+    if(argc && array && array->elems_cnt == length && argc < ARRAY_DENSE_MAX_LENGTH-length) {
+        hres = reserve_elems(array, length+argc);
+        if(FAILED(hres))
+            return hres;
+
+        memmove(array->elems+argc, array->elems, length*sizeof(*array->elems));
+        for(i=0; i<argc; i++) {
+            if(SUCCEEDED(hres))
+                hres = jsval_copy(argv[i], array->elems+i);
+            if(FAILED(hres))
+                array->elems[i] = jsval_undefined();
+        }
+        array->elems_cnt += argc;
+        array->length = length += argc;
+        if(FAILED(hres))
+            return hres;
+
+        if(r)
+            *r = ctx->version < 2 ? jsval_undefined() : jsval_number(length);
+        return S_OK;
+    }
+
     if(argc) {
         buf_end = buf + sizeof(buf)/sizeof(WCHAR)-1;
         *buf_end-- = 0;
@@ -1021,7 +1273,11 @@ static HRESULT Array_value(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags, unsig
 
 static void Array_destructor(jsdisp_t *dispex)
 {
-    heap_free(dispex);
+    ArrayInstance *array = array_from_jsdisp(dispex);
+
+    truncate_elems(array, 0);
+    heap_free(array->elems);
+    heap_free(array);
 }
 
 static void Array_on_put(jsdisp_t *dispex, const WCHAR *name)
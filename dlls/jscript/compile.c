@@ -40,12 +40,20 @@ typedef struct _statement_ctx_t {
     struct _statement_ctx_t *next;
 } statement_ctx_t;
 
+typedef struct {
+    const WCHAR *name;
+    int slot;
+} local_ref_t;
+
 typedef struct {
     parser_ctx_t *parser;
     bytecode_t *code;
 
     BOOL from_eval;
 
+    local_ref_t *locals;
+    unsigned locals_cnt;
+
     unsigned code_off;
     unsigned code_size;
 
@@ -287,6 +295,19 @@ static HRESULT push_instr_bstr_uint(compiler_ctx_t *ctx, jsop_t op, const WCHAR
     return S_OK;
 }
 
+static HRESULT push_instr_uint_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, unsigned arg2)
+{
+    unsigned instr;
+
+    instr = push_instr(ctx, op);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = arg1;
+    instr_ptr(ctx, instr)->u.arg[1].uint = arg2;
+    return S_OK;
+}
+
 static HRESULT push_instr_uint_str(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, const WCHAR *arg2)
 {
     unsigned instr;
@@ -360,6 +381,12 @@ static HRESULT compile_unary_expression(compiler_ctx_t *ctx, unary_expression_t
     return push_instr(ctx, op) ? S_OK : E_OUTOFMEMORY;
 }
 
+/* Member access sites get their own property cache, index 0 means no cache. */
+static unsigned alloc_prop_cache(compiler_ctx_t *ctx)
+{
+    return ++ctx->code->prop_cache_cnt;
+}
+
 /* ECMA-262 3rd Edition    11.2.1 */
 static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_t *expr)
 {
@@ -369,7 +396,7 @@ static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_
     if(FAILED(hres))
         return hres;
 
-    return push_instr_bstr(ctx, OP_member, expr->identifier);
+    return push_instr_bstr_uint(ctx, OP_member, expr->identifier, alloc_prop_cache(ctx));
 }
 
 #define LABEL_FLAG 0x80000000
@@ -401,6 +428,24 @@ static void label_set_addr(compiler_ctx_t *ctx, unsigned label)
     ctx->labels[label & ~LABEL_FLAG] = ctx->code_off;
 }
 
+static int local_cmp(const void *a, const void *b)
+{
+    return strcmpW(((const local_ref_t*)a)->name, ((const local_ref_t*)b)->name);
+}
+
+/* Returns the call frame slot of a function local variable or -1 if it has to be looked up by name. */
+static int find_local(compiler_ctx_t *ctx, const WCHAR *name)
+{
+    local_ref_t key, *ref;
+
+    if(!ctx->locals_cnt)
+        return -1;
+
+    key.name = name;
+    ref = bsearch(&key, ctx->locals, ctx->locals_cnt, sizeof(*ctx->locals), local_cmp);
+    return ref ? ref->slot : -1;
+}
+
 static inline BOOL is_memberid_expr(expression_type_t type)
 {
     return type == EXPR_IDENT || type == EXPR_MEMBER || type == EXPR_ARRAY;
@@ -413,8 +458,12 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
     switch(expr->type) {
     case EXPR_IDENT: {
         identifier_expression_t *ident_expr = (identifier_expression_t*)expr;
+        int slot = find_local(ctx, ident_expr->identifier);
 
-        hres = push_instr_bstr_uint(ctx, OP_identid, ident_expr->identifier, flags);
+        if(slot != -1)
+            hres = push_instr_uint(ctx, OP_local_ref, slot);
+        else
+            hres = push_instr_bstr_uint(ctx, OP_identid, ident_expr->identifier, flags);
         break;
     }
     case EXPR_ARRAY: {
@@ -428,7 +477,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, 0);
         break;
     }
     case EXPR_MEMBER: {
@@ -443,7 +492,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, alloc_prop_cache(ctx));
         break;
     }
     DEFAULT_UNREACHABLE;
@@ -727,8 +776,18 @@ static HRESULT compile_typeof_expression(compiler_ctx_t *ctx, unary_expression_t
     HRESULT hres;
 
     if(is_memberid_expr(expr->expression->type)) {
-        if(expr->expression->type == EXPR_IDENT)
-            return push_instr_bstr(ctx, OP_typeofident, ((identifier_expression_t*)expr->expression)->identifier);
+        if(expr->expression->type == EXPR_IDENT) {
+            const WCHAR *identifier = ((identifier_expression_t*)expr->expression)->identifier;
+            int slot = find_local(ctx, identifier);
+
+            if(slot == -1)
+                return push_instr_bstr(ctx, OP_typeofident, identifier);
+
+            hres = push_instr_uint(ctx, OP_local, slot);
+            if(FAILED(hres))
+                return hres;
+            return push_instr(ctx, OP_typeof) ? S_OK : E_OUTOFMEMORY;
+        }
 
         op = OP_typeofid;
         hres = compile_memberid_expression(ctx, expr->expression, 0);
@@ -862,7 +921,11 @@ static HRESULT compile_function_expression(compiler_ctx_t *ctx, function_express
 
     /* FIXME: not exactly right */
     if(expr->identifier) {
+        int slot = find_local(ctx, expr->identifier);
+
         ctx->func->func_cnt++;
+        if(slot != -1)
+            return push_instr_uint(ctx, OP_local, slot);
         return push_instr_bstr(ctx, OP_ident, expr->identifier);
     }
 
@@ -959,9 +1022,16 @@ static HRESULT compile_expression(compiler_ctx_t *ctx, expression_t *expr, BOOL
     case EXPR_GREATEREQ:
         hres = compile_binary_expression(ctx, (binary_expression_t*)expr, OP_gteq);
         break;
-    case EXPR_IDENT:
-        hres = push_instr_bstr(ctx, OP_ident, ((identifier_expression_t*)expr)->identifier);
+    case EXPR_IDENT: {
+        const WCHAR *identifier = ((identifier_expression_t*)expr)->identifier;
+        int slot = find_local(ctx, identifier);
+
+        if(slot != -1)
+            hres = push_instr_uint(ctx, OP_local, slot);
+        else
+            hres = push_instr_bstr(ctx, OP_ident, identifier);
         break;
+    }
     case EXPR_IN:
         hres = compile_binary_expression(ctx, (binary_expression_t*)expr, OP_in);
         break;
@@ -1079,6 +1149,7 @@ static HRESULT compile_block_statement(compiler_ctx_t *ctx, statement_t *iter)
 static HRESULT compile_variable_list(compiler_ctx_t *ctx, variable_declaration_t *list)
 {
     variable_declaration_t *iter;
+    int slot;
     HRESULT hres;
 
     assert(list != NULL);
@@ -1101,7 +1172,11 @@ static HRESULT compile_variable_list(compiler_ctx_t *ctx, variable_declaration_t
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_bstr(ctx, OP_var_set, iter->identifier);
+        slot = find_local(ctx, iter->identifier);
+        if(slot != -1)
+            hres = push_instr_uint(ctx, OP_local_set, slot);
+        else
+            hres = push_instr_bstr(ctx, OP_var_set, iter->identifier);
         if(FAILED(hres))
             return hres;
     }
@@ -1299,7 +1374,12 @@ static HRESULT compile_forin_statement(compiler_ctx_t *ctx, forin_statement_t *s
         return hres;
 
     if(stat->variable) {
-        hres = push_instr_bstr_uint(ctx, OP_identid, stat->variable->identifier, fdexNameEnsure);
+        int slot = find_local(ctx, stat->variable->identifier);
+
+        if(slot != -1)
+            hres = push_instr_uint(ctx, OP_local_ref, slot);
+        else
+            hres = push_instr_bstr_uint(ctx, OP_identid, stat->variable->identifier, fdexNameEnsure);
         if(FAILED(hres))
             return hres;
     }else if(is_memberid_expr(stat->expr->type)) {
@@ -1799,6 +1879,11 @@ void release_bytecode(bytecode_t *code)
         SysFreeString(code->bstr_pool[i]);
     for(i=0; i < code->str_cnt; i++)
         jsstr_release(code->str_pool[i]);
+    if(code->prop_caches) {
+        for(i=0; i < code->prop_cache_cnt; i++)
+            release_shape(code->prop_caches[i].shape);
+        heap_free(code->prop_caches);
+    }
 
     heap_free(code->source);
     heap_pool_free(&code->heap);
@@ -1834,6 +1919,347 @@ static HRESULT init_code(compiler_ctx_t *compiler, const WCHAR *source)
     return S_OK;
 }
 
+typedef struct {
+    const WCHAR **names;
+    unsigned cnt;
+    unsigned size;
+} name_list_t;
+
+typedef struct {
+    name_list_t decls;
+    name_list_t pins;
+    BOOL uses_arguments;
+    BOOL disabled;
+} local_scan_t;
+
+static void scan_statement(local_scan_t*,statement_t*,BOOL);
+static void scan_expression(local_scan_t*,expression_t*,BOOL);
+
+static void name_list_add(local_scan_t *scan, name_list_t *list, const WCHAR *name)
+{
+    if(scan->disabled)
+        return;
+
+    if(list->cnt == list->size) {
+        const WCHAR **new_names;
+        unsigned new_size = list->size ? list->size*2 : 16;
+
+        new_names = heap_realloc(list->names, new_size*sizeof(*new_names));
+        if(!new_names) {
+            /* Falling back to named variables is always safe. */
+            scan->disabled = TRUE;
+            return;
+        }
+
+        list->names = new_names;
+        list->size = new_size;
+    }
+
+    list->names[list->cnt++] = name;
+}
+
+static int name_cmp(const void *a, const void *b)
+{
+    return strcmpW(*(const WCHAR* const*)a, *(const WCHAR* const*)b);
+}
+
+static void scan_variable_list(local_scan_t *scan, variable_declaration_t *list, BOOL nested)
+{
+    variable_declaration_t *iter;
+
+    for(iter = list; iter; iter = iter->next) {
+        name_list_add(scan, nested ? &scan->pins : &scan->decls, iter->identifier);
+        if(iter->expr)
+            scan_expression(scan, iter->expr, nested);
+    }
+}
+
+static void scan_function_expression(local_scan_t *scan, function_expression_t *expr, BOOL nested)
+{
+    parameter_t *param_iter;
+    statement_t *stat_iter;
+
+    if(expr->identifier)
+        name_list_add(scan, nested ? &scan->pins : &scan->decls, expr->identifier);
+
+    /* Nested functions may access anything they reference through the scope chain. */
+    for(param_iter = expr->parameter_list; param_iter; param_iter = param_iter->next)
+        name_list_add(scan, &scan->pins, param_iter->identifier);
+    for(stat_iter = expr->source_elements->statement; stat_iter; stat_iter = stat_iter->next)
+        scan_statement(scan, stat_iter, TRUE);
+}
+
+static void scan_expression(local_scan_t *scan, expression_t *expr, BOOL nested)
+{
+    switch(expr->type) {
+    case EXPR_IDENT: {
+        const WCHAR *identifier = ((identifier_expression_t*)expr)->identifier;
+        static const WCHAR argumentsW[] = {'a','r','g','u','m','e','n','t','s',0};
+        static const WCHAR evalW[] = {'e','v','a','l',0};
+
+        if(!strcmpW(identifier, evalW))
+            scan->disabled = TRUE;
+        else if(!nested && !strcmpW(identifier, argumentsW))
+            scan->uses_arguments = TRUE;
+        if(nested)
+            name_list_add(scan, &scan->pins, identifier);
+        break;
+    }
+    case EXPR_FUNC:
+        scan_function_expression(scan, (function_expression_t*)expr, nested);
+        break;
+    case EXPR_MEMBER:
+        scan_expression(scan, ((member_expression_t*)expr)->expression, nested);
+        break;
+    case EXPR_NEW:
+    case EXPR_CALL: {
+        call_expression_t *call_expr = (call_expression_t*)expr;
+        argument_t *arg;
+
+        scan_expression(scan, call_expr->expression, nested);
+        for(arg = call_expr->argument_list; arg; arg = arg->next)
+            scan_expression(scan, arg->expr, nested);
+        break;
+    }
+    case EXPR_COND: {
+        conditional_expression_t *cond_expr = (conditional_expression_t*)expr;
+
+        scan_expression(scan, cond_expr->expression, nested);
+        scan_expression(scan, cond_expr->true_expression, nested);
+        scan_expression(scan, cond_expr->false_expression, nested);
+        break;
+    }
+    case EXPR_ARRAYLIT: {
+        array_element_t *iter;
+
+        for(iter = ((array_literal_expression_t*)expr)->element_list; iter; iter = iter->next)
+            scan_expression(scan, iter->expr, nested);
+        break;
+    }
+    case EXPR_PROPVAL: {
+        prop_val_t *iter;
+
+        for(iter = ((property_value_expression_t*)expr)->property_list; iter; iter = iter->next)
+            scan_expression(scan, iter->value, nested);
+        break;
+    }
+    case EXPR_DELETE:
+    case EXPR_VOID:
+    case EXPR_TYPEOF:
+    case EXPR_MINUS:
+    case EXPR_PLUS:
+    case EXPR_POSTINC:
+    case EXPR_POSTDEC:
+    case EXPR_PREINC:
+    case EXPR_PREDEC:
+    case EXPR_BITNEG:
+    case EXPR_LOGNEG: {
+        unary_expression_t *unary_expr = (unary_expression_t*)expr;
+
+        /* Deleting a variable has to find its property. */
+        if(expr->type == EXPR_DELETE && unary_expr->expression->type == EXPR_IDENT)
+            name_list_add(scan, &scan->pins, ((identifier_expression_t*)unary_expr->expression)->identifier);
+        scan_expression(scan, unary_expr->expression, nested);
+        break;
+    }
+    case EXPR_THIS:
+    case EXPR_LITERAL:
+        break;
+    default: {
+        binary_expression_t *binary_expr = (binary_expression_t*)expr;
+
+        /* Parametrized assignment passes its target to the object it's called on. */
+        if(expr->type == EXPR_ASSIGN && binary_expr->expression1->type == EXPR_CALL) {
+            call_expression_t *call_expr = (call_expression_t*)binary_expr->expression1;
+
+            if(call_expr->expression->type == EXPR_IDENT)
+                name_list_add(scan, &scan->pins, ((identifier_expression_t*)call_expr->expression)->identifier);
+        }
+
+        scan_expression(scan, binary_expr->expression1, nested);
+        scan_expression(scan, binary_expr->expression2, nested);
+    }
+    }
+}
+
+static void scan_statement(local_scan_t *scan, statement_t *stat, BOOL nested)
+{
+    statement_t *iter;
+
+    switch(stat->type) {
+    case STAT_BLOCK:
+        for(iter = ((block_statement_t*)stat)->stat_list; iter; iter = iter->next)
+            scan_statement(scan, iter, nested);
+        break;
+    case STAT_BREAK:
+    case STAT_CONTINUE:
+    case STAT_EMPTY:
+        break;
+    case STAT_EXPR:
+    case STAT_RETURN:
+    case STAT_THROW: {
+        expression_statement_t *expr_stat = (expression_statement_t*)stat;
+
+        if(expr_stat->expr)
+            scan_expression(scan, expr_stat->expr, nested);
+        break;
+    }
+    case STAT_FOR: {
+        for_statement_t *for_stat = (for_statement_t*)stat;
+
+        if(for_stat->variable_list)
+            scan_variable_list(scan, for_stat->variable_list, nested);
+        if(for_stat->begin_expr)
+            scan_expression(scan, for_stat->begin_expr, nested);
+        if(for_stat->expr)
+            scan_expression(scan, for_stat->expr, nested);
+        if(for_stat->end_expr)
+            scan_expression(scan, for_stat->end_expr, nested);
+        scan_statement(scan, for_stat->statement, nested);
+        break;
+    }
+    case STAT_FORIN: {
+        forin_statement_t *forin_stat = (forin_statement_t*)stat;
+
+        if(forin_stat->variable)
+            scan_variable_list(scan, forin_stat->variable, nested);
+        else
+            scan_expression(scan, forin_stat->expr, nested);
+        scan_expression(scan, forin_stat->in_expr, nested);
+        scan_statement(scan, forin_stat->statement, nested);
+        break;
+    }
+    case STAT_IF: {
+        if_statement_t *if_stat = (if_statement_t*)stat;
+
+        scan_expression(scan, if_stat->expr, nested);
+        scan_statement(scan, if_stat->if_stat, nested);
+        if(if_stat->else_stat)
+            scan_statement(scan, if_stat->else_stat, nested);
+        break;
+    }
+    case STAT_LABEL:
+        scan_statement(scan, ((labelled_statement_t*)stat)->statement, nested);
+        break;
+    case STAT_SWITCH: {
+        switch_statement_t *switch_stat = (switch_statement_t*)stat;
+        case_clausule_t *case_iter;
+
+        scan_expression(scan, switch_stat->expr, nested);
+        for(case_iter = switch_stat->case_list; case_iter; case_iter = case_iter->next) {
+            if(case_iter->expr)
+                scan_expression(scan, case_iter->expr, nested);
+            for(iter = case_iter->stat; iter && (!case_iter->next || case_iter->next->stat != iter);
+                iter = iter->next)
+                scan_statement(scan, iter, nested);
+        }
+        break;
+    }
+    case STAT_TRY: {
+        try_statement_t *try_stat = (try_statement_t*)stat;
+
+        scan_statement(scan, try_stat->try_statement, nested);
+        if(try_stat->catch_block) {
+            /* The exception is stored in its own scope object. */
+            name_list_add(scan, &scan->pins, try_stat->catch_block->identifier);
+            scan_statement(scan, try_stat->catch_block->statement, nested);
+        }
+        if(try_stat->finally_statement)
+            scan_statement(scan, try_stat->finally_statement, nested);
+        break;
+    }
+    case STAT_VAR:
+        scan_variable_list(scan, ((var_statement_t*)stat)->variable_list, nested);
+        break;
+    case STAT_WHILE: {
+        while_statement_t *while_stat = (while_statement_t*)stat;
+
+        scan_expression(scan, while_stat->expr, nested);
+        scan_statement(scan, while_stat->statement, nested);
+        break;
+    }
+    case STAT_WITH: {
+        with_statement_t *with_stat = (with_statement_t*)stat;
+
+        /* Any identifier inside with statement may refer to a property of its object. */
+        if(!nested)
+            scan->disabled = TRUE;
+        scan_expression(scan, with_stat->expr, nested);
+        scan_statement(scan, with_stat->statement, nested);
+        break;
+    }
+    DEFAULT_UNREACHABLE;
+    }
+}
+
+/* Finds function variables that are never accessed by name and assigns them call frame slots. */
+static HRESULT resolve_locals(compiler_ctx_t *ctx, function_expression_t *func_expr, function_code_t *func)
+{
+    static const WCHAR argumentsW[] = {'a','r','g','u','m','e','n','t','s',0};
+    local_scan_t scan = {{NULL}};
+    parameter_t *param_iter;
+    statement_t *stat_iter;
+    unsigned i, cnt = 0;
+    HRESULT hres = S_OK;
+
+    for(param_iter = func_expr->parameter_list; param_iter; param_iter = param_iter->next)
+        name_list_add(&scan, &scan.decls, param_iter->identifier);
+    for(stat_iter = func_expr->source_elements->statement; stat_iter && !scan.disabled; stat_iter = stat_iter->next)
+        scan_statement(&scan, stat_iter, FALSE);
+
+    /* The arguments object exposes parameters by name. */
+    name_list_add(&scan, &scan.pins, argumentsW);
+    if(scan.uses_arguments) {
+        for(param_iter = func_expr->parameter_list; param_iter; param_iter = param_iter->next)
+            name_list_add(&scan, &scan.pins, param_iter->identifier);
+    }
+
+    if(!scan.disabled && scan.decls.cnt) {
+        qsort(scan.decls.names, scan.decls.cnt, sizeof(*scan.decls.names), name_cmp);
+        qsort(scan.pins.names, scan.pins.cnt, sizeof(*scan.pins.names), name_cmp);
+
+        ctx->locals = parser_alloc(ctx->parser, scan.decls.cnt * sizeof(*ctx->locals));
+        if(!ctx->locals) {
+            hres = E_OUTOFMEMORY;
+            goto done;
+        }
+
+        for(i = 0; i < scan.decls.cnt; i++) {
+            if(cnt && !strcmpW(ctx->locals[cnt-1].name, scan.decls.names[i]))
+                continue;
+            if(bsearch(scan.decls.names+i, scan.pins.names, scan.pins.cnt, sizeof(*scan.pins.names), name_cmp))
+                continue;
+            ctx->locals[cnt].name = scan.decls.names[i];
+            ctx->locals[cnt].slot = cnt;
+            cnt++;
+        }
+    }
+
+    if(cnt) {
+        func->locals = compiler_alloc(ctx->code, cnt * sizeof(*func->locals));
+        if(!func->locals) {
+            hres = E_OUTOFMEMORY;
+            goto done;
+        }
+
+        for(i = 0; i < cnt; i++) {
+            func->locals[i] = compiler_alloc_bstr(ctx, ctx->locals[i].name);
+            if(!func->locals[i]) {
+                hres = E_OUTOFMEMORY;
+                goto done;
+            }
+        }
+
+        func->local_cnt = ctx->locals_cnt = cnt;
+        TRACE("%u variables stored in call frame\n", cnt);
+    }
+
+done:
+    heap_free(scan.decls.names);
+    heap_free(scan.pins.names);
+    return hres;
+}
+
 static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source, function_expression_t *func_expr,
         BOOL from_eval, function_code_t *func)
 {
@@ -1847,6 +2273,14 @@ static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source,
     ctx->var_head = ctx->var_tail = NULL;
     ctx->func_head = ctx->func_tail = NULL;
     ctx->from_eval = from_eval;
+    ctx->locals = NULL;
+    ctx->locals_cnt = 0;
+
+    if(func_expr && !from_eval) {
+        hres = resolve_locals(ctx, func_expr, func);
+        if(FAILED(hres))
+            return hres;
+    }
 
     off = ctx->code_off;
     ctx->func = func;
@@ -1888,25 +2322,42 @@ static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source,
             if(!func->params[i])
                 return E_OUTOFMEMORY;
         }
+
+        if(func->local_cnt) {
+            func->param_slots = compiler_alloc(ctx->code, func->param_cnt * sizeof(*func->param_slots));
+            if(!func->param_slots)
+                return E_OUTOFMEMORY;
+
+            for(param_iter = func_expr->parameter_list, i=0; param_iter; param_iter = param_iter->next, i++)
+                func->param_slots[i] = find_local(ctx, param_iter->identifier);
+        }
     }
 
     func->variables = compiler_alloc(ctx->code, func->var_cnt * sizeof(*func->variables));
     if(!func->variables)
         return E_OUTOFMEMORY;
 
-    for(var_iter = ctx->var_head, i=0; var_iter; var_iter = var_iter->global_next, i++) {
+    for(var_iter = ctx->var_head, i=0; var_iter; var_iter = var_iter->global_next) {
+        if(find_local(ctx, var_iter->identifier) != -1)
+            continue;
+
         func->variables[i] = compiler_alloc_bstr(ctx, var_iter->identifier);
         if(!func->variables[i])
             return E_OUTOFMEMORY;
+        i++;
     }
 
-    assert(i == func->var_cnt);
+    /* Variables stored in call frame slots don't need their properties. */
+    func->var_cnt = i;
 
     func->funcs = compiler_alloc(ctx->code, func->func_cnt * sizeof(*func->funcs));
     if(!func->funcs)
         return E_OUTOFMEMORY;
     memset(func->funcs, 0, func->func_cnt * sizeof(*func->funcs));
 
+    for(iter = ctx->func_head, i=0; iter; iter = iter->next, i++)
+        func->funcs[i].local_slot = iter->identifier ? find_local(ctx, iter->identifier) : -1;
+
     for(iter = ctx->func_head, i=0; iter; iter = iter->next, i++) {
         hres = compile_function(ctx, iter->source_elements, iter, FALSE, func->funcs+i);
         if(FAILED(hres))
@@ -2020,6 +2471,11 @@ HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, const WCHAR *args,
 
     hres = compile_function(&compiler, compiler.parser->source, NULL, from_eval, &compiler.code->global_code);
     parser_release(compiler.parser);
+    if(SUCCEEDED(hres) && compiler.code->prop_cache_cnt) {
+        compiler.code->prop_caches = heap_alloc_zero(compiler.code->prop_cache_cnt * sizeof(*compiler.code->prop_caches));
+        if(!compiler.code->prop_caches)
+            hres = E_OUTOFMEMORY;
+    }
     if(FAILED(hres)) {
         release_bytecode(compiler.code);
         return hres;
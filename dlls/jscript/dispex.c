@@ -60,6 +60,97 @@ struct _dispex_prop_t {
     int bucket_next;
 };
 
+/* Objects with too many properties or uncommon layouts are not worth tracking. */
+#define SHAPE_MAX_PROPS     64
+#define SHAPE_MAX_CHILDREN  32
+
+struct _dispex_shape_t {
+    LONG ref;
+    WCHAR *name;
+    unsigned hash;
+    DWORD prop_cnt;
+
+    dispex_shape_t *parent;
+    dispex_shape_t *children;
+    dispex_shape_t *next;
+    unsigned child_cnt;
+};
+
+static dispex_shape_t *get_root_shape(script_ctx_t *ctx)
+{
+    if(!ctx->root_shape) {
+        ctx->root_shape = heap_alloc_zero(sizeof(*ctx->root_shape));
+        if(!ctx->root_shape)
+            return NULL;
+
+        ctx->root_shape->ref = 1;
+        ctx->root_shape->prop_cnt = 1;
+    }
+
+    ctx->root_shape->ref++;
+    return ctx->root_shape;
+}
+
+void release_shape(dispex_shape_t *shape)
+{
+    dispex_shape_t *parent, **iter;
+
+    while(shape && !--shape->ref) {
+        parent = shape->parent;
+        if(parent) {
+            for(iter = &parent->children; *iter != shape; iter = &(*iter)->next);
+            *iter = shape->next;
+            parent->child_cnt--;
+        }
+
+        heap_free(shape->name);
+        heap_free(shape);
+        shape = parent;
+    }
+}
+
+/* Returns the shape of an object after adding a property, consumes the reference to the old one. */
+static dispex_shape_t *shape_add_prop(dispex_shape_t *shape, const WCHAR *name, unsigned hash)
+{
+    dispex_shape_t *child;
+
+    for(child = shape->children; child; child = child->next) {
+        if(child->hash == hash && !strcmpW(child->name, name)) {
+            child->ref++;
+            release_shape(shape);
+            return child;
+        }
+    }
+
+    if(shape->prop_cnt >= SHAPE_MAX_PROPS || shape->child_cnt >= SHAPE_MAX_CHILDREN
+       || !(child = heap_alloc(sizeof(*child)))) {
+        release_shape(shape);
+        return NULL;
+    }
+
+    child->name = heap_strdupW(name);
+    if(!child->name) {
+        heap_free(child);
+        release_shape(shape);
+        return NULL;
+    }
+
+    child->ref = 1;
+    child->hash = hash;
+    child->prop_cnt = shape->prop_cnt + 1;
+    child->children = NULL;
+    child->child_cnt = 0;
+
+    /* The child takes over our reference to its parent */
+    child->parent = shape;
+    child->next = shape->children;
+    shape->children = child;
+    shape->child_cnt++;
+    return child;
+}
+
+static dispex_prop_t *get_elem_prop(jsdisp_t*,DISPID);
+
 static inline DISPID prop_to_id(jsdisp_t *This, dispex_prop_t *prop)
 {
     return prop - This->props;
@@ -67,12 +158,56 @@ static inline DISPID prop_to_id(jsdisp_t *This, dispex_prop_t *prop)
 
 static inline dispex_prop_t *get_prop(jsdisp_t *This, DISPID id)
 {
+    if(id >= DISPID_ARRAY_ELEM_FIRST)
+        return get_elem_prop(This, id);
+
     if(id < 0 || id >= This->prop_cnt || This->props[id].type == PROP_DELETED)
         return NULL;
 
     return This->props+id;
 }
 
+static inline DISPID elem_to_id(DWORD idx)
+{
+    return DISPID_ARRAY_ELEM_FIRST + idx;
+}
+
+static inline jsval_t *get_dense_elem(jsdisp_t *This, DISPID id)
+{
+    if(id < DISPID_ARRAY_ELEM_FIRST || !is_dense_array(This))
+        return NULL;
+
+    return array_get_elem(This, id - DISPID_ARRAY_ELEM_FIRST);
+}
+
+static BOOL is_dense_idx(jsdisp_t *This, const WCHAR *name, DWORD *ret)
+{
+    const WCHAR *ptr = name;
+    DWORD idx = 0;
+
+    if(!isdigitW(*ptr) || (*ptr == '0' && ptr[1]) || !is_dense_array(This))
+        return FALSE;
+
+    for(; isdigitW(*ptr); ptr++) {
+        idx = idx*10 + (*ptr-'0');
+        if(idx >= ARRAY_DENSE_MAX_LENGTH)
+            return FALSE;
+    }
+    if(*ptr)
+        return FALSE;
+
+    *ret = idx;
+    return TRUE;
+}
+
+static WCHAR *idx_to_name(DWORD idx, WCHAR *buf)
+{
+    static const WCHAR formatW[] = {'%','u',0};
+
+    sprintfW(buf, formatW, idx);
+    return buf;
+}
+
 static DWORD get_flags(jsdisp_t *This, dispex_prop_t *prop)
 {
     if(prop->type == PROP_PROTREF) {
@@ -171,6 +306,9 @@ static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_
     bucket = get_props_idx(This, prop->hash);
     prop->bucket_next = This->props[bucket].bucket_head;
     This->props[bucket].bucket_head = This->prop_cnt++;
+
+    if(This->shape)
+        This->shape = shape_add_prop(This->shape, name, prop->hash);
     return prop;
 }
 
@@ -242,6 +380,24 @@ static HRESULT find_prop_name(jsdisp_t *This, unsigned hash, const WCHAR *name,
     return S_OK;
 }
 
+/* Element DISPIDs stay valid after the array is converted to a sparse one. */
+static dispex_prop_t *get_elem_prop(jsdisp_t *This, DISPID id)
+{
+    dispex_prop_t *prop;
+    WCHAR name[12];
+    HRESULT hres;
+
+    if(!is_class(This, JSCLASS_ARRAY) || is_dense_array(This))
+        return NULL;
+
+    idx_to_name(id - DISPID_ARRAY_ELEM_FIRST, name);
+    hres = find_prop_name(This, string_hash(name), name, &prop);
+    if(FAILED(hres) || !prop || prop->type == PROP_DELETED)
+        return NULL;
+
+    return prop;
+}
+
 static HRESULT find_prop_name_prot(jsdisp_t *This, unsigned hash, const WCHAR *name, dispex_prop_t **ret)
 {
     dispex_prop_t *prop, *del=NULL;
@@ -261,7 +417,7 @@ static HRESULT find_prop_name_prot(jsdisp_t *This, unsigned hash, const WCHAR *n
         hres = find_prop_name_prot(This->prototype, hash, name, &prop);
         if(FAILED(hres))
             return hres;
-        if(prop) {
+        if(prop && prop->type != PROP_DELETED) {
             if(del) {
                 del->type = PROP_PROTREF;
                 del->flags = 0;
@@ -413,6 +569,17 @@ static HRESULT invoke_prop_func(jsdisp_t *This, IDispatch *jsthis, dispex_prop_t
     return E_FAIL;
 }
 
+static HRESULT invoke_elem_func(jsdisp_t *This, IDispatch *jsthis, jsval_t elem, WORD flags,
+        unsigned argc, jsval_t *argv, jsval_t *r)
+{
+    if(!is_object_instance(elem)) {
+        FIXME("invoke %s\n", debugstr_jsval(elem));
+        return E_FAIL;
+    }
+
+    return disp_call_value(This->ctx, get_object(elem), jsthis, flags, argc, argv, r);
+}
+
 static HRESULT prop_get(jsdisp_t *This, dispex_prop_t *prop, DISPPARAMS *dp,
         jsval_t *r, IServiceProvider *caller)
 {
@@ -521,8 +688,15 @@ static HRESULT fill_protrefs(jsdisp_t *This)
     fill_protrefs(This->prototype);
 
     for(iter = This->prototype->props; iter < This->prototype->props+This->prototype->prop_cnt; iter++) {
+        DWORD idx;
+
         if(!iter->name)
             continue;
+        if(is_dense_idx(This, iter->name, &idx)) {
+            hres = array_make_sparse(This);
+            if(FAILED(hres))
+                return hres;
+        }
         hres = find_prop_name(This, iter->hash, iter->name, &prop);
         if(FAILED(hres))
             return hres;
@@ -661,6 +835,7 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
 {
     jsdisp_t *This = impl_from_IDispatchEx(iface);
     dispex_prop_t *prop;
+    jsval_t *elem;
     HRESULT hres;
 
     TRACE("(%p)->(%x %x %x %p %p %p %p)\n", This, id, lcid, wFlags, pdp, pvarRes, pei, pspCaller);
@@ -668,10 +843,15 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
     if(pvarRes)
         V_VT(pvarRes) = VT_EMPTY;
 
-    prop = get_prop(This, id);
-    if(!prop || prop->type == PROP_DELETED) {
-        TRACE("invalid id\n");
-        return DISP_E_MEMBERNOTFOUND;
+    elem = get_dense_elem(This, id);
+    if(elem) {
+        prop = NULL;
+    }else {
+        prop = get_prop(This, id);
+        if(!prop || prop->type == PROP_DELETED) {
+            TRACE("invalid id\n");
+            return DISP_E_MEMBERNOTFOUND;
+        }
     }
 
     clear_ei(This->ctx);
@@ -689,7 +869,10 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
         if(FAILED(hres))
             return hres;
 
-        hres = invoke_prop_func(This, get_this(pdp), prop, wFlags, argc, argv, pvarRes ? &r : NULL, pspCaller);
+        if(elem)
+            hres = invoke_elem_func(This, get_this(pdp), *elem, wFlags, argc, argv, pvarRes ? &r : NULL);
+        else
+            hres = invoke_prop_func(This, get_this(pdp), prop, wFlags, argc, argv, pvarRes ? &r : NULL, pspCaller);
         if(argv != buf)
             heap_free(argv);
         if(SUCCEEDED(hres) && pvarRes) {
@@ -701,7 +884,10 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
     case DISPATCH_PROPERTYGET: {
         jsval_t r;
 
-        hres = prop_get(This, prop, pdp, &r, pspCaller);
+        if(elem)
+            hres = jsval_copy(*elem, &r);
+        else
+            hres = prop_get(This, prop, pdp, &r, pspCaller);
         if(SUCCEEDED(hres)) {
             hres = jsval_to_variant(r, pvarRes);
             jsval_release(r);
@@ -726,7 +912,10 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
         if(FAILED(hres))
             return hres;
 
-        hres = prop_put(This, prop, val, pspCaller);
+        if(elem)
+            hres = array_put_elem(This, id - DISPID_ARRAY_ELEM_FIRST, val);
+        else
+            hres = prop_put(This, prop, val, pspCaller);
         jsval_release(val);
         break;
     }
@@ -760,6 +949,7 @@ static HRESULT WINAPI DispatchEx_DeleteMemberByName(IDispatchEx *iface, BSTR bst
 {
     jsdisp_t *This = impl_from_IDispatchEx(iface);
     dispex_prop_t *prop;
+    DWORD idx;
     BOOL b;
     HRESULT hres;
 
@@ -768,6 +958,12 @@ static HRESULT WINAPI DispatchEx_DeleteMemberByName(IDispatchEx *iface, BSTR bst
     if(grfdex & ~(fdexNameCaseSensitive|fdexNameEnsure|fdexNameImplicit|FDEX_VERSION_MASK))
         FIXME("Unsupported grfdex %x\n", grfdex);
 
+    if(is_dense_idx(This, bstrName, &idx)) {
+        hres = array_delete_elem(This, idx);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     hres = find_prop_name(This, string_hash(bstrName), bstrName, &prop);
     if(FAILED(hres))
         return hres;
@@ -787,6 +983,12 @@ static HRESULT WINAPI DispatchEx_DeleteMemberByDispID(IDispatchEx *iface, DISPID
 
     TRACE("(%p)->(%x)\n", This, id);
 
+    if(get_dense_elem(This, id)) {
+        HRESULT hres = array_delete_elem(This, id - DISPID_ARRAY_ELEM_FIRST);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     prop = get_prop(This, id);
     if(!prop) {
         WARN("invalid id\n");
@@ -810,6 +1012,13 @@ static HRESULT WINAPI DispatchEx_GetMemberName(IDispatchEx *iface, DISPID id, BS
 
     TRACE("(%p)->(%x %p)\n", This, id, pbstrName);
 
+    if(get_dense_elem(This, id)) {
+        WCHAR name[12];
+
+        *pbstrName = SysAllocString(idx_to_name(id - DISPID_ARRAY_ELEM_FIRST, name));
+        return *pbstrName ? S_OK : E_OUTOFMEMORY;
+    }
+
     prop = get_prop(This, id);
     if(!prop || !prop->name || prop->type == PROP_DELETED)
         return DISP_E_MEMBERNOTFOUND;
@@ -835,6 +1044,33 @@ static HRESULT WINAPI DispatchEx_GetNextDispID(IDispatchEx *iface, DWORD grfdex,
             return hres;
     }
 
+    /* The array was made sparse during enumeration, continue after the moved element. */
+    if(id >= DISPID_ARRAY_ELEM_FIRST && !is_dense_array(This)) {
+        WCHAR name[12];
+
+        idx_to_name(id - DISPID_ARRAY_ELEM_FIRST, name);
+        hres = find_prop_name(This, string_hash(name), name, &iter);
+        if(FAILED(hres))
+            return hres;
+        if(!iter) {
+            *pid = DISPID_STARTENUM;
+            return S_FALSE;
+        }
+        id = prop_to_id(This, iter);
+    }
+
+    /* Elements of dense arrays are enumerated first, in index order. */
+    if(id == DISPID_STARTENUM || id >= DISPID_ARRAY_ELEM_FIRST) {
+        DWORD idx = id == DISPID_STARTENUM ? 0 : id - DISPID_ARRAY_ELEM_FIRST + 1;
+
+        if(array_get_elem(This, idx)) {
+            *pid = elem_to_id(idx);
+            return S_OK;
+        }
+
+        id = 0;
+    }
+
     if(id+1>=0 && id+1<This->prop_cnt) {
         iter = &This->props[id+1];
     }else {
@@ -902,11 +1138,21 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     if(!dispex->props)
         return E_OUTOFMEMORY;
 
+    /* Inherited elements are looked up by name, so keep them in the property table. */
+    if(prototype && is_dense_array(prototype)) {
+        HRESULT hres = array_make_sparse(prototype);
+        if(FAILED(hres)) {
+            heap_free(dispex->props);
+            return hres;
+        }
+    }
+
     dispex->prototype = prototype;
     if(prototype)
         jsdisp_addref(prototype);
 
     dispex->prop_cnt = 1;
+    dispex->shape = get_root_shape(ctx);
     if(builtin_info->value_prop.invoke) {
         dispex->props[0].type = PROP_BUILTIN;
         dispex->props[0].u.p = &builtin_info->value_prop;
@@ -959,6 +1205,7 @@ void jsdisp_free(jsdisp_t *obj)
         heap_free(prop->name);
     }
     heap_free(obj->props);
+    release_shape(obj->shape);
     script_release(obj->ctx);
     if(obj->prototype)
         jsdisp_release(obj->prototype);
@@ -1032,11 +1279,52 @@ jsdisp_t *iface_to_jsdisp(IUnknown *iface)
     return ret;
 }
 
+static HRESULT get_dense_idx_id(jsdisp_t *jsdisp, DWORD idx, const WCHAR *name, DWORD flags, DISPID *id)
+{
+    dispex_prop_t *prop;
+    HRESULT hres;
+
+    if(array_get_elem(jsdisp, idx)) {
+        *id = elem_to_id(idx);
+        return S_OK;
+    }
+
+    if(flags & fdexNameEnsure) {
+        hres = array_ensure_elem(jsdisp, idx);
+        if(hres == S_OK)
+            *id = elem_to_id(idx);
+        return hres;
+    }
+
+    if(jsdisp->prototype) {
+        hres = find_prop_name_prot(jsdisp->prototype, string_hash(name), name, &prop);
+        if(FAILED(hres))
+            return hres;
+    }else {
+        prop = NULL;
+    }
+    if(!prop || prop->type == PROP_DELETED) {
+        TRACE("not found %s\n", debugstr_w(name));
+        return DISP_E_UNKNOWNNAME;
+    }
+
+    /* The element is inherited, it needs a protref in the property table. */
+    hres = array_make_sparse(jsdisp);
+    return FAILED(hres) ? hres : S_FALSE;
+}
+
 HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *id)
 {
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(jsdisp, name, &idx)) {
+        hres = get_dense_idx_id(jsdisp, idx, name, flags, id);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     if(flags & fdexNameEnsure)
         hres = ensure_prop_name(jsdisp, name, TRUE, PROPF_ENUM, &prop);
     else
@@ -1053,6 +1341,50 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/* Same as jsdisp_get_id, but skips the lookup if the object has the same shape as the last one
+ * resolved at the caller's site. */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, prop_cache_t *cache, DISPID *id)
+{
+    HRESULT hres;
+
+    if(cache->shape && cache->shape == jsdisp->shape && jsdisp->props[cache->id].type != PROP_DELETED) {
+        jsdisp->ctx->prop_cache_hits++;
+        *id = cache->id;
+        return S_OK;
+    }
+
+    jsdisp->ctx->prop_cache_misses++;
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(hres == S_OK && jsdisp->shape && *id < jsdisp->prop_cnt && *id > 0) {
+        jsdisp->shape->ref++;
+        release_shape(cache->shape);
+        cache->shape = jsdisp->shape;
+        cache->id = *id;
+    }
+
+    return hres;
+}
+
+HRESULT jsdisp_get_idx_id(jsdisp_t *jsdisp, DWORD idx, DWORD flags, DISPID *id)
+{
+    WCHAR name[12];
+
+    if(is_dense_array(jsdisp) && idx < ARRAY_DENSE_MAX_LENGTH) {
+        if(array_get_elem(jsdisp, idx)) {
+            *id = elem_to_id(idx);
+            return S_OK;
+        }
+
+        if((flags & fdexNameEnsure) && array_ensure_elem(jsdisp, idx) == S_OK) {
+            *id = elem_to_id(idx);
+            return S_OK;
+        }
+    }
+
+    return jsdisp_get_id(jsdisp, idx_to_name(idx, name), flags, id);
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -1072,6 +1404,11 @@ HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsig
 HRESULT jsdisp_call(jsdisp_t *disp, DISPID id, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     dispex_prop_t *prop;
+    jsval_t *elem;
+
+    elem = get_dense_elem(disp, id);
+    if(elem)
+        return invoke_elem_func(disp, to_disp(disp), *elem, flags, argc, argv, r);
 
     prop = get_prop(disp, id);
     if(!prop)
@@ -1287,8 +1624,16 @@ HRESULT disp_call_value(script_ctx_t *ctx, IDispatch *disp, IDispatch *jsthis, W
 HRESULT jsdisp_propput(jsdisp_t *obj, const WCHAR *name, DWORD flags, jsval_t val)
 {
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(obj, name, &idx)) {
+        /* Dense elements are always plain enumerable values. */
+        hres = flags == PROPF_ENUM ? array_put_elem(obj, idx, val) : array_make_sparse(obj);
+        if(FAILED(hres) || (flags == PROPF_ENUM && hres == S_OK))
+            return hres;
+    }
+
     hres = ensure_prop_name(obj, name, FALSE, flags, &prop);
     if(FAILED(hres))
         return hres;
@@ -1304,8 +1649,15 @@ HRESULT jsdisp_propput_name(jsdisp_t *obj, const WCHAR *name, jsval_t val)
 HRESULT jsdisp_propput_const(jsdisp_t *obj, const WCHAR *name, jsval_t val)
 {
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(obj, name, &idx)) {
+        hres = array_make_sparse(obj);
+        if(FAILED(hres))
+            return hres;
+    }
+
     hres = ensure_prop_name(obj, name, FALSE, PROPF_CONST, &prop);
     if(FAILED(hres))
         return hres;
@@ -1322,10 +1674,13 @@ HRESULT jsdisp_propput_idx(jsdisp_t *obj, DWORD idx, jsval_t val)
 {
     WCHAR buf[12];
 
-    static const WCHAR formatW[] = {'%','d',0};
+    if(is_dense_array(obj)) {
+        HRESULT hres = array_put_elem(obj, idx, val);
+        if(hres != S_FALSE)
+            return hres;
+    }
 
-    sprintfW(buf, formatW, idx);
-    return jsdisp_propput_name(obj, buf, val);
+    return jsdisp_propput_name(obj, idx_to_name(idx, buf), val);
 }
 
 HRESULT disp_propput(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t val)
@@ -1337,11 +1692,15 @@ HRESULT disp_propput(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t val)
     if(jsdisp) {
         dispex_prop_t *prop;
 
-        prop = get_prop(jsdisp, id);
-        if(prop)
+        if(get_dense_elem(jsdisp, id)) {
+            hres = array_put_elem(jsdisp, id - DISPID_ARRAY_ELEM_FIRST, val);
+            if(hres == S_FALSE)
+                hres = jsdisp_propput_idx(jsdisp, id - DISPID_ARRAY_ELEM_FIRST, val);
+        }else if((prop = get_prop(jsdisp, id))) {
             hres = prop_put(jsdisp, prop, val, NULL);
-        else
+        }else {
             hres = DISP_E_MEMBERNOTFOUND;
+        }
 
         jsdisp_release(jsdisp);
     }else {
@@ -1373,12 +1732,44 @@ HRESULT disp_propput(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t val)
     return hres;
 }
 
+/* Reads an element of a dense array without adding protrefs for inherited elements. */
+static HRESULT get_dense_idx(jsdisp_t *obj, DWORD idx, const WCHAR *name, jsval_t *r)
+{
+    DISPPARAMS dp = {NULL, NULL, 0, 0};
+    dispex_prop_t *prop = NULL;
+    jsval_t *elem;
+    HRESULT hres;
+
+    elem = array_get_elem(obj, idx);
+    if(elem)
+        return jsval_copy(*elem, r);
+
+    if(obj->prototype) {
+        hres = find_prop_name_prot(obj->prototype, string_hash(name), name, &prop);
+        if(FAILED(hres))
+            return hres;
+    }
+
+    if(!prop || prop->type == PROP_DELETED) {
+        *r = jsval_undefined();
+        return DISP_E_UNKNOWNNAME;
+    }
+
+    return prop_get(obj->prototype, prop, &dp, r, NULL);
+}
+
 HRESULT jsdisp_propget_name(jsdisp_t *obj, const WCHAR *name, jsval_t *val)
 {
     DISPPARAMS dp = {NULL, NULL, 0, 0};
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(obj, name, &idx)) {
+        hres = get_dense_idx(obj, idx, name, val);
+        return hres == DISP_E_UNKNOWNNAME ? S_OK : hres;
+    }
+
     hres = find_prop_name_prot(obj, string_hash(name), name, &prop);
     if(FAILED(hres))
         return hres;
@@ -1398,9 +1789,10 @@ HRESULT jsdisp_get_idx(jsdisp_t *obj, DWORD idx, jsval_t *r)
     dispex_prop_t *prop;
     HRESULT hres;
 
-    static const WCHAR formatW[] = {'%','d',0};
+    idx_to_name(idx, name);
 
-    sprintfW(name, formatW, idx);
+    if(is_dense_array(obj) && idx < ARRAY_DENSE_MAX_LENGTH)
+        return get_dense_idx(obj, idx, name, r);
 
     hres = find_prop_name_prot(obj, string_hash(name), name, &prop);
     if(FAILED(hres))
@@ -1418,6 +1810,11 @@ HRESULT jsdisp_propget(jsdisp_t *jsdisp, DISPID id, jsval_t *val)
 {
     DISPPARAMS dp  = {NULL,NULL,0,0};
     dispex_prop_t *prop;
+    jsval_t *elem;
+
+    elem = get_dense_elem(jsdisp, id);
+    if(elem)
+        return jsval_copy(*elem, val);
 
     prop = get_prop(jsdisp, id);
     if(!prop)
@@ -1464,13 +1861,18 @@ HRESULT disp_propget(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t *val
 
 HRESULT jsdisp_delete_idx(jsdisp_t *obj, DWORD idx)
 {
-    static const WCHAR formatW[] = {'%','d',0};
     WCHAR buf[12];
     dispex_prop_t *prop;
     BOOL b;
     HRESULT hres;
 
-    sprintfW(buf, formatW, idx);
+    if(is_dense_array(obj)) {
+        hres = array_delete_elem(obj, idx);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
+    idx_to_name(idx, buf);
 
     hres = find_prop_name(obj, string_hash(buf), buf, &prop);
     if(FAILED(hres) || !prop)
@@ -1489,6 +1891,15 @@ HRESULT disp_delete(IDispatch *disp, DISPID id, BOOL *ret)
     if(jsdisp) {
         dispex_prop_t *prop;
 
+        if(get_dense_elem(jsdisp, id)) {
+            hres = array_delete_elem(jsdisp, id - DISPID_ARRAY_ELEM_FIRST);
+            if(hres != S_FALSE) {
+                *ret = TRUE;
+                jsdisp_release(jsdisp);
+                return hres;
+            }
+        }
+
         prop = get_prop(jsdisp, id);
         if(prop)
             hres = delete_prop(prop, ret);
@@ -1525,6 +1936,7 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
     if(jsdisp) {
         dispex_prop_t *prop;
         const WCHAR *ptr;
+        DWORD idx;
 
         ptr = jsstr_flatten(name);
         if(!ptr) {
@@ -1532,6 +1944,15 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
             return E_OUTOFMEMORY;
         }
 
+        if(is_dense_idx(jsdisp, ptr, &idx)) {
+            hres = array_delete_elem(jsdisp, idx);
+            if(hres != S_FALSE) {
+                *ret = TRUE;
+                jsdisp_release(jsdisp);
+                return hres;
+            }
+        }
+
         hres = find_prop_name(jsdisp, string_hash(ptr), ptr, &prop);
         if(prop) {
             hres = delete_prop(prop, ret);
@@ -1576,8 +1997,14 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
 HRESULT jsdisp_is_own_prop(jsdisp_t *obj, const WCHAR *name, BOOL *ret)
 {
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(obj, name, &idx)) {
+        *ret = array_get_elem(obj, idx) != NULL;
+        return S_OK;
+    }
+
     hres = find_prop_name(obj, string_hash(name), name, &prop);
     if(FAILED(hres))
         return hres;
@@ -1589,8 +2016,14 @@ HRESULT jsdisp_is_own_prop(jsdisp_t *obj, const WCHAR *name, BOOL *ret)
 HRESULT jsdisp_is_enumerable(jsdisp_t *obj, const WCHAR *name, BOOL *ret)
 {
     dispex_prop_t *prop;
+    DWORD idx;
     HRESULT hres;
 
+    if(is_dense_idx(obj, name, &idx)) {
+        *ret = array_get_elem(obj, idx) != NULL;
+        return S_OK;
+    }
+
     hres = find_prop_name(obj, string_hash(name), name, &prop);
     if(FAILED(hres))
         return hres;
@@ -163,20 +163,45 @@ static inline HRESULT stack_pop_uint(exec_ctx_t *ctx, DWORD *r)
     return to_uint32(ctx->script, stack_pop(ctx), r);
 }
 
-static inline IDispatch *stack_pop_objid(exec_ctx_t *ctx, DISPID *id)
+/* Local variable references are pushed as a pair of numbers, object references as an object and a number. */
+static HRESULT stack_push_local_ref(exec_ctx_t *ctx, unsigned slot)
 {
-    assert(is_number(stack_top(ctx)) && is_object_instance(stack_topn(ctx, 1)));
+    HRESULT hres;
+
+    hres = stack_push(ctx, jsval_number(slot));
+    if(FAILED(hres))
+        return hres;
 
-    *id = get_number(stack_pop(ctx));
-    return get_object(stack_pop(ctx));
+    return stack_push(ctx, jsval_number(0));
 }
 
-static inline IDispatch *stack_topn_objid(exec_ctx_t *ctx, unsigned n, DISPID *id)
+static void stack_topn_exprval(exec_ctx_t *ctx, unsigned n, exprval_t *r)
 {
-    assert(is_number(stack_topn(ctx, n)) && is_object_instance(stack_topn(ctx, n+1)));
+    jsval_t v = stack_topn(ctx, n+1);
+
+    if(is_number(v)) {
+        r->type = EXPRVAL_LOCAL;
+        r->u.local = get_number(v);
+        return;
+    }
+
+    assert(is_number(stack_topn(ctx, n)) && is_object_instance(v));
+
+    if(get_object(v)) {
+        r->type = EXPRVAL_IDREF;
+        r->u.idref.disp = get_object(v);
+        r->u.idref.id = get_number(stack_topn(ctx, n));
+    }else {
+        r->type = EXPRVAL_INVALID;
+        r->u.hres = get_number(stack_topn(ctx, n));
+    }
+}
 
-    *id = get_number(stack_topn(ctx, n));
-    return get_object(stack_topn(ctx, n+1));
+/* Takes ownership of the reference, caller has to call exprval_release */
+static void stack_pop_exprval(exec_ctx_t *ctx, exprval_t *r)
+{
+    stack_topn_exprval(ctx, 0, r);
+    ctx->top -= 2;
 }
 
 static void exprval_release(exprval_t *val)
@@ -189,11 +214,90 @@ static void exprval_release(exprval_t *val)
         if(val->u.idref.disp)
             IDispatch_Release(val->u.idref.disp);
         return;
+    case EXPRVAL_LOCAL:
     case EXPRVAL_INVALID:
         return;
     }
 }
 
+static HRESULT local_get(exec_ctx_t *ctx, unsigned slot, jsval_t *r)
+{
+    /* After detach_locals, variables are properties of variable object. */
+    if(!ctx->locals)
+        return jsdisp_propget_name(ctx->var_disp, ctx->locals_code->locals[slot], r);
+
+    return jsval_copy(ctx->locals[slot], r);
+}
+
+static HRESULT local_put(exec_ctx_t *ctx, unsigned slot, jsval_t val)
+{
+    jsval_t copy;
+    HRESULT hres;
+
+    if(!ctx->locals)
+        return jsdisp_propput_name(ctx->var_disp, ctx->locals_code->locals[slot], val);
+
+    hres = jsval_copy(val, &copy);
+    if(FAILED(hres))
+        return hres;
+
+    jsval_release(ctx->locals[slot]);
+    ctx->locals[slot] = copy;
+    return S_OK;
+}
+
+static HRESULT exprval_propget(exec_ctx_t *ctx, exprval_t *ref, jsval_t *r)
+{
+    switch(ref->type) {
+    case EXPRVAL_LOCAL:
+        return local_get(ctx, ref->u.local, r);
+    case EXPRVAL_IDREF:
+        return disp_propget(ctx->script, ref->u.idref.disp, ref->u.idref.id, r);
+    default:
+        assert(0);
+        return E_FAIL;
+    }
+}
+
+static HRESULT exprval_propput(exec_ctx_t *ctx, exprval_t *ref, jsval_t v)
+{
+    switch(ref->type) {
+    case EXPRVAL_LOCAL:
+        return local_put(ctx, ref->u.local, v);
+    case EXPRVAL_IDREF:
+        return disp_propput(ctx->script, ref->u.idref.disp, ref->u.idref.id, v);
+    default:
+        assert(0);
+        return E_FAIL;
+    }
+}
+
+static HRESULT exprval_call(exec_ctx_t *ctx, exprval_t *ref, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
+{
+    switch(ref->type) {
+    case EXPRVAL_LOCAL: {
+        jsval_t v;
+        HRESULT hres;
+
+        hres = local_get(ctx, ref->u.local, &v);
+        if(FAILED(hres))
+            return hres;
+
+        if(is_object_instance(v) && get_object(v))
+            hres = disp_call_value(ctx->script, get_object(v), NULL, flags, argc, argv, r);
+        else
+            hres = throw_type_error(ctx->script, JS_E_FUNCTION_EXPECTED, NULL);
+        jsval_release(v);
+        return hres;
+    }
+    case EXPRVAL_IDREF:
+        return disp_call(ctx->script, ref->u.idref.disp, ref->u.idref.id, flags, argc, argv, r);
+    default:
+        assert(0);
+        return E_FAIL;
+    }
+}
+
 /* ECMA-262 3rd Edition    8.7.1 */
 static HRESULT exprval_to_value(script_ctx_t *ctx, exprval_t *val, jsval_t *ret)
 {
@@ -209,6 +313,7 @@ static HRESULT exprval_to_value(script_ctx_t *ctx, exprval_t *val, jsval_t *ret)
         }
 
         return disp_propget(ctx, val->u.idref.disp, val->u.idref.id, ret);
+    case EXPRVAL_LOCAL:
     case EXPRVAL_INVALID:
         assert(0);
     }
@@ -240,6 +345,7 @@ HRESULT scope_push(scope_chain_t *scope, jsdisp_t *jsobj, IDispatch *obj, scope_
     IDispatch_AddRef(obj);
     new_scope->jsobj = jsobj;
     new_scope->obj = obj;
+    new_scope->exec_ctx = NULL;
 
     if(scope) {
         scope_addref(scope);
@@ -341,11 +447,69 @@ void exec_release(exec_ctx_t *ctx)
         IDispatch_Release(ctx->this_obj);
     if(ctx->script)
         script_release(ctx->script);
+    if(ctx->locals) {
+        unsigned i;
+
+        for(i = 0; i < ctx->locals_code->local_cnt; i++)
+            jsval_release(ctx->locals[i]);
+        heap_free(ctx->locals);
+    }
     jsval_release(ctx->ret);
     heap_free(ctx->stack);
     heap_free(ctx);
 }
 
+HRESULT init_locals(exec_ctx_t *ctx, function_code_t *func, unsigned argc, jsval_t *argv)
+{
+    unsigned i;
+    HRESULT hres;
+
+    ctx->locals_code = func;
+    if(!func->local_cnt)
+        return S_OK;
+
+    ctx->locals = heap_alloc(func->local_cnt * sizeof(*ctx->locals));
+    if(!ctx->locals)
+        return E_OUTOFMEMORY;
+
+    for(i = 0; i < func->local_cnt; i++)
+        ctx->locals[i] = jsval_undefined();
+
+    for(i = 0; i < argc && i < func->param_cnt; i++) {
+        if(func->param_slots[i] == -1)
+            continue;
+
+        hres = local_put(ctx, func->param_slots[i], argv[i]);
+        if(FAILED(hres))
+            return hres;
+    }
+
+    return S_OK;
+}
+
+/* Moves call frame variables to variable object, used when they need to be accessed by name. */
+HRESULT detach_locals(exec_ctx_t *ctx)
+{
+    jsval_t *locals = ctx->locals;
+    unsigned i;
+    HRESULT hres = S_OK;
+
+    if(!locals)
+        return S_OK;
+
+    TRACE("%p\n", ctx);
+
+    for(i = 0; i < ctx->locals_code->local_cnt; i++) {
+        if(SUCCEEDED(hres))
+            hres = jsdisp_propput_name(ctx->var_disp, ctx->locals_code->locals[i], locals[i]);
+        jsval_release(locals[i]);
+    }
+
+    ctx->locals = NULL;
+    heap_free(locals);
+    return hres;
+}
+
 static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
 {
     IDispatchEx *dispex;
@@ -567,6 +731,11 @@ static inline unsigned get_op_int(exec_ctx_t *ctx, int i){
     return ctx->code->instrs[ctx->ip].u.arg[i].lng;
 }
 
+static inline prop_cache_t *get_op_prop_cache(exec_ctx_t *ctx, int i){
+    unsigned idx = ctx->code->instrs[ctx->ip].u.arg[i].uint;
+    return idx ? ctx->code->prop_caches + idx - 1 : NULL;
+}
+
 static inline jsstr_t *get_op_str(exec_ctx_t *ctx, int i){
     return ctx->code->instrs[ctx->ip].u.arg[i].str;
 }
@@ -594,9 +763,10 @@ static HRESULT interp_var_set(exec_ctx_t *ctx)
 static HRESULT interp_forin(exec_ctx_t *ctx)
 {
     const HRESULT arg = get_op_uint(ctx, 0);
-    IDispatch *var_obj, *obj = NULL;
+    IDispatch *obj = NULL;
     IDispatchEx *dispex;
-    DISPID id, var_id;
+    exprval_t ref;
+    DISPID id;
     BSTR name = NULL;
     HRESULT hres;
 
@@ -605,8 +775,8 @@ static HRESULT interp_forin(exec_ctx_t *ctx)
     assert(is_number(stack_top(ctx)));
     id = get_number(stack_top(ctx));
 
-    var_obj = stack_topn_objid(ctx, 1, &var_id);
-    if(!var_obj) {
+    stack_topn_exprval(ctx, 1, &ref);
+    if(ref.type == EXPRVAL_INVALID) {
         FIXME("invalid ref\n");
         return E_FAIL;
     }
@@ -639,7 +809,7 @@ static HRESULT interp_forin(exec_ctx_t *ctx)
         stack_pop(ctx);
         stack_push(ctx, jsval_number(id)); /* safe, just after pop() */
 
-        hres = disp_propput(ctx->script, var_obj, var_id, jsval_string(str));
+        hres = exprval_propput(ctx, &ref, jsval_string(str));
         jsstr_release(str);
         if(FAILED(hres))
             return hres;
@@ -828,13 +998,31 @@ static HRESULT interp_func(exec_ctx_t *ctx)
 }
 
 /* ECMA-262 3rd Edition    11.2.1 */
+/* Numeric member names that are array indices don't need to be converted to strings. */
+static inline BOOL get_array_idx(jsval_t v, DWORD *ret)
+{
+    double n;
+
+    if(!is_number(v))
+        return FALSE;
+
+    n = get_number(v);
+    if(!(n >= 0 && n < ARRAY_DENSE_MAX_LENGTH) || n != (DWORD)n)
+        return FALSE;
+
+    *ret = n;
+    return TRUE;
+}
+
 static HRESULT interp_array(exec_ctx_t *ctx)
 {
     jsstr_t *name_str;
     const WCHAR *name;
     jsval_t v, namev;
     IDispatch *obj;
+    jsdisp_t *jsdisp;
     DISPID id;
+    DWORD idx;
     HRESULT hres;
 
     TRACE("\n");
@@ -847,6 +1035,20 @@ static HRESULT interp_array(exec_ctx_t *ctx)
         return hres;
     }
 
+    if(get_array_idx(namev, &idx) && (jsdisp = iface_to_jsdisp((IUnknown*)obj))) {
+        hres = jsdisp_get_idx(jsdisp, idx, &v);
+        jsdisp_release(jsdisp);
+        IDispatch_Release(obj);
+        if(hres == DISP_E_UNKNOWNNAME) {
+            v = jsval_undefined();
+            hres = S_OK;
+        }
+        if(FAILED(hres))
+            return hres;
+
+        return stack_push(ctx, v);
+    }
+
     hres = to_flat_string(ctx->script, namev, &name_str, &name);
     jsval_release(namev);
     if(FAILED(hres)) {
@@ -873,7 +1075,9 @@ static HRESULT interp_array(exec_ctx_t *ctx)
 static HRESULT interp_member(exec_ctx_t *ctx)
 {
     const BSTR arg = get_op_bstr(ctx, 0);
+    prop_cache_t *cache = get_op_prop_cache(ctx, 1);
     IDispatch *obj;
+    jsdisp_t *jsdisp;
     jsval_t v;
     DISPID id;
     HRESULT hres;
@@ -884,9 +1088,13 @@ static HRESULT interp_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, arg, arg, 0, &id);
+    jsdisp = to_jsdisp(obj);
+    if(jsdisp)
+        hres = jsdisp_get_id_cached(jsdisp, arg, 0, cache, &id);
+    else
+        hres = disp_get_id(ctx->script, obj, arg, arg, 0, &id);
     if(SUCCEEDED(hres)) {
-        hres = disp_propget(ctx->script, obj, id, &v);
+        hres = jsdisp ? jsdisp_propget(jsdisp, id, &v) : disp_propget(ctx->script, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
         v = jsval_undefined();
         hres = S_OK;
@@ -902,11 +1110,14 @@ static HRESULT interp_member(exec_ctx_t *ctx)
 static HRESULT interp_memberid(exec_ctx_t *ctx)
 {
     const unsigned arg = get_op_uint(ctx, 0);
+    prop_cache_t *cache = get_op_prop_cache(ctx, 1);
     jsval_t objv, namev;
     const WCHAR *name;
     jsstr_t *name_str;
     IDispatch *obj;
+    jsdisp_t *jsdisp;
     DISPID id;
+    DWORD idx;
     HRESULT hres;
 
     TRACE("%x\n", arg);
@@ -916,17 +1127,28 @@ static HRESULT interp_memberid(exec_ctx_t *ctx)
 
     hres = to_object(ctx->script, objv, &obj);
     jsval_release(objv);
-    if(SUCCEEDED(hres)) {
+    if(FAILED(hres)) {
+        jsval_release(namev);
+        return hres;
+    }
+
+    if(get_array_idx(namev, &idx) && (jsdisp = iface_to_jsdisp((IUnknown*)obj))) {
+        hres = jsdisp_get_idx_id(jsdisp, idx, arg, &id);
+        jsdisp_release(jsdisp);
+    }else {
         hres = to_flat_string(ctx->script, namev, &name_str, &name);
-        if(FAILED(hres))
+        jsval_release(namev);
+        if(FAILED(hres)) {
             IDispatch_Release(obj);
-    }
-    jsval_release(namev);
-    if(FAILED(hres))
-        return hres;
+            return hres;
+        }
 
-    hres = disp_get_id(ctx->script, obj, name, NULL, arg, &id);
-    jsstr_release(name_str);
+        if(cache && (jsdisp = to_jsdisp(obj)))
+            hres = jsdisp_get_id_cached(jsdisp, name, arg, cache, &id);
+        else
+            hres = disp_get_id(ctx->script, obj, name, NULL, arg, &id);
+        jsstr_release(name_str);
+    }
     if(FAILED(hres)) {
         IDispatch_Release(obj);
         if(hres == DISP_E_UNKNOWNNAME && !(arg & fdexNameEnsure)) {
@@ -944,18 +1166,17 @@ static HRESULT interp_memberid(exec_ctx_t *ctx)
 /* ECMA-262 3rd Edition    11.2.1 */
 static HRESULT interp_refval(exec_ctx_t *ctx)
 {
-    IDispatch *disp;
+    exprval_t ref;
     jsval_t v;
-    DISPID id;
     HRESULT hres;
 
     TRACE("\n");
 
-    disp = stack_topn_objid(ctx, 0, &id);
-    if(!disp)
+    stack_topn_exprval(ctx, 0, &ref);
+    if(ref.type == EXPRVAL_INVALID)
         return throw_reference_error(ctx->script, JS_E_ILLEGAL_ASSIGN, NULL);
 
-    hres = disp_propget(ctx->script, disp, id, &v);
+    hres = exprval_propget(ctx, &ref, &v);
     if(FAILED(hres))
         return hres;
 
@@ -1018,18 +1239,17 @@ static HRESULT interp_call_member(exec_ctx_t *ctx)
 {
     const unsigned argn = get_op_uint(ctx, 0);
     const int do_ret = get_op_int(ctx, 1);
-    IDispatch *obj;
+    exprval_t ref;
     jsval_t r;
-    DISPID id;
     HRESULT hres;
 
     TRACE("%d %d\n", argn, do_ret);
 
-    obj = stack_topn_objid(ctx, argn, &id);
-    if(!obj)
-        return throw_type_error(ctx->script, id, NULL);
+    stack_topn_exprval(ctx, argn, &ref);
+    if(ref.type == EXPRVAL_INVALID)
+        return throw_type_error(ctx->script, ref.u.hres, NULL);
 
-    hres = disp_call(ctx->script, obj, id, DISPATCH_METHOD, argn, stack_args(ctx, argn), do_ret ? &r : NULL);
+    hres = exprval_call(ctx, &ref, DISPATCH_METHOD, argn, stack_args(ctx, argn), do_ret ? &r : NULL);
     if(FAILED(hres))
         return hres;
 
@@ -1105,6 +1325,44 @@ static HRESULT interp_identid(exec_ctx_t *ctx)
     return stack_push_objid(ctx, exprval.u.idref.disp, exprval.u.idref.id);
 }
 
+static HRESULT interp_local(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    jsval_t v;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ctx->func_code->locals[arg]));
+
+    hres = local_get(ctx, arg, &v);
+    if(FAILED(hres))
+        return hres;
+
+    return stack_push(ctx, v);
+}
+
+static HRESULT interp_local_ref(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+
+    TRACE("%s\n", debugstr_w(ctx->func_code->locals[arg]));
+
+    return stack_push_local_ref(ctx, arg);
+}
+
+static HRESULT interp_local_set(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    jsval_t val;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ctx->func_code->locals[arg]));
+
+    val = stack_pop(ctx);
+    hres = local_put(ctx, arg, val);
+    jsval_release(val);
+    return hres;
+}
+
 /* ECMA-262 3rd Edition    7.8.1 */
 static HRESULT interp_null(exec_ctx_t *ctx)
 {
@@ -1185,17 +1443,17 @@ static HRESULT interp_carray(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    i = arg;
-    while(i--) {
-        val = stack_pop(ctx);
+    /* Store elements in ascending order, so they are appended to the dense vector. */
+    for(i = 0; i < arg; i++) {
+        val = stack_topn(ctx, arg-i-1);
         hres = jsdisp_propput_idx(array, i, val);
-        jsval_release(val);
         if(FAILED(hres)) {
             jsdisp_release(array);
             return hres;
         }
     }
 
+    stack_popn(ctx, arg);
     return stack_push(ctx, jsval_obj(array));
 }
 
@@ -1702,19 +1960,18 @@ static HRESULT typeof_string(jsval_t v, const WCHAR **ret)
 static HRESULT interp_typeofid(exec_ctx_t *ctx)
 {
     const WCHAR *ret;
-    IDispatch *obj;
+    exprval_t ref;
     jsval_t v;
-    DISPID id;
     HRESULT hres;
 
     TRACE("\n");
 
-    obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    stack_pop_exprval(ctx, &ref);
+    if(ref.type == EXPRVAL_INVALID)
         return stack_push(ctx, jsval_string(jsstr_undefined()));
 
-    hres = disp_propget(ctx->script, obj, id, &v);
-    IDispatch_Release(obj);
+    hres = exprval_propget(ctx, &ref, &v);
+    exprval_release(&ref);
     if(FAILED(hres))
         return stack_push_string(ctx, unknownW);
 
@@ -1815,28 +2072,27 @@ static HRESULT interp_tonum(exec_ctx_t *ctx)
 static HRESULT interp_postinc(exec_ctx_t *ctx)
 {
     const int arg = get_op_int(ctx, 0);
-    IDispatch *obj;
-    DISPID id;
+    exprval_t ref;
     jsval_t v;
     HRESULT hres;
 
     TRACE("%d\n", arg);
 
-    obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    stack_pop_exprval(ctx, &ref);
+    if(ref.type == EXPRVAL_INVALID)
         return throw_type_error(ctx->script, JS_E_OBJECT_EXPECTED, NULL);
 
-    hres = disp_propget(ctx->script, obj, id, &v);
+    hres = exprval_propget(ctx, &ref, &v);
     if(SUCCEEDED(hres)) {
         double n;
 
         hres = to_number(ctx->script, v, &n);
         if(SUCCEEDED(hres))
-            hres = disp_propput(ctx->script, obj, id, jsval_number(n+(double)arg));
+            hres = exprval_propput(ctx, &ref, jsval_number(n+(double)arg));
         if(FAILED(hres))
             jsval_release(v);
     }
-    IDispatch_Release(obj);
+    exprval_release(&ref);
     if(FAILED(hres))
         return hres;
 
@@ -1847,19 +2103,18 @@ static HRESULT interp_postinc(exec_ctx_t *ctx)
 static HRESULT interp_preinc(exec_ctx_t *ctx)
 {
     const int arg = get_op_int(ctx, 0);
-    IDispatch *obj;
+    exprval_t ref;
     double ret;
-    DISPID id;
     jsval_t v;
     HRESULT hres;
 
     TRACE("%d\n", arg);
 
-    obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    stack_pop_exprval(ctx, &ref);
+    if(ref.type == EXPRVAL_INVALID)
         return throw_type_error(ctx->script, JS_E_OBJECT_EXPECTED, NULL);
 
-    hres = disp_propget(ctx->script, obj, id, &v);
+    hres = exprval_propget(ctx, &ref, &v);
     if(SUCCEEDED(hres)) {
         double n;
 
@@ -1867,10 +2122,10 @@ static HRESULT interp_preinc(exec_ctx_t *ctx)
         jsval_release(v);
         if(SUCCEEDED(hres)) {
             ret = n+(double)arg;
-            hres = disp_propput(ctx->script, obj, id, jsval_number(ret));
+            hres = exprval_propput(ctx, &ref, jsval_number(ret));
         }
     }
-    IDispatch_Release(obj);
+    exprval_release(&ref);
     if(FAILED(hres))
         return hres;
 
@@ -2253,8 +2508,7 @@ static HRESULT interp_rshift2(exec_ctx_t *ctx)
 /* ECMA-262 3rd Edition    11.13.1 */
 static HRESULT interp_assign(exec_ctx_t *ctx)
 {
-    IDispatch *disp;
-    DISPID id;
+    exprval_t ref;
     jsval_t v;
     HRESULT hres;
 
@@ -2262,14 +2516,14 @@ static HRESULT interp_assign(exec_ctx_t *ctx)
 
     v = stack_pop(ctx);
 
-    disp = stack_pop_objid(ctx, &id);
-    if(!disp) {
+    stack_pop_exprval(ctx, &ref);
+    if(ref.type == EXPRVAL_INVALID) {
         jsval_release(v);
         return throw_reference_error(ctx->script, JS_E_ILLEGAL_ASSIGN, NULL);
     }
 
-    hres = disp_propput(ctx->script, disp, id, v);
-    IDispatch_Release(disp);
+    hres = exprval_propput(ctx, &ref, v);
+    exprval_release(&ref);
     if(FAILED(hres)) {
         jsval_release(v);
         return hres;
@@ -2282,18 +2536,17 @@ static HRESULT interp_assign(exec_ctx_t *ctx)
 static HRESULT interp_assign_call(exec_ctx_t *ctx)
 {
     const unsigned argc = get_op_uint(ctx, 0);
-    IDispatch *disp;
+    exprval_t ref;
     jsval_t v;
-    DISPID id;
     HRESULT hres;
 
     TRACE("%u\n", argc);
 
-    disp = stack_topn_objid(ctx, argc+1, &id);
-    if(!disp)
+    stack_topn_exprval(ctx, argc+1, &ref);
+    if(ref.type == EXPRVAL_INVALID)
         return throw_reference_error(ctx->script, JS_E_ILLEGAL_ASSIGN, NULL);
 
-    hres = disp_call(ctx->script, disp, id, DISPATCH_PROPERTYPUT, argc+1, stack_args(ctx, argc+1), NULL);
+    hres = exprval_call(ctx, &ref, DISPATCH_PROPERTYPUT, argc+1, stack_args(ctx, argc+1), NULL);
     if(FAILED(hres))
         return hres;
 
@@ -2502,6 +2755,21 @@ HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BO
     unsigned i;
     HRESULT hres = S_OK;
 
+    /* Eval code accesses variables of the calling function and the functions
+     * enclosing it by name. When eval is called through an alias, none of them
+     * has to refer to eval, so they may still use call frame slots. */
+    if(from_eval) {
+        scope_chain_t *scope;
+
+        hres = detach_locals(ctx);
+        for(scope = ctx->scope_chain; scope && SUCCEEDED(hres); scope = scope->next) {
+            if(scope->exec_ctx)
+                hres = detach_locals(scope->exec_ctx);
+        }
+        if(FAILED(hres))
+            return hres;
+    }
+
     for(i = 0; i < func->func_cnt; i++) {
         jsdisp_t *func_obj;
 
@@ -2512,7 +2780,10 @@ HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BO
         if(FAILED(hres))
             return hres;
 
-        hres = jsdisp_propput_name(ctx->var_disp, func->funcs[i].name, jsval_obj(func_obj));
+        if(func->funcs[i].local_slot != -1)
+            hres = local_put(ctx, func->funcs[i].local_slot, jsval_obj(func_obj));
+        else
+            hres = jsdisp_propput_name(ctx->var_disp, func->funcs[i].name, jsval_obj(func_obj));
         jsdisp_release(func_obj);
         if(FAILED(hres))
             return hres;
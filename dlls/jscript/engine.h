@@ -68,11 +68,14 @@ typedef struct {
     X(int,        1, ARG_INT,    0)        \
     X(jmp,        0, ARG_ADDR,   0)        \
     X(jmp_z,      0, ARG_ADDR,   0)        \
+    X(local,      1, ARG_UINT,   0)        \
+    X(local_ref,  1, ARG_UINT,   0)        \
+    X(local_set,  1, ARG_UINT,   0)        \
     X(lshift,     1, 0,0)                  \
     X(lt,         1, 0,0)                  \
     X(lteq,       1, 0,0)                  \
-    X(member,     1, ARG_BSTR,   0)        \
-    X(memberid,   1, ARG_UINT,   0)        \
+    X(member,     1, ARG_BSTR,   ARG_UINT) \
+    X(memberid,   1, ARG_UINT,   ARG_UINT) \
     X(minus,      1, 0,0)                  \
     X(mod,        1, 0,0)                  \
     X(mul,        1, 0,0)                  \
@@ -160,6 +163,12 @@ typedef struct _function_code_t {
 
     unsigned param_cnt;
     BSTR *params;
+
+    /* Variables that are never accessed by name are stored in call frame slots. */
+    unsigned local_cnt;
+    BSTR *locals;
+    int *param_slots;
+    int local_slot; /* slot of the declared function in its parent's call frame or -1 */
 } function_code_t;
 
 typedef struct _bytecode_t {
@@ -180,6 +189,9 @@ typedef struct _bytecode_t {
     unsigned str_pool_size;
     unsigned str_cnt;
 
+    prop_cache_t *prop_caches;
+    unsigned prop_cache_cnt;
+
     struct _bytecode_t *next;
 } bytecode_t;
 
@@ -210,6 +222,7 @@ typedef struct _scope_chain_t {
     LONG ref;
     jsdisp_t *jsobj;
     IDispatch *obj;
+    exec_ctx_t *exec_ctx; /* call frame of the function while it runs, for function scopes */
     struct _scope_chain_t *next;
 } scope_chain_t;
 
@@ -241,6 +254,9 @@ struct _exec_ctx_t {
     except_frame_t *except_frame;
     jsval_t ret;
 
+    jsval_t *locals;
+    function_code_t *locals_code;
+
     unsigned ip;
 };
 
@@ -252,6 +268,8 @@ static inline void exec_addref(exec_ctx_t *ctx)
 void exec_release(exec_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT create_exec_ctx(script_ctx_t*,IDispatch*,jsdisp_t*,scope_chain_t*,BOOL,exec_ctx_t**) DECLSPEC_HIDDEN;
 HRESULT exec_source(exec_ctx_t*,bytecode_t*,function_code_t*,BOOL,jsval_t*) DECLSPEC_HIDDEN;
+HRESULT init_locals(exec_ctx_t*,function_code_t*,unsigned,jsval_t*) DECLSPEC_HIDDEN;
+HRESULT detach_locals(exec_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT create_source_function(script_ctx_t*,bytecode_t*,function_code_t*,scope_chain_t*,jsdisp_t**) DECLSPEC_HIDDEN;
 
 typedef enum {
@@ -403,6 +421,7 @@ typedef struct {
     enum {
         EXPRVAL_JSVAL,
         EXPRVAL_IDREF,
+        EXPRVAL_LOCAL,
         EXPRVAL_INVALID
     } type;
     union {
@@ -411,6 +430,8 @@ typedef struct {
             IDispatch *disp;
             DISPID id;
         } idref;
+        unsigned local;
+        HRESULT hres;
     } u;
 } exprval_t;
 
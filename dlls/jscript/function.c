@@ -41,6 +41,7 @@ typedef struct {
     jsdisp_t jsdisp;
     FunctionInstance *function;
     jsdisp_t *var_obj;
+    exec_ctx_t *exec_ctx;
 } ArgumentsInstance;
 
 static inline FunctionInstance *function_from_vdisp(vdisp_t *vdisp)
@@ -67,6 +68,10 @@ static HRESULT init_parameters(jsdisp_t *var_disp, FunctionInstance *function, u
     HRESULT hres;
 
     for(i=0; i < function->func_code->param_cnt; i++) {
+        /* Stored in call frame by init_locals */
+        if(function->func_code->param_slots && function->func_code->param_slots[i] != -1)
+            continue;
+
         hres = jsdisp_propput_name(var_disp, function->func_code->params[i],
                 i < argc ? argv[i] : jsval_undefined());
         if(FAILED(hres))
@@ -98,12 +103,27 @@ static unsigned Arguments_idx_length(jsdisp_t *jsdisp)
     return arguments->function->length;
 }
 
+static jsval_t *get_argument_local(ArgumentsInstance *arguments, unsigned idx)
+{
+    function_code_t *func_code = arguments->function->func_code;
+
+    if(!arguments->exec_ctx || !arguments->exec_ctx->locals || func_code->param_slots[idx] == -1)
+        return NULL;
+
+    return arguments->exec_ctx->locals + func_code->param_slots[idx];
+}
+
 static HRESULT Arguments_idx_get(jsdisp_t *jsdisp, unsigned idx, jsval_t *res)
 {
     ArgumentsInstance *arguments = (ArgumentsInstance*)jsdisp;
+    jsval_t *local;
 
     TRACE("%p[%u]\n", arguments, idx);
 
+    local = get_argument_local(arguments, idx);
+    if(local)
+        return jsval_copy(*local, res);
+
     /* FIXME: Accessing by name won't work for duplicated argument names */
     return jsdisp_propget_name(arguments->var_obj, arguments->function->func_code->params[idx], res);
 }
@@ -111,9 +131,24 @@ static HRESULT Arguments_idx_get(jsdisp_t *jsdisp, unsigned idx, jsval_t *res)
 static HRESULT Arguments_idx_put(jsdisp_t *jsdisp, unsigned idx, jsval_t val)
 {
     ArgumentsInstance *arguments = (ArgumentsInstance*)jsdisp;
+    jsval_t *local;
+    HRESULT hres;
 
     TRACE("%p[%u] = %s\n", arguments, idx, debugstr_jsval(val));
 
+    local = get_argument_local(arguments, idx);
+    if(local) {
+        jsval_t copy;
+
+        hres = jsval_copy(val, &copy);
+        if(FAILED(hres))
+            return hres;
+
+        jsval_release(*local);
+        *local = copy;
+        return S_OK;
+    }
+
     /* FIXME: Accessing by name won't work for duplicated argument names */
     return jsdisp_propput_name(arguments->var_obj, arguments->function->func_code->params[idx], val);
 }
@@ -233,12 +268,33 @@ static HRESULT invoke_source(script_ctx_t *ctx, FunctionInstance *function, IDis
         scope_release(scope);
 
         if(SUCCEEDED(hres)) {
-            jsdisp_t *prev_args;
-
-            prev_args = function->arguments;
-            function->arguments = arg_disp;
-            hres = exec_source(exec_ctx, function->code, function->func_code, FALSE, r);
-            function->arguments = prev_args;
+            hres = init_locals(exec_ctx, function->func_code, argc, argv);
+            if(SUCCEEDED(hres)) {
+                ArgumentsInstance *args = (ArgumentsInstance*)arg_disp;
+                jsdisp_t *prev_args;
+
+                args->exec_ctx = exec_ctx;
+                exec_ctx->scope_chain->exec_ctx = exec_ctx;
+                prev_args = function->arguments;
+                function->arguments = arg_disp;
+                hres = exec_source(exec_ctx, function->code, function->func_code, FALSE, r);
+                function->arguments = prev_args;
+
+                /* Nested functions keep the variable object in their scope chain and
+                 * may look up any variable by name later, through an aliased eval.
+                 * The locals are gone from the call frame even if this fails. */
+                if(function->func_code->func_cnt) {
+                    HRESULT detach_hres = detach_locals(exec_ctx);
+
+                    if(SUCCEEDED(hres) && FAILED(detach_hres)) {
+                        if(r)
+                            jsval_release(*r);
+                        hres = detach_hres;
+                    }
+                }
+                exec_ctx->scope_chain->exec_ctx = NULL;
+                args->exec_ctx = NULL;
+            }
 
             exec_release(exec_ctx);
         }
@@ -571,7 +627,19 @@ static HRESULT Function_arguments(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags
 
     switch(flags) {
     case DISPATCH_PROPERTYGET: {
-        *r = function->arguments ? jsval_obj(jsdisp_addref(function->arguments)) : jsval_null();
+        if(!function->arguments) {
+            *r = jsval_null();
+            break;
+        }
+
+        /* The arguments object may outlive the call now, so its parameters have to be accessed by name. */
+        if(((ArgumentsInstance*)function->arguments)->exec_ctx) {
+            hres = detach_locals(((ArgumentsInstance*)function->arguments)->exec_ctx);
+            if(FAILED(hres))
+                return hres;
+        }
+
+        *r = jsval_obj(jsdisp_addref(function->arguments));
         break;
     }
     case DISPATCH_PROPERTYPUT:
@@ -68,9 +68,13 @@ void script_release(script_ctx_t *ctx)
     if(--ctx->ref)
         return;
 
+    TRACE("property cache: %u hits, %u misses\n", ctx->prop_cache_hits, ctx->prop_cache_misses);
+
     clear_ei(ctx);
     if(ctx->cc)
         release_cc(ctx->cc);
+    release_shape(ctx->root_shape);
+    release_regexp_cache(ctx);
     heap_pool_free(&ctx->tmp_heap);
     if(ctx->last_match)
         jsstr_release(ctx->last_match);
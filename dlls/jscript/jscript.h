@@ -38,6 +38,7 @@ typedef struct _jsstr_t jsstr_t;
 typedef struct _script_ctx_t script_ctx_t;
 typedef struct _exec_ctx_t exec_ctx_t;
 typedef struct _dispex_prop_t dispex_prop_t;
+typedef struct _dispex_shape_t dispex_shape_t;
 
 typedef struct {
     void **blocks;
@@ -206,6 +207,13 @@ typedef struct {
     HRESULT (*idx_put)(jsdisp_t*,unsigned,jsval_t);
 } builtin_info_t;
 
+/* Objects that had the same properties added in the same order share a shape,
+ * which lets a member access site cache the DISPID it resolved to. */
+typedef struct {
+    dispex_shape_t *shape;
+    DISPID id;
+} prop_cache_t;
+
 struct jsdisp_t {
     IDispatchEx IDispatchEx_iface;
 
@@ -214,6 +222,7 @@ struct jsdisp_t {
     DWORD buf_size;
     DWORD prop_cnt;
     dispex_prop_t *props;
+    dispex_shape_t *shape;
     script_ctx_t *ctx;
 
     jsdisp_t *prototype;
@@ -229,6 +238,7 @@ static inline IDispatch *to_disp(jsdisp_t *jsdisp)
 jsdisp_t *as_jsdisp(IDispatch*) DECLSPEC_HIDDEN;
 jsdisp_t *to_jsdisp(IDispatch*) DECLSPEC_HIDDEN;
 void jsdisp_free(jsdisp_t*) DECLSPEC_HIDDEN;
+void release_shape(dispex_shape_t*) DECLSPEC_HIDDEN;
 
 #ifndef TRACE_REFCNT
 
@@ -277,6 +287,8 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,prop_cache_t*,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_idx_id(jsdisp_t*,DWORD,DWORD,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*);
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -309,6 +321,17 @@ HRESULT create_bool(script_ctx_t*,BOOL,jsdisp_t**) DECLSPEC_HIDDEN;
 HRESULT create_number(script_ctx_t*,double,jsdisp_t**) DECLSPEC_HIDDEN;
 HRESULT create_vbarray(script_ctx_t*,SAFEARRAY*,jsdisp_t**) DECLSPEC_HIDDEN;
 
+/* Elements of dense arrays use DISPIDs from this range instead of property table entries. */
+#define DISPID_ARRAY_ELEM_FIRST 0x40000000
+#define ARRAY_DENSE_MAX_LENGTH  0x40000000
+
+BOOL is_dense_array(jsdisp_t*) DECLSPEC_HIDDEN;
+jsval_t *array_get_elem(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
+HRESULT array_put_elem(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
+HRESULT array_ensure_elem(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
+HRESULT array_delete_elem(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
+HRESULT array_make_sparse(jsdisp_t*) DECLSPEC_HIDDEN;
+
 typedef enum {
     NO_HINT,
     HINT_STRING,
@@ -367,6 +390,14 @@ typedef struct {
     unsigned length;
 } match_result_t;
 
+/* Most recently used compiled regexps, keyed by source and flags. */
+#define REGEXP_CACHE_SIZE 16
+
+typedef struct {
+    jsstr_t *src;
+    struct regexp_t *regexp;
+} regexp_cache_entry_t;
+
 struct _script_ctx_t {
     LONG ref;
 
@@ -412,6 +443,13 @@ struct _script_ctx_t {
     jsdisp_t *regexp_constr;
     jsdisp_t *string_constr;
     jsdisp_t *vbarray_constr;
+
+    dispex_shape_t *root_shape;
+    DWORD prop_cache_hits;
+    DWORD prop_cache_misses;
+
+    regexp_cache_entry_t regexp_cache[REGEXP_CACHE_SIZE];
+    unsigned regexp_cache_cnt;
 };
 
 void script_release(script_ctx_t*) DECLSPEC_HIDDEN;
@@ -449,6 +487,7 @@ struct match_state_t;
 HRESULT regexp_match_next(script_ctx_t*,jsdisp_t*,DWORD,jsstr_t*,struct match_state_t**) DECLSPEC_HIDDEN;
 HRESULT parse_regexp_flags(const WCHAR*,DWORD,DWORD*) DECLSPEC_HIDDEN;
 HRESULT regexp_string_match(script_ctx_t*,jsdisp_t*,jsstr_t*,jsval_t*) DECLSPEC_HIDDEN;
+void release_regexp_cache(script_ctx_t*) DECLSPEC_HIDDEN;
 
 static inline BOOL is_class(jsdisp_t *jsdisp, jsclass_t class)
 {
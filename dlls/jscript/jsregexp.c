@@ -585,7 +585,7 @@ static void RegExp_destructor(jsdisp_t *dispex)
     RegExpInstance *This = (RegExpInstance*)dispex;
 
     if(This->jsregexp)
-        regexp_destroy(This->jsregexp);
+        regexp_release(This->jsregexp);
     jsval_release(This->last_index_val);
     jsstr_release(This->str);
     heap_free(This);
@@ -651,8 +651,61 @@ static HRESULT alloc_regexp(script_ctx_t *ctx, jsdisp_t *object_prototype, RegEx
     return S_OK;
 }
 
+/*
+ * Compiled regexps are shared between instances with the same source and
+ * flags. An entry keeps a reference to the string the regexp_t source
+ * points to, and every instance using the regexp holds that string as well.
+ */
+static regexp_cache_entry_t *lookup_regexp_cache(script_ctx_t *ctx, const WCHAR *str, DWORD len, DWORD flags)
+{
+    regexp_cache_entry_t entry;
+    unsigned i;
+
+    for(i = 0; i < ctx->regexp_cache_cnt; i++) {
+        regexp_t *cached = ctx->regexp_cache[i].regexp;
+
+        if(cached->flags == flags && cached->source_len == len
+           && !memcmp(cached->source, str, len*sizeof(WCHAR)))
+            break;
+    }
+    if(i == ctx->regexp_cache_cnt)
+        return NULL;
+
+    entry = ctx->regexp_cache[i];
+    memmove(ctx->regexp_cache+1, ctx->regexp_cache, i*sizeof(*ctx->regexp_cache));
+    ctx->regexp_cache[0] = entry;
+    return ctx->regexp_cache;
+}
+
+static void add_regexp_cache(script_ctx_t *ctx, jsstr_t *src, regexp_t *jsregexp)
+{
+    if(ctx->regexp_cache_cnt == REGEXP_CACHE_SIZE) {
+        regexp_cache_entry_t *entry = ctx->regexp_cache + --ctx->regexp_cache_cnt;
+
+        regexp_release(entry->regexp);
+        jsstr_release(entry->src);
+    }
+
+    memmove(ctx->regexp_cache+1, ctx->regexp_cache, ctx->regexp_cache_cnt*sizeof(*ctx->regexp_cache));
+    ctx->regexp_cache[0].src = jsstr_addref(src);
+    ctx->regexp_cache[0].regexp = regexp_addref(jsregexp);
+    ctx->regexp_cache_cnt++;
+}
+
+void release_regexp_cache(script_ctx_t *ctx)
+{
+    unsigned i;
+
+    for(i = 0; i < ctx->regexp_cache_cnt; i++) {
+        regexp_release(ctx->regexp_cache[i].regexp);
+        jsstr_release(ctx->regexp_cache[i].src);
+    }
+    ctx->regexp_cache_cnt = 0;
+}
+
 HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **ret)
 {
+    regexp_cache_entry_t *cached;
     RegExpInstance *regexp;
     const WCHAR *str;
     HRESULT hres;
@@ -667,14 +720,22 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
     if(FAILED(hres))
         return hres;
 
-    regexp->str = jsstr_addref(src);
     regexp->last_index_val = jsval_number(0);
 
-    regexp->jsregexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(regexp->str), flags, FALSE);
-    if(!regexp->jsregexp) {
-        WARN("regexp_new failed\n");
-        jsdisp_release(&regexp->dispex);
-        return E_FAIL;
+    cached = lookup_regexp_cache(ctx, str, jsstr_length(src), flags);
+    if(cached) {
+        regexp->str = jsstr_addref(cached->src);
+        regexp->jsregexp = regexp_addref(cached->regexp);
+    }else {
+        regexp->str = jsstr_addref(src);
+        regexp->jsregexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(regexp->str), flags, FALSE);
+        if(!regexp->jsregexp) {
+            WARN("regexp_new failed\n");
+            jsdisp_release(&regexp->dispex);
+            return E_FAIL;
+        }
+
+        add_regexp_cache(ctx, regexp->str, regexp->jsregexp);
     }
 
     *ret = &regexp->dispex;
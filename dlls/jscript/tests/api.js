@@ -1029,6 +1029,31 @@ ok(tmp === (invokeVersion < 2 ? undefined : 3), "unshift returned " +tmp);
 ok(arr.length === 3, "arr.length = " + arr.length);
 ok(arr[0] === 0 && arr[1] === 1 && arr[2] === 2, "unexpected array");
 
+arr = [1,2,3];
+arr[5] = 6;
+ok(arr.length === 6, "arr.length = " + arr.length);
+ok(!("4" in arr) && ("5" in arr), "unexpected array");
+tmp = "";
+for(var iter in arr)
+    tmp += iter + ",";
+ok(tmp === "0,1,2,5,", "for in = " + tmp);
+
+arr = [1,2,3,4];
+delete arr[3];
+ok(arr.length === 4 && !arr.hasOwnProperty("3"), "arr.length = " + arr.length);
+delete arr[1];
+ok(arr.length === 4 && !(1 in arr) && arr[2] === 3, "arr = " + arr.toString());
+arr.length = 1;
+arr[1] = 5;
+ok(arr.toString() === "1,5", "arr = " + arr.toString());
+
+Array.prototype[2] = "p";
+arr = [0,1];
+ok(arr[2] === "p", "arr[2] = " + arr[2]);
+ok(arr.length === 2 && !arr.hasOwnProperty("2"), "arr.length = " + arr.length);
+delete Array.prototype[2];
+ok(arr[2] === undefined, "arr[2] = " + arr[2]);
+
 arr = [1,2,,4];
 tmp = arr.shift();
 ok(tmp === 1, "[1,2,,4].shift() = " + tmp);
@@ -1439,6 +1439,90 @@ function returnTest() {
 
 ok(returnTest() === undefined, "returnTest = " + returnTest());
 
+function localVarsTest(a, b) {
+    var c = a + b, i;
+    var closure = function() { return c; };
+
+    for(i = 0; i < 3; i++)
+        c++;
+    ok(closure() === c, "closure() = " + closure() + " expected " + c);
+    ok(typeof(b) === "number", "typeof(b) = " + typeof(b));
+    return c;
+}
+
+ok(localVarsTest(1, 2) === 6, "localVarsTest(1, 2) = " + localVarsTest(1, 2));
+
+function localVarsCaller(a) {
+    var x = 1;
+    localVarsCallee();
+    x = getEval()("x + a");
+    return a + x;
+}
+
+function localVarsCallee() {
+    ok(localVarsCaller.arguments[0] === 2, "localVarsCaller.arguments[0] = " + localVarsCaller.arguments[0]);
+    localVarsCaller.arguments[0] = 3;
+}
+
+function getEval() {
+    return eval;
+}
+
+ok(localVarsCaller(2) === 7, "localVarsCaller(2) = " + localVarsCaller(2));
+
+var evalAlias = eval;
+
+function localVarsOuter() {
+    var x = 1;
+    function inner() { return evalAlias("x"); }
+    return inner();
+}
+
+ok(localVarsOuter() === 1, "localVarsOuter() = " + localVarsOuter());
+
+function localVarsClosure() {
+    var y = 2;
+    return function() { return evalAlias("y"); };
+}
+
+ok(localVarsClosure()() === 2, "localVarsClosure()() = " + localVarsClosure()());
+
+function localVarsArgs(a) {
+    return localVarsGetArgs();
+}
+
+function localVarsGetArgs() {
+    return localVarsArgs.arguments;
+}
+
+tmp = localVarsArgs(5);
+ok(tmp[0] === 5, "localVarsArgs(5)[0] = " + tmp[0]);
+
+function localVarsForIn(o) {
+    var r = "";
+    for(var p in o)
+        r += p;
+    return r;
+}
+
+ok(localVarsForIn({x: 1, y: 2}) === "xy", "localVarsForIn() = " + localVarsForIn({x: 1, y: 2}));
+
+function getPropA(o) {
+    return o.a;
+}
+
+tmp = {a: 1};
+ok(getPropA(tmp) === 1, "getPropA(tmp) = " + getPropA(tmp));
+ok(getPropA({b: 2, a: 3}) === 3, "getPropA({b: 2, a: 3}) = " + getPropA({b: 2, a: 3}));
+ok(getPropA(tmp) === 1, "getPropA(tmp) = " + getPropA(tmp));
+delete tmp.a;
+ok(getPropA(tmp) === undefined, "getPropA(tmp) = " + getPropA(tmp));
+Object.prototype.a = 4;
+ok(getPropA(tmp) === 4, "getPropA(tmp) = " + getPropA(tmp));
+tmp.a = 5;
+ok(getPropA(tmp) === 5, "getPropA(tmp) = " + getPropA(tmp));
+delete Object.prototype.a;
+
 /* Keep this test in the end of file */
 undefined = 6;
 ok(undefined === 6, "undefined = " + undefined);
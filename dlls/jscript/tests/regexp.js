@@ -660,4 +660,75 @@ tmp = new RegExp("abc/", "mgi");
 ok(tmp.toString() === "/abc//igm", "(new RegExp(\"abc/\")).toString() = " + tmp.toString());
 ok(/abc/.toString(1, false, "3") === "/abc/", "/abc/.toString(1, false, \"3\") = " + /abc/.toString());
 
+function test_match_start(re, str, exp_index, exp_match) {
+    var m = re.exec(str);
+    if(exp_index === -1) {
+        ok(m === null, re + ".exec(" + str + ") = " + m);
+        return;
+    }
+    ok(m !== null, re + ".exec(" + str + ") = null");
+    if(!m)
+        return;
+    ok(m.index === exp_index, re + ".exec(" + str + ").index = " + m.index);
+    ok(m[0] === exp_match, re + ".exec(" + str + ")[0] = " + m[0]);
+}
+
+test_match_start(/abc/, "xxabxabcab", 5, "abc");
+test_match_start(/abc/, "xxabxabab", -1);
+test_match_start(/abc/, "", -1);
+test_match_start(/aab/, "aaaab", 2, "aab");
+test_match_start(/\u0161b/, "aaa\u0161ab\u0161b", 6, "\u0161b");
+test_match_start(/x\u0161/, "xaxbx\u0161", 4, "x\u0161");
+test_match_start(/ab+c/, "abbabbbc", 3, "abbbc");
+test_match_start(/ABC/i, "xxabc", 2, "abc");
+test_match_start(/\u00e9t\u00e9/i, "ETE \u00c9T\u00c9", 4, "\u00c9T\u00c9");
+test_match_start(/[0-9]+px/, "top: 10px", 5, "10px");
+test_match_start(/[a-c]x/i, "DX bX", 3, "bX");
+test_match_start(/\d\w/, "a 12", 2, "12");
+test_match_start(/(cat|dog)s/, "a dog, cats", 7, "cats");
+test_match_start(/(?:ab|cd)+e/, "abcdab cde", 7, "cde");
+test_match_start(/a*b/, "cccab", 3, "ab");
+test_match_start(/x?y/, "zzy", 2, "y");
+test_match_start(/a*/, "bbb", 0, "");
+test_match_start(/\bfoo/, "afoo foo", 5, "foo");
+test_match_start(/(?=b)\w/, "aab", 2, "b");
+test_match_start(/^ab/m, "xab\nab", 4, "ab");
+test_match_start(/\s+x/, "a\u3000 x", 1, "\u3000 x");
+test_match_start(/[\u0100-\u0200]z/, "az\u0150z", 2, "\u0150z");
+test_match_start(/\u4e2d/, "\u6587\u4e2d", 1, "\u4e2d");
+test_match_start(/\u4e2d/, "\u6587\u5b57", -1);
+
+ok(!/\u4e2d/.test("\u6587"), "/\\u4e2d/.test(\"\\u6587\") returned true");
+ok(/\u4e2d/.test("a\u4e2d"), "/\\u4e2d/.test(\"a\\u4e2d\") returned false");
+tmp = "\u6587\u5b57".replace(/\u4e2d/g, "x");
+ok(tmp === "\u6587\u5b57", "replace(/\\u4e2d/g) = " + tmp);
+tmp = "\u6587\u4e2d\u5b57\u4e2d".replace(/\u4e2d/g, "x");
+ok(tmp === "\u6587x\u5b57x", "replace(/\\u4e2d/g) = " + tmp);
+
+for(i = 0; i < 3; i++) {
+    re = /b/g;
+    ok(re.lastIndex === 0, "re.lastIndex = " + re.lastIndex);
+    m = re.exec("abcb");
+    ok(m.index === 1, "m.index = " + m.index);
+    ok(re.lastIndex === 2, "re.lastIndex = " + re.lastIndex);
+}
+
+re = new RegExp("b", "g");
+tmp = new RegExp("b", "i");
+ok(tmp.source === "b", "tmp.source = " + tmp.source);
+ok(tmp.exec("aB")[0] === "B", "tmp.exec(\"aB\")[0] = " + tmp.exec("aB")[0]);
+ok(re.exec("aB") === null, "re.exec(\"aB\") != null");
+m = re.exec("abab");
+ok(m.index === 1, "m.index = " + m.index);
+ok(re.lastIndex === 2, "re.lastIndex = " + re.lastIndex);
+
+for(i = 0; i < 40; i++) {
+    re = new RegExp("x" + i);
+    ok(re.source === "x" + i, "re.source = " + re.source);
+    ok(re.test("ax" + i), "re.test(ax" + i + ") failed");
+}
+re = new RegExp("x0");
+ok(re.source === "x0", "re.source = " + re.source);
+ok(re.exec("ax0").index === 1, "re.exec(ax0).index = " + re.exec("ax0").index);
+
 reportSuccess();
@@ -50,6 +50,8 @@ typedef struct tagPROFILEKEY
 {
     WCHAR                 *value;
     struct tagPROFILEKEY  *next;
+    struct tagPROFILEKEY  *hash_next;      /* next key in the same index bucket */
+    ULONG                  hash;
     WCHAR                  name[1];
 } PROFILEKEY;
 
@@ -57,6 +59,11 @@ typedef struct tagPROFILESECTION
 {
     struct tagPROFILEKEY       *key;
     struct tagPROFILESECTION   *next;
+    struct tagPROFILESECTION   *hash_next; /* next section in the same index bucket */
+    struct tagPROFILEKEY      **key_index; /* hash index of the keys, built on demand */
+    UINT                        key_index_size;
+    UINT                        key_count;
+    ULONG                       hash;
     WCHAR                       name[1];
 } PROFILESECTION;
 
@@ -65,16 +72,25 @@ typedef struct
 {
     BOOL             changed;
     PROFILESECTION  *section;
+    PROFILESECTION **section_index;     /* hash index of the sections, built on demand */
+    UINT             section_index_size;
+    UINT             section_count;
     WCHAR           *filename;
+    ULONG            filename_hash;
     FILETIME LastWriteTime;
+    ULONGLONG        size;
+    ULONGLONG        file_index;
+    DWORD            volume;
     ENCODING encoding;
 } PROFILE;
 
 
-#define N_CACHED_PROFILES 10
+#define N_CACHED_PROFILES 64
+#define MAX_CACHED_PROFILES 256
 
 /* Cached profile files */
-static PROFILE *MRUProfile[N_CACHED_PROFILES]={NULL};
+static PROFILE *MRUProfile[MAX_CACHED_PROFILES]={NULL};
+static UINT n_cached_profiles;
 
 #define CurProfile (MRUProfile[0])
 
@@ -95,6 +111,29 @@ static CRITICAL_SECTION PROFILE_CritSect = { &critsect_debug, -1, 0, 0, 0, 0 };
 
 static const char hex[16] = "0123456789ABCDEF";
 
+/* sections and keys are searched linearly until there are this many of them */
+#define PROFILE_INDEX_MIN 8
+
+/* files larger than this are mapped instead of read into a buffer */
+#define PROFILE_MAP_MIN 0x10000
+
+/* case insensitive hash of the first len characters of a name */
+static ULONG PROFILE_Hash( const WCHAR *str, int len )
+{
+    ULONG hash = 0;
+
+    while (len-- > 0) hash = hash * 31 + tolowerW( *str++ );
+    return hash;
+}
+
+static UINT PROFILE_IndexSize( UINT count )
+{
+    UINT size = 16;
+
+    while (size < count) size *= 2;
+    return size;
+}
+
 /***********************************************************************
  *           PROFILE_CopyEntry
  *
@@ -194,38 +233,43 @@ static void PROFILE_WriteLine( HANDLE hFile, WCHAR * szLine, int len, ENCODING e
  */
 static void PROFILE_Save( HANDLE hFile, const PROFILESECTION *section, ENCODING encoding )
 {
+    const PROFILESECTION *s;
     PROFILEKEY *key;
     WCHAR *buffer, *p;
+    int len = 0;
 
     PROFILE_WriteMarker(hFile, encoding);
 
-    for ( ; section; section = section->next)
+    /* the whole tree is written at once, rather than one write per section */
+    for (s = section; s; s = s->next)
     {
-        int len = 0;
-
-        if (section->name[0]) len += strlenW(section->name) + 4;
+        if (s->name[0]) len += strlenW(s->name) + 4;
 
-        for (key = section->key; key; key = key->next)
+        for (key = s->key; key; key = key->next)
         {
             len += strlenW(key->name) + 2;
             if (key->value) len += strlenW(key->value) + 1;
         }
+    }
+    if (!len) return;
 
-        buffer = HeapAlloc(GetProcessHeap(), 0, len * sizeof(WCHAR));
-        if (!buffer) return;
+    buffer = HeapAlloc(GetProcessHeap(), 0, len * sizeof(WCHAR));
+    if (!buffer) return;
 
-        p = buffer;
-        if (section->name[0])
+    p = buffer;
+    for (s = section; s; s = s->next)
+    {
+        if (s->name[0])
         {
             *p++ = '[';
-            strcpyW( p, section->name );
+            strcpyW( p, s->name );
             p += strlenW(p);
             *p++ = ']';
             *p++ = '\r';
             *p++ = '\n';
         }
 
-        for (key = section->key; key; key = key->next)
+        for (key = s->key; key; key = key->next)
         {
             strcpyW( p, key->name );
             p += strlenW(p);
@@ -238,9 +282,9 @@ static void PROFILE_Save( HANDLE hFile, const PROFILESECTION *section, ENCODING
             *p++ = '\r';
             *p++ = '\n';
         }
-        PROFILE_WriteLine( hFile, buffer, len, encoding );
-        HeapFree(GetProcessHeap(), 0, buffer);
     }
+    PROFILE_WriteLine( hFile, buffer, len, encoding );
+    HeapFree(GetProcessHeap(), 0, buffer);
 }
 
 
@@ -263,6 +307,7 @@ static void PROFILE_Free( PROFILESECTION *section )
             HeapFree( GetProcessHeap(), 0, key );
         }
         next_section = section->next;
+        HeapFree( GetProcessHeap(), 0, section->key_index );
         HeapFree( GetProcessHeap(), 0, section );
     }
 }
@@ -300,6 +345,13 @@ static inline ENCODING PROFILE_DetectTextEncoding(const void * buffer, int * len
 }
 
 
+static void PROFILE_FreeBuffer(void *buffer, BOOL mapped)
+{
+    if (mapped) UnmapViewOfFile(buffer);
+    else HeapFree(GetProcessHeap(), 0, buffer);
+}
+
+
 /***********************************************************************
  *           PROFILE_Load
  *
@@ -307,7 +359,9 @@ static inline ENCODING PROFILE_DetectTextEncoding(const void * buffer, int * len
  */
 static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
 {
-    void *buffer_base, *pBuffer;
+    void *buffer_base = NULL, *pBuffer;
+    HANDLE mapping;
+    BOOL mapped;
     WCHAR * szFile;
     const WCHAR *szLineStart, *szLineEnd;
     const WCHAR *szValueStart, *szEnd, *next_line;
@@ -323,14 +377,28 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
     if (dwFileSize == INVALID_FILE_SIZE || dwFileSize == 0)
         return NULL;
 
-    buffer_base = HeapAlloc(GetProcessHeap(), 0 , dwFileSize);
-    if (!buffer_base) return NULL;
-    
-    if (!ReadFile(hFile, buffer_base, dwFileSize, &dwFileSize, NULL))
+    /* big files are parsed straight from a private copy-on-write view,
+     * the UTF-16BE byte swapping below writes to it */
+    if (dwFileSize >= PROFILE_MAP_MIN &&
+        (mapping = CreateFileMappingW( hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL )))
     {
-        HeapFree(GetProcessHeap(), 0, buffer_base);
-        WARN("Error %d reading file\n", GetLastError());
-        return NULL;
+        buffer_base = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, dwFileSize );
+        CloseHandle( mapping );
+    }
+
+    if ((mapped = (buffer_base != NULL)))
+        TRACE("mapped %u bytes at %p\n", dwFileSize, buffer_base);
+    else
+    {
+        buffer_base = HeapAlloc(GetProcessHeap(), 0 , dwFileSize);
+        if (!buffer_base) return NULL;
+
+        if (!ReadFile(hFile, buffer_base, dwFileSize, &dwFileSize, NULL))
+        {
+            HeapFree(GetProcessHeap(), 0, buffer_base);
+            WARN("Error %d reading file\n", GetLastError());
+            return NULL;
+        }
     }
     len = dwFileSize;
     *pEncoding = PROFILE_DetectTextEncoding(buffer_base, &len);
@@ -347,7 +415,7 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
         szFile = HeapAlloc(GetProcessHeap(), 0, len * sizeof(WCHAR));
         if (!szFile)
         {
-            HeapFree(GetProcessHeap(), 0, buffer_base);
+            PROFILE_FreeBuffer(buffer_base, mapped);
             return NULL;
         }
         MultiByteToWideChar(CP_ACP, 0, pBuffer, dwFileSize, szFile, len);
@@ -360,7 +428,7 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
         szFile = HeapAlloc(GetProcessHeap(), 0, len * sizeof(WCHAR));
         if (!szFile)
         {
-            HeapFree(GetProcessHeap(), 0, buffer_base);
+            PROFILE_FreeBuffer(buffer_base, mapped);
             return NULL;
         }
         MultiByteToWideChar(CP_UTF8, 0, pBuffer, dwFileSize, szFile, len);
@@ -379,7 +447,7 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
         break;
     default:
         FIXME("encoding type %d not implemented\n", *pEncoding);
-        HeapFree(GetProcessHeap(), 0, buffer_base);
+        PROFILE_FreeBuffer(buffer_base, mapped);
         return NULL;
     }
 
@@ -388,12 +456,14 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
     {
         if (szFile != pBuffer)
             HeapFree(GetProcessHeap(), 0, szFile);
-        HeapFree(GetProcessHeap(), 0, buffer_base);
+        PROFILE_FreeBuffer(buffer_base, mapped);
         return NULL;
     }
     first_section->name[0] = 0;
     first_section->key  = NULL;
     first_section->next = NULL;
+    first_section->key_index = NULL;
+    first_section->hash = 0;
     next_section = &first_section->next;
     next_key     = &first_section->key;
     prev_key     = NULL;
@@ -436,6 +506,8 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
                 section->name[len] = '\0';
                 section->key  = NULL;
                 section->next = NULL;
+                section->key_index = NULL;
+                section->hash = PROFILE_Hash(section->name, len);
                 *next_section = section;
                 next_section  = &section->next;
                 next_key      = &section->key;
@@ -466,6 +538,7 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
             if (!(key = HeapAlloc( GetProcessHeap(), 0, sizeof(*key) + len * sizeof(WCHAR) ))) break;
             memcpy(key->name, szLineStart, len * sizeof(WCHAR));
             key->name[len] = '\0';
+            key->hash = PROFILE_Hash(key->name, len);
             if (szValueStart)
             {
                 len = (int)(szLineEnd - szValueStart);
@@ -486,18 +559,152 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
     }
     if (szFile != pBuffer)
         HeapFree(GetProcessHeap(), 0, szFile);
-    HeapFree(GetProcessHeap(), 0, buffer_base);
+    PROFILE_FreeBuffer(buffer_base, mapped);
     return first_section;
 }
 
 
+/***********************************************************************
+ *           PROFILE_AddSectionIndex
+ *
+ * Append a section to the section index of a profile.
+ */
+static void PROFILE_AddSectionIndex( PROFILE *profile, PROFILESECTION *section )
+{
+    PROFILESECTION **bucket = &profile->section_index[section->hash & (profile->section_index_size - 1)];
+
+    /* keep the buckets in file order, the first of duplicate sections wins */
+    while (*bucket) bucket = &(*bucket)->hash_next;
+    section->hash_next = NULL;
+    *bucket = section;
+}
+
+static void PROFILE_FreeSectionIndex( PROFILE *profile )
+{
+    HeapFree( GetProcessHeap(), 0, profile->section_index );
+    profile->section_index = NULL;
+}
+
+static BOOL PROFILE_BuildSectionIndex( PROFILE *profile )
+{
+    PROFILESECTION *section;
+    UINT count = 0, size;
+
+    for (section = profile->section; section; section = section->next) count++;
+    if (count < PROFILE_INDEX_MIN) return FALSE;
+
+    size = PROFILE_IndexSize( count );
+    profile->section_index = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                        size * sizeof(*profile->section_index) );
+    if (!profile->section_index) return FALSE;
+    profile->section_index_size = size;
+    profile->section_count = count;
+    for (section = profile->section; section; section = section->next)
+        PROFILE_AddSectionIndex( profile, section );
+    return TRUE;
+}
+
+/***********************************************************************
+ *           PROFILE_FindSection
+ *
+ * Find the first section called name (len characters, case insensitive).
+ */
+static PROFILESECTION *PROFILE_FindSection( PROFILE *profile, LPCWSTR name, int len )
+{
+    PROFILESECTION *section;
+    ULONG hash;
+
+    if (!len) return NULL;  /* the unnamed leading section can't be looked up */
+    hash = PROFILE_Hash( name, len );
+
+    if (profile->section_index || PROFILE_BuildSectionIndex( profile ))
+    {
+        for (section = profile->section_index[hash & (profile->section_index_size - 1)];
+             section; section = section->hash_next)
+            if (section->hash == hash && !strncmpiW( section->name, name, len ) && !section->name[len])
+                return section;
+        return NULL;
+    }
+
+    for (section = profile->section; section; section = section->next)
+        if (section->hash == hash && !strncmpiW( section->name, name, len ) && !section->name[len])
+            return section;
+    return NULL;
+}
+
+/***********************************************************************
+ *           PROFILE_AddKeyIndex
+ *
+ * Append a key to the key index of a section.
+ */
+static void PROFILE_AddKeyIndex( PROFILESECTION *section, PROFILEKEY *key )
+{
+    PROFILEKEY **bucket = &section->key_index[key->hash & (section->key_index_size - 1)];
+
+    while (*bucket) bucket = &(*bucket)->hash_next;
+    key->hash_next = NULL;
+    *bucket = key;
+}
+
+static void PROFILE_FreeKeyIndex( PROFILESECTION *section )
+{
+    HeapFree( GetProcessHeap(), 0, section->key_index );
+    section->key_index = NULL;
+}
+
+static BOOL PROFILE_BuildKeyIndex( PROFILESECTION *section )
+{
+    PROFILEKEY *key;
+    UINT count = 0, size;
+
+    for (key = section->key; key; key = key->next) count++;
+    if (count < PROFILE_INDEX_MIN) return FALSE;
+
+    size = PROFILE_IndexSize( count );
+    section->key_index = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                    size * sizeof(*section->key_index) );
+    if (!section->key_index) return FALSE;
+    section->key_index_size = size;
+    section->key_count = count;
+    for (key = section->key; key; key = key->next)
+        PROFILE_AddKeyIndex( section, key );
+    return TRUE;
+}
+
+/***********************************************************************
+ *           PROFILE_FindKey
+ *
+ * Find the first key of a section called name (len characters, case insensitive).
+ */
+static PROFILEKEY *PROFILE_FindKey( PROFILESECTION *section, LPCWSTR name, int len )
+{
+    PROFILEKEY *key;
+    ULONG hash = PROFILE_Hash( name, len );
+
+    if (section->key_index || PROFILE_BuildKeyIndex( section ))
+    {
+        for (key = section->key_index[hash & (section->key_index_size - 1)]; key; key = key->hash_next)
+            if (key->hash == hash && !strncmpiW( key->name, name, len ) && !key->name[len])
+                return key;
+        return NULL;
+    }
+
+    for (key = section->key; key; key = key->next)
+        if (key->hash == hash && !strncmpiW( key->name, name, len ) && !key->name[len])
+            return key;
+    return NULL;
+}
+
+
 /***********************************************************************
  *           PROFILE_DeleteSection
  *
  * Delete a section from a profile tree.
  */
-static BOOL PROFILE_DeleteSection( PROFILESECTION **section, LPCWSTR name )
+static BOOL PROFILE_DeleteSection( PROFILE *profile, LPCWSTR name )
 {
+    PROFILESECTION **section = &profile->section;
+
     while (*section)
     {
         if ((*section)->name[0] && !strcmpiW( (*section)->name, name ))
@@ -506,6 +713,7 @@ static BOOL PROFILE_DeleteSection( PROFILESECTION **section, LPCWSTR name )
             *section = to_del->next;
             to_del->next = NULL;
             PROFILE_Free( to_del );
+            PROFILE_FreeSectionIndex( profile );
             return TRUE;
         }
         section = &(*section)->next;
@@ -535,6 +743,7 @@ static BOOL PROFILE_DeleteKey( PROFILESECTION **section,
                     *key = to_del->next;
                     HeapFree( GetProcessHeap(), 0, to_del->value);
                     HeapFree( GetProcessHeap(), 0, to_del );
+                    PROFILE_FreeKeyIndex( *section );
                     return TRUE;
                 }
                 key = &(*key)->next;
@@ -567,6 +776,7 @@ static void PROFILE_DeleteAllKeys( LPCWSTR section_name)
 		HeapFree( GetProcessHeap(), 0, to_del );
 		CurProfile->changed =TRUE;
             }
+            PROFILE_FreeKeyIndex( *section );
         }
         section = &(*section)->next;
     }
@@ -578,78 +788,85 @@ static void PROFILE_DeleteAllKeys( LPCWSTR section_name)
  *
  * Find a key in a profile tree, optionally creating it.
  */
-static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
+static PROFILEKEY *PROFILE_Find( PROFILE *profile, LPCWSTR section_name,
                                  LPCWSTR key_name, BOOL create, BOOL create_always )
 {
-    LPCWSTR p;
+    PROFILESECTION *section, **next_section;
+    PROFILEKEY *key, **next_key;
     int seclen, keylen;
 
     while (PROFILE_isspaceW(*section_name)) section_name++;
-    if (*section_name)
-        p = section_name + strlenW(section_name) - 1;
-    else
-        p = section_name;
-
-    while ((p > section_name) && PROFILE_isspaceW(*p)) p--;
-    seclen = p - section_name + 1;
+    seclen = strlenW(section_name);
+    while (seclen && PROFILE_isspaceW(section_name[seclen - 1])) seclen--;
 
     while (PROFILE_isspaceW(*key_name)) key_name++;
-    if (*key_name)
-        p = key_name + strlenW(key_name) - 1;
-    else
-        p = key_name;
+    keylen = strlenW(key_name);
+    while (keylen && PROFILE_isspaceW(key_name[keylen - 1])) keylen--;
 
-    while ((p > key_name) && PROFILE_isspaceW(*p)) p--;
-    keylen = p - key_name + 1;
-
-    while (*section)
+    if ((section = PROFILE_FindSection( profile, section_name, seclen )))
     {
-        if ( ((*section)->name[0])
-             && (!(strncmpiW( (*section)->name, section_name, seclen )))
-             && (((*section)->name)[seclen] == '\0') )
+        /* If create_always is FALSE then we check if the keyname
+         * already exists. Otherwise we add it regardless of its
+         * existence, to allow keys to be added more than once in
+         * some cases.
+         */
+        if (!create_always && (key = PROFILE_FindKey( section, key_name, keylen )))
+            return key;
+        if (!create) return NULL;
+    }
+    else
+    {
+        if (!create) return NULL;
+        section = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILESECTION) + strlenW(section_name) * sizeof(WCHAR) );
+        if (section == NULL) return NULL;
+        strcpyW( section->name, section_name );
+        section->hash = PROFILE_Hash( section->name, strlenW(section->name) );
+        section->key = NULL;
+        section->next = NULL;
+        section->key_index = NULL;
+
+        for (next_section = &profile->section; *next_section; next_section = &(*next_section)->next);
+        *next_section = section;
+        if (profile->section_index)
         {
-            PROFILEKEY **key = &(*section)->key;
-
-            while (*key)
-            {
-                /* If create_always is FALSE then we check if the keyname
-                 * already exists. Otherwise we add it regardless of its
-                 * existence, to allow keys to be added more than once in
-                 * some cases.
-                 */
-                if(!create_always)
-                {
-                    if ( (!(strncmpiW( (*key)->name, key_name, keylen )))
-                         && (((*key)->name)[keylen] == '\0') )
-                        return *key;
-                }
-                key = &(*key)->next;
-            }
-            if (!create) return NULL;
-            if (!(*key = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILEKEY) + strlenW(key_name) * sizeof(WCHAR) )))
-                return NULL;
-            strcpyW( (*key)->name, key_name );
-            (*key)->value = NULL;
-            (*key)->next  = NULL;
-            return *key;
+            if (++profile->section_count > 2 * profile->section_index_size)
+                PROFILE_FreeSectionIndex( profile );
+            else
+                PROFILE_AddSectionIndex( profile, section );
         }
-        section = &(*section)->next;
     }
-    if (!create) return NULL;
-    *section = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILESECTION) + strlenW(section_name) * sizeof(WCHAR) );
-    if(*section == NULL) return NULL;
-    strcpyW( (*section)->name, section_name );
-    (*section)->next = NULL;
-    if (!((*section)->key  = HeapAlloc( GetProcessHeap(), 0,
-                                        sizeof(PROFILEKEY) + strlenW(key_name) * sizeof(WCHAR) )))
-    {
-        HeapFree(GetProcessHeap(), 0, *section);
+
+    if (!(key = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILEKEY) + strlenW(key_name) * sizeof(WCHAR) )))
         return NULL;
+    strcpyW( key->name, key_name );
+    key->hash  = PROFILE_Hash( key->name, strlenW(key->name) );
+    key->value = NULL;
+    key->next  = NULL;
+
+    for (next_key = &section->key; *next_key; next_key = &(*next_key)->next);
+    *next_key = key;
+    if (section->key_index)
+    {
+        if (++section->key_count > 2 * section->key_index_size)
+            PROFILE_FreeKeyIndex( section );
+        else
+            PROFILE_AddKeyIndex( section, key );
     }
-    strcpyW( (*section)->key->name, key_name );
-    (*section)->key->value = NULL;
-    (*section)->key->next  = NULL;
-    return (*section)->key;
+    return key;
+}
+
+
+/***********************************************************************
+ *           PROFILE_SetFileInfo
+ *
+ * Remember which file, and which version of it, a profile was loaded from.
+ */
+static void PROFILE_SetFileInfo( PROFILE *profile, const BY_HANDLE_FILE_INFORMATION *info )
+{
+    profile->LastWriteTime = info->ftLastWriteTime;
+    profile->size = ((ULONGLONG)info->nFileSizeHigh << 32) | info->nFileSizeLow;
+    profile->file_index = ((ULONGLONG)info->nFileIndexHigh << 32) | info->nFileIndexLow;
+    profile->volume = info->dwVolumeSerialNumber;
 }
 
 
@@ -661,7 +878,7 @@ static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
 static BOOL PROFILE_FlushFile(void)
 {
     HANDLE hFile = NULL;
-    FILETIME LastWriteTime;
+    BY_HANDLE_FILE_INFORMATION info;
 
     if(!CurProfile)
     {
@@ -682,8 +899,8 @@ static BOOL PROFILE_FlushFile(void)
 
     TRACE("Saving %s\n", debugstr_w(CurProfile->filename));
     PROFILE_Save( hFile, CurProfile->section, CurProfile->encoding );
-    if(GetFileTime(hFile, NULL, NULL, &LastWriteTime))
-       CurProfile->LastWriteTime=LastWriteTime;
+    if (GetFileInformationByHandle( hFile, &info ))
+        PROFILE_SetFileInfo( CurProfile, &info );
     CloseHandle( hFile );
     CurProfile->changed = FALSE;
     return TRUE;
@@ -699,11 +916,13 @@ static void PROFILE_ReleaseFile(void)
 {
     PROFILE_FlushFile();
     PROFILE_Free( CurProfile->section );
+    PROFILE_FreeSectionIndex( CurProfile );
     HeapFree( GetProcessHeap(), 0, CurProfile->filename );
     CurProfile->changed = FALSE;
     CurProfile->section = NULL;
     CurProfile->filename  = NULL;
     CurProfile->encoding = ENCODING_ANSI;
+    CurProfile->size = 0;
     ZeroMemory(&CurProfile->LastWriteTime, sizeof(CurProfile->LastWriteTime));
 }
 
@@ -727,6 +946,55 @@ static BOOL is_not_current(FILETIME * ft)
     return ftll + 21000000 < nowll;
 }
 
+/***********************************************************************
+ *           PROFILE_GetCacheSize
+ *
+ * Get the number of profile files to keep in memory.
+ */
+static UINT PROFILE_GetCacheSize(void)
+{
+    static const WCHAR profileW[] = {'S','o','f','t','w','a','r','e','\\',
+                                     'W','i','n','e','\\','P','r','o','f','i','l','e',0};
+    static const WCHAR cachesizeW[] = {'C','a','c','h','e','S','i','z','e',0};
+
+    char tmp[80];
+    HANDLE root, hkey;
+    DWORD dummy;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING nameW;
+    UINT ret = N_CACHED_PROFILES;
+
+    if (RtlOpenCurrentUser( KEY_READ, &root )) return ret;
+    attr.Length = sizeof(attr);
+    attr.RootDirectory = root;
+    attr.ObjectName = &nameW;
+    attr.Attributes = 0;
+    attr.SecurityDescriptor = NULL;
+    attr.SecurityQualityOfService = NULL;
+    RtlInitUnicodeString( &nameW, profileW );
+
+    /* @@ Wine registry key: HKCU\Software\Wine\Profile */
+    if (!NtOpenKey( &hkey, KEY_READ, &attr ))
+    {
+        KEY_VALUE_PARTIAL_INFORMATION *info = (KEY_VALUE_PARTIAL_INFORMATION *)tmp;
+
+        memset( tmp, 0, sizeof(tmp) );
+        RtlInitUnicodeString( &nameW, cachesizeW );
+        if (!NtQueryValueKey( hkey, &nameW, KeyValuePartialInformation,
+                              tmp, sizeof(tmp) - sizeof(WCHAR), &dummy ))
+        {
+            if (info->Type == REG_DWORD) ret = *(DWORD *)info->Data;
+            else if (info->Type == REG_SZ) ret = atoiW( (WCHAR *)info->Data );
+        }
+        NtClose( hkey );
+    }
+    NtClose( root );
+
+    ret = max( 1, min( ret, MAX_CACHED_PROFILES ));
+    TRACE("caching %u profile files\n", ret);
+    return ret;
+}
+
 /***********************************************************************
  *           PROFILE_Open
  *
@@ -736,25 +1004,26 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
 {
     WCHAR buffer[MAX_PATH];
     HANDLE hFile = INVALID_HANDLE_VALUE;
-    FILETIME LastWriteTime;
-    int i,j;
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    BY_HANDLE_FILE_INFORMATION info;
+    ULONG hash;
+    UINT i,j;
     PROFILE *tempProfile;
-    
-    ZeroMemory(&LastWriteTime, sizeof(LastWriteTime));
 
     /* First time around */
 
     if(!CurProfile)
-       for(i=0;i<N_CACHED_PROFILES;i++)
+    {
+       n_cached_profiles = PROFILE_GetCacheSize();
+       for(i=0;i<n_cached_profiles;i++)
        {
-          MRUProfile[i]=HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILE) );
+          MRUProfile[i]=HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(PROFILE) );
           if(MRUProfile[i] == NULL) break;
-          MRUProfile[i]->changed=FALSE;
-          MRUProfile[i]->section=NULL;
-          MRUProfile[i]->filename=NULL;
           MRUProfile[i]->encoding=ENCODING_ANSI;
-          ZeroMemory(&MRUProfile[i]->LastWriteTime, sizeof(FILETIME));
        }
+       if (!i) return FALSE;
+       n_cached_profiles = i;
+    }
 
     if (!filename)
 	filename = wininiW;
@@ -777,6 +1046,38 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
         
     TRACE("path: %s\n", debugstr_w(buffer));
 
+    hash = PROFILE_Hash( buffer, strlenW(buffer) );
+    for(i=0;i<n_cached_profiles;i++)
+    {
+        if (MRUProfile[i]->filename && MRUProfile[i]->filename_hash == hash &&
+            !strcmpiW( buffer, MRUProfile[i]->filename ))
+            break;
+    }
+
+    if (i < n_cached_profiles)
+    {
+        TRACE("MRU Filename: %s, new filename: %s\n", debugstr_w(MRUProfile[i]->filename), debugstr_w(buffer));
+        if(i)
+        {
+            PROFILE_FlushFile();
+            tempProfile=MRUProfile[i];
+            for(j=i;j>0;j--)
+                MRUProfile[j]=MRUProfile[j-1];
+            CurProfile=tempProfile;
+        }
+
+        /* Reading a file that didn't change since it was loaded doesn't
+         * need to open it, its attributes are enough to tell. */
+        if (!write_access && GetFileAttributesExW( buffer, GetFileExInfoStandard, &data ) &&
+            !memcmp( &CurProfile->LastWriteTime, &data.ftLastWriteTime, sizeof(FILETIME) ) &&
+            CurProfile->size == (((ULONGLONG)data.nFileSizeHigh << 32) | data.nFileSizeLow) &&
+            is_not_current(&data.ftLastWriteTime))
+        {
+            TRACE("(%s): already opened (mru=%u)\n", debugstr_w(buffer), i);
+            return TRUE;
+        }
+    }
+
     hFile = CreateFileW(buffer, GENERIC_READ | (write_access ? GENERIC_WRITE : 0),
                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
@@ -787,64 +1088,74 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
         return FALSE;
     }
 
-    for(i=0;i<N_CACHED_PROFILES;i++)
+    if (i < n_cached_profiles)
     {
-        if ((MRUProfile[i]->filename && !strcmpiW( buffer, MRUProfile[i]->filename )))
+        if (hFile != INVALID_HANDLE_VALUE)
         {
-            TRACE("MRU Filename: %s, new filename: %s\n", debugstr_w(MRUProfile[i]->filename), debugstr_w(buffer));
-            if(i)
-            {
-                PROFILE_FlushFile();
-                tempProfile=MRUProfile[i];
-                for(j=i;j>0;j--)
-                    MRUProfile[j]=MRUProfile[j-1];
-                CurProfile=tempProfile;
-            }
-
-            if (hFile != INVALID_HANDLE_VALUE)
+            BOOL have_info = GetFileInformationByHandle(hFile, &info);
+
+            /* the file may also have been replaced by another one, assume it was if we can't tell */
+            if (have_info &&
+                !memcmp( &CurProfile->LastWriteTime, &info.ftLastWriteTime, sizeof(FILETIME) ) &&
+                CurProfile->size == (((ULONGLONG)info.nFileSizeHigh << 32) | info.nFileSizeLow) &&
+                CurProfile->file_index == (((ULONGLONG)info.nFileIndexHigh << 32) | info.nFileIndexLow) &&
+                CurProfile->volume == info.dwVolumeSerialNumber &&
+                is_not_current(&info.ftLastWriteTime))
+                TRACE("(%s): already opened (mru=%u)\n",
+                      debugstr_w(buffer), i);
+            else
             {
-                GetFileTime(hFile, NULL, NULL, &LastWriteTime);
-                if (!memcmp( &CurProfile->LastWriteTime, &LastWriteTime, sizeof(FILETIME) ) &&
-                    is_not_current(&LastWriteTime))
-                    TRACE("(%s): already opened (mru=%d)\n",
-                          debugstr_w(buffer), i);
-                else
-                {
-                    TRACE("(%s): already opened, needs refreshing (mru=%d)\n",
-                          debugstr_w(buffer), i);
-                    PROFILE_Free(CurProfile->section);
-                    CurProfile->section = PROFILE_Load(hFile, &CurProfile->encoding);
-                    CurProfile->LastWriteTime = LastWriteTime;
-                }
-                CloseHandle(hFile);
-                return TRUE;
+                TRACE("(%s): already opened, needs refreshing (mru=%u)\n",
+                      debugstr_w(buffer), i);
+                PROFILE_Free(CurProfile->section);
+                PROFILE_FreeSectionIndex(CurProfile);
+                CurProfile->section = PROFILE_Load(hFile, &CurProfile->encoding);
+                if (have_info)
+                    PROFILE_SetFileInfo(CurProfile, &info);
             }
-            else TRACE("(%s): already opened, not yet created (mru=%d)\n",
-                       debugstr_w(buffer), i);
+            CloseHandle(hFile);
         }
+        else if (CurProfile->changed)
+        {
+            /* don't lose the pending changes, write them to a new file */
+            TRACE("(%s): already opened, not yet created (mru=%u)\n",
+                  debugstr_w(buffer), i);
+            PROFILE_FlushFile();
+        }
+        else
+        {
+            TRACE("(%s): already opened, file no longer exists (mru=%u)\n",
+                  debugstr_w(buffer), i);
+            PROFILE_Free(CurProfile->section);
+            PROFILE_FreeSectionIndex(CurProfile);
+            CurProfile->section = NULL;
+            CurProfile->changed = FALSE;
+            CurProfile->size = 0;
+            ZeroMemory(&CurProfile->LastWriteTime, sizeof(CurProfile->LastWriteTime));
+        }
+        return TRUE;
     }
 
     /* Flush the old current profile */
     PROFILE_FlushFile();
 
     /* Make the oldest profile the current one only in order to get rid of it */
-    if(i==N_CACHED_PROFILES)
-      {
-       tempProfile=MRUProfile[N_CACHED_PROFILES-1];
-       for(i=N_CACHED_PROFILES-1;i>0;i--)
-          MRUProfile[i]=MRUProfile[i-1];
-       CurProfile=tempProfile;
-      }
+    tempProfile=MRUProfile[n_cached_profiles-1];
+    for(i=n_cached_profiles-1;i>0;i--)
+        MRUProfile[i]=MRUProfile[i-1];
+    CurProfile=tempProfile;
     if(CurProfile->filename) PROFILE_ReleaseFile();
 
     /* OK, now that CurProfile is definitely free we assign it our new file */
     CurProfile->filename  = HeapAlloc( GetProcessHeap(), 0, (strlenW(buffer)+1) * sizeof(WCHAR) );
     strcpyW( CurProfile->filename, buffer );
+    CurProfile->filename_hash = hash;
 
     if (hFile != INVALID_HANDLE_VALUE)
     {
         CurProfile->section = PROFILE_Load(hFile, &CurProfile->encoding);
-        GetFileTime(hFile, NULL, NULL, &CurProfile->LastWriteTime);
+        if (GetFileInformationByHandle(hFile, &info))
+            PROFILE_SetFileInfo(CurProfile, &info);
         CloseHandle(hFile);
     }
     else
@@ -862,55 +1173,53 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
  * Returns all keys of a section.
  * If return_values is TRUE, also include the corresponding values.
  */
-static INT PROFILE_GetSection( PROFILESECTION *section, LPCWSTR section_name,
+static INT PROFILE_GetSection( PROFILE *profile, LPCWSTR section_name,
 			       LPWSTR buffer, UINT len, BOOL return_values )
 {
+    PROFILESECTION *section;
     PROFILEKEY *key;
+    UINT oldlen = len;
 
     if(!buffer) return 0;
 
     TRACE("%s,%p,%u\n", debugstr_w(section_name), buffer, len);
 
-    while (section)
+    if (!(section = PROFILE_FindSection( profile, section_name, strlenW(section_name) )))
     {
-        if (section->name[0] && !strcmpiW( section->name, section_name ))
-        {
-            UINT oldlen = len;
-            for (key = section->key; key; key = key->next)
-            {
-                if (len <= 2) break;
-                if (!*key->name) continue;  /* Skip empty lines */
-                if (IS_ENTRY_COMMENT(key->name)) continue;  /* Skip comments */
-                if (!return_values && !key->value) continue;  /* Skip lines w.o. '=' */
-                PROFILE_CopyEntry( buffer, key->name, len - 1, 0 );
-                len -= strlenW(buffer) + 1;
-                buffer += strlenW(buffer) + 1;
-		if (len < 2)
-		    break;
-		if (return_values && key->value) {
-			buffer[-1] = '=';
-			PROFILE_CopyEntry ( buffer, key->value, len - 1, 0 );
-			len -= strlenW(buffer) + 1;
-			buffer += strlenW(buffer) + 1;
-                }
-            }
-            *buffer = '\0';
-            if (len <= 1)
-                /*If either lpszSection or lpszKey is NULL and the supplied
-                  destination buffer is too small to hold all the strings,
-                  the last string is truncated and followed by two null characters.
-                  In this case, the return value is equal to cchReturnBuffer
-                  minus two. */
-            {
-		buffer[-1] = '\0';
-                return oldlen - 2;
-            }
-            return oldlen - len;
+        buffer[0] = buffer[1] = '\0';
+        return 0;
+    }
+
+    for (key = section->key; key; key = key->next)
+    {
+        if (len <= 2) break;
+        if (!*key->name) continue;  /* Skip empty lines */
+        if (IS_ENTRY_COMMENT(key->name)) continue;  /* Skip comments */
+        if (!return_values && !key->value) continue;  /* Skip lines w.o. '=' */
+        PROFILE_CopyEntry( buffer, key->name, len - 1, 0 );
+        len -= strlenW(buffer) + 1;
+        buffer += strlenW(buffer) + 1;
+        if (len < 2)
+            break;
+        if (return_values && key->value) {
+            buffer[-1] = '=';
+            PROFILE_CopyEntry ( buffer, key->value, len - 1, 0 );
+            len -= strlenW(buffer) + 1;
+            buffer += strlenW(buffer) + 1;
         }
-        section = section->next;
     }
-    buffer[0] = buffer[1] = '\0';
-    return 0;
+    *buffer = '\0';
+    if (len <= 1)
+        /*If either lpszSection or lpszKey is NULL and the supplied
+          destination buffer is too small to hold all the strings,
+          the last string is truncated and followed by two null characters.
+          In this case, the return value is equal to cchReturnBuffer
+          minus two. */
+    {
+        buffer[-1] = '\0';
+        return oldlen - 2;
+    }
+    return oldlen - len;
 }
 
 /* See GetPrivateProfileSectionNamesA for documentation */
@@ -993,7 +1302,7 @@ static INT PROFILE_GetString( LPCWSTR section, LPCWSTR key_name,
             PROFILE_CopyEntry(buffer, def_val, len, TRUE);
             return strlenW(buffer);
         }
-        key = PROFILE_Find( &CurProfile->section, section, key_name, FALSE, FALSE);
+        key = PROFILE_Find( CurProfile, section, key_name, FALSE, FALSE);
         PROFILE_CopyEntry( buffer, (key && key->value) ? key->value : def_val,
                            len, TRUE );
         TRACE("(%s,%s,%s): returning %s\n",
@@ -1004,7 +1313,7 @@ static INT PROFILE_GetString( LPCWSTR section, LPCWSTR key_name,
     /* no "else" here ! */
     if (section && section[0])
     {
-        INT ret = PROFILE_GetSection(CurProfile->section, section, buffer, len, FALSE);
+        INT ret = PROFILE_GetSection(CurProfile, section, buffer, len, FALSE);
         if (!buffer[0]) /* no luck -> def_val */
         {
             PROFILE_CopyEntry(buffer, def_val, len, TRUE);
@@ -1028,8 +1337,7 @@ static BOOL PROFILE_SetString( LPCWSTR section_name, LPCWSTR key_name,
     if (!key_name)  /* Delete a whole section */
     {
         TRACE("(%s)\n", debugstr_w(section_name));
-        CurProfile->changed |= PROFILE_DeleteSection( &CurProfile->section,
-                                                      section_name );
+        CurProfile->changed |= PROFILE_DeleteSection( CurProfile, section_name );
         return TRUE;         /* Even if PROFILE_DeleteSection() has failed,
                                 this is not an error on application's level.*/
     }
@@ -1042,7 +1350,7 @@ static BOOL PROFILE_SetString( LPCWSTR section_name, LPCWSTR key_name,
     }
     else  /* Set the key value */
     {
-        PROFILEKEY *key = PROFILE_Find(&CurProfile->section, section_name,
+        PROFILEKEY *key = PROFILE_Find(CurProfile, section_name,
                                         key_name, TRUE, create_always );
         TRACE("(%s,%s,%s):\n",
               debugstr_w(section_name), debugstr_w(key_name), debugstr_w(value) );
@@ -1298,7 +1606,7 @@ INT WINAPI GetPrivateProfileSectionW( LPCWSTR section, LPWSTR buffer,
     RtlEnterCriticalSection( &PROFILE_CritSect );
 
     if (PROFILE_Open( filename, FALSE ))
-        ret = PROFILE_GetSection(CurProfile->section, section, buffer, len, TRUE);
+        ret = PROFILE_GetSection(CurProfile, section, buffer, len, TRUE);
 
     RtlLeaveCriticalSection( &PROFILE_CritSect );
 
@@ -1623,7 +1931,7 @@ BOOL WINAPI GetPrivateProfileStructW (LPCWSTR section, LPCWSTR key,
     RtlEnterCriticalSection( &PROFILE_CritSect );
 
     if (PROFILE_Open( filename, FALSE )) {
-        PROFILEKEY *k = PROFILE_Find ( &CurProfile->section, section, key, FALSE, FALSE);
+        PROFILEKEY *k = PROFILE_Find ( CurProfile, section, key, FALSE, FALSE);
 	if (k) {
 	    TRACE("value (at %p): %s\n", k->value, debugstr_w(k->value));
 	    if (((strlenW(k->value) - 2) / 2) == len)
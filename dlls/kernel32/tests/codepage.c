@@ -462,6 +462,53 @@ static void test_undefined_byte_char(void)
     }
 }
 
+static void test_long_strings(void)
+{
+    WCHAR strW[1000], bufW[1000];
+    char str1252[1000], strutf8[2000], buf[2000];
+    int i, len, ret;
+
+    /* long ASCII runs broken up by non-ASCII chars at irregular intervals */
+    for (i = len = 0; i < sizeof(strW)/sizeof(strW[0]); i++)
+    {
+        if (i % 37 == 36)
+        {
+            strW[i] = 0xe4;
+            str1252[i] = '\xe4';
+            strutf8[len++] = '\xc3';
+            strutf8[len++] = '\xa4';
+        }
+        else strW[i] = str1252[i] = strutf8[len++] = 'a' + i % 26;
+    }
+
+    ret = MultiByteToWideChar(1252, 0, str1252, sizeof(str1252), bufW, sizeof(bufW)/sizeof(bufW[0]));
+    ok(ret == sizeof(strW)/sizeof(strW[0]), "ret is %d\n", ret);
+    ok(!memcmp(bufW, strW, sizeof(strW)), "wrong conversion from 1252\n");
+
+    ret = WideCharToMultiByte(1252, 0, strW, sizeof(strW)/sizeof(strW[0]), buf, sizeof(buf), NULL, NULL);
+    ok(ret == sizeof(str1252), "ret is %d\n", ret);
+    ok(!memcmp(buf, str1252, sizeof(str1252)), "wrong conversion to 1252\n");
+
+    ret = MultiByteToWideChar(CP_UTF8, 0, strutf8, len, bufW, sizeof(bufW)/sizeof(bufW[0]));
+    ok(ret == sizeof(strW)/sizeof(strW[0]), "ret is %d\n", ret);
+    ok(!memcmp(bufW, strW, sizeof(strW)), "wrong conversion from UTF-8\n");
+
+    ret = WideCharToMultiByte(CP_UTF8, 0, strW, sizeof(strW)/sizeof(strW[0]), buf, sizeof(buf), NULL, NULL);
+    ok(ret == len, "ret is %d\n", ret);
+    ok(!memcmp(buf, strutf8, len), "wrong conversion to UTF-8\n");
+
+    /* destination too small in the middle of an ASCII run */
+    SetLastError(0xdeadbeef);
+    ret = MultiByteToWideChar(CP_UTF8, 0, strutf8, len, bufW, 100);
+    ok(!ret, "ret is %d\n", ret);
+    ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "GetLastError() is %u\n", GetLastError());
+
+    SetLastError(0xdeadbeef);
+    ret = WideCharToMultiByte(1252, 0, strW, sizeof(strW)/sizeof(strW[0]), buf, 100, NULL, NULL);
+    ok(!ret, "ret is %d\n", ret);
+    ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "GetLastError() is %u\n", GetLastError());
+}
+
 START_TEST(codepage)
 {
     BOOL bUsedDefaultChar;
@@ -478,4 +525,5 @@ START_TEST(codepage)
     test_string_conversion(&bUsedDefaultChar);
 
     test_undefined_byte_char();
+    test_long_strings();
 }
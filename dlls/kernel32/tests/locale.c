@@ -1292,6 +1292,9 @@ struct comparestringa_entry {
   int ret;
 };
 
+/* the accented strings are in code page 1252 */
+#define LCID_EN_US MAKELCID(MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US), SORT_DEFAULT)
+
 static const struct comparestringa_entry comparestringa_data[] = {
   { LOCALE_SYSTEM_DEFAULT, 0, "EndDialog", -1, "_Property", -1, CSTR_GREATER_THAN },
   { LOCALE_SYSTEM_DEFAULT, 0, "osp_vba.sreg0070", -1, "_IEWWBrowserComp", -1, CSTR_GREATER_THAN },
@@ -1321,6 +1324,63 @@ static const struct comparestringa_entry comparestringa_data[] = {
   { LOCALE_SYSTEM_DEFAULT, 0, "/m", -1, "'o", -1, CSTR_LESS_THAN },
   { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "'o", -1, "/m", -1, CSTR_LESS_THAN },
   { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "/m", -1, "'o", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "coop", -1, "co-op", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "co-op", -1, "Co-op", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, "co-op", -1, "Co-op", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "coop", -1, "co-op", -1, CSTR_GREATER_THAN },
+  /* case only differences, compared in step */
+  { LOCALE_SYSTEM_DEFAULT, 0, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORECASE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORECASE | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORECASE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORECASE | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORECASE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORECASE | NORM_IGNORENONSPACE, "aBc", -1, "abc", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, 0, "Abc", -1, "aBc", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS, "a.Bc", -1, "a.bc", -1, CSTR_GREATER_THAN },
+  /* case only differences after a hyphen, the strings are compared out of step */
+  { LOCALE_SYSTEM_DEFAULT, 0, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "coop", -1, "co-Op", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORECASE, "co-Op", -1, "coop", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORECASE | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "co-Op", -1, "coop", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORECASE, "co-Op", -1, "coop", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORECASE | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORECASE, "co-Op", -1, "coop", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT | NORM_IGNORESYMBOLS | NORM_IGNORECASE | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1, CSTR_EQUAL },
+  /* same with an apostrophe */
+  { LOCALE_SYSTEM_DEFAULT, 0, "O'Neill", -1, "oneill", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, "O'Neill", -1, "oneill", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORESYMBOLS | NORM_IGNORECASE, "O'Neill", -1, "oneill", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "O'Neill", -1, "oneill", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "o'neill", -1, "O'Neill", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "can't", -1, "cant", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, SORT_STRINGSORT, "can't", -1, "cant", -1, CSTR_LESS_THAN },
+  /* diacritic only differences */
+  { LCID_EN_US, NORM_IGNORENONSPACE, "resume", -1, "r\xe9sum\xe9", -1, CSTR_EQUAL },
+  { LCID_EN_US, NORM_IGNORENONSPACE, "Resume", -1, "r\xe9sum\xe9", -1, CSTR_GREATER_THAN },
+  { LCID_EN_US, NORM_IGNORENONSPACE | NORM_IGNORECASE, "R\xe9sum\xe9", -1, "resume", -1, CSTR_EQUAL },
+  { LCID_EN_US, 0, "r\xe9sum\xe9", -1, "R\xe9sum\xe9", -1, CSTR_LESS_THAN },
+  { LCID_EN_US, NORM_IGNORECASE, "r\xe9sum\xe9", -1, "R\xe9sum\xe9", -1, CSTR_EQUAL },
+  { LCID_EN_US, 0, "R\xe9sum\xe9", -1, "resume", -1, CSTR_GREATER_THAN },
+  { LCID_EN_US, NORM_IGNORENONSPACE, "co-\xf6p", -1, "co\xf6p", -1, CSTR_GREATER_THAN },
+  { LCID_EN_US, NORM_IGNORENONSPACE, "co-op", -1, "co\xf6p", -1, CSTR_GREATER_THAN },
   { LOCALE_SYSTEM_DEFAULT, 0, "aLuZkUtZ", 8, "aLuZkUtZ", 9, CSTR_EQUAL },
   { LOCALE_SYSTEM_DEFAULT, 0, "aLuZkUtZ", 7, "aLuZkUtZ\0A", 10, CSTR_LESS_THAN }
 };
@@ -1340,6 +1400,19 @@ static void test_CompareStringA(void)
       ok(ret == entry->ret, "%d: got %d, expected %d\n", i, ret, entry->ret);
   }
 
+  /* diacritics are compared before case, and before hyphens and apostrophes */
+  ret = CompareStringA(LCID_EN_US, 0, "resume", -1, "r\xe9sum\xe9", -1);
+  todo_wine ok(ret == CSTR_LESS_THAN, "(resume/r\\xe9sum\\xe9) Expected CSTR_LESS_THAN, got %d\n", ret);
+
+  ret = CompareStringA(LCID_EN_US, 0, "Resume", -1, "r\xe9sum\xe9", -1);
+  todo_wine ok(ret == CSTR_LESS_THAN, "(Resume/r\\xe9sum\\xe9) Expected CSTR_LESS_THAN, got %d\n", ret);
+
+  ret = CompareStringA(LCID_EN_US, 0, "co-op", -1, "co\xf6p", -1);
+  todo_wine ok(ret == CSTR_LESS_THAN, "(co-op/co\\xf6p) Expected CSTR_LESS_THAN, got %d\n", ret);
+
+  ret = CompareStringA(LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE | NORM_IGNORENONSPACE, "co-Op", -1, "coop", -1);
+  todo_wine ok(ret == CSTR_GREATER_THAN, "(co-Op/coop) Expected CSTR_GREATER_THAN, got %d\n", ret);
+
   ret = CompareStringA(lcid, NORM_IGNORECASE, "Salut", -1, "Salute", -1);
   ok (ret == CSTR_LESS_THAN, "(Salut/Salute) Expected CSTR_LESS_THAN, got %d\n", ret);
 
@@ -520,6 +520,109 @@ static void create_test_file(LPCSTR name, LPCSTR data, DWORD size)
     CloseHandle(hfile);
 }
 
+static void test_profile_cache(void)
+{
+    char temp[MAX_PATH], path[20][MAX_PATH], section[32], key[32], expect[64], buf[64];
+    char *data, *p;
+    WCHAR *dataW, *q;
+    int i, j, k, round, len;
+    DWORD ret;
+
+    GetTempPathA(MAX_PATH, temp);
+
+    /* more files than wine used to cache, each with enough sections and keys to be indexed */
+    data = HeapAlloc(GetProcessHeap(), 0, 0x10000);
+    for (i = 0; i < 20; i++)
+    {
+        sprintf(path[i], "%swine_cache%d.ini", temp, i);
+        p = data;
+        for (j = 0; j < 20; j++)
+        {
+            p += sprintf(p, "[Section%d]\r\n", j);
+            for (k = 0; k < 20; k++) p += sprintf(p, "Key%d=%d.%d.%d\r\n", k, i, j, k);
+        }
+        p += sprintf(p, "[Dup]\r\nkey=first\r\nKEY=second\r\n[dup]\r\nkey=third\r\nother=fourth\r\n");
+        create_test_file(path[i], data, p - data);
+    }
+
+    for (round = 0; round < 3; round++)
+    {
+        for (i = 0; i < 20; i++)
+        {
+            j = (i + round * 7) % 20;
+            k = (i * 3 + round) % 20;
+            sprintf(section, round == 1 ? "  SECTION%d " : "section%d", j);
+            sprintf(key, round == 2 ? " kEy%d  " : "key%d", k);
+            sprintf(expect, "%d.%d.%d", i, j, k);
+            ret = GetPrivateProfileStringA(section, key, "default", buf, sizeof(buf), path[i]);
+            ok(ret == strlen(expect) && !strcmp(buf, expect), "%d: [%s] %s: got %s\n", i, section, key, buf);
+        }
+    }
+
+    /* the first of duplicate sections and keys is used */
+    ret = GetPrivateProfileStringA("dup", "key", "default", buf, sizeof(buf), path[3]);
+    ok(ret == 5 && !strcmp(buf, "first"), "got %s\n", buf);
+    ret = GetPrivateProfileStringA("dup", "other", "default", buf, sizeof(buf), path[3]);
+    ok(ret == 7 && !strcmp(buf, "default"), "got %s\n", buf);
+
+    /* modifications through the cache */
+    ret = WritePrivateProfileStringA("Section5", "NewKey", "new", path[4]);
+    ok(ret, "WritePrivateProfileString failed\n");
+    ret = GetPrivateProfileStringA("section5", "newkey", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 3 && !strcmp(buf, "new"), "got %s\n", buf);
+    ret = GetPrivateProfileStringA("section5", "key19", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 6 && !strcmp(buf, "4.5.19"), "got %s\n", buf);
+
+    ret = WritePrivateProfileStringA("Section5", "key0", NULL, path[4]);
+    ok(ret, "WritePrivateProfileString failed\n");
+    ret = GetPrivateProfileStringA("section5", "key0", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 7 && !strcmp(buf, "default"), "got %s\n", buf);
+    ret = GetPrivateProfileStringA("section5", "key1", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 5 && !strcmp(buf, "4.5.1"), "got %s\n", buf);
+
+    ret = WritePrivateProfileStringA("Section6", NULL, NULL, path[4]);
+    ok(ret, "WritePrivateProfileString failed\n");
+    ret = GetPrivateProfileStringA("section6", "key1", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 7 && !strcmp(buf, "default"), "got %s\n", buf);
+    ret = GetPrivateProfileStringA("section7", "key1", "default", buf, sizeof(buf), path[4]);
+    ok(ret == 5 && !strcmp(buf, "4.7.1"), "got %s\n", buf);
+
+    for (i = 0; i < 20; i++)
+    {
+        sprintf(section, "Added%d", i);
+        ret = WritePrivateProfileStringA(section, "key", section, path[5]);
+        ok(ret, "WritePrivateProfileString failed\n");
+    }
+    for (i = 0; i < 20; i++)
+    {
+        sprintf(section, "added%d", i);
+        ret = GetPrivateProfileStringA(section, "KEY", "default", buf, sizeof(buf), path[5]);
+        ok(ret == strlen(section) && !lstrcmpiA(buf, section), "got %s\n", buf);
+    }
+
+    /* a big UTF-16 big endian file */
+    dataW = HeapAlloc(GetProcessHeap(), 0, 0x30000 * sizeof(WCHAR));
+    q = dataW;
+    *q++ = 0xfeff;
+    q += MultiByteToWideChar(CP_ACP, 0, "[big]\r\n", -1, q, 16) - 1;
+    for (i = 0; i < 4000; i++)
+    {
+        sprintf(data, "Key%d=value%d\r\n", i, i);
+        q += MultiByteToWideChar(CP_ACP, 0, data, -1, q, 64) - 1;
+    }
+    len = q - dataW;
+    for (i = 0; i < len; i++) dataW[i] = (dataW[i] << 8) | (dataW[i] >> 8);
+    create_test_file(path[6], (char *)dataW, len * sizeof(WCHAR));
+    ret = GetPrivateProfileStringA("big", "key3999", "default", buf, sizeof(buf), path[6]);
+    ok(ret == 9 && !strcmp(buf, "value3999"), "got %s\n", buf);
+    ret = GetPrivateProfileStringA("big", "key0", "default", buf, sizeof(buf), path[6]);
+    ok(ret == 6 && !strcmp(buf, "value0"), "got %s\n", buf);
+
+    HeapFree(GetProcessHeap(), 0, dataW);
+    HeapFree(GetProcessHeap(), 0, data);
+    for (i = 0; i < 20; i++) DeleteFileA(path[i]);
+}
+
 static BOOL emptystr_ok(CHAR emptystr[MAX_PATH])
 {
     int i;
@@ -1128,6 +1231,7 @@ START_TEST(profile)
     test_profile_existing();
     test_profile_delete_on_close();
     test_profile_refresh();
+    test_profile_cache();
     test_GetPrivateProfileString(
         "[section1]\r\n"
         "name1=val1\r\n"
@@ -348,8 +348,8 @@ void __asm_dummy_vtables(void) {
             VTABLE_ADD_FUNC(basic_streambuf_char_showmanyc)
             VTABLE_ADD_FUNC(basic_filebuf_char_underflow)
             VTABLE_ADD_FUNC(basic_filebuf_char_uflow)
-            VTABLE_ADD_FUNC(basic_streambuf_char_xsgetn)
-            VTABLE_ADD_FUNC(basic_streambuf_char_xsputn)
+            VTABLE_ADD_FUNC(basic_filebuf_char_xsgetn)
+            VTABLE_ADD_FUNC(basic_filebuf_char_xsputn)
             VTABLE_ADD_FUNC(basic_filebuf_char_seekoff)
             VTABLE_ADD_FUNC(basic_filebuf_char_seekpos)
             VTABLE_ADD_FUNC(basic_filebuf_char_setbuf)
@@ -2284,6 +2284,56 @@ int __thiscall basic_filebuf_char_underflow(basic_filebuf_char *this)
     return ret;
 }
 
+/* Used only through the vtable, basic_filebuf doesn't export xsputn */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsputn, 16)
+streamsize __thiscall basic_filebuf_char_xsputn(basic_filebuf_char *this, const char *ptr, streamsize count)
+{
+    char buf[512], *to_next;
+    const char *from, *from_next;
+    int ret;
+
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+
+    if(!basic_filebuf_char_is_open(this) || count<=0)
+        return basic_streambuf_char_xsputn(&this->base, ptr, count);
+
+    /* Without conversion the put area is the FILE buffer, pass the whole block to fwrite */
+    if(!this->cvt)
+        return fwrite(ptr, sizeof(char), count, this->file);
+
+    for(from=ptr; from<ptr+count; from=from_next) {
+        ret = codecvt_char_out(this->cvt, &this->state, from, ptr+count,
+                &from_next, buf, buf+sizeof(buf), &to_next);
+
+        if(ret == CODECVT_noconv)
+            return from-ptr + fwrite(from, sizeof(char), ptr+count-from, this->file);
+        if(ret!=CODECVT_ok && ret!=CODECVT_partial)
+            break;
+        if(to_next!=buf && !fwrite(buf, to_next-buf, 1, this->file))
+            return from-ptr;
+        if(from_next == from)
+            break;
+    }
+
+    /* let overflow handle the characters that couldn't be converted in bulk */
+    if(from < ptr+count)
+        from += basic_streambuf_char_xsputn(&this->base, from, ptr+count-from);
+    return from-ptr;
+}
+
+/* Used only through the vtable, basic_filebuf doesn't export xsgetn */
+DEFINE_THISCALL_WRAPPER(basic_filebuf_char_xsgetn, 16)
+streamsize __thiscall basic_filebuf_char_xsgetn(basic_filebuf_char *this, char *ptr, streamsize count)
+{
+    TRACE("(%p %p %s)\n", this, ptr, wine_dbgstr_longlong(count));
+
+    if(!basic_filebuf_char_is_open(this) || this->cvt || count<=0)
+        return basic_streambuf_char_xsgetn(&this->base, ptr, count);
+
+    /* The get area is the FILE buffer, fread drains it before reading from the file */
+    return fread(ptr, sizeof(char), count, this->file);
+}
+
 /* ?seekoff@?$basic_filebuf@DU?$char_traits@D@std@@@std@@MAE?AV?$fpos@H@2@JHH@Z */
 /* ?seekoff@?$basic_filebuf@DU?$char_traits@D@std@@@std@@MEAA?AV?$fpos@H@2@_JHH@Z */
 DEFINE_THISCALL_WRAPPER(basic_filebuf_char_seekoff, 24)
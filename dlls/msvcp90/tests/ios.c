@@ -468,6 +468,10 @@ static basic_ostream_char* (*__thiscall p_basic_ostream_char_print_double)(basic
 
 static basic_ostream_wchar* (*__thiscall p_basic_ostream_wchar_print_double)(basic_ostream_wchar*, double);
 
+/* basic_streambuf */
+static streamsize (*__thiscall p_basic_streambuf_char_sgetn)(basic_streambuf_char*, char*, streamsize);
+static streamsize (*__thiscall p_basic_streambuf_char_sputn)(basic_streambuf_char*, const char*, streamsize);
+
 /* basic_ios */
 static locale*  (*__thiscall p_basic_ios_char_imbue)(basic_ios_char*, locale*, const locale*);
 
@@ -694,6 +698,11 @@ static BOOL init(void)
         SET(p_ios_base_precision_set,
             "?precision@ios_base@std@@QEAA_J_J@Z");
 
+        SET(p_basic_streambuf_char_sgetn,
+            "?sgetn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QEAA_JPEAD_J@Z");
+        SET(p_basic_streambuf_char_sputn,
+            "?sputn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QEAA_JPEBD_J@Z");
+
         SET(p_basic_ios_char_imbue,
             "?imbue@?$basic_ios@DU?$char_traits@D@std@@@std@@QEAA?AVlocale@2@AEBV32@@Z");
 
@@ -804,6 +813,11 @@ static BOOL init(void)
         SET(p_ios_base_precision_set,
             "?precision@ios_base@std@@QAEHH@Z");
 
+        SET(p_basic_streambuf_char_sgetn,
+            "?sgetn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPADH@Z");
+        SET(p_basic_streambuf_char_sputn,
+            "?sputn@?$basic_streambuf@DU?$char_traits@D@std@@@std@@QAEHPBDH@Z");
+
         SET(p_basic_ios_char_imbue,
             "?imbue@?$basic_ios@DU?$char_traits@D@std@@@std@@QAE?AVlocale@2@ABV32@@Z");
 
@@ -1809,6 +1823,42 @@ static void test_istream_getline(void)
 }
 
 
+static void test_filebuf_sputn_sgetn(void)
+{
+    basic_fstream_char fs;
+    char buf[5000], out[5000];
+    streamsize ret;
+    int i;
+
+    const char *testfile = "file.txt";
+
+    for(i=0; i<sizeof(buf); i++)
+        buf[i] = 'a' + i%26;
+
+    call_func5(p_basic_fstream_char_ctor_name, &fs, testfile,
+            OPENMODE_out|OPENMODE_in|OPENMODE_trunc|OPENMODE_binary, SH_DENYNO, TRUE);
+
+    ret = (streamsize)call_func3(p_basic_streambuf_char_sputn, &fs.filebuf.base, buf, 1);
+    ok(ret == 1, "sputn returned %ld\n", ret);
+    ret = (streamsize)call_func3(p_basic_streambuf_char_sputn, &fs.filebuf.base, buf+1, sizeof(buf)-1);
+    ok(ret == sizeof(buf)-1, "sputn returned %ld\n", ret);
+
+    call_func3(p_basic_istream_char_seekg, &fs.base.base1, 0, SEEK_SET);
+
+    memset(out, 0, sizeof(out));
+    ret = (streamsize)call_func3(p_basic_streambuf_char_sgetn, &fs.filebuf.base, out, 10);
+    ok(ret == 10, "sgetn returned %ld\n", ret);
+    ret = (streamsize)call_func3(p_basic_streambuf_char_sgetn, &fs.filebuf.base, out+10, sizeof(out));
+    ok(ret == sizeof(out)-10, "sgetn returned %ld\n", ret);
+    ok(!memcmp(buf, out, sizeof(buf)), "read data doesn't match written data\n");
+
+    ret = (streamsize)call_func3(p_basic_streambuf_char_sgetn, &fs.filebuf.base, out, sizeof(out));
+    ok(ret == 0, "sgetn returned %ld\n", ret);
+
+    call_func1(p_basic_fstream_char_vbase_dtor, &fs);
+    unlink(testfile);
+}
+
 START_TEST(ios)
 {
     if(!init())
@@ -1824,6 +1874,7 @@ START_TEST(ios)
     test_istream_peek();
     test_istream_tellg();
     test_istream_getline();
+    test_filebuf_sputn_sgetn();
 
     ok(!invalid_parameter, "invalid_parameter_handler was invoked too many times\n");
 }
@@ -49,6 +49,317 @@ static unsigned int MSVCRT_amblksiz = 16;
 /* FIXME - According to documentation it should be 480 bytes, at runtime default is 0 */
 static MSVCRT_size_t MSVCRT_sbh_threshold = 0;
 
+/* Small-block heap: once enabled with _set_sbh_threshold, allocations up to
+ * the threshold are carved from chunks of a reserved address range, each
+ * chunk holding blocks of a single size class. Freed blocks are kept on
+ * per-thread lists, and batches of them move to and from shared lists under
+ * sbh_cs, so the process heap lock isn't taken for them at all. A block is
+ * recognized by its address, and its size class is stored per chunk. Each
+ * chunk starts with the requested size of its blocks, 0 for free ones, for
+ * _msize and _heapwalk. */
+#define SBH_GRANULARITY 16
+#define SBH_CLASSES     (1024 / SBH_GRANULARITY)
+#define SBH_MAX_CACHED  32
+#define SBH_BATCH       16
+#define SBH_CHUNK_SIZE  0x10000
+#define SBH_CHUNKS      512
+
+struct __sbh_cache
+{
+  void         *head[SBH_CLASSES];
+  unsigned int  count[SBH_CLASSES];
+  LONG          generation;
+};
+
+/* base and the class of chunks with allocated blocks don't change, so they
+ * may be read without the lock; everything else is protected by sbh_cs */
+static struct
+{
+  char *base;
+  BYTE  chunk_class[SBH_CHUNKS];  /* size class + 1 of committed chunks */
+  void *free[SBH_CLASSES];        /* blocks given back by the threads */
+  char *next[SBH_CLASSES];        /* part of the last chunk not handed out yet */
+  char *end[SBH_CLASSES];
+} sbh;
+
+/* incremented to make the threads give back their cached blocks */
+static LONG sbh_generation;
+
+static CRITICAL_SECTION sbh_cs;
+static CRITICAL_SECTION_DEBUG sbh_cs_debug =
+{
+    0, 0, &sbh_cs,
+    { &sbh_cs_debug.ProcessLocksList, &sbh_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": sbh_cs") }
+};
+static CRITICAL_SECTION sbh_cs = { &sbh_cs_debug, -1, 0, 0, 0, 0 };
+
+static inline MSVCRT_size_t sbh_class_size(unsigned int idx)
+{
+  return (idx + 1) * SBH_GRANULARITY;
+}
+
+/* number of blocks in a chunk, after the array of their sizes */
+static inline unsigned int sbh_chunk_blocks(unsigned int idx)
+{
+  return (SBH_CHUNK_SIZE - SBH_GRANULARITY) / (sbh_class_size(idx) + sizeof(WORD));
+}
+
+static inline unsigned int sbh_chunk_header(unsigned int idx)
+{
+  return (sbh_chunk_blocks(idx) * sizeof(WORD) + SBH_GRANULARITY - 1) & ~(SBH_GRANULARITY - 1);
+}
+
+static inline char *sbh_chunk(const void *ptr)
+{
+  return sbh.base + ((const char*)ptr - sbh.base) / SBH_CHUNK_SIZE * SBH_CHUNK_SIZE;
+}
+
+/* returns where the requested size of a small block is stored */
+static inline WORD *sbh_block_size(const void *ptr, unsigned int idx)
+{
+  char *chunk = sbh_chunk(ptr);
+
+  return (WORD*)chunk + ((const char*)ptr - chunk - sbh_chunk_header(idx)) / sbh_class_size(idx);
+}
+
+/* returns the size class + 1 of a small block, 0 for other blocks */
+static inline unsigned int sbh_block_class(const void *ptr)
+{
+  ULONG_PTR offset;
+
+  if(!sbh.base)
+    return 0;
+  offset = (const char*)ptr - sbh.base;
+  if(offset >= SBH_CHUNKS * SBH_CHUNK_SIZE)
+    return 0;
+  return sbh.chunk_class[offset / SBH_CHUNK_SIZE];
+}
+
+/* called with sbh_cs held */
+static void *sbh_carve(unsigned int idx)
+{
+  MSVCRT_size_t size = sbh_class_size(idx);
+  char *chunk;
+  void *ret;
+  int i;
+
+  if(sbh.end[idx] - sbh.next[idx] < size)
+  {
+    for(i=0; i<SBH_CHUNKS; i++)
+      if(!sbh.chunk_class[i]) break;
+    if(i == SBH_CHUNKS)
+      return NULL;
+
+    chunk = sbh.base + i * SBH_CHUNK_SIZE;
+    if(!VirtualAlloc(chunk, SBH_CHUNK_SIZE, MEM_COMMIT, PAGE_READWRITE))
+      return NULL;
+    sbh.chunk_class[i] = idx + 1;
+    sbh.next[idx] = chunk + sbh_chunk_header(idx);
+    sbh.end[idx] = sbh.next[idx] + sbh_chunk_blocks(idx) * size;
+  }
+
+  ret = sbh.next[idx];
+  sbh.next[idx] += size;
+  return ret;
+}
+
+static void sbh_refill(struct __sbh_cache *cache, unsigned int idx)
+{
+  void *ptr;
+
+  EnterCriticalSection(&sbh_cs);
+  while(cache->count[idx] < SBH_BATCH)
+  {
+    if((ptr = sbh.free[idx]))
+      sbh.free[idx] = *(void**)ptr;
+    else if(!(ptr = sbh_carve(idx)))
+      break;
+    *(void**)ptr = cache->head[idx];
+    cache->head[idx] = ptr;
+    cache->count[idx]++;
+  }
+  LeaveCriticalSection(&sbh_cs);
+}
+
+/* called with sbh_cs held */
+static void sbh_release(struct __sbh_cache *cache, unsigned int idx, unsigned int keep)
+{
+  void *ptr;
+
+  while(cache->count[idx] > keep)
+  {
+    ptr = cache->head[idx];
+    cache->head[idx] = *(void**)ptr;
+    *(void**)ptr = sbh.free[idx];
+    sbh.free[idx] = ptr;
+    cache->count[idx]--;
+  }
+}
+
+static void sbh_flush_cache(struct __sbh_cache *cache)
+{
+  int i;
+
+  EnterCriticalSection(&sbh_cs);
+  for(i=0; i<SBH_CLASSES; i++)
+    sbh_release(cache, i, 0);
+  cache->generation = sbh_generation;
+  LeaveCriticalSection(&sbh_cs);
+}
+
+static struct __sbh_cache *sbh_get_cache(void)
+{
+  thread_data_t *data = msvcrt_get_thread_data();
+  struct __sbh_cache *cache = data->sbh_cache;
+
+  if(!cache)
+  {
+    if(!(cache = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cache))))
+      return NULL;
+    cache->generation = sbh_generation;
+    data->sbh_cache = cache;
+  }
+  else if(cache->generation != sbh_generation)
+  {
+    /* _heapmin or _set_sbh_threshold(0) was called since */
+    sbh_flush_cache(cache);
+  }
+  return cache;
+}
+
+/* number of blocks handed out from a chunk so far, called with sbh_cs held */
+static unsigned int sbh_carved(unsigned int i)
+{
+  unsigned int idx = sbh.chunk_class[i] - 1;
+  char *chunk = sbh.base + i * SBH_CHUNK_SIZE;
+
+  if(sbh.next[idx] >= chunk && sbh.next[idx] < chunk + SBH_CHUNK_SIZE)
+    return (sbh.next[idx] - chunk - sbh_chunk_header(idx)) / sbh_class_size(idx);
+  return sbh_chunk_blocks(idx);
+}
+
+/* decommit the chunks whose blocks are all on the shared lists */
+static void sbh_trim(void)
+{
+  WORD counts[SBH_CHUNKS];
+  BOOL release[SBH_CHUNKS];
+  unsigned int i, idx;
+  void **ptr;
+  char *chunk;
+
+  EnterCriticalSection(&sbh_cs);
+  if(!sbh.base)
+  {
+    LeaveCriticalSection(&sbh_cs);
+    return;
+  }
+
+  memset(counts, 0, sizeof(counts));
+  for(idx=0; idx<SBH_CLASSES; idx++)
+    for(ptr = sbh.free[idx]; ptr; ptr = *ptr)
+      counts[((char*)ptr - sbh.base) / SBH_CHUNK_SIZE]++;
+
+  for(i=0; i<SBH_CHUNKS; i++)
+  {
+    release[i] = sbh.chunk_class[i] && counts[i] == sbh_carved(i);
+  }
+
+  for(idx=0; idx<SBH_CLASSES; idx++)
+  {
+    ptr = &sbh.free[idx];
+    while(*ptr)
+    {
+      if(release[((char*)*ptr - sbh.base) / SBH_CHUNK_SIZE])
+        *ptr = *(void**)*ptr;
+      else
+        ptr = *ptr;
+    }
+  }
+
+  for(i=0; i<SBH_CHUNKS; i++)
+  {
+    if(!release[i])
+      continue;
+
+    idx = sbh.chunk_class[i] - 1;
+    chunk = sbh.base + i * SBH_CHUNK_SIZE;
+    if(sbh.next[idx] >= chunk && sbh.next[idx] < chunk + SBH_CHUNK_SIZE)
+      sbh.next[idx] = sbh.end[idx] = NULL;
+    VirtualFree(chunk, SBH_CHUNK_SIZE, MEM_DECOMMIT);
+    sbh.chunk_class[i] = 0;
+  }
+  LeaveCriticalSection(&sbh_cs);
+}
+
+static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size)
+{
+  if(size && size <= MSVCRT_sbh_threshold && sbh.base)
+  {
+    struct __sbh_cache *cache = sbh_get_cache();
+    unsigned int idx = (size - 1) / SBH_GRANULARITY;
+    void *ret;
+
+    if(cache)
+    {
+      if(!cache->head[idx])
+        sbh_refill(cache, idx);
+      if((ret = cache->head[idx]))
+      {
+        cache->head[idx] = *(void**)ret;
+        cache->count[idx]--;
+        *sbh_block_size(ret, idx) = size;
+        if(flags & HEAP_ZERO_MEMORY)
+          memset(ret, 0, sbh_class_size(idx));
+        return ret;
+      }
+    }
+  }
+  return HeapAlloc(GetProcessHeap(), flags, size);
+}
+
+static BOOL msvcrt_heap_free(void *ptr)
+{
+  unsigned int class = sbh_block_class(ptr);
+
+  if(class)
+  {
+    struct __sbh_cache *cache = MSVCRT_sbh_threshold ? sbh_get_cache() : NULL;
+    unsigned int idx = class - 1;
+
+    *sbh_block_size(ptr, idx) = 0;
+    if(!cache)
+    {
+      EnterCriticalSection(&sbh_cs);
+      *(void**)ptr = sbh.free[idx];
+      sbh.free[idx] = ptr;
+      LeaveCriticalSection(&sbh_cs);
+      return TRUE;
+    }
+
+    *(void**)ptr = cache->head[idx];
+    cache->head[idx] = ptr;
+    if(++cache->count[idx] > SBH_MAX_CACHED)
+    {
+      EnterCriticalSection(&sbh_cs);
+      sbh_release(cache, idx, SBH_MAX_CACHED / 2);
+      LeaveCriticalSection(&sbh_cs);
+    }
+    return TRUE;
+  }
+  return HeapFree(GetProcessHeap(), 0, ptr);
+}
+
+/* called when a thread exits */
+void msvcrt_free_sbh_cache(thread_data_t *data)
+{
+  if(!data->sbh_cache)
+    return;
+  sbh_flush_cache(data->sbh_cache);
+  HeapFree(GetProcessHeap(), 0, data->sbh_cache);
+  data->sbh_cache = NULL;
+}
+
 /*********************************************************************
  *		??2@YAPAXI@Z (MSVCRT.@)
  */
@@ -59,7 +370,7 @@ void* CDECL MSVCRT_operator_new(MSVCRT_size_t size)
 
   do
   {
-    retval = HeapAlloc(GetProcessHeap(), 0, size);
+    retval = msvcrt_heap_alloc(0, size);
     if(retval)
     {
       TRACE("(%ld) returning %p\n", size, retval);
@@ -94,7 +405,7 @@ void* CDECL MSVCRT_operator_new_dbg(MSVCRT_size_t size, int type, const char *fi
 void CDECL MSVCRT_operator_delete(void *mem)
 {
   TRACE("(%p)\n", mem);
-  HeapFree(GetProcessHeap(), 0, mem);
+  msvcrt_heap_free(mem);
 }
 
 
@@ -166,6 +477,16 @@ int CDECL _callnewh(MSVCRT_size_t size)
  */
 void* CDECL _expand(void* mem, MSVCRT_size_t size)
 {
+  unsigned int class = sbh_block_class(mem);
+
+  if(class)
+  {
+    if(size > sbh_class_size(class - 1))
+      return NULL;
+    if(size)
+      *sbh_block_size(mem, class - 1) = size;
+    return mem;
+  }
   return HeapReAlloc(GetProcessHeap(), HEAP_REALLOC_IN_PLACE_ONLY, mem, size);
 }
 
@@ -187,6 +508,14 @@ int CDECL _heapchk(void)
  */
 int CDECL _heapmin(void)
 {
+  thread_data_t *data = msvcrt_get_thread_data();
+
+  /* the other threads give back their cached blocks on their next allocation or free */
+  InterlockedIncrement(&sbh_generation);
+  if(data->sbh_cache)
+    sbh_flush_cache(data->sbh_cache);
+  sbh_trim();
+
   if (!HeapCompact( GetProcessHeap(), 0 ))
   {
     if (GetLastError() != ERROR_CALL_NOT_IMPLEMENTED)
@@ -196,6 +525,51 @@ int CDECL _heapmin(void)
   return 0;
 }
 
+/* continue a heap walk with the small blocks, once the process heap is done */
+static int sbh_heapwalk(struct MSVCRT__heapinfo *next)
+{
+  unsigned int i, idx, block = 0, class;
+  char *chunk;
+  WORD size;
+
+  EnterCriticalSection(&sbh_cs);
+  i = 0;
+  if((class = sbh_block_class(next->_pentry)))
+  {
+    MSVCRT_size_t offset;
+
+    idx = class - 1;
+    chunk = sbh_chunk(next->_pentry);
+    offset = (char*)next->_pentry - chunk - sbh_chunk_header(idx);
+    i = (chunk - sbh.base) / SBH_CHUNK_SIZE;
+    if(offset >= SBH_CHUNK_SIZE || offset % sbh_class_size(idx) ||
+       offset / sbh_class_size(idx) >= sbh_carved(i))
+    {
+      LeaveCriticalSection(&sbh_cs);
+      *MSVCRT__errno() = MSVCRT_EINVAL;
+      return MSVCRT__HEAPBADNODE;
+    }
+    block = offset / sbh_class_size(idx) + 1;
+  }
+
+  for(; sbh.base && i<SBH_CHUNKS; i++, block = 0)
+  {
+    if(!sbh.chunk_class[i] || block >= sbh_carved(i))
+      continue;
+
+    idx = sbh.chunk_class[i] - 1;
+    chunk = sbh.base + i * SBH_CHUNK_SIZE;
+    size = ((WORD*)chunk)[block];
+    next->_pentry = (int*)(chunk + sbh_chunk_header(idx) + block * sbh_class_size(idx));
+    next->_size = size ? size : sbh_class_size(idx);
+    next->_useflag = size ? MSVCRT__USEDENTRY : MSVCRT__FREEENTRY;
+    LeaveCriticalSection(&sbh_cs);
+    return MSVCRT__HEAPOK;
+  }
+  LeaveCriticalSection(&sbh_cs);
+  return MSVCRT__HEAPEND;
+}
+
 /*********************************************************************
  *		_heapwalk (MSVCRT.@)
  */
@@ -203,6 +577,9 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
 {
   PROCESS_HEAP_ENTRY phe;
 
+  if (sbh_block_class(next->_pentry))
+    return sbh_heapwalk(next);
+
   LOCK_HEAP;
   phe.lpData = next->_pentry;
   phe.cbData = next->_size;
@@ -222,7 +599,7 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
     {
       UNLOCK_HEAP;
       if (GetLastError() == ERROR_NO_MORE_ITEMS)
-         return MSVCRT__HEAPEND;
+         return sbh_heapwalk(next);
       msvcrt_set_errno(GetLastError());
       if (!phe.lpData)
         return MSVCRT__HEAPBADBEGIN;
@@ -237,6 +614,26 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
   return MSVCRT__HEAPOK;
 }
 
+/* fill the free small blocks, except for their list link; the ones cached
+ * by other threads may be handed out at any time, so they're left alone */
+static void sbh_heapset(unsigned int value)
+{
+  thread_data_t *data = msvcrt_get_thread_data();
+  unsigned int idx;
+  void *ptr;
+
+  if(!sbh.base)
+    return;
+  if(data->sbh_cache)
+    sbh_flush_cache(data->sbh_cache);
+
+  EnterCriticalSection(&sbh_cs);
+  for(idx=0; idx<SBH_CLASSES; idx++)
+    for(ptr = sbh.free[idx]; ptr; ptr = *(void**)ptr)
+      memset((void**)ptr + 1, value, sbh_class_size(idx) - sizeof(void*));
+  LeaveCriticalSection(&sbh_cs);
+}
+
 /*********************************************************************
  *		_heapset (MSVCRT.@)
  */
@@ -249,10 +646,11 @@ int CDECL _heapset(unsigned int value)
   LOCK_HEAP;
   while ((retval = _heapwalk(&heap)) == MSVCRT__HEAPOK)
   {
-    if (heap._useflag == MSVCRT__FREEENTRY)
+    if (heap._useflag == MSVCRT__FREEENTRY && !sbh_block_class(heap._pentry))
       memset(heap._pentry, value, heap._size);
   }
   UNLOCK_HEAP;
+  if (retval == MSVCRT__HEAPEND) sbh_heapset(value);
   return retval == MSVCRT__HEAPEND? MSVCRT__HEAPOK : retval;
 }
 
@@ -279,7 +677,11 @@ MSVCRT_intptr_t CDECL _get_heap_handle(void)
  */
 MSVCRT_size_t CDECL _msize(void* mem)
 {
-  MSVCRT_size_t size = HeapSize(GetProcessHeap(),0,mem);
+  unsigned int class = sbh_block_class(mem);
+  MSVCRT_size_t size;
+
+  if (class) return *sbh_block_size(mem, class - 1);
+  size = HeapSize(GetProcessHeap(),0,mem);
   if (size == ~(MSVCRT_size_t)0)
   {
     WARN(":Probably called with non wine-allocated memory, ret = -1\n");
@@ -293,7 +695,7 @@ MSVCRT_size_t CDECL _msize(void* mem)
  */
 void* CDECL MSVCRT_calloc(MSVCRT_size_t size, MSVCRT_size_t count)
 {
-  return HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, size * count );
+  return msvcrt_heap_alloc(HEAP_ZERO_MEMORY, size * count);
 }
 
 /*********************************************************************
@@ -301,7 +703,7 @@ void* CDECL MSVCRT_calloc(MSVCRT_size_t size, MSVCRT_size_t count)
  */
 void CDECL MSVCRT_free(void* ptr)
 {
-  HeapFree(GetProcessHeap(),0,ptr);
+  msvcrt_heap_free(ptr);
 }
 
 /*********************************************************************
@@ -309,7 +711,7 @@ void CDECL MSVCRT_free(void* ptr)
  */
 void* CDECL MSVCRT_malloc(MSVCRT_size_t size)
 {
-  void *ret = HeapAlloc(GetProcessHeap(),0,size);
+  void *ret = msvcrt_heap_alloc(0, size);
   if (!ret)
       *MSVCRT__errno() = MSVCRT_ENOMEM;
   return ret;
@@ -320,10 +722,29 @@ void* CDECL MSVCRT_malloc(MSVCRT_size_t size)
  */
 void* CDECL MSVCRT_realloc(void* ptr, MSVCRT_size_t size)
 {
+  unsigned int class;
+  void *ret;
+
   if (!ptr) return MSVCRT_malloc(size);
-  if (size) return HeapReAlloc(GetProcessHeap(), 0, ptr, size);
-  MSVCRT_free(ptr);
-  return NULL;
+  if (!size)
+  {
+    MSVCRT_free(ptr);
+    return NULL;
+  }
+  if (!(class = sbh_block_class(ptr))) return HeapReAlloc(GetProcessHeap(), 0, ptr, size);
+
+  /* small blocks can't be resized in place */
+  if (size <= sbh_class_size(class - 1))
+  {
+    *sbh_block_size(ptr, class - 1) = size;
+    return ptr;
+  }
+  if ((ret = MSVCRT_malloc(size)))
+  {
+    memcpy(ret, ptr, *sbh_block_size(ptr, class - 1));
+    MSVCRT_free(ptr);
+  }
+  return ret;
 }
 
 /*********************************************************************
@@ -347,10 +768,28 @@ MSVCRT_size_t CDECL _get_sbh_threshold(void)
  */
 int CDECL _set_sbh_threshold(MSVCRT_size_t threshold)
 {
+  thread_data_t *data;
+
   if(threshold > 1016)
      return 0;
-  else
-     MSVCRT_sbh_threshold = threshold;
+
+  if(threshold && !sbh.base)
+  {
+     EnterCriticalSection(&sbh_cs);
+     if(!sbh.base)
+        sbh.base = VirtualAlloc(NULL, SBH_CHUNKS * SBH_CHUNK_SIZE, MEM_RESERVE, PAGE_READWRITE);
+     LeaveCriticalSection(&sbh_cs);
+  }
+  MSVCRT_sbh_threshold = threshold;
+
+  if(!threshold)
+  {
+     /* existing small blocks stay valid, the cached ones go back to the shared lists */
+     InterlockedIncrement(&sbh_generation);
+     data = msvcrt_get_thread_data();
+     if(data->sbh_cache)
+        sbh_flush_cache(data->sbh_cache);
+  }
   return 1;
 }
 
@@ -76,6 +76,7 @@ static inline void msvcrt_free_tls_mem(void)
     HeapFree(GetProcessHeap(),0,tls->time_buffer);
     HeapFree(GetProcessHeap(),0,tls->tmpnam_buffer);
     HeapFree(GetProcessHeap(),0,tls->wtmpnam_buffer);
+    msvcrt_free_sbh_cache(tls);
     if(tls->have_locale) {
         free_locinfo(tls->locinfo);
         free_mbcinfo(tls->mbcinfo);
@@ -220,11 +220,13 @@ struct __thread_data {
     int                             unk7;
     EXCEPTION_RECORD               *exc_record;
     void                           *unk8[100];
+    struct __sbh_cache             *sbh_cache;          /* freed small blocks */
 };
 
 typedef struct __thread_data thread_data_t;
 
 extern thread_data_t *msvcrt_get_thread_data(void) DECLSPEC_HIDDEN;
+extern void msvcrt_free_sbh_cache(thread_data_t*) DECLSPEC_HIDDEN;
 
 LCID MSVCRT_locale_to_LCID(const char*, unsigned short*) DECLSPEC_HIDDEN;
 extern MSVCRT__locale_t MSVCRT_locale DECLSPEC_HIDDEN;
@@ -1591,38 +1591,6 @@ int CDECL MSVCRT_I10_OUTPUT(MSVCRT__LDOUBLE ld80, int prec, int flag, struct _I1
 }
 #undef I10_OUTPUT_MAX_PREC
 
-/*********************************************************************
- *                  memcpy   (MSVCRT.@)
- */
-void * __cdecl MSVCRT_memcpy( void *dst, const void *src, size_t n )
-{
-    return memmove( dst, src, n );
-}
-
-/*********************************************************************
- *		    memset (MSVCRT.@)
- */
-void* __cdecl MSVCRT_memset(void *dst, int c, MSVCRT_size_t n)
-{
-    return memset(dst, c, n);
-}
-
-/*********************************************************************
- *		    strchr (MSVCRT.@)
- */
-char* __cdecl MSVCRT_strchr(const char *str, int c)
-{
-    return strchr(str, c);
-}
-
-/*********************************************************************
- *                  memchr   (MSVCRT.@)
- */
-void* __cdecl MSVCRT_memchr(const void *ptr, int c, MSVCRT_size_t n)
-{
-    return memchr(ptr, c, n);
-}
-
 /*********************************************************************
  *                  strncmp   (MSVCRT.@)
  */
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <errno.h>
+#include <string.h>
 #include "wine/test.h"
 
 static void (__cdecl *p_aligned_free)(void*) = NULL;
@@ -413,6 +414,101 @@ static void test_aligned(void)
     test_aligned_offset_realloc(256, 128, 64, 112);
 }
 
+static void test_sbh(void)
+{
+    _HEAPINFO hi;
+    char *mem, *mem2, *blocks[5];
+    int i, ret, found[5];
+
+    if (!_set_sbh_threshold(1016))
+    {
+        win_skip("small-block heap not supported\n");
+        return;
+    }
+    ok(_get_sbh_threshold() == 1016, "threshold = %u\n", (unsigned int)_get_sbh_threshold());
+
+    mem = malloc(24);
+    ok(mem != NULL, "memory not allocated\n");
+    ok(_msize(mem) == 24, "_msize returned %u\n", (unsigned int)_msize(mem));
+    free(mem);
+
+    mem = malloc(20);
+    ok(mem != NULL, "memory not allocated\n");
+    for (i = 0; i < 20; i++) mem[i] = i;
+    mem2 = _expand(mem, 8);
+    ok(mem2 == mem, "_expand returned %p, expected %p\n", mem2, mem);
+    ok(_msize(mem) == 8, "_msize returned %u\n", (unsigned int)_msize(mem));
+
+    mem = realloc(mem, 2000);
+    ok(mem != NULL, "memory not reallocated\n");
+    for (i = 0; i < 8; i++)
+        ok(mem[i] == i, "mem[%d] = %d\n", i, mem[i]);
+    free(mem);
+
+    mem = calloc(10, 3);
+    ok(mem != NULL, "memory not allocated\n");
+    for (i = 0; i < 30; i++)
+        if (mem[i]) break;
+    ok(i == 30, "memory not zeroed at %d\n", i);
+    free(mem);
+
+    /* the small blocks are part of the heap walk */
+    for (i = 0; i < 5; i++)
+    {
+        blocks[i] = malloc(40 + i);
+        ok(blocks[i] != NULL, "memory not allocated\n");
+        memset(blocks[i], 'a' + i, 40 + i);
+        found[i] = 0;
+    }
+    free(blocks[2]);
+
+    memset(&hi, 0, sizeof(hi));
+    while ((ret = _heapwalk(&hi)) == _HEAPOK)
+    {
+        for (i = 0; i < 5; i++)
+        {
+            if ((char *)hi._pentry != blocks[i]) continue;
+            found[i]++;
+            if (i == 2)
+                ok(hi._useflag == _FREEENTRY, "block %d: _useflag = %d\n", i, hi._useflag);
+            else
+            {
+                ok(hi._useflag == _USEDENTRY, "block %d: _useflag = %d\n", i, hi._useflag);
+                ok(hi._size == 40 + i, "block %d: _size = %u\n", i, (unsigned int)hi._size);
+            }
+        }
+    }
+    ok(ret == _HEAPEND, "_heapwalk returned %d\n", ret);
+    for (i = 0; i < 5; i++)
+        ok(found[i] == 1, "block %d found %d times\n", i, found[i]);
+
+    ret = _heapset(0xfe);
+    ok(ret == _HEAPOK, "_heapset returned %d\n", ret);
+    for (i = 0; i < 5; i++)
+    {
+        int j;
+
+        if (i == 2) continue;
+        for (j = 0; j < 40 + i; j++)
+            if (blocks[i][j] != 'a' + i) break;
+        ok(j == 40 + i, "block %d changed at %d\n", i, j);
+        free(blocks[i]);
+    }
+
+    /* small blocks stay usable once the small-block heap is disabled */
+    mem = malloc(100);
+    ok(mem != NULL, "memory not allocated\n");
+    for (i = 0; i < 100; i++) mem[i] = i;
+    ok(_set_sbh_threshold(0), "_set_sbh_threshold failed\n");
+    ok(_msize(mem) >= 100, "_msize returned %u\n", (unsigned int)_msize(mem));
+    mem = realloc(mem, 300);
+    ok(mem != NULL, "memory not reallocated\n");
+    for (i = 0; i < 100; i++)
+        ok(mem[i] == i, "mem[%d] = %d\n", i, mem[i]);
+    free(mem);
+    _heapmin();
+}
+
 START_TEST(heap)
 {
     void *mem;
@@ -436,4 +532,5 @@ START_TEST(heap)
     free(mem);
 
     test_aligned();
+    test_sbh();
 }
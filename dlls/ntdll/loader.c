@@ -23,7 +23,15 @@
 #include "wine/port.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
 #endif
@@ -39,6 +47,8 @@
 
 #include "wine/exception.h"
 #include "wine/library.h"
+#include "wine/list.h"
+#include "wine/rbtree.h"
 #include "wine/unicode.h"
 #include "wine/debug.h"
 #include "wine/server.h"
@@ -59,6 +69,7 @@ typedef DWORD (CALLBACK *DLLENTRYPROC)(HMODULE,DWORD,LPVOID);
 
 static int process_detaching = 0;  /* set on process detach to avoid deadlocks with thread detach */
 static int free_lib_count;   /* recursion depth of LdrUnloadDll calls */
+static BOOL prefetch_dlls;   /* prefetch the files of imported dlls before loading them */
 
 static const char * const reason_names[] =
 {
@@ -72,12 +83,26 @@ static const char * const reason_names[] =
 
 static const WCHAR dllW[] = {'.','d','l','l',0};
 
+/* identity of a module file in the import cache */
+struct import_cache_key
+{
+    ULONGLONG size;   /* file size */
+    LONGLONG  mtime;  /* last write time */
+    ULONGLONG base;   /* preferred load address */
+};
+
 /* internal representation of 32bit modules. per process. */
 typedef struct _wine_modref
 {
     LDR_MODULE            ldr;
     int                   nDeps;
     struct _wine_modref **deps;
+    struct list           basename_entry;  /* entry in basename_hash */
+    struct list           fullname_entry;  /* entry in fullname_hash */
+    struct wine_rb_entry  addr_entry;      /* entry in module_tree */
+    BOOL                  indexed;         /* set once inserted in the lookup indices */
+    int                   cache_state;     /* 0: cache_key not computed, 1: valid, -1: not cacheable */
+    struct import_cache_key cache_key;     /* identity of the file for the import cache */
 } WINE_MODREF;
 
 /* info about the current builtin dll load */
@@ -109,11 +134,29 @@ static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
 };
 static RTL_CRITICAL_SECTION loader_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 
-static WINE_MODREF *cached_modref;
+/* case-insensitive hash indices of the modules by base name and full name,
+ * and a tree of their address ranges; all protected by the loader_section */
+#define MODULE_HASH_SIZE 64
+static struct list basename_hash[MODULE_HASH_SIZE];
+static struct list fullname_hash[MODULE_HASH_SIZE];
+static struct wine_rb_tree module_tree;
+
 static WINE_MODREF *current_modref;
 static WINE_MODREF *last_failed_modref;
 
+/* persistent cache of resolved import address tables, set with WINEIMPORTCACHE */
+enum import_cache_mode
+{
+    IMPORT_CACHE_OFF,     /* no caching */
+    IMPORT_CACHE_ON,      /* use and update the cache file */
+    IMPORT_CACHE_STATS,   /* same, and print the hit rates on exit */
+    IMPORT_CACHE_VERIFY   /* resolve everything anyway and check the cached entries */
+};
+static enum import_cache_mode import_cache_mode;
+
 static NTSTATUS load_dll( LPCWSTR load_path, LPCWSTR libname, DWORD flags, WINE_MODREF** pwm );
+static NTSTATUS find_dll_file( const WCHAR *load_path, const WCHAR *libname,
+                               WCHAR *filename, ULONG *size, WINE_MODREF **pwm, HANDLE *handle );
 static NTSTATUS process_attach( WINE_MODREF *wm, LPVOID lpReserved );
 static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
                                     DWORD exp_size, DWORD ordinal, LPCWSTR load_path );
@@ -319,6 +362,124 @@ static inline ULONG_PTR allocate_stub( const char *dll, const char *name ) { ret
 #endif  /* __i386__ */
 
 
+/*************************************************************************
+ *		hash_module_name
+ *
+ * Case-insensitive hash of a module name, consistent with strcmpiW.
+ */
+static inline unsigned int hash_module_name( LPCWSTR name )
+{
+    unsigned int hash = 0;
+
+    while (*name) hash = hash * 31 + tolowerW( *name++ );
+    return hash % MODULE_HASH_SIZE;
+}
+
+
+static void *module_tree_alloc( size_t size )
+{
+    return RtlAllocateHeap( GetProcessHeap(), 0, size );
+}
+
+static void *module_tree_realloc( void *ptr, size_t size )
+{
+    return RtlReAllocateHeap( GetProcessHeap(), 0, ptr, size );
+}
+
+static void module_tree_free( void *ptr )
+{
+    RtlFreeHeap( GetProcessHeap(), 0, ptr );
+}
+
+/* the key is an address, it matches the module whose image contains it */
+static int module_tree_compare( const void *key, const struct wine_rb_entry *entry )
+{
+    const WINE_MODREF *wm = WINE_RB_ENTRY_VALUE( entry, const WINE_MODREF, addr_entry );
+    const char *addr = key;
+    const char *base = wm->ldr.BaseAddress;
+
+    if (addr < base) return -1;
+    if (addr >= base + max( wm->ldr.SizeOfImage, 1 )) return 1;
+    return 0;
+}
+
+static const struct wine_rb_functions module_tree_functions =
+{
+    module_tree_alloc,
+    module_tree_realloc,
+    module_tree_free,
+    module_tree_compare,
+};
+
+
+/*************************************************************************
+ *		init_module_index
+ *
+ * Initialize the module lookup indices.
+ */
+static void init_module_index(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < MODULE_HASH_SIZE; i++)
+    {
+        list_init( &basename_hash[i] );
+        list_init( &fullname_hash[i] );
+    }
+    if (wine_rb_init( &module_tree, &module_tree_functions ) == -1)
+    {
+        MESSAGE( "wine: failed to initialize the module tree\n" );
+        exit(1);
+    }
+}
+
+
+/*************************************************************************
+ *		index_module
+ *
+ * Add a module to the name hashes and the address tree.
+ * The loader_section must be locked while calling this function.
+ */
+static void index_module( WINE_MODREF *wm )
+{
+    list_add_tail( &basename_hash[hash_module_name( wm->ldr.BaseDllName.Buffer )], &wm->basename_entry );
+    list_add_tail( &fullname_hash[hash_module_name( wm->ldr.FullDllName.Buffer )], &wm->fullname_entry );
+    if (wine_rb_put( &module_tree, wm->ldr.BaseAddress, &wm->addr_entry ) == -1)
+        ERR( "failed to index %s at %p\n", debugstr_w(wm->ldr.FullDllName.Buffer), wm->ldr.BaseAddress );
+    else
+        wm->indexed = TRUE;
+}
+
+
+/*************************************************************************
+ *		unindex_module
+ *
+ * Remove a module from the name hashes and the address tree.
+ * The loader_section must be locked while calling this function.
+ */
+static void unindex_module( WINE_MODREF *wm )
+{
+    list_remove( &wm->basename_entry );
+    list_remove( &wm->fullname_entry );
+    if (wm->indexed) wine_rb_remove( &module_tree, wm->ldr.BaseAddress );
+    wm->indexed = FALSE;
+}
+
+
+/*************************************************************************
+ *		find_address_module
+ *
+ * Find the module whose image contains the given address.
+ */
+static WINE_MODREF *find_address_module( const void *addr )
+{
+    struct wine_rb_entry *entry = wine_rb_get( &module_tree, addr );
+
+    if (!entry) return NULL;
+    return WINE_RB_ENTRY_VALUE( entry, WINE_MODREF, addr_entry );
+}
+
+
 /*************************************************************************
  *		get_modref
  *
@@ -327,19 +488,9 @@ static inline ULONG_PTR allocate_stub( const char *dll, const char *name ) { ret
  */
 static WINE_MODREF *get_modref( HMODULE hmod )
 {
-    PLIST_ENTRY mark, entry;
-    PLDR_MODULE mod;
-
-    if (cached_modref && cached_modref->ldr.BaseAddress == hmod) return cached_modref;
+    WINE_MODREF *wm = find_address_module( hmod );
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        mod = CONTAINING_RECORD(entry, LDR_MODULE, InMemoryOrderModuleList);
-        if (mod->BaseAddress == hmod)
-            return cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-        if (mod->BaseAddress > (void*)hmod) break;
-    }
+    if (wm && wm->ldr.BaseAddress == hmod) return wm;
     return NULL;
 }
 
@@ -352,21 +503,10 @@ static WINE_MODREF *get_modref( HMODULE hmod )
  */
 static WINE_MODREF *find_basename_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
-
-    if (cached_modref && !strcmpiW( name, cached_modref->ldr.BaseDllName.Buffer ))
-        return cached_modref;
+    WINE_MODREF *wm;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->BaseDllName.Buffer ))
-        {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-            return cached_modref;
-        }
-    }
+    LIST_FOR_EACH_ENTRY( wm, &basename_hash[hash_module_name( name )], WINE_MODREF, basename_entry )
+        if (!strcmpiW( name, wm->ldr.BaseDllName.Buffer )) return wm;
     return NULL;
 }
 
@@ -379,21 +519,10 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
  */
 static WINE_MODREF *find_fullname_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
-
-    if (cached_modref && !strcmpiW( name, cached_modref->ldr.FullDllName.Buffer ))
-        return cached_modref;
+    WINE_MODREF *wm;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->FullDllName.Buffer ))
-        {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-            return cached_modref;
-        }
-    }
+    LIST_FOR_EACH_ENTRY( wm, &fullname_hash[hash_module_name( name )], WINE_MODREF, fullname_entry )
+        if (!strcmpiW( name, wm->ldr.FullDllName.Buffer )) return wm;
     return NULL;
 }
 
@@ -541,6 +670,463 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
 }
 
 
+/*************************************************************************
+ * Persistent import cache
+ *
+ * The resolved import address table of every import descriptor is stored
+ * in a file in the config dir, keyed by the path, size, modification time
+ * and preferred base of both the importing and the exporting module, so
+ * that the next run can patch the whole table at once instead of looking
+ * up every name.  Only native modules loaded at their preferred base are
+ * cached, and only tables where every entry points into the exporting
+ * module itself, since forwarded exports and stubs have side effects or
+ * addresses that don't survive a restart.  The cache is disabled while
+ * relay or snoop tracing is active.  In memory the entries are hashed by
+ * importer and by exporter path; when a module file is seen with a new
+ * size or modification time, all the entries referring to it are dropped.
+ */
+
+#define IMPORT_CACHE_MAGIC     0x31434957  /* "WIC1" */
+#define IMPORT_CACHE_MAX_SIZE  (16 * 1024 * 1024)
+#define IMPORT_CACHE_HASH_SIZE 256
+
+struct import_cache_header
+{
+    DWORD magic;
+    DWORD ptr_size;  /* sizeof(ULONG_PTR) of the processes using the file */
+    DWORD count;     /* number of entries */
+    DWORD reserved;
+};
+
+struct import_cache_entry
+{
+    DWORD                   size;          /* total size of the entry, including the variable part */
+    DWORD                   thunk_rva;     /* FirstThunk of the import descriptor */
+    DWORD                   count;         /* number of resolved addresses */
+    DWORD                   importer_len;  /* length of the importer path in WCHARs */
+    DWORD                   exporter_len;  /* length of the exporter path in WCHARs */
+    DWORD                   stale;         /* out of date, not written back; always 0 on disk */
+    struct import_cache_key importer;
+    struct import_cache_key exporter;
+    /* followed by ULONG_PTR addresses[count], WCHAR importer[importer_len], WCHAR exporter[exporter_len] */
+};
+
+/* in-memory slot of an entry; chain links are slot indices plus one, 0 ends the chain */
+struct import_cache_slot
+{
+    struct import_cache_entry *entry;
+    unsigned int               next_importer;  /* next slot in the same importer_hash bucket */
+    unsigned int               next_exporter;  /* next slot in the same exporter_hash bucket */
+};
+
+static struct
+{
+    BOOL                       loaded;     /* set once the file has been read */
+    BOOL                       dirty;      /* entries have been added or invalidated */
+    char                      *data;       /* contents of the file */
+    struct import_cache_slot  *entries;
+    unsigned int               importer_hash[IMPORT_CACHE_HASH_SIZE];  /* first slot of each bucket, plus one */
+    unsigned int               exporter_hash[IMPORT_CACHE_HASH_SIZE];
+    unsigned int               count;
+    unsigned int               size;
+    unsigned int               hits;
+    unsigned int               misses;
+    unsigned int               uncached;
+    unsigned int               mismatches;
+} import_cache;
+
+static inline ULONG_PTR *import_cache_addrs( struct import_cache_entry *entry )
+{
+    return (ULONG_PTR *)(entry + 1);
+}
+
+static inline WCHAR *import_cache_importer( struct import_cache_entry *entry )
+{
+    return (WCHAR *)(import_cache_addrs( entry ) + entry->count);
+}
+
+static inline WCHAR *import_cache_exporter( struct import_cache_entry *entry )
+{
+    return import_cache_importer( entry ) + entry->importer_len;
+}
+
+static inline DWORD import_cache_entry_size( DWORD count, DWORD importer_len, DWORD exporter_len )
+{
+    DWORD size = sizeof(struct import_cache_entry) + count * sizeof(ULONG_PTR) +
+                 (importer_len + exporter_len) * sizeof(WCHAR);
+    return (size + 7) & ~7;
+}
+
+/* return the unix name of the cache file; the result must be freed by the caller */
+static char *get_import_cache_file(void)
+{
+    const char *config_dir = wine_get_config_dir();
+    char *name;
+
+    if (!config_dir) return NULL;
+    if ((name = RtlAllocateHeap( GetProcessHeap(), 0, strlen(config_dir) + sizeof("/import64.cache") )))
+        sprintf( name, "%s/import%u.cache", config_dir, (unsigned int)sizeof(ULONG_PTR) * 8 );
+    return name;
+}
+
+/* case-insensitive hash of a path that isn't null-terminated, consistent with strncmpiW */
+static inline unsigned int hash_import_cache_path( const WCHAR *path, DWORD len )
+{
+    unsigned int hash = 0;
+
+    while (len--) hash = hash * 31 + tolowerW( *path++ );
+    return hash % IMPORT_CACHE_HASH_SIZE;
+}
+
+static BOOL add_import_cache_entry( struct import_cache_entry *entry )
+{
+    struct import_cache_slot *slot;
+    unsigned int hash;
+
+    if (import_cache.count == import_cache.size)
+    {
+        unsigned int new_size = max( 64, import_cache.size * 2 );
+        struct import_cache_slot *new_entries;
+
+        if (import_cache.entries)
+            new_entries = RtlReAllocateHeap( GetProcessHeap(), 0, import_cache.entries,
+                                             new_size * sizeof(*new_entries) );
+        else
+            new_entries = RtlAllocateHeap( GetProcessHeap(), 0, new_size * sizeof(*new_entries) );
+        if (!new_entries) return FALSE;
+        import_cache.entries = new_entries;
+        import_cache.size = new_size;
+    }
+    slot = &import_cache.entries[import_cache.count++];
+    slot->entry = entry;
+    hash = hash_import_cache_path( import_cache_importer( entry ), entry->importer_len );
+    slot->next_importer = import_cache.importer_hash[hash];
+    import_cache.importer_hash[hash] = import_cache.count;
+    hash = hash_import_cache_path( import_cache_exporter( entry ), entry->exporter_len );
+    slot->next_exporter = import_cache.exporter_hash[hash];
+    import_cache.exporter_hash[hash] = import_cache.count;
+    return TRUE;
+}
+
+/*************************************************************************
+ *		load_import_cache
+ *
+ * Read the cache file; a missing or malformed file gives an empty cache.
+ * The loader_section must be locked while calling this function.
+ */
+static void load_import_cache(void)
+{
+    struct import_cache_header *header;
+    struct stat st;
+    char *name, *ptr, *end;
+    ssize_t ret;
+    DWORD i;
+    int fd;
+
+    import_cache.loaded = TRUE;
+    if (!(name = get_import_cache_file())) return;
+    fd = open( name, O_RDONLY );
+    RtlFreeHeap( GetProcessHeap(), 0, name );
+    if (fd == -1) return;
+
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(*header) || st.st_size > IMPORT_CACHE_MAX_SIZE ||
+        !(import_cache.data = RtlAllocateHeap( GetProcessHeap(), 0, st.st_size )))
+    {
+        close( fd );
+        return;
+    }
+    ret = pread( fd, import_cache.data, st.st_size, 0 );
+    close( fd );
+    if (ret != st.st_size) goto invalid;
+
+    header = (struct import_cache_header *)import_cache.data;
+    if (header->magic != IMPORT_CACHE_MAGIC || header->ptr_size != sizeof(ULONG_PTR)) goto invalid;
+
+    ptr = (char *)(header + 1);
+    end = import_cache.data + st.st_size;
+    for (i = 0; i < header->count; i++)
+    {
+        struct import_cache_entry *entry = (struct import_cache_entry *)ptr;
+
+        if (end - ptr < sizeof(*entry) || entry->size > end - ptr || entry->size & 7 ||
+            entry->count > entry->size / sizeof(ULONG_PTR) ||
+            entry->importer_len > entry->size / sizeof(WCHAR) ||
+            entry->exporter_len > entry->size / sizeof(WCHAR) ||
+            entry->size != import_cache_entry_size( entry->count, entry->importer_len, entry->exporter_len ))
+            goto invalid;
+        entry->stale = 0;
+        if (!add_import_cache_entry( entry )) goto invalid;
+        ptr += entry->size;
+    }
+    TRACE_(imports)( "loaded %u entries\n", import_cache.count );
+    return;
+
+invalid:
+    WARN_(imports)( "ignoring invalid import cache\n" );
+    RtlFreeHeap( GetProcessHeap(), 0, import_cache.entries );
+    RtlFreeHeap( GetProcessHeap(), 0, import_cache.data );
+    import_cache.entries = NULL;
+    import_cache.data = NULL;
+    import_cache.count = import_cache.size = 0;
+    memset( import_cache.importer_hash, 0, sizeof(import_cache.importer_hash) );
+    memset( import_cache.exporter_hash, 0, sizeof(import_cache.exporter_hash) );
+    import_cache.dirty = TRUE;
+}
+
+static BOOL write_import_cache_data( int fd, const void *data, size_t size )
+{
+    const char *ptr = data;
+    ssize_t ret;
+
+    while (size)
+    {
+        if ((ret = write( fd, ptr, size )) == -1)
+        {
+            if (errno == EINTR) continue;
+            return FALSE;
+        }
+        ptr += ret;
+        size -= ret;
+    }
+    return TRUE;
+}
+
+/*************************************************************************
+ *		save_import_cache
+ *
+ * Write back the cache file if anything changed.  The file is written
+ * under a temporary name and renamed, so that other processes always see
+ * a complete file; if several processes update it, the last one wins.
+ * The loader_section must be locked while calling this function.
+ */
+static void save_import_cache(void)
+{
+    struct import_cache_header header;
+    char *name, *tmp_name;
+    unsigned int i;
+    BOOL ret = TRUE;
+    int fd;
+
+    if (!import_cache.dirty) return;
+    if (!(name = get_import_cache_file())) return;
+    if (!(tmp_name = RtlAllocateHeap( GetProcessHeap(), 0, strlen(name) + 16 )))
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, name );
+        return;
+    }
+    sprintf( tmp_name, "%s.%x", name, (unsigned int)getpid() );
+
+    header.magic    = IMPORT_CACHE_MAGIC;
+    header.ptr_size = sizeof(ULONG_PTR);
+    header.count    = 0;
+    header.reserved = 0;
+    for (i = 0; i < import_cache.count; i++) if (!import_cache.entries[i].entry->stale) header.count++;
+
+    if ((fd = open( tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0666 )) != -1)
+    {
+        ret = write_import_cache_data( fd, &header, sizeof(header) );
+        for (i = 0; ret && i < import_cache.count; i++)
+        {
+            struct import_cache_entry *entry = import_cache.entries[i].entry;
+
+            if (entry->stale) continue;
+            ret = write_import_cache_data( fd, entry, entry->size );
+        }
+        close( fd );
+        if (ret && !rename( tmp_name, name )) import_cache.dirty = FALSE;
+        else unlink( tmp_name );
+    }
+    TRACE_(imports)( "saved %u entries to %s\n", header.count, debugstr_a(name) );
+    RtlFreeHeap( GetProcessHeap(), 0, tmp_name );
+    RtlFreeHeap( GetProcessHeap(), 0, name );
+}
+
+static inline BOOL import_cache_path_equal( const WCHAR *path, DWORD len, const UNICODE_STRING *name )
+{
+    return len == name->Length / sizeof(WCHAR) && !strncmpiW( path, name->Buffer, len );
+}
+
+/*************************************************************************
+ *		import_cache_prune
+ *
+ * Invalidate the entries that refer to an older version of a module file,
+ * either as importer or as exporter.
+ * The loader_section must be locked while calling this function.
+ */
+static void import_cache_prune( WINE_MODREF *wm )
+{
+    const UNICODE_STRING *name = &wm->ldr.FullDllName;
+    struct import_cache_slot *slot;
+    unsigned int i, hash = hash_import_cache_path( name->Buffer, name->Length / sizeof(WCHAR) );
+
+    if (!import_cache.loaded) load_import_cache();
+
+    for (i = import_cache.importer_hash[hash]; i; i = slot->next_importer)
+    {
+        slot = &import_cache.entries[i - 1];
+        if (slot->entry->stale ||
+            !import_cache_path_equal( import_cache_importer( slot->entry ), slot->entry->importer_len, name ) ||
+            !memcmp( &slot->entry->importer, &wm->cache_key, sizeof(wm->cache_key) )) continue;
+        TRACE_(imports)( "dropping entries for the previous version of %s\n", debugstr_w(name->Buffer) );
+        slot->entry->stale = 1;
+        import_cache.dirty = TRUE;
+    }
+    for (i = import_cache.exporter_hash[hash]; i; i = slot->next_exporter)
+    {
+        slot = &import_cache.entries[i - 1];
+        if (slot->entry->stale ||
+            !import_cache_path_equal( import_cache_exporter( slot->entry ), slot->entry->exporter_len, name ) ||
+            !memcmp( &slot->entry->exporter, &wm->cache_key, sizeof(wm->cache_key) )) continue;
+        TRACE_(imports)( "dropping entries for the previous version of %s\n", debugstr_w(name->Buffer) );
+        slot->entry->stale = 1;
+        import_cache.dirty = TRUE;
+    }
+}
+
+/*************************************************************************
+ *		get_import_cache_key
+ *
+ * Return the identity of a module file, or NULL if the module can't be
+ * used with the import cache.
+ */
+static const struct import_cache_key *get_import_cache_key( WINE_MODREF *wm )
+{
+    const IMAGE_NT_HEADERS *nt;
+    FILE_NETWORK_OPEN_INFORMATION info;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING nt_name;
+    NTSTATUS status;
+
+    if (wm->cache_state) return wm->cache_state > 0 ? &wm->cache_key : NULL;
+    wm->cache_state = -1;
+
+    /* builtin dlls end up at a different address on every run */
+    if (wm->ldr.Flags & LDR_WINE_INTERNAL) return NULL;
+    nt = RtlImageNtHeader( wm->ldr.BaseAddress );
+    if (nt->OptionalHeader.ImageBase != (ULONG_PTR)wm->ldr.BaseAddress) return NULL;
+
+    if (!RtlDosPathNameToNtPathName_U( wm->ldr.FullDllName.Buffer, &nt_name, NULL, NULL )) return NULL;
+    attr.Length = sizeof(attr);
+    attr.RootDirectory = 0;
+    attr.Attributes = OBJ_CASE_INSENSITIVE;
+    attr.ObjectName = &nt_name;
+    attr.SecurityDescriptor = NULL;
+    attr.SecurityQualityOfService = NULL;
+    status = NtQueryFullAttributesFile( &attr, &info );
+    RtlFreeUnicodeString( &nt_name );
+    if (status) return NULL;
+
+    wm->cache_key.size  = info.EndOfFile.QuadPart;
+    wm->cache_key.mtime = info.LastWriteTime.QuadPart;
+    wm->cache_key.base  = nt->OptionalHeader.ImageBase;
+    wm->cache_state = 1;
+    import_cache_prune( wm );
+    return &wm->cache_key;
+}
+
+/*************************************************************************
+ *		import_cache_lookup
+ *
+ * Find the cached import address table for an import descriptor.  Entries
+ * for the same descriptor whose modules have changed are invalidated.
+ * The loader_section must be locked while calling this function.
+ */
+static struct import_cache_entry *import_cache_lookup( WINE_MODREF *importer, WINE_MODREF *exporter,
+                                                       DWORD thunk_rva, DWORD count )
+{
+    const UNICODE_STRING *name = &importer->ldr.FullDllName;
+    struct import_cache_entry *entry, *found = NULL;
+    unsigned int i;
+
+    if (!import_cache.loaded) load_import_cache();
+
+    for (i = import_cache.importer_hash[hash_import_cache_path( name->Buffer, name->Length / sizeof(WCHAR) )];
+         i; i = import_cache.entries[i - 1].next_importer)
+    {
+        entry = import_cache.entries[i - 1].entry;
+        if (entry->stale || entry->thunk_rva != thunk_rva) continue;
+        if (!import_cache_path_equal( import_cache_importer( entry ), entry->importer_len,
+                                      &importer->ldr.FullDllName )) continue;
+        if (!import_cache_path_equal( import_cache_exporter( entry ), entry->exporter_len,
+                                      &exporter->ldr.FullDllName )) continue;
+
+        if (!found && entry->count == count &&
+            !memcmp( &entry->importer, &importer->cache_key, sizeof(entry->importer) ) &&
+            !memcmp( &entry->exporter, &exporter->cache_key, sizeof(entry->exporter) ))
+        {
+            found = entry;
+            continue;
+        }
+        TRACE_(imports)( "invalidating entry for %s imports from %s\n",
+                         debugstr_w(importer->ldr.FullDllName.Buffer),
+                         debugstr_w(exporter->ldr.FullDllName.Buffer) );
+        entry->stale = 1;
+        import_cache.dirty = TRUE;
+    }
+    if (found) import_cache.hits++;
+    else import_cache.misses++;
+    return found;
+}
+
+/*************************************************************************
+ *		import_cache_update
+ *
+ * Check a freshly resolved import address table against the cached entry
+ * if any, and store it in the cache if it can be reused by the next run.
+ * The loader_section must be locked while calling this function.
+ */
+static void import_cache_update( WINE_MODREF *importer, WINE_MODREF *exporter, DWORD thunk_rva,
+                                 const IMAGE_THUNK_DATA *thunks, DWORD count,
+                                 struct import_cache_entry *cached )
+{
+    struct import_cache_entry *entry;
+    ULONG_PTR start = (ULONG_PTR)exporter->ldr.BaseAddress;
+    DWORD i, importer_len, exporter_len, size;
+
+    if (cached)
+    {
+        for (i = 0; i < count; i++) if (import_cache_addrs( cached )[i] != thunks[i].u1.Function) break;
+        if (i == count) return;
+        ERR_(imports)( "cached entry %u for %s imports from %s is wrong\n", i,
+                       debugstr_w(importer->ldr.FullDllName.Buffer),
+                       debugstr_w(exporter->ldr.FullDllName.Buffer) );
+        import_cache.mismatches++;
+        cached->stale = 1;
+        import_cache.dirty = TRUE;
+    }
+
+    /* forwarded exports and stubs live outside of the exporting module */
+    for (i = 0; i < count; i++)
+        if (thunks[i].u1.Function - start >= exporter->ldr.SizeOfImage) break;
+    if (i < count)
+    {
+        import_cache.uncached++;
+        return;
+    }
+
+    importer_len = importer->ldr.FullDllName.Length / sizeof(WCHAR);
+    exporter_len = exporter->ldr.FullDllName.Length / sizeof(WCHAR);
+    size = import_cache_entry_size( count, importer_len, exporter_len );
+    if (!(entry = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, size ))) return;
+    entry->size         = size;
+    entry->thunk_rva    = thunk_rva;
+    entry->count        = count;
+    entry->importer_len = importer_len;
+    entry->exporter_len = exporter_len;
+    entry->importer     = importer->cache_key;
+    entry->exporter     = exporter->cache_key;
+    for (i = 0; i < count; i++) import_cache_addrs( entry )[i] = thunks[i].u1.Function;
+    memcpy( import_cache_importer( entry ), importer->ldr.FullDllName.Buffer, importer_len * sizeof(WCHAR) );
+    memcpy( import_cache_exporter( entry ), exporter->ldr.FullDllName.Buffer, exporter_len * sizeof(WCHAR) );
+    if (!add_import_cache_entry( entry ))
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, entry );
+        return;
+    }
+    import_cache.dirty = TRUE;
+}
+
+
 /*************************************************************************
  *		import_dll
  *
@@ -561,7 +1147,9 @@ static WINE_MODREF *import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *d
     DWORD len = strlen(name);
     PVOID protect_base;
     SIZE_T protect_size = 0;
-    DWORD protect_old;
+    DWORD protect_old, count;
+    struct import_cache_entry *cache_entry = NULL;
+    BOOL use_cache = FALSE;
 
     thunk_list = get_rva( module, (DWORD)descr->FirstThunk );
     if (descr->u.OriginalFirstThunk)
@@ -601,6 +1189,7 @@ static WINE_MODREF *import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *d
     /* unprotect the import address table since it can be located in
      * readonly section */
     while (import_list[protect_size].u1.Ordinal) protect_size++;
+    count = protect_size;
     protect_base = thunk_list;
     protect_size *= sizeof(*thunk_list);
     NtProtectVirtualMemory( NtCurrentProcess(), &protect_base,
@@ -635,6 +1224,26 @@ static WINE_MODREF *import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *d
         goto done;
     }
 
+    /* relay and snoop thunks are different on every run */
+    if (import_cache_mode && !TRACE_ON(relay) && !TRACE_ON(snoop))
+    {
+        if (get_import_cache_key( current_modref ) && get_import_cache_key( wmImp ))
+        {
+            use_cache = TRUE;
+            cache_entry = import_cache_lookup( current_modref, wmImp, descr->FirstThunk, count );
+            if (cache_entry && import_cache_mode != IMPORT_CACHE_VERIFY)
+            {
+                const ULONG_PTR *addrs = import_cache_addrs( cache_entry );
+                DWORD i;
+
+                TRACE_(imports)( "--- %u entries of %s from cache\n", count, name );
+                for (i = 0; i < count; i++) thunk_list[i].u1.Function = addrs[i];
+                goto done;
+            }
+        }
+        else import_cache.uncached++;
+    }
+
     while (import_list->u1.Ordinal)
     {
         if (IMAGE_SNAP_BY_ORDINAL(import_list->u1.Ordinal))
@@ -673,6 +1282,9 @@ static WINE_MODREF *import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *d
         thunk_list++;
     }
 
+    if (use_cache)
+        import_cache_update( current_modref, wmImp, descr->FirstThunk, thunk_list - count, count, cache_entry );
+
 done:
     /* restore old protection of the import address table */
     NtProtectVirtualMemory( NtCurrentProcess(), &protect_base, &protect_size, protect_old, NULL );
@@ -706,6 +1318,48 @@ static NTSTATUS create_module_activation_context( LDR_MODULE *module )
 }
 
 
+/****************************************************************
+ *       prefetch_imports
+ *
+ * Start reading in the files of all the dlls imported by a module that
+ * aren't loaded yet, so that the I/O for independent dlls overlaps instead
+ * of being done one page fault at a time during the depth-first load.
+ * The load order itself is not affected.
+ * The loader_section must be locked while calling this function.
+ */
+static void prefetch_imports( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *imports, int nb_imports,
+                              LPCWSTR load_path )
+{
+    WCHAR buffer[32], filename[MAX_PATH];
+    WINE_MODREF *wm;
+    HANDLE handle;
+    ULONG size;
+    int i;
+
+    for (i = 0; i < nb_imports; i++)
+    {
+        const char *name = get_rva( module, imports[i].Name );
+        DWORD len = strlen(name);
+
+        while (len && name[len-1] == ' ') len--;  /* remove trailing spaces */
+        if (len * sizeof(WCHAR) >= sizeof(buffer)) continue;
+        ascii_to_unicode( buffer, name, len );
+        buffer[len] = 0;
+
+        size = sizeof(filename);
+        handle = 0;
+        if (find_dll_file( load_path, buffer, filename, &size, &wm, &handle )) continue;
+        if (!handle) continue;
+        if (!wm)
+        {
+            TRACE( "prefetching %s\n", debugstr_w(filename) );
+            virtual_prefetch_file( handle );
+        }
+        NtClose( handle );
+    }
+}
+
+
 /****************************************************************
  *       fixup_imports
  *
@@ -740,6 +1394,8 @@ static NTSTATUS fixup_imports( WINE_MODREF *wm, LPCWSTR load_path )
     wm->nDeps = nb_imports;
     wm->deps  = RtlAllocateHeap( GetProcessHeap(), 0, nb_imports*sizeof(WINE_MODREF *) );
 
+    if (prefetch_dlls) prefetch_imports( wm->ldr.BaseAddress, imports, nb_imports, load_path );
+
     /* load the imported modules. They are automatically
      * added to the modref list of the process.
      */
@@ -812,6 +1468,8 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
 
     wm->nDeps    = 0;
     wm->deps     = NULL;
+    wm->indexed  = FALSE;
+    wm->cache_state = 0;
 
     wm->ldr.BaseAddress   = hModule;
     wm->ldr.EntryPoint    = NULL;
@@ -851,6 +1509,8 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
     wm->ldr.InMemoryOrderModuleList.Flink = entry;
     entry->Blink = &wm->ldr.InMemoryOrderModuleList;
 
+    index_module( wm );
+
     /* wait until init is called for inserting into this list */
     wm->ldr.InInitializationOrderModuleList.Flink = NULL;
     wm->ldr.InInitializationOrderModuleList.Blink = NULL;
@@ -1269,22 +1929,11 @@ NTSTATUS WINAPI LdrDisableThreadCalloutsForDll(HMODULE hModule)
  */
 NTSTATUS WINAPI LdrFindEntryForAddress(const void* addr, PLDR_MODULE* pmod)
 {
-    PLIST_ENTRY mark, entry;
-    PLDR_MODULE mod;
+    WINE_MODREF *wm = find_address_module( addr );
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        mod = CONTAINING_RECORD(entry, LDR_MODULE, InMemoryOrderModuleList);
-        if (mod->BaseAddress <= addr &&
-            (const char *)addr < (char*)mod->BaseAddress + mod->SizeOfImage)
-        {
-            *pmod = mod;
-            return STATUS_SUCCESS;
-        }
-        if (mod->BaseAddress > addr) break;
-    }
-    return STATUS_NO_MORE_ENTRIES;
+    if (!wm || !wm->ldr.SizeOfImage) return STATUS_NO_MORE_ENTRIES;
+    *pmod = &wm->ldr;
+    return STATUS_SUCCESS;
 }
 
 /******************************************************************
@@ -1480,6 +2129,7 @@ static void load_builtin_callback( void *module, const char *filename )
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            unindex_module( wm );
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -1552,6 +2202,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, LPCWSTR name, HANDLE file,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            unindex_module( wm );
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -2394,6 +3045,18 @@ BOOLEAN WINAPI RtlDllShutdownInProgress(void)
 void WINAPI LdrShutdownProcess(void)
 {
     TRACE("()\n");
+    if (import_cache_mode)
+    {
+        RtlEnterCriticalSection( &loader_section );
+        save_import_cache();
+        if (import_cache_mode >= IMPORT_CACHE_STATS)
+            MESSAGE( "wine: import cache: %u hits, %u misses (%u%% hit rate), %u not cacheable, %u wrong\n",
+                     import_cache.hits, import_cache.misses,
+                     import_cache.hits + import_cache.misses ?
+                     import_cache.hits * 100 / (import_cache.hits + import_cache.misses) : 0,
+                     import_cache.uncached, import_cache.mismatches );
+        RtlLeaveCriticalSection( &loader_section );
+    }
     process_detach( TRUE, (LPVOID)1 );
 }
 
@@ -2441,6 +3104,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
     RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+    unindex_module( wm );
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
 
@@ -2460,7 +3124,6 @@ static void free_modref( WINE_MODREF *wm )
     RtlReleaseActivationContext( wm->ldr.ActivationContext );
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.BaseAddress );
     if (wm->ldr.Flags & LDR_WINE_INTERNAL) wine_dll_unload( wm->ldr.SectionHandle );
-    if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
     RtlFreeHeap( GetProcessHeap(), 0, wm->deps );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
@@ -2899,6 +3562,7 @@ void CDECL __wine_init_windows_dir( const WCHAR *windir, const WCHAR *sysdir )
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
         LDR_MODULE *mod = CONTAINING_RECORD( entry, LDR_MODULE, InLoadOrderModuleList );
+        WINE_MODREF *wm = CONTAINING_RECORD( mod, WINE_MODREF, ldr );
 
         assert( mod->Flags & LDR_WINE_INTERNAL );
 
@@ -2911,6 +3575,9 @@ void CDECL __wine_init_windows_dir( const WCHAR *windir, const WCHAR *sysdir )
         strcpyW( p, mod->FullDllName.Buffer );
         RtlInitUnicodeString( &mod->FullDllName, buffer );
         RtlInitUnicodeString( &mod->BaseDllName, p );
+        /* the full name changed, rehash it */
+        list_remove( &wm->fullname_entry );
+        list_add_tail( &fullname_hash[hash_module_name( buffer )], &wm->fullname_entry );
     }
 }
 
@@ -2925,6 +3592,7 @@ void __wine_process_init(void)
     WINE_MODREF *wm;
     NTSTATUS status;
     ANSI_STRING func_name;
+    const char *prefetch, *import_cache_env;
     void (* DECLSPEC_NORETURN CDECL init_func)(void);
 
     main_exe_file = thread_init();
@@ -2934,6 +3602,14 @@ void __wine_process_init(void)
     umask( FILE_umask );
 
     load_global_options();
+    init_module_index();
+    if ((prefetch = getenv( "WINEPREFETCHDLLS" ))) prefetch_dlls = atoi( prefetch ) != 0;
+    if ((import_cache_env = getenv( "WINEIMPORTCACHE" )))
+    {
+        if (!strcmp( import_cache_env, "stats" )) import_cache_mode = IMPORT_CACHE_STATS;
+        else if (!strcmp( import_cache_env, "verify" )) import_cache_mode = IMPORT_CACHE_VERIFY;
+        else if (atoi( import_cache_env )) import_cache_mode = IMPORT_CACHE_ON;
+    }
 
     /* setup the load callback and create ntdll modref */
     wine_dll_set_callback( load_builtin_callback );
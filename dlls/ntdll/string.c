@@ -28,17 +28,157 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "windef.h"
 #include "winternl.h"
 
+#ifdef __SSE2__
+
+/* above this size the host libc routines, which pick the best instructions
+ * for the cpu at run time, make up for the cost of the calling convention switch */
+#define HOST_MEM_THRESHOLD 1024
+
+static inline __m128i load16( const void *ptr )
+{
+    return _mm_loadu_si128( (const __m128i *)ptr );
+}
+
+static inline void store16( void *ptr, __m128i val )
+{
+    _mm_storeu_si128( (__m128i *)ptr, val );
+}
+
+/* copy non-overlapping blocks; the head and tail are copied with possibly overlapping
+ * stores so that no byte loops are needed */
+static inline void copy_block( unsigned char *d, const unsigned char *s, size_t n )
+{
+    if (n >= 16)
+    {
+        __m128i head = load16( s ), tail = load16( s + n - 16 );
+        size_t i;
+
+        for (i = 16; i + 16 < n; i += 16) store16( d + i, load16( s + i ));
+        store16( d, head );
+        store16( d + n - 16, tail );
+    }
+    else if (n >= 8)
+    {
+        __m128i head = _mm_loadl_epi64( (const __m128i *)s );
+        __m128i tail = _mm_loadl_epi64( (const __m128i *)(s + n - 8) );
+        _mm_storel_epi64( (__m128i *)d, head );
+        _mm_storel_epi64( (__m128i *)(d + n - 8), tail );
+    }
+    else if (n >= 4)
+    {
+        DWORD head = *(const DWORD *)s, tail = *(const DWORD *)(s + n - 4);
+        *(DWORD *)d = head;
+        *(DWORD *)(d + n - 4) = tail;
+    }
+    else if (n)
+    {
+        unsigned char head = s[0], mid = s[n / 2], tail = s[n - 1];
+        d[0] = head;
+        d[n / 2] = mid;
+        d[n - 1] = tail;
+    }
+}
+
+static inline void fill_block( unsigned char *d, unsigned char c, size_t n )
+{
+    if (n >= 16)
+    {
+        __m128i val = _mm_set1_epi8( c );
+        size_t i;
+
+        for (i = 0; i + 16 < n; i += 16) store16( d + i, val );
+        store16( d + n - 16, val );
+    }
+    else if (n >= 8)
+    {
+        __m128i val = _mm_set1_epi8( c );
+        _mm_storel_epi64( (__m128i *)d, val );
+        _mm_storel_epi64( (__m128i *)(d + n - 8), val );
+    }
+    else if (n >= 4)
+    {
+        DWORD val = 0x01010101u * c;
+        *(DWORD *)d = val;
+        *(DWORD *)(d + n - 4) = val;
+    }
+    else if (n)
+    {
+        d[0] = d[n / 2] = d[n - 1] = c;
+    }
+}
+
+/* find the first char that is NUL or equal to ch; aligned loads never cross a page boundary */
+static const char *find_char_or_nul( const char *str, char ch )
+{
+    const __m128i zero = _mm_setzero_si128(), chv = _mm_set1_epi8( ch );
+    const __m128i *block = (const __m128i *)((ULONG_PTR)str & ~15);
+    __m128i chars = _mm_load_si128( block );
+    unsigned int mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( chars, zero ),
+                                                         _mm_cmpeq_epi8( chars, chv )));
+
+    mask &= ~0u << ((ULONG_PTR)str & 15);  /* ignore the chars before str */
+    while (!mask)
+    {
+        chars = _mm_load_si128( ++block );
+        mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( chars, zero ),
+                                                _mm_cmpeq_epi8( chars, chv )));
+    }
+    return (const char *)block + __builtin_ctz( mask );
+}
+
+#endif  /* __SSE2__ */
+
+static inline void *move_mem( void *dst, const void *src, size_t n )
+{
+#ifdef __SSE2__
+    /* small blocks are loaded completely before being stored, so they may overlap */
+    if (n <= 32)
+    {
+        if (n > 16)
+        {
+            __m128i head = load16( src ), tail = load16( (const char *)src + n - 16 );
+            store16( dst, head );
+            store16( (char *)dst + n - 16, tail );
+        }
+        else copy_block( dst, src, n );
+        return dst;
+    }
+    if (n < HOST_MEM_THRESHOLD && (size_t)((char *)dst - (const char *)src) >= n &&
+        (size_t)((const char *)src - (char *)dst) >= n)
+    {
+        copy_block( dst, src, n );
+        return dst;
+    }
+#endif
+    return memmove( dst, src, n );
+}
+
 
 /*********************************************************************
  *                  memchr   (NTDLL.@)
  */
 void * __cdecl NTDLL_memchr( const void *ptr, int c, size_t n )
 {
+#ifdef __SSE2__
+    const unsigned char *p = ptr;
+    const __m128i chv = _mm_set1_epi8( c );
+    unsigned int mask;
+
+    for ( ; n >= 16; p += 16, n -= 16)
+        if ((mask = _mm_movemask_epi8( _mm_cmpeq_epi8( load16( p ), chv ))))
+            return (void *)(p + __builtin_ctz( mask ));
+    for ( ; n; p++, n--) if (*p == (unsigned char)c) return (void *)p;
+    return NULL;
+#else
     return memchr( ptr, c, n );
+#endif
 }
 
 
@@ -47,7 +187,24 @@ void * __cdecl NTDLL_memchr( const void *ptr, int c, size_t n )
  */
 int __cdecl NTDLL_memcmp( const void *ptr1, const void *ptr2, size_t n )
 {
+#ifdef __SSE2__
+    const unsigned char *p1 = ptr1, *p2 = ptr2;
+    unsigned int mask;
+
+    for ( ; n >= 16; p1 += 16, p2 += 16, n -= 16)
+    {
+        mask = _mm_movemask_epi8( _mm_cmpeq_epi8( load16( p1 ), load16( p2 )));
+        if (mask != 0xffff)
+        {
+            mask = __builtin_ctz( ~mask );
+            return p1[mask] - p2[mask];
+        }
+    }
+    for ( ; n; p1++, p2++, n--) if (*p1 != *p2) return *p1 - *p2;
+    return 0;
+#else
     return memcmp( ptr1, ptr2, n );
+#endif
 }
 
 
@@ -59,7 +216,7 @@ int __cdecl NTDLL_memcmp( const void *ptr1, const void *ptr2, size_t n )
  */
 void * __cdecl NTDLL_memcpy( void *dst, const void *src, size_t n )
 {
-    return memmove( dst, src, n );
+    return move_mem( dst, src, n );
 }
 
 
@@ -68,7 +225,7 @@ void * __cdecl NTDLL_memcpy( void *dst, const void *src, size_t n )
  */
 void * __cdecl NTDLL_memmove( void *dst, const void *src, size_t n )
 {
-    return memmove( dst, src, n );
+    return move_mem( dst, src, n );
 }
 
 
@@ -77,6 +234,13 @@ void * __cdecl NTDLL_memmove( void *dst, const void *src, size_t n )
  */
 void * __cdecl NTDLL_memset( void *dst, int c, size_t n )
 {
+#ifdef __SSE2__
+    if (n < HOST_MEM_THRESHOLD)
+    {
+        fill_block( dst, c, n );
+        return dst;
+    }
+#endif
     return memset( dst, c, n );
 }
 
@@ -95,7 +259,12 @@ char * __cdecl NTDLL_strcat( char *dst, const char *src )
  */
 char * __cdecl NTDLL_strchr( const char *str, int c )
 {
+#ifdef __SSE2__
+    str = find_char_or_nul( str, c );
+    return *str == (char)c ? (char *)str : NULL;
+#else
     return strchr( str, c );
+#endif
 }
 
 
@@ -131,7 +300,11 @@ size_t __cdecl NTDLL_strcspn( const char *str, const char *reject )
  */
 size_t __cdecl NTDLL_strlen( const char *str )
 {
+#ifdef __SSE2__
+    return find_char_or_nul( str, 0 ) - str;
+#else
     return strlen( str );
+#endif
 }
 
 
@@ -56,6 +56,15 @@ static LPWSTR   (__cdecl *p_wcsupr)(LPWSTR);
 
 static LPWSTR   (WINAPIV *p_wcschr)(LPCWSTR, WCHAR);
 static LPWSTR   (WINAPIV *p_wcsrchr)(LPCWSTR, WCHAR);
+static int      (__cdecl *p_wcslen)(LPCWSTR);
+static int      (__cdecl *p_wcscmp)(LPCWSTR, LPCWSTR);
+static int      (__cdecl *p_wcsicmp)(LPCWSTR, LPCWSTR);
+static void*    (__cdecl *p_memchr)(const void *, int, size_t);
+static int      (__cdecl *p_memcmp)(const void *, const void *, size_t);
+static void*    (__cdecl *p_memmove)(void *, const void *, size_t);
+static void*    (__cdecl *p_memset)(void *, int, size_t);
+static size_t   (__cdecl *p_strlen)(const char *);
+static char*    (__cdecl *p_strchr)(const char *, int);
 
 static void     (__cdecl *p_qsort)(void *,size_t,size_t, int(__cdecl *compar)(const void *, const void *) );
 static void*    (__cdecl *p_bsearch)(void *,void*,size_t,size_t, int(__cdecl *compar)(const void *, const void *) );
@@ -94,6 +103,15 @@ static void InitFunctionPtrs(void)
 
 	p_wcschr= (void *)GetProcAddress(hntdll, "wcschr");
 	p_wcsrchr= (void *)GetProcAddress(hntdll, "wcsrchr");
+	p_wcslen = (void *)GetProcAddress(hntdll, "wcslen");
+	p_wcscmp = (void *)GetProcAddress(hntdll, "wcscmp");
+	p_wcsicmp = (void *)GetProcAddress(hntdll, "_wcsicmp");
+	p_memchr = (void *)GetProcAddress(hntdll, "memchr");
+	p_memcmp = (void *)GetProcAddress(hntdll, "memcmp");
+	p_memmove = (void *)GetProcAddress(hntdll, "memmove");
+	p_memset = (void *)GetProcAddress(hntdll, "memset");
+	p_strlen = (void *)GetProcAddress(hntdll, "strlen");
+	p_strchr = (void *)GetProcAddress(hntdll, "strchr");
 	p_qsort= (void *)GetProcAddress(hntdll, "qsort");
 	p_bsearch= (void *)GetProcAddress(hntdll, "bsearch");
     } /* if */
@@ -1143,6 +1161,64 @@ static void test_wcsrchr(void)
        "wcsrchr should have returned NULL\n");
 }
 
+static int sign(int val)
+{
+    return val < 0 ? -1 : val > 0 ? 1 : 0;
+}
+
+static WCHAR lower_ascii(WCHAR ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? ch + 'a' - 'A' : ch;
+}
+
+/* compare against plain loops for all the alignments and lengths around the block size */
+static void test_wcs_alignment(void)
+{
+    WCHAR buffer1[80], buffer2[80];
+    int off1, off2, len, diff, i, expect;
+
+    for (off1 = 0; off1 < 8; off1++)
+    for (len = 0; len < 40; len++)
+    {
+        WCHAR *str1 = buffer1 + off1;
+        const WCHAR *p;
+
+        for (i = 0; i < len; i++) str1[i] = 'a' + i % 7;
+        str1[len] = 0;
+        str1[len + 1] = 'a';
+
+        if (p_wcslen) ok(p_wcslen(str1) == len, "off %d: wcslen returned %d, expected %d\n",
+                         off1, p_wcslen(str1), len);
+        if (p_wcschr)
+        {
+            for (p = str1; *p && *p != 'g'; p++);
+            ok(p_wcschr(str1, 'g') == (*p ? p : NULL), "off %d len %d: wrong wcschr result\n", off1, len);
+            ok(p_wcschr(str1, 0) == str1 + len, "off %d len %d: wrong wcschr result for 0\n", off1, len);
+        }
+
+        for (off2 = 0; off2 < 8; off2++)
+        for (diff = 0; diff <= len; diff++)
+        {
+            WCHAR *str2 = buffer2 + off2;
+
+            memcpy(str2, str1, (len + 1) * sizeof(WCHAR));
+            if (diff < len) str2[diff] = 'b' + diff % 7;
+            for (i = 0; str1[i] && str1[i] == str2[i]; i++);
+            expect = sign(str1[i] - str2[i]);
+            if (p_wcscmp)
+                ok(sign(p_wcscmp(str1, str2)) == expect, "off %d,%d len %d diff %d: wrong wcscmp result\n",
+                   off1, off2, len, diff);
+
+            if (diff < len) str2[diff] = str1[diff] - 'a' + 'A';
+            for (i = 0; str1[i] && lower_ascii(str1[i]) == lower_ascii(str2[i]); i++);
+            expect = sign(lower_ascii(str1[i]) - lower_ascii(str2[i]));
+            if (p_wcsicmp)
+                ok(sign(p_wcsicmp(str1, str2)) == expect, "off %d,%d len %d diff %d: wrong _wcsicmp result\n",
+                   off1, off2, len, diff);
+        }
+    }
+}
+
 static void test_wcslwrupr(void)
 {
     static WCHAR teststringW[] = {'a','b','r','a','c','a','d','a','b','r','a',0};
@@ -1270,6 +1346,80 @@ static void test_bsearch(void)
     }
 }
 
+static void test_mem_alignment(void)
+{
+    static const int sizes[] = { 0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000, 1100 };
+    static char buffer[1300], expect[1300];
+    int off1, off2, i, j, len;
+    char *p;
+
+    for (off1 = 0; off1 < 16; off1++)
+    for (i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+        len = sizes[i];
+        for (j = 0; j < sizeof(buffer); j++) buffer[j] = 'a' + j % 23;
+
+        if (p_memset)
+        {
+            memcpy(expect, buffer, sizeof(buffer));
+            for (j = 0; j < len; j++) expect[off1 + j] = 'x';
+            ok(p_memset(buffer + off1, 'x', len) == buffer + off1, "off %d len %d: wrong memset result\n", off1, len);
+            ok(!memcmp(buffer, expect, sizeof(buffer)), "off %d len %d: wrong memset data\n", off1, len);
+            for (j = 0; j < sizeof(buffer); j++) buffer[j] = 'a' + j % 23;
+        }
+
+        if (p_memchr)
+        {
+            buffer[off1 + len] = '!';
+            ok(p_memchr(buffer + off1, '!', len) == NULL, "off %d len %d: wrong memchr result\n", off1, len);
+            ok(p_memchr(buffer + off1, '!', len + 1) == buffer + off1 + len,
+               "off %d len %d: wrong memchr result\n", off1, len);
+        }
+
+        if (p_strlen && p_strchr)
+        {
+            buffer[off1 + len] = 0;
+            ok(p_strlen(buffer + off1) == len, "off %d: strlen returned %u, expected %d\n",
+               off1, (unsigned int)p_strlen(buffer + off1), len);
+            ok(p_strchr(buffer + off1, 0) == buffer + off1 + len, "off %d len %d: wrong strchr result for 0\n", off1, len);
+            for (p = buffer + off1; *p && *p != 'w'; p++);
+            ok(p_strchr(buffer + off1, 'w') == (*p ? p : NULL), "off %d len %d: wrong strchr result\n", off1, len);
+            buffer[off1 + len] = '!';
+        }
+
+        for (off2 = 0; off2 < 16; off2 += 5)
+        {
+            if (p_memcmp && len)
+            {
+                memcpy(expect + off2, buffer + off1, len);
+                ok(!p_memcmp(buffer + off1, expect + off2, len), "off %d,%d len %d: wrong memcmp result\n",
+                   off1, off2, len);
+                expect[off2 + len - 1]++;
+                ok(p_memcmp(buffer + off1, expect + off2, len) < 0, "off %d,%d len %d: wrong memcmp result\n",
+                   off1, off2, len);
+                expect[off2 + len / 2] -= 2;
+                ok(p_memcmp(buffer + off1, expect + off2, len) > 0, "off %d,%d len %d: wrong memcmp result\n",
+                   off1, off2, len);
+            }
+
+            if (p_memmove)
+            {
+                /* overlapping in both directions */
+                for (j = 0; j < sizeof(buffer); j++) buffer[j] = 'a' + j % 23;
+                memcpy(expect, buffer + 100 + off1, len);
+                ok(p_memmove(buffer + 100 + off2, buffer + 100 + off1, len) == buffer + 100 + off2,
+                   "off %d,%d len %d: wrong memmove result\n", off1, off2, len);
+                ok(!memcmp(buffer + 100 + off2, expect, len), "off %d,%d len %d: wrong memmove data\n",
+                   off1, off2, len);
+                memcpy(expect, buffer, len);
+                p_memmove(buffer + 150 + off2, buffer, len);
+                ok(!memcmp(buffer + 150 + off2, expect, len), "off %d,%d len %d: wrong memmove data\n",
+                   off1, off2, len);
+            }
+        }
+    }
+}
+
 START_TEST(string)
 {
     InitFunctionPtrs();
@@ -1294,6 +1444,8 @@ START_TEST(string)
         test_wcschr();
     if (p_wcsrchr)
         test_wcsrchr();
+    test_wcs_alignment();
+    test_mem_alignment();
     if (p_wcslwr && p_wcsupr)
         test_wcslwrupr();
     if (patoi)
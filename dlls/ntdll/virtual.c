@@ -1810,6 +1810,24 @@ static int free_reserved_memory( void *base, size_t size, void *arg )
     return 1;  /* stop enumeration since the list has changed */
 }
 
+/***********************************************************************
+ *           virtual_prefetch_file
+ *
+ * Ask the kernel to start reading in the contents of a file, so that
+ * mapping it later doesn't have to wait for the disk page by page.
+ */
+void virtual_prefetch_file( HANDLE handle )
+{
+#ifdef POSIX_FADV_WILLNEED
+    int unix_fd, needs_close;
+
+    if (server_get_unix_fd( handle, FILE_READ_DATA, &unix_fd, &needs_close, NULL, NULL )) return;
+    posix_fadvise( unix_fd, 0, 0, POSIX_FADV_WILLNEED );
+    if (needs_close) close( unix_fd );
+#endif
+}
+
+
 /***********************************************************************
  *           virtual_release_address_space
  *
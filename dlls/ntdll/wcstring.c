@@ -28,11 +28,44 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "windef.h"
 #include "winternl.h"
 #include "wine/unicode.h"
 
+#ifdef __SSE2__
+
+/* check that an unaligned 16-byte load at ptr doesn't cross a page boundary */
+static inline BOOL can_load_16( const void *ptr )
+{
+    return ((ULONG_PTR)ptr & 0xfff) <= 0x1000 - 16;
+}
+
+/* find the first char that is NUL or equal to ch; str must be WCHAR-aligned */
+static const WCHAR *find_char_or_nul( const WCHAR *str, WCHAR ch )
+{
+    const __m128i zero = _mm_setzero_si128(), chv = _mm_set1_epi16( ch );
+    /* aligned loads never cross a page boundary */
+    const __m128i *block = (const __m128i *)((ULONG_PTR)str & ~15);
+    __m128i chars = _mm_load_si128( block );
+    unsigned int mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi16( chars, zero ),
+                                                         _mm_cmpeq_epi16( chars, chv )));
+
+    mask &= ~0u << ((ULONG_PTR)str & 15);  /* ignore the chars before str */
+    while (!mask)
+    {
+        chars = _mm_load_si128( ++block );
+        mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi16( chars, zero ),
+                                                _mm_cmpeq_epi16( chars, chv )));
+    }
+    return (const WCHAR *)((const char *)block + __builtin_ctz( mask ));
+}
+
+#endif  /* __SSE2__ */
+
 /*********************************************************************
  *           _wcsicmp    (NTDLL.@)
  */
@@ -101,6 +134,13 @@ LPWSTR __cdecl NTDLL_wcscat( LPWSTR dst, LPCWSTR src )
  */
 LPWSTR __cdecl NTDLL_wcschr( LPCWSTR str, WCHAR ch )
 {
+#ifdef __SSE2__
+    if (!((ULONG_PTR)str & 1))
+    {
+        str = find_char_or_nul( str, ch );
+        return *str == ch ? (LPWSTR)str : NULL;
+    }
+#endif
     return strchrW( str, ch );
 }
 
@@ -110,7 +150,34 @@ LPWSTR __cdecl NTDLL_wcschr( LPCWSTR str, WCHAR ch )
  */
 INT __cdecl NTDLL_wcscmp( LPCWSTR str1, LPCWSTR str2 )
 {
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for (;;)
+    {
+        if (can_load_16( str1 ) && can_load_16( str2 ))
+        {
+            __m128i chars1 = _mm_loadu_si128( (const __m128i *)str1 );
+            __m128i chars2 = _mm_loadu_si128( (const __m128i *)str2 );
+
+            if (_mm_movemask_epi8( _mm_cmpeq_epi16( chars1, chars2 )) == 0xffff &&
+                !_mm_movemask_epi8( _mm_cmpeq_epi16( chars1, zero )))
+            {
+                str1 += 8;
+                str2 += 8;
+                continue;
+            }
+            /* the difference or the terminator is in this block */
+            while (*str1 && *str1 == *str2) { str1++; str2++; }
+            return *str1 - *str2;
+        }
+        if (!*str1 || *str1 != *str2) return *str1 - *str2;
+        str1++;
+        str2++;
+    }
+#else
     return strcmpW( str1, str2 );
+#endif
 }
 
 
@@ -137,6 +204,9 @@ INT __cdecl NTDLL_wcscspn( LPCWSTR str, LPCWSTR reject )
  */
 INT __cdecl NTDLL_wcslen( LPCWSTR str )
 {
+#ifdef __SSE2__
+    if (!((ULONG_PTR)str & 1)) return find_char_or_nul( str, 0 ) - str;
+#endif
     return strlenW( str );
 }
 
@@ -96,6 +96,9 @@ static void dump_instr_arg(instr_arg_type_t type, instr_arg_t *arg)
     case ARG_DOUBLE:
         TRACE_(vbscript_disas)("\t%lf", *arg->dbl);
         break;
+    case ARG_MEMBER:
+        TRACE_(vbscript_disas)("\t%s", debugstr_w(arg->member->name));
+        break;
     case ARG_NONE:
         break;
     DEFAULT_UNREACHABLE;
@@ -316,6 +319,28 @@ static HRESULT push_instr_uint_bstr(compile_ctx_t *ctx, vbsop_t op, unsigned arg
     return S_OK;
 }
 
+static HRESULT push_instr_member_uint(compile_ctx_t *ctx, vbsop_t op, const WCHAR *name, unsigned arg2)
+{
+    member_ref_t *member;
+    unsigned instr;
+
+    member = compiler_alloc_zero(ctx->code, sizeof(*member));
+    if(!member)
+        return E_OUTOFMEMORY;
+
+    member->name = alloc_bstr_arg(ctx, name);
+    if(!member->name)
+        return E_OUTOFMEMORY;
+
+    instr = push_instr(ctx, op);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->arg1.member = member;
+    instr_ptr(ctx, instr)->arg2.uint = arg2;
+    return S_OK;
+}
+
 #define LABEL_FLAG 0x80000000
 
 static unsigned alloc_label(compile_ctx_t *ctx)
@@ -405,7 +430,7 @@ static HRESULT compile_member_expression(compile_ctx_t *ctx, member_expression_t
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_bstr_uint(ctx, ret_val ? OP_mcall : OP_mcallv, expr->identifier, arg_cnt);
+        hres = push_instr_member_uint(ctx, ret_val ? OP_mcall : OP_mcallv, expr->identifier, arg_cnt);
     }else {
         hres = push_instr_bstr_uint(ctx, ret_val ? OP_icall : OP_icallv, expr->identifier, arg_cnt);
     }
@@ -870,6 +895,8 @@ static HRESULT compile_assignment(compile_ctx_t *ctx, member_expression_t *membe
     if(FAILED(hres))
         return hres;
 
+    if(member_expr->obj_expr)
+        return push_instr_member_uint(ctx, op, member_expr->identifier, args_cnt);
     return push_instr_bstr_uint(ctx, op, member_expr->identifier, args_cnt);
 }
 
@@ -1199,6 +1226,79 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+static BOOL lookup_local_slot(function_t *func, const WCHAR *name, unsigned *slot)
+{
+    unsigned i;
+
+    for(i = 0; i < func->var_cnt; i++) {
+        if(!strcmpiW(func->vars[i].name, name)) {
+            *slot = i;
+            return TRUE;
+        }
+    }
+
+    for(i = 0; i < func->arg_cnt; i++) {
+        if(!strcmpiW(func->args[i].name, name)) {
+            *slot = func->var_cnt + i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * Dim statements apply to the whole procedure, so locals are known only
+ * once its body is compiled. Rewrite accesses to them to use frame slots,
+ * following the lookup order of lookup_identifier. Assignments to the
+ * function's own name store its return value and keep the lookup.
+ */
+static void resolve_locals(compile_ctx_t *ctx, function_t *func)
+{
+    BOOL has_ret_val = func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET;
+    instr_t *instr;
+    unsigned slot;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+            if(!instr->arg2.uint && lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_assign_ident:
+        case OP_set_ident:
+            if(instr->arg2.uint || (has_ret_val && !strcmpiW(instr->arg1.bstr, func->name)))
+                break;
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = instr->op == OP_assign_ident ? OP_assign_local : OP_set_local;
+                instr->arg1.uint = slot;
+                instr->arg2.uint = 0;
+            }
+            break;
+        case OP_incc:
+            if(has_ret_val && !strcmpiW(instr->arg1.bstr, func->name))
+                break;
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_incc_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_step:
+            if(has_ret_val && !strcmpiW(instr->arg2.bstr, func->name))
+                break;
+            if(lookup_local_slot(func, instr->arg2.bstr, &slot)) {
+                instr->op = OP_step_local;
+                instr->arg2.uint = slot;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *func)
 {
     HRESULT hres;
@@ -1292,6 +1392,9 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         }
     }
 
+    if(func->type != FUNC_GLOBAL)
+        resolve_locals(ctx, func);
+
     return S_OK;
 }
 
@@ -93,6 +93,12 @@ static BOOL lookup_dynamic_vars(dynamic_var_t *var, const WCHAR *name, ref_t *re
     return FALSE;
 }
 
+static inline VARIANT *get_local(exec_ctx_t *ctx, unsigned slot)
+{
+    assert(slot < ctx->func->var_cnt + ctx->func->arg_cnt);
+    return slot < ctx->func->var_cnt ? ctx->vars+slot : ctx->args+slot-ctx->func->var_cnt;
+}
+
 static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
 {
     named_item_t *item;
@@ -568,9 +574,23 @@ static HRESULT interp_icallv(exec_ctx_t *ctx)
     return do_icall(ctx, NULL);
 }
 
+static HRESULT interp_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    VARIANT *v, r;
+
+    TRACE("%u\n", slot);
+
+    v = get_local(ctx, slot);
+
+    V_VT(&r) = VT_BYREF|VT_VARIANT;
+    V_BYREF(&r) = V_VT(v) == (VT_VARIANT|VT_BYREF) ? V_VARIANTREF(v) : v;
+    return stack_push(ctx, &r);
+}
+
 static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 {
-    const BSTR identifier = ctx->instr->arg1.bstr;
+    member_ref_t *member = ctx->instr->arg1.member;
     const unsigned arg_cnt = ctx->instr->arg2.uint;
     IDispatch *obj;
     DISPPARAMS dp;
@@ -588,7 +608,7 @@ static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 
     vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
 
-    hres = disp_get_id(obj, identifier, VBDISP_CALLGET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, member, VBDISP_CALLGET, &id);
     if(SUCCEEDED(hres))
         hres = disp_call(ctx->script, obj, id, &dp, res);
     IDispatch_Release(obj);
@@ -723,16 +743,60 @@ static HRESULT interp_set_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT assign_local(exec_ctx_t *ctx, unsigned slot)
+{
+    VARIANT *v = get_local(ctx, slot);
+    HRESULT hres;
+
+    if(V_VT(v) == (VT_VARIANT|VT_BYREF))
+        v = V_VARIANTREF(v);
+
+    hres = VariantCopy(v, stack_top(ctx, 0));
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
+static HRESULT interp_assign_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    HRESULT hres;
+
+    TRACE("%u\n", slot);
+
+    hres = stack_assume_val(ctx, 0);
+    if(FAILED(hres))
+        return hres;
+
+    return assign_local(ctx, slot);
+}
+
+static HRESULT interp_set_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    HRESULT hres;
+
+    TRACE("%u\n", slot);
+
+    hres = stack_assume_disp(ctx, 0, NULL);
+    if(FAILED(hres))
+        return hres;
+
+    return assign_local(ctx, slot);
+}
+
 static HRESULT interp_assign_member(exec_ctx_t *ctx)
 {
-    BSTR identifier = ctx->instr->arg1.bstr;
+    member_ref_t *member = ctx->instr->arg1.member;
     const unsigned arg_cnt = ctx->instr->arg2.uint;
     IDispatch *obj;
     DISPPARAMS dp;
     DISPID id;
     HRESULT hres;
 
-    TRACE("%s\n", debugstr_w(identifier));
+    TRACE("%s\n", debugstr_w(member->name));
 
     hres = stack_assume_disp(ctx, arg_cnt+1, &obj);
     if(FAILED(hres))
@@ -747,7 +811,7 @@ static HRESULT interp_assign_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(obj, identifier, VBDISP_LET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, member, VBDISP_LET, &id);
     if(SUCCEEDED(hres)) {
         vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
         hres = disp_propput(ctx->script, obj, id, &dp);
@@ -761,14 +825,14 @@ static HRESULT interp_assign_member(exec_ctx_t *ctx)
 
 static HRESULT interp_set_member(exec_ctx_t *ctx)
 {
-    BSTR identifier = ctx->instr->arg1.bstr;
+    member_ref_t *member = ctx->instr->arg1.member;
     const unsigned arg_cnt = ctx->instr->arg2.uint;
     IDispatch *obj;
     DISPPARAMS dp;
     DISPID id;
     HRESULT hres;
 
-    TRACE("%s\n", debugstr_w(identifier));
+    TRACE("%s\n", debugstr_w(member->name));
 
     if(arg_cnt) {
         FIXME("arguments not supported\n");
@@ -788,7 +852,7 @@ static HRESULT interp_set_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(obj, identifier, VBDISP_SET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, member, VBDISP_SET, &id);
     if(SUCCEEDED(hres)) {
         vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
         hres = disp_propput(ctx->script, obj, id, &dp);
@@ -887,16 +951,12 @@ static HRESULT interp_new(exec_ctx_t *ctx)
     return stack_push(ctx, &v);
 }
 
-static HRESULT interp_step(exec_ctx_t *ctx)
+static HRESULT do_step(exec_ctx_t *ctx, VARIANT *v)
 {
-    const BSTR ident = ctx->instr->arg2.bstr;
     BOOL gteq_zero;
     VARIANT zero;
-    ref_t ref;
     HRESULT hres;
 
-    TRACE("%s\n", debugstr_w(ident));
-
     V_VT(&zero) = VT_I2;
     V_I2(&zero) = 0;
     hres = VarCmp(stack_top(ctx, 0), &zero, ctx->script->lcid, 0);
@@ -905,16 +965,7 @@ static HRESULT interp_step(exec_ctx_t *ctx)
 
     gteq_zero = hres == VARCMP_GT || hres == VARCMP_EQ;
 
-    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
-    if(FAILED(hres))
-        return hres;
-
-    if(ref.type != REF_VAR) {
-        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
-        return E_FAIL;
-    }
-
-    hres = VarCmp(ref.u.v, stack_top(ctx, 1), ctx->script->lcid, 0);
+    hres = VarCmp(v, stack_top(ctx, 1), ctx->script->lcid, 0);
     if(FAILED(hres))
         return hres;
 
@@ -927,6 +978,35 @@ static HRESULT interp_step(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_step(exec_ctx_t *ctx)
+{
+    const BSTR ident = ctx->instr->arg2.bstr;
+    ref_t ref;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ident));
+
+    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
+    if(FAILED(hres))
+        return hres;
+
+    if(ref.type != REF_VAR) {
+        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
+        return E_FAIL;
+    }
+
+    return do_step(ctx, ref.u.v);
+}
+
+static HRESULT interp_step_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg2.uint;
+
+    TRACE("%u\n", slot);
+
+    return do_step(ctx, get_local(ctx, slot));
+}
+
 static HRESULT interp_newenum(exec_ctx_t *ctx)
 {
     VARIANT *v, r;
@@ -1766,10 +1846,23 @@ static HRESULT interp_neg(exec_ctx_t *ctx)
     return stack_push(ctx, &v);
 }
 
+static HRESULT do_incc(exec_ctx_t *ctx, VARIANT *var)
+{
+    VARIANT v;
+    HRESULT hres;
+
+    hres = VarAdd(stack_top(ctx, 0), var, &v);
+    if(FAILED(hres))
+        return hres;
+
+    VariantClear(var);
+    *var = v;
+    return S_OK;
+}
+
 static HRESULT interp_incc(exec_ctx_t *ctx)
 {
     const BSTR ident = ctx->instr->arg1.bstr;
-    VARIANT v;
     ref_t ref;
     HRESULT hres;
 
@@ -1784,13 +1877,16 @@ static HRESULT interp_incc(exec_ctx_t *ctx)
         return E_FAIL;
     }
 
-    hres = VarAdd(stack_top(ctx, 0), ref.u.v, &v);
-    if(FAILED(hres))
-        return hres;
+    return do_incc(ctx, ref.u.v);
+}
 
-    VariantClear(ref.u.v);
-    *ref.u.v = v;
-    return S_OK;
+static HRESULT interp_incc_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+
+    TRACE("%u\n", slot);
+
+    return do_incc(ctx, get_local(ctx, slot));
 }
 
 static const instr_func_t op_funcs[] = {
@@ -73,6 +73,28 @@ typedef struct RECharSet {
     } u;
 } RECharSet;
 
+/*
+ * Search hints computed when the regexp is compiled. They let MatchRegExp
+ * skip start positions that can't possibly begin a match without entering
+ * the backtracking interpreter. The first character set is complete only
+ * once the classes listed in classes[] have been merged into it, which is
+ * done on first use, after the classes themselves have been converted.
+ */
+#define RESEARCH_MAX_CLASSES    4
+#define RESEARCH_MAX_DEPTH      32
+
+typedef struct RESearch {
+    JSPackedBool    first_known;    /* first[] holds every possible start */
+    JSPackedBool    first_wide;     /* any char >= 256 may start a match */
+    JSPackedBool    literal;        /* pattern is exactly prefix[] */
+    BYTE            class_cnt;      /* classes still to merge into first[] */
+    size_t          classes[RESEARCH_MAX_CLASSES];
+    BYTE            first[32];      /* bitmap of start chars below 256 */
+    DWORD           shift[256];     /* Horspool shifts, by low byte of char */
+    DWORD           prefix_len;     /* case sensitive literal prefix */
+    WCHAR           prefix[1];
+} RESearch;
+
 #define JSMSG_MIN_TOO_BIG 47
 #define JSMSG_MAX_TOO_BIG 48
 #define JSMSG_OUT_OF_ORDER 49
@@ -797,6 +819,158 @@ EmitREBytecode(CompilerState *state, regexp_t *re, size_t treeDepth,
     goto cleanup;
 }
 
+static void
+AddFirstChar(CompilerState *state, RESearch *search, WCHAR ch)
+{
+    UINT c;
+
+    if (state->flags & REG_FOLD) {
+        /* Folding may map characters outside of Latin-1 onto ch. */
+        for (c = 0; c < 256; c++) {
+            if (toupperW(c) == toupperW(ch))
+                search->first[c >> 3] |= 1 << (c & 7);
+        }
+        search->first_wide = TRUE;
+    } else if (ch < 256) {
+        search->first[ch >> 3] |= 1 << (ch & 7);
+    } else {
+        search->first_wide = TRUE;
+    }
+}
+
+/*
+ * Collect the characters a match of the node list starting at t may begin
+ * with. Returns 0 if every match consumes at least one character, 1 if the
+ * list may match the empty string and -1 if the set can't be determined.
+ */
+static INT
+FindFirstChars(CompilerState *state, RESearch *search, RENode *t, UINT depth)
+{
+    INT ret, ret2;
+    UINT c;
+
+    if (depth > RESEARCH_MAX_DEPTH)
+        return -1;
+
+    for (; t; t = t->next) {
+        switch (t->op) {
+          case REOP_EMPTY:
+          case REOP_BOL:
+          case REOP_EOL:
+          case REOP_WBDRY:
+          case REOP_WNONBDRY:
+          case REOP_ASSERT:
+          case REOP_ASSERT_NOT:
+            /* Zero width, whatever follows has to match at this position. */
+            break;
+          case REOP_FLAT:
+            AddFirstChar(state, search, t->u.flat.chr);
+            return 0;
+          case REOP_DIGIT:
+            for (c = '0'; c <= '9'; c++)
+                search->first[c >> 3] |= 1 << (c & 7);
+            return 0;
+          case REOP_ALNUM:
+            for (c = 0; c < 128; c++) {
+                if (JS_ISWORD(c))
+                    search->first[c >> 3] |= 1 << (c & 7);
+            }
+            return 0;
+          case REOP_SPACE:
+            for (c = 0; c < 256; c++) {
+                if (isspaceW(c))
+                    search->first[c >> 3] |= 1 << (c & 7);
+            }
+            search->first_wide = TRUE;
+            return 0;
+          case REOP_CLASS:
+            if (!t->u.ucclass.sense || search->class_cnt == RESEARCH_MAX_CLASSES)
+                return -1;
+            search->classes[search->class_cnt++] = t->u.ucclass.index;
+            return 0;
+          case REOP_LPAREN:
+            ret = FindFirstChars(state, search, t->kid, depth + 1);
+            if (ret != 1)
+                return ret;
+            break;
+          case REOP_QUANT:
+            ret = FindFirstChars(state, search, t->kid, depth + 1);
+            if (ret < 0)
+                return ret;
+            if (ret == 0 && t->u.range.min)
+                return 0;
+            break;
+          case REOP_ALT:
+          case REOP_ALTPREREQ:
+          case REOP_ALTPREREQ2:
+            ret = FindFirstChars(state, search, t->kid, depth + 1);
+            if (ret < 0)
+                return ret;
+            ret2 = FindFirstChars(state, search, t->u.kid2, depth + 1);
+            if (ret2 < 0)
+                return ret2;
+            if (ret == 0 && ret2 == 0)
+                return 0;
+            break;
+          default:
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Build the search hints for the parsed regexp. This has to run before the
+ * bytecode is emitted, since emitting coalesces the FLAT nodes in place.
+ * Returns NULL if there is nothing to speed up, or on allocation failure;
+ * the hints are optional either way.
+ */
+static RESearch *
+NewRESearch(CompilerState *state)
+{
+    RESearch *search;
+    DWORD prefix_len = 0, i;
+    RENode *t;
+
+    if (!(state->flags & REG_FOLD)) {
+        for (t = state->result; t && t->op == REOP_FLAT; t = t->next)
+            prefix_len += t->kid ? t->u.flat.length : 1;
+    }
+
+    search = heap_alloc_zero(offsetof(RESearch, prefix[prefix_len]));
+    if (!search)
+        return NULL;
+
+    if (prefix_len) {
+        for (t = state->result; t && t->op == REOP_FLAT; t = t->next) {
+            if (t->kid) {
+                memcpy(search->prefix + search->prefix_len, t->kid,
+                       t->u.flat.length * sizeof(WCHAR));
+                search->prefix_len += t->u.flat.length;
+            } else {
+                search->prefix[search->prefix_len++] = t->u.flat.chr;
+            }
+        }
+        search->literal = !t;
+
+        for (i = 0; i < 256; i++)
+            search->shift[i] = prefix_len;
+        for (i = 0; i + 1 < prefix_len; i++)
+            search->shift[search->prefix[i] & 0xff] = prefix_len - 1 - i;
+    }
+
+    search->first_known = !FindFirstChars(state, search, state->result, 0);
+    if (!search->first_known && !prefix_len) {
+        heap_free(search);
+        return NULL;
+    }
+
+    TRACE("prefix %s literal %d first_known %d\n", debugstr_wn(search->prefix, prefix_len),
+          search->literal, search->first_known);
+    return search;
+}
+
 /*
  * Process the op against the two top operands, reducing them to a single
  * operand in the penultimate slot. Update progLength and treeDepth.
@@ -3070,18 +3244,65 @@ good:
     return x;
 }
 
+/*
+ * Find the first position at or after cp where a match may start, or NULL
+ * if there is none. Search hints are only built for patterns that can't
+ * match the empty string, so the end of input never qualifies.
+ */
+static const WCHAR *FindMatchStart(const RESearch *search, const WCHAR *cp,
+                                   const WCHAR *cpend)
+{
+    DWORD len = search->prefix_len;
+    WCHAR ch;
+
+    /* a literal prefix is always compared exactly, the first[] bitmap
+     * can't tell characters >= 256 apart */
+    if (len) {
+        WCHAR last = search->prefix[len - 1];
+
+        while ((size_t)(cpend - cp) >= len) {
+            ch = cp[len - 1];
+            if (ch == last && !memcmp(cp, search->prefix, (len - 1) * sizeof(WCHAR)))
+                return cp;
+            cp += search->shift[ch & 0xff];
+        }
+        return NULL;
+    }
+
+    for (; cp < cpend; cp++) {
+        ch = *cp;
+        if (ch < 256 ? (search->first[ch >> 3] & (1 << (ch & 7))) : search->first_wide)
+            return cp;
+    }
+    return NULL;
+}
+
 static match_state_t *MatchRegExp(REGlobalData *gData, match_state_t *x)
 {
     match_state_t *result;
+    const RESearch *search = gData->regexp->search;
     const WCHAR *cp = x->cp;
     const WCHAR *cp2;
     UINT j;
 
+    if (search && (!search->first_known || (gData->regexp->flags & REG_STICKY)))
+        search = NULL;
+
     /*
      * Have to include the position beyond the last character
      * in order to detect end-of-input/line condition.
      */
     for (cp2 = cp; cp2 <= gData->cpend; cp2++) {
+        if (search) {
+            cp2 = FindMatchStart(search, cp2, gData->cpend);
+            if (!cp2)
+                return NULL;
+            if (search->literal) {
+                gData->skipped = cp2 - cp;
+                x->cp = cp2 + search->prefix_len;
+                return x;
+            }
+        }
         gData->skipped = cp2 - cp;
         x->cp = cp2;
         for (j = 0; j < gData->regexp->parenCount; j++)
@@ -3129,6 +3350,25 @@ static HRESULT InitMatch(regexp_t *re, void *cx, heap_pool_t *pool, REGlobalData
         }
     }
 
+    if (re->search && re->search->class_cnt) {
+        RESearch *search = re->search;
+        RECharSet *charSet;
+        UINT c;
+
+        for (i = 0; i < search->class_cnt; i++) {
+            charSet = &re->classList[search->classes[i]];
+            if (!charSet->length)
+                continue;
+            for (c = 0; c < 256 && c <= charSet->length; c++) {
+                if (charSet->u.bits[c >> 3] & (1 << (c & 7)))
+                    search->first[c >> 3] |= 1 << (c & 7);
+            }
+            if (charSet->length >= 256)
+                search->first_wide = TRUE;
+        }
+        search->class_cnt = 0;
+    }
+
     return S_OK;
 
 bad:
@@ -3178,8 +3418,12 @@ HRESULT regexp_execute(regexp_t *regexp, void *cx, heap_pool_t *pool,
     return S_OK;
 }
 
-void regexp_destroy(regexp_t *re)
+void regexp_release(regexp_t *re)
 {
+    if (--re->ref)
+        return;
+
+    heap_free(re->search);
     if (re->classList) {
         UINT i;
         for (i = 0; i < re->classCount; i++) {
@@ -3242,12 +3486,14 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
     if (!re)
         goto out;
 
+    re->ref = 1;
+    re->search = NULL;
     assert(state.classBitmapsMem <= CLASS_BITMAPS_MEM_LIMIT);
     re->classCount = state.classCount;
     if (re->classCount) {
         re->classList = heap_alloc(re->classCount * sizeof(RECharSet));
         if (!re->classList) {
-            regexp_destroy(re);
+            regexp_release(re);
             re = NULL;
             goto out;
         }
@@ -3256,9 +3502,10 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
     } else {
         re->classList = NULL;
     }
+    re->search = NewRESearch(&state);
     endPC = EmitREBytecode(&state, re, state.treeDepth, re->program, state.result);
     if (!endPC) {
-        regexp_destroy(re);
+        regexp_release(re);
         re = NULL;
         goto out;
     }
@@ -3296,7 +3543,7 @@ HRESULT regexp_set_flags(regexp_t **regexp, void *cx, heap_pool_t *pool, WORD fl
         if(!new_regexp)
             return E_FAIL;
 
-        regexp_destroy(*regexp);
+        regexp_release(*regexp);
         *regexp = new_regexp;
     }else {
         (*regexp)->flags = flags;
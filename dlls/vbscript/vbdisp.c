@@ -926,6 +926,52 @@ HRESULT disp_get_id(IDispatch *disp, BSTR name, vbdisp_invoke_type_t invoke_type
     return hres;
 }
 
+static BOOL is_named_item_disp(script_ctx_t *ctx, IDispatch *disp)
+{
+    named_item_t *item;
+
+    LIST_FOR_EACH_ENTRY(item, &ctx->named_items, named_item_t, entry) {
+        if(item->disp == disp)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+ * Like disp_get_id, but remembers the result in the call site's member_ref_t.
+ * Script objects are keyed by their class, which determines their DISPIDs.
+ * Other objects are only cached if they are named items, since those are
+ * kept alive by the script and their address can't be reused by another
+ * object until release_script bumps member_cache_gen.
+ */
+HRESULT disp_get_id_cached(script_ctx_t *ctx, IDispatch *disp, member_ref_t *member,
+        vbdisp_invoke_type_t invoke_type, DISPID *id)
+{
+    vbdisp_t *vbdisp;
+    const void *key;
+    HRESULT hres;
+
+    vbdisp = unsafe_impl_from_IDispatch(disp);
+    key = vbdisp ? (const void*)vbdisp->desc : (const void*)disp;
+
+    if(member->key == key && member->gen == ctx->member_cache_gen) {
+        *id = member->id;
+        return S_OK;
+    }
+
+    hres = disp_get_id(disp, member->name, invoke_type, FALSE, id);
+    if(FAILED(hres))
+        return hres;
+
+    if(vbdisp || is_named_item_disp(ctx, disp)) {
+        member->key = key;
+        member->gen = ctx->member_cache_gen;
+        member->id = *id;
+    }
+    return S_OK;
+}
+
 HRESULT disp_call(script_ctx_t *ctx, IDispatch *disp, DISPID id, DISPPARAMS *dp, VARIANT *retv)
 {
     const WORD flags = DISPATCH_METHOD|(retv ? DISPATCH_PROPERTYGET : 0);
@@ -1118,7 +1118,7 @@ static ULONG WINAPI RegExp2_Release(IRegExp2 *iface)
     if(!ref) {
         heap_free(This->pattern);
         if(This->regexp)
-            regexp_destroy(This->regexp);
+            regexp_release(This->regexp);
         heap_pool_free(&This->pool);
         heap_free(This);
     }
@@ -1197,7 +1197,7 @@ static HRESULT WINAPI RegExp2_put_Pattern(IRegExp2 *iface, BSTR pattern)
     if(!pattern) {
         heap_free(This->pattern);
         if(This->regexp) {
-            regexp_destroy(This->regexp);
+            regexp_release(This->regexp);
             This->regexp = NULL;
         }
         This->pattern = NULL;
@@ -1213,7 +1213,7 @@ static HRESULT WINAPI RegExp2_put_Pattern(IRegExp2 *iface, BSTR pattern)
     This->pattern = p;
     memcpy(p, pattern, size);
     if(This->regexp) {
-        regexp_destroy(This->regexp);
+        regexp_release(This->regexp);
         This->regexp = NULL;
     }
     return S_OK;
@@ -174,6 +174,8 @@ static void release_script(script_ctx_t *ctx)
 
     heap_pool_free(&ctx->heap);
     heap_pool_init(&ctx->heap);
+
+    ctx->member_cache_gen++;
 }
 
 static void destroy_script(script_ctx_t *ctx)
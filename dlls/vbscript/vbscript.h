@@ -133,8 +133,17 @@ typedef struct {
     script_ctx_t *ctx;
 } ScriptDisp;
 
+/* Per call site cache of the DISPID a member name resolved to. */
+typedef struct {
+    BSTR name;
+    const void *key;
+    unsigned gen;
+    DISPID id;
+} member_ref_t;
+
 HRESULT create_vbdisp(const class_desc_t*,vbdisp_t**) DECLSPEC_HIDDEN;
 HRESULT disp_get_id(IDispatch*,BSTR,vbdisp_invoke_type_t,BOOL,DISPID*) DECLSPEC_HIDDEN;
+HRESULT disp_get_id_cached(script_ctx_t*,IDispatch*,member_ref_t*,vbdisp_invoke_type_t,DISPID*) DECLSPEC_HIDDEN;
 HRESULT vbdisp_get_id(vbdisp_t*,BSTR,vbdisp_invoke_type_t,BOOL,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_call(script_ctx_t*,IDispatch*,DISPID,DISPPARAMS*,VARIANT*) DECLSPEC_HIDDEN;
 HRESULT disp_propput(script_ctx_t*,IDispatch*,DISPID,DISPPARAMS*) DECLSPEC_HIDDEN;
@@ -186,6 +195,9 @@ struct _script_ctx_t {
     struct list objects;
     struct list code_list;
     struct list named_items;
+
+    /* Bumped whenever objects that member caches may refer to are released. */
+    unsigned member_cache_gen;
 };
 
 HRESULT init_global(script_ctx_t*) DECLSPEC_HIDDEN;
@@ -200,14 +212,16 @@ typedef enum {
     ARG_INT,
     ARG_UINT,
     ARG_ADDR,
-    ARG_DOUBLE
+    ARG_DOUBLE,
+    ARG_MEMBER
 } instr_arg_type_t;
 
 #define OP_LIST                                   \
     X(add,            1, 0,           0)          \
     X(and,            1, 0,           0)          \
     X(assign_ident,   1, ARG_BSTR,    ARG_UINT)   \
-    X(assign_member,  1, ARG_BSTR,    ARG_UINT)   \
+    X(assign_local,   1, ARG_UINT,    0)          \
+    X(assign_member,  1, ARG_MEMBER,  ARG_UINT)   \
     X(bool,           1, ARG_INT,     0)          \
     X(case,           0, ARG_ADDR,    0)          \
     X(concat,         1, 0,           0)          \
@@ -227,15 +241,17 @@ typedef enum {
     X(idiv,           1, 0,           0)          \
     X(imp,            1, 0,           0)          \
     X(incc,           1, ARG_BSTR,    0)          \
+    X(incc_local,     1, ARG_UINT,    0)          \
     X(is,             1, 0,           0)          \
     X(jmp,            0, ARG_ADDR,    0)          \
     X(jmp_false,      0, ARG_ADDR,    0)          \
     X(jmp_true,       0, ARG_ADDR,    0)          \
+    X(local,          1, ARG_UINT,    0)          \
     X(long,           1, ARG_INT,     0)          \
     X(lt,             1, 0,           0)          \
     X(lteq,           1, 0,           0)          \
-    X(mcall,          1, ARG_BSTR,    ARG_UINT)   \
-    X(mcallv,         1, ARG_BSTR,    ARG_UINT)   \
+    X(mcall,          1, ARG_MEMBER,  ARG_UINT)   \
+    X(mcallv,         1, ARG_MEMBER,  ARG_UINT)   \
     X(me,             1, 0,           0)          \
     X(mod,            1, 0,           0)          \
     X(mul,            1, 0,           0)          \
@@ -250,9 +266,11 @@ typedef enum {
     X(pop,            1, ARG_UINT,    0)          \
     X(ret,            0, 0,           0)          \
     X(set_ident,      1, ARG_BSTR,    ARG_UINT)   \
-    X(set_member,     1, ARG_BSTR,    ARG_UINT)   \
+    X(set_local,      1, ARG_UINT,    0)          \
+    X(set_member,     1, ARG_MEMBER,  ARG_UINT)   \
     X(short,          1, ARG_INT,     0)          \
     X(step,           0, ARG_ADDR,    ARG_BSTR)   \
+    X(step_local,     0, ARG_ADDR,    ARG_UINT)   \
     X(stop,           1, 0,           0)          \
     X(string,         1, ARG_STR,     0)          \
     X(sub,            1, 0,           0)          \
@@ -272,6 +290,7 @@ typedef union {
     unsigned uint;
     LONG lng;
     double *dbl;
+    member_ref_t *member;
 } instr_arg_t;
 
 typedef struct {
@@ -67,11 +67,20 @@ struct pixelformatinfo {
     copyfunc copy_function;
 };
 
+struct row_converter {
+    enum pixelformat src_format, dst_format;
+    UINT src_bytes, dst_bytes; /* bytes per pixel */
+    void (*convert_row)(const BYTE *src, BYTE *dst, UINT width);
+};
+
 typedef struct FormatConverter {
     IWICFormatConverter IWICFormatConverter_iface;
     LONG ref;
     IWICBitmapSource *source;
     const struct pixelformatinfo *dst_format, *src_format;
+    const struct row_converter *row_converter;
+    BYTE *buffer; /* source rows for row_converter, kept between calls */
+    UINT buffer_size;
     WICBitmapDitherType dither;
     double alpha_threshold;
     WICBitmapPaletteType palette_type;
@@ -994,6 +1003,336 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     }
 }
 
+/* Direct conversions between common formats, a row at a time. They give the
+ * same results as the copypixels_to_* functions, which are still used for
+ * everything else. The source and destination may be the same buffer when
+ * the pixel sizes are equal. */
+
+static void convert_row_24bppBGR_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 4)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xff;
+    }
+}
+
+static void convert_row_24bppRGB_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 4)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 0xff;
+    }
+}
+
+static void convert_row_8bppGray_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, dst += 4)
+    {
+        dst[0] = dst[1] = dst[2] = src[x];
+        dst[3] = 0xff;
+    }
+}
+
+static void convert_row_8bppGray_to_24bpp(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, dst += 3)
+        dst[0] = dst[1] = dst[2] = src[x];
+}
+
+static void convert_row_32bppBGR_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    const DWORD *srcpixel = (const DWORD *)src;
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    for (x = 0; x < width; x++)
+        dstpixel[x] = srcpixel[x] | 0xff000000;
+}
+
+static void convert_row_32bppBGRA_to_32bppPBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        BYTE alpha = src[3];
+
+        dst[0] = src[0] * alpha / 255;
+        dst[1] = src[1] * alpha / 255;
+        dst[2] = src[2] * alpha / 255;
+        dst[3] = alpha;
+    }
+}
+
+static void convert_row_32bppPBGRA_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        BYTE alpha = src[3];
+
+        if (alpha != 0 && alpha != 255)
+        {
+            dst[0] = src[0] * 255 / alpha;
+            dst[1] = src[1] * 255 / alpha;
+            dst[2] = src[2] * 255 / alpha;
+        }
+        else
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+        dst[3] = alpha;
+    }
+}
+
+static void convert_row_32bpp_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+static void convert_row_32bpp_to_24bppRGB(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+    }
+}
+
+static void convert_row_swap_24bpp(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 3)
+    {
+        BYTE red = src[0];
+
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = red;
+    }
+}
+
+/* like copypixels_to_32bppBGRA, these use the first byte of each channel */
+static void convert_row_48bppRGB_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 6, dst += 4)
+    {
+        dst[0] = src[4];
+        dst[1] = src[2];
+        dst[2] = src[0];
+        dst[3] = 0xff;
+    }
+}
+
+static void convert_row_48bppRGB_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 6, dst += 3)
+    {
+        dst[0] = src[4];
+        dst[1] = src[2];
+        dst[2] = src[0];
+    }
+}
+
+static void convert_row_48bppRGB_to_24bppRGB(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 6, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[2];
+        dst[2] = src[4];
+    }
+}
+
+static void convert_row_64bppRGBA_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8, dst += 4)
+    {
+        dst[0] = src[4];
+        dst[1] = src[2];
+        dst[2] = src[0];
+        dst[3] = src[6];
+    }
+}
+
+static void convert_row_64bppRGBA_to_32bppPBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8, dst += 4)
+    {
+        BYTE alpha = src[6];
+
+        dst[0] = src[4] * alpha / 255;
+        dst[1] = src[2] * alpha / 255;
+        dst[2] = src[0] * alpha / 255;
+        dst[3] = alpha;
+    }
+}
+
+static void convert_row_64bppRGBA_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8, dst += 3)
+    {
+        dst[0] = src[4];
+        dst[1] = src[2];
+        dst[2] = src[0];
+    }
+}
+
+static void convert_row_64bppRGBA_to_24bppRGB(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[2];
+        dst[2] = src[4];
+    }
+}
+
+static const struct row_converter row_converters[] = {
+    {format_8bppGray, format_24bppBGR, 1, 3, convert_row_8bppGray_to_24bpp},
+    {format_8bppGray, format_24bppRGB, 1, 3, convert_row_8bppGray_to_24bpp},
+    {format_8bppGray, format_32bppBGR, 1, 4, convert_row_8bppGray_to_32bppBGRA},
+    {format_8bppGray, format_32bppBGRA, 1, 4, convert_row_8bppGray_to_32bppBGRA},
+    {format_8bppGray, format_32bppPBGRA, 1, 4, convert_row_8bppGray_to_32bppBGRA},
+    {format_24bppBGR, format_24bppRGB, 3, 3, convert_row_swap_24bpp},
+    {format_24bppBGR, format_32bppBGR, 3, 4, convert_row_24bppBGR_to_32bppBGRA},
+    {format_24bppBGR, format_32bppBGRA, 3, 4, convert_row_24bppBGR_to_32bppBGRA},
+    {format_24bppBGR, format_32bppPBGRA, 3, 4, convert_row_24bppBGR_to_32bppBGRA},
+    {format_24bppRGB, format_24bppBGR, 3, 3, convert_row_swap_24bpp},
+    {format_24bppRGB, format_32bppBGR, 3, 4, convert_row_24bppRGB_to_32bppBGRA},
+    {format_24bppRGB, format_32bppBGRA, 3, 4, convert_row_24bppRGB_to_32bppBGRA},
+    {format_24bppRGB, format_32bppPBGRA, 3, 4, convert_row_24bppRGB_to_32bppBGRA},
+    {format_32bppBGR, format_24bppBGR, 4, 3, convert_row_32bpp_to_24bppBGR},
+    {format_32bppBGR, format_24bppRGB, 4, 3, convert_row_32bpp_to_24bppRGB},
+    {format_32bppBGR, format_32bppBGRA, 4, 4, convert_row_32bppBGR_to_32bppBGRA},
+    {format_32bppBGR, format_32bppPBGRA, 4, 4, convert_row_32bppBGR_to_32bppBGRA},
+    {format_32bppBGRA, format_24bppBGR, 4, 3, convert_row_32bpp_to_24bppBGR},
+    {format_32bppBGRA, format_24bppRGB, 4, 3, convert_row_32bpp_to_24bppRGB},
+    {format_32bppBGRA, format_32bppPBGRA, 4, 4, convert_row_32bppBGRA_to_32bppPBGRA},
+    {format_32bppPBGRA, format_24bppBGR, 4, 3, convert_row_32bpp_to_24bppBGR},
+    {format_32bppPBGRA, format_24bppRGB, 4, 3, convert_row_32bpp_to_24bppRGB},
+    {format_32bppPBGRA, format_32bppBGRA, 4, 4, convert_row_32bppPBGRA_to_32bppBGRA},
+    {format_48bppRGB, format_24bppBGR, 6, 3, convert_row_48bppRGB_to_24bppBGR},
+    {format_48bppRGB, format_24bppRGB, 6, 3, convert_row_48bppRGB_to_24bppRGB},
+    {format_48bppRGB, format_32bppBGR, 6, 4, convert_row_48bppRGB_to_32bppBGRA},
+    {format_48bppRGB, format_32bppBGRA, 6, 4, convert_row_48bppRGB_to_32bppBGRA},
+    {format_48bppRGB, format_32bppPBGRA, 6, 4, convert_row_48bppRGB_to_32bppBGRA},
+    {format_64bppRGBA, format_24bppBGR, 8, 3, convert_row_64bppRGBA_to_24bppBGR},
+    {format_64bppRGBA, format_24bppRGB, 8, 3, convert_row_64bppRGBA_to_24bppRGB},
+    {format_64bppRGBA, format_32bppBGR, 8, 4, convert_row_64bppRGBA_to_32bppBGRA},
+    {format_64bppRGBA, format_32bppBGRA, 8, 4, convert_row_64bppRGBA_to_32bppBGRA},
+    {format_64bppRGBA, format_32bppPBGRA, 8, 4, convert_row_64bppRGBA_to_32bppPBGRA},
+};
+
+static const struct row_converter *get_row_converter(enum pixelformat src, enum pixelformat dst)
+{
+    UINT i;
+
+    for (i = 0; i < sizeof(row_converters) / sizeof(row_converters[0]); i++)
+        if (row_converters[i].src_format == src && row_converters[i].dst_format == dst)
+            return &row_converters[i];
+
+    return NULL;
+}
+
+/* size of the buffer holding source rows when the pixel sizes differ */
+#define ROW_BUFFER_SIZE 0x10000
+
+static HRESULT copypixels_rows(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    const struct row_converter *conv = This->row_converter;
+    UINT src_stride = prc->Width * conv->src_bytes, dst_size = prc->Width * conv->dst_bytes;
+    UINT y, count, rows;
+    HRESULT hr;
+
+    if (cbStride < dst_size || cbBufferSize < dst_size ||
+        (cbBufferSize - dst_size) / cbStride < prc->Height - 1)
+        return E_INVALIDARG;
+
+    if (conv->src_bytes == conv->dst_bytes)
+    {
+        /* convert in place */
+        hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        if (FAILED(hr)) return hr;
+
+        for (y = 0; y < prc->Height; y++)
+            conv->convert_row(pbBuffer + cbStride * y, pbBuffer + cbStride * y, prc->Width);
+        return S_OK;
+    }
+
+    rows = max(1, min(ROW_BUFFER_SIZE / src_stride, prc->Height));
+    if (This->buffer_size < rows * src_stride)
+    {
+        HeapFree(GetProcessHeap(), 0, This->buffer);
+        This->buffer_size = 0;
+        if (!(This->buffer = HeapAlloc(GetProcessHeap(), 0, rows * src_stride)))
+            return E_OUTOFMEMORY;
+        This->buffer_size = rows * src_stride;
+    }
+
+    for (y = 0; y < prc->Height; y += count)
+    {
+        WICRect rc;
+        UINT i;
+
+        count = min(rows, prc->Height - y);
+        rc.X = prc->X;
+        rc.Y = prc->Y + y;
+        rc.Width = prc->Width;
+        rc.Height = count;
+        hr = IWICBitmapSource_CopyPixels(This->source, &rc, src_stride, count * src_stride, This->buffer);
+        if (FAILED(hr)) return hr;
+
+        for (i = 0; i < count; i++)
+            conv->convert_row(This->buffer + src_stride * i, pbBuffer + cbStride * (y + i), prc->Width);
+    }
+
+    return S_OK;
+}
+
 static const struct pixelformatinfo supported_formats[] = {
     {format_1bppIndexed, &GUID_WICPixelFormat1bppIndexed, NULL},
     {format_2bppIndexed, &GUID_WICPixelFormat2bppIndexed, NULL},
@@ -1074,6 +1413,7 @@ static ULONG WINAPI FormatConverter_Release(IWICFormatConverter *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        HeapFree(GetProcessHeap(), 0, This->buffer);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -1150,6 +1490,14 @@ static HRESULT WINAPI FormatConverter_CopyPixels(IWICFormatConverter *iface,
             prc = &rc;
         }
 
+        if (This->row_converter && prc->Width > 0 && prc->Height > 0)
+        {
+            EnterCriticalSection(&This->lock);
+            hr = copypixels_rows(This, prc, cbStride, cbBufferSize, pbBuffer);
+            LeaveCriticalSection(&This->lock);
+            return hr;
+        }
+
         return This->dst_format->copy_function(This, prc, cbStride, cbBufferSize,
             pbBuffer, This->src_format->format);
     }
@@ -1204,6 +1552,7 @@ static HRESULT WINAPI FormatConverter_Initialize(IWICFormatConverter *iface,
         IWICBitmapSource_AddRef(pISource);
         This->src_format = srcinfo;
         This->dst_format = dstinfo;
+        This->row_converter = get_row_converter(srcinfo->format, dstinfo->format);
         This->dither = dither;
         This->alpha_threshold = alphaThresholdPercent;
         This->palette_type = paletteTranslate;
@@ -1246,8 +1595,8 @@ static HRESULT WINAPI FormatConverter_CanConvert(IWICFormatConverter *iface,
         return WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT;
     }
 
-    if (dstinfo->copy_function &&
-        SUCCEEDED(dstinfo->copy_function(This, NULL, 0, 0, NULL, dstinfo->format)))
+    if (get_row_converter(srcinfo->format, dstinfo->format) || (dstinfo->copy_function &&
+        SUCCEEDED(dstinfo->copy_function(This, NULL, 0, 0, NULL, dstinfo->format))))
         *pfCanConvert = TRUE;
     else
     {
@@ -1288,6 +1637,9 @@ HRESULT FormatConverter_CreateInstance(IUnknown *pUnkOuter, REFIID iid, void** p
     This->IWICFormatConverter_iface.lpVtbl = &FormatConverter_Vtbl;
     This->ref = 1;
     This->source = NULL;
+    This->row_converter = NULL;
+    This->buffer = NULL;
+    This->buffer_size = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": FormatConverter.lock");
 
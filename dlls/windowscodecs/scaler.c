@@ -19,6 +19,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -33,6 +34,18 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* weights of the separable filters are fixed point with this many fractional bits */
+#define FILTER_BITS 12
+/* extra precision kept in horizontally filtered rows */
+#define ROW_BITS 8
+
+struct filter_taps
+{
+    UINT count;    /* number of source pixels contributing to each destination pixel */
+    UINT *first;   /* first contributing source pixel for each destination pixel */
+    INT *weights;  /* count weights for each destination pixel */
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -43,9 +56,26 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    /* filtered modes: source rows are read as needed and kept horizontally
+     * filtered in a ring of y_taps.count rows, so scanline by scanline or
+     * tiled calls read each source row once per horizontal range */
+    struct filter_taps x_taps, y_taps;
+    BYTE *src_row;
+    INT *rows;
+    INT *row_index;
+    INT *accum;
+    UINT cache_x, cache_width;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
+static void free_filter_taps(struct filter_taps *taps)
+{
+    HeapFree(GetProcessHeap(), 0, taps->first);
+    HeapFree(GetProcessHeap(), 0, taps->weights);
+    taps->first = NULL;
+    taps->weights = NULL;
+}
+
 static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
 {
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
@@ -97,6 +127,12 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filter_taps(&This->x_taps);
+        free_filter_taps(&This->y_taps);
+        HeapFree(GetProcessHeap(), 0, This->src_row);
+        HeapFree(GetProcessHeap(), 0, This->rows);
+        HeapFree(GetProcessHeap(), 0, This->row_index);
+        HeapFree(GetProcessHeap(), 0, This->accum);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -191,6 +227,259 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static double cubic_weight(double x)
+{
+    /* Catmull-Rom spline */
+    x = fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+/* Compute the weights of the source pixels [start, start + count) for a
+ * destination pixel, in floating point. Pixels outside of the source are
+ * clamped to the edge. */
+static void get_filter_weights(WICBitmapInterpolationMode mode, UINT dst, UINT src_size, UINT dst_size,
+    int *start, int *count, double *weights)
+{
+    double scale = (double)src_size / dst_size;
+    int i;
+
+    if (mode == WICBitmapInterpolationModeFant)
+    {
+        /* average of the area covered by the destination pixel */
+        double left = dst * scale, right = (dst + 1) * scale;
+
+        *start = floor(left);
+        *count = (int)ceil(right) - *start;
+        for (i = 0; i < *count; i++)
+            weights[i] = (min(right, *start + i + 1) - max(left, *start + i)) / scale;
+    }
+    else
+    {
+        double pos = (dst + 0.5) * scale - 0.5, left = floor(pos), frac = pos - left;
+
+        if (mode == WICBitmapInterpolationModeLinear)
+        {
+            *start = left;
+            *count = 2;
+            weights[0] = 1.0 - frac;
+            weights[1] = frac;
+        }
+        else
+        {
+            *start = left - 1;
+            *count = 4;
+            for (i = 0; i < 4; i++)
+                weights[i] = cubic_weight(i - 1 - frac);
+        }
+    }
+}
+
+/* Check whether each pixel of the format is made of whole 8-bit unsigned
+ * channels, possibly with padding, which the filters can work on directly. */
+static BOOL has_8bit_channels(const WICPixelFormatGUID *format, UINT bpp)
+{
+    WICPixelFormatNumericRepresentation numeric;
+    IWICPixelFormatInfo2 *formatinfo;
+    IWICComponentInfo *info;
+    UINT channels;
+    HRESULT hr;
+
+    if (!bpp || bpp % 8) return FALSE;
+
+    hr = CreateComponentInfo(format, &info);
+    if (FAILED(hr)) return FALSE;
+
+    hr = IWICComponentInfo_QueryInterface(info, &IID_IWICPixelFormatInfo2, (void**)&formatinfo);
+    IWICComponentInfo_Release(info);
+    if (FAILED(hr)) return FALSE;
+
+    hr = IWICPixelFormatInfo2_GetChannelCount(formatinfo, &channels);
+    if (SUCCEEDED(hr))
+        hr = IWICPixelFormatInfo2_GetNumericRepresentation(formatinfo, &numeric);
+    IWICPixelFormatInfo2_Release(formatinfo);
+
+    return SUCCEEDED(hr) && numeric == WICPixelFormatNumericRepresentationUnsignedInteger &&
+           channels && channels <= bpp / 8 && bpp / channels < 16;
+}
+
+static HRESULT init_filter_taps(WICBitmapInterpolationMode mode, UINT src_size, UINT dst_size,
+    struct filter_taps *taps)
+{
+    double *weights, *clamped;
+    UINT i, count = 1;
+    int j, start, n;
+
+    /* the widest kernel is the area covered by a destination pixel, plus one pixel for the alignment */
+    n = max(4, (src_size + dst_size - 1) / dst_size + 2);
+    weights = HeapAlloc(GetProcessHeap(), 0, n * sizeof(double));
+    clamped = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, src_size * sizeof(double));
+    if (!weights || !clamped)
+    {
+        HeapFree(GetProcessHeap(), 0, weights);
+        HeapFree(GetProcessHeap(), 0, clamped);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        get_filter_weights(mode, i, src_size, dst_size, &start, &n, weights);
+        count = max(count, min(n, src_size));
+    }
+
+    taps->count = count;
+    taps->first = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(UINT));
+    taps->weights = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, dst_size * count * sizeof(INT));
+    if (!taps->first || !taps->weights)
+    {
+        HeapFree(GetProcessHeap(), 0, weights);
+        HeapFree(GetProcessHeap(), 0, clamped);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        int first, last, sum = 0, largest = 0;
+        INT *dst_weights;
+
+        get_filter_weights(mode, i, src_size, dst_size, &start, &n, weights);
+
+        first = src_size;
+        last = -1;
+        for (j = 0; j < n; j++)
+        {
+            int pos = min(max(start + j, 0), (int)src_size - 1);
+            clamped[pos] += weights[j];
+            first = min(first, pos);
+            last = max(last, pos);
+        }
+
+        first = max(0, min(first, (int)(src_size - count)));
+        taps->first[i] = first;
+        dst_weights = taps->weights + i * count;
+
+        for (j = 0; j < count; j++)
+        {
+            dst_weights[j] = floor(clamped[first + j] * (1 << FILTER_BITS) + 0.5);
+            clamped[first + j] = 0.0;
+            sum += dst_weights[j];
+            if (abs(dst_weights[j]) > abs(dst_weights[largest])) largest = j;
+        }
+        /* make sure a solid color stays the same */
+        dst_weights[largest] += (1 << FILTER_BITS) - sum;
+    }
+
+    HeapFree(GetProcessHeap(), 0, weights);
+    HeapFree(GetProcessHeap(), 0, clamped);
+    return S_OK;
+}
+
+/* Apply the horizontal filter to a source row for the destination columns [x, x + width). */
+static void filter_row(BitmapScaler *This, const BYTE *src, UINT src_x, UINT x, UINT width, INT *dst)
+{
+    UINT i, j, k, channels = This->bpp / 8, count = This->x_taps.count;
+
+    for (i = 0; i < width; i++)
+    {
+        const BYTE *pixel = src + (This->x_taps.first[x + i] - src_x) * channels;
+        const INT *weights = This->x_taps.weights + (x + i) * count;
+
+        for (j = 0; j < channels; j++)
+        {
+            INT sum = 0;
+
+            for (k = 0; k < count; k++)
+                sum += weights[k] * pixel[k * channels + j];
+            dst[i * channels + j] = (sum + (1 << (FILTER_BITS - ROW_BITS - 1))) >> (FILTER_BITS - ROW_BITS);
+        }
+    }
+}
+
+static HRESULT Filter_CopyPixels(BitmapScaler *This, const WICRect *dest_rect, UINT cbStride, BYTE *pbBuffer)
+{
+    UINT channels = This->bpp / 8, row_size = This->width * channels;
+    UINT count = This->y_taps.count, src_x, src_width;
+    INT x, y, k, i;
+    HRESULT hr;
+
+    if (!This->rows)
+    {
+        This->src_row = HeapAlloc(GetProcessHeap(), 0, This->src_width * channels);
+        This->rows = HeapAlloc(GetProcessHeap(), 0, count * row_size * sizeof(INT));
+        This->row_index = HeapAlloc(GetProcessHeap(), 0, count * sizeof(INT));
+        This->accum = HeapAlloc(GetProcessHeap(), 0, row_size * sizeof(INT));
+        if (!This->src_row || !This->rows || !This->row_index || !This->accum)
+        {
+            HeapFree(GetProcessHeap(), 0, This->src_row);
+            HeapFree(GetProcessHeap(), 0, This->rows);
+            HeapFree(GetProcessHeap(), 0, This->row_index);
+            HeapFree(GetProcessHeap(), 0, This->accum);
+            This->src_row = NULL;
+            This->rows = NULL;
+            This->row_index = NULL;
+            This->accum = NULL;
+            return E_OUTOFMEMORY;
+        }
+        This->cache_width = 0;
+    }
+
+    if (This->cache_x != dest_rect->X || This->cache_width != dest_rect->Width)
+    {
+        for (k = 0; k < count; k++) This->row_index[k] = -1;
+        This->cache_x = dest_rect->X;
+        This->cache_width = dest_rect->Width;
+    }
+
+    src_x = This->x_taps.first[dest_rect->X];
+    src_width = This->x_taps.first[dest_rect->X + dest_rect->Width - 1] + This->x_taps.count - src_x;
+
+    for (y = 0; y < dest_rect->Height; y++)
+    {
+        UINT first = This->y_taps.first[dest_rect->Y + y];
+        const INT *weights = This->y_taps.weights + (dest_rect->Y + y) * count;
+        BYTE *dst = pbBuffer + cbStride * y;
+        INT size = dest_rect->Width * channels;
+
+        for (k = 0; k < count; k++)
+        {
+            INT *row = This->rows + ((first + k) % count) * row_size;
+
+            if (This->row_index[(first + k) % count] != first + k)
+            {
+                WICRect rc;
+
+                rc.X = src_x;
+                rc.Y = first + k;
+                rc.Width = src_width;
+                rc.Height = 1;
+                hr = IWICBitmapSource_CopyPixels(This->source, &rc, src_width * channels,
+                                                 src_width * channels, This->src_row);
+                if (FAILED(hr))
+                {
+                    This->row_index[(first + k) % count] = -1;
+                    return hr;
+                }
+                filter_row(This, This->src_row, src_x, dest_rect->X, dest_rect->Width, row);
+                This->row_index[(first + k) % count] = first + k;
+            }
+
+            if (!k)
+                for (i = 0; i < size; i++) This->accum[i] = weights[k] * row[i];
+            else
+                for (i = 0; i < size; i++) This->accum[i] += weights[k] * row[i];
+        }
+
+        for (x = 0; x < size; x++)
+        {
+            INT value = (This->accum[x] + (1 << (FILTER_BITS + ROW_BITS - 1))) >> (FILTER_BITS + ROW_BITS);
+            dst[x] = min(max(value, 0), 255);
+        }
+    }
+
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -245,6 +534,13 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->x_taps.weights)
+    {
+        hr = dest_rect.Width && dest_rect.Height ?
+            Filter_CopyPixels(This, &dest_rect, cbStride, pbBuffer) : S_OK;
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -332,10 +628,40 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         hr = get_pixelformat_bpp(&src_pixelformat, &This->bpp);
     }
 
+    /* the filters work on 8-bit channels, other formats keep using
+     * nearest neighbour so that the pixel format stays the same */
+    if (SUCCEEDED(hr) && (mode == WICBitmapInterpolationModeLinear ||
+        mode == WICBitmapInterpolationModeCubic || mode == WICBitmapInterpolationModeFant) &&
+        !has_8bit_channels(&src_pixelformat, This->bpp))
+    {
+        FIXME("unsupported format %s for mode %i\n", debugstr_guid(&src_pixelformat), mode);
+        mode = WICBitmapInterpolationModeNearestNeighbor;
+    }
+
     if (SUCCEEDED(hr))
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            if (uiWidth && uiHeight && This->src_width && This->src_height)
+            {
+                hr = init_filter_taps(mode, This->src_width, uiWidth, &This->x_taps);
+                if (SUCCEEDED(hr))
+                    hr = init_filter_taps(mode, This->src_height, uiHeight, &This->y_taps);
+                if (FAILED(hr))
+                {
+                    free_filter_taps(&This->x_taps);
+                    free_filter_taps(&This->y_taps);
+                    break;
+                }
+            }
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+            This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
+            This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
@@ -391,6 +717,13 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->x_taps, 0, sizeof(This->x_taps));
+    memset(&This->y_taps, 0, sizeof(This->y_taps));
+    This->src_row = NULL;
+    This->rows = NULL;
+    This->row_index = NULL;
+    This->accum = NULL;
+    This->cache_x = This->cache_width = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -769,6 +769,206 @@ todo_wine
     DeleteObject(hpal);
 }
 
+static void test_bitmap_scaler(void)
+{
+    static const WICBitmapInterpolationMode modes[] = { WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic, WICBitmapInterpolationModeFant };
+    static const UINT sizes[][2] = { { 2, 1 }, { 4, 2 }, { 7, 5 }, { 16, 8 } };
+    static const struct
+    {
+        const GUID *format;
+        UINT bpp;
+    } formats[] =
+    {
+        { &GUID_WICPixelFormat16bppBGR565, 16 },
+        { &GUID_WICPixelFormat48bppRGB, 48 },
+        { &GUID_WICPixelFormat64bppRGBA, 64 },
+    };
+    static const struct
+    {
+        WICBitmapInterpolationMode mode;
+        UINT width, height;
+        BYTE blue[8], green[4];
+    } gradient[] =
+    {
+        { WICBitmapInterpolationModeLinear, 2, 1, { 0x40, 0xc0 }, { 0x80 } },
+        { WICBitmapInterpolationModeLinear, 3, 3, { 0x2b, 0x80, 0xd5 }, { 0x40, 0x80, 0xc0 } },
+        { WICBitmapInterpolationModeLinear, 8, 4, { 0x20, 0x30, 0x50, 0x70, 0x90, 0xb0, 0xd0, 0xe0 },
+          { 0x40, 0x60, 0xa0, 0xc0 } },
+        { WICBitmapInterpolationModeCubic, 2, 1, { 0x3c, 0xc4 }, { 0x80 } },
+        { WICBitmapInterpolationModeCubic, 3, 3, { 0x27, 0x80, 0xd9 }, { 0x39, 0x80, 0xc7 } },
+        { WICBitmapInterpolationModeCubic, 8, 4, { 0x1c, 0x2c, 0x4f, 0x70, 0x90, 0xb2, 0xd5, 0xe5 },
+          { 0x37, 0x5a, 0xa6, 0xc9 } },
+        { WICBitmapInterpolationModeFant, 2, 1, { 0x40, 0xc0 }, { 0x80 } },
+        { WICBitmapInterpolationModeFant, 3, 3, { 0x30, 0x80, 0xd0 }, { 0x40, 0x80, 0xc0 } },
+        { WICBitmapInterpolationModeFant, 8, 4, { 0x20, 0x20, 0x60, 0x60, 0xa0, 0xa0, 0xe0, 0xe0 },
+          { 0x40, 0x40, 0xc0, 0xc0 } },
+    };
+    BYTE src_data[4 * 2 * 8], data[16 * 8 * 4];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    WICPixelFormatGUID format;
+    WICRect rc;
+    UINT width, height, i, j, k;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(src_data); i += 4)
+    {
+        src_data[i] = 0x10;
+        src_data[i + 1] = 0x80;
+        src_data[i + 2] = 0xf0;
+        src_data[i + 3] = 0xff;
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 2, &GUID_WICPixelFormat32bppBGRA,
+                                                   16, sizeof(src_data), src_data, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        for (j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+        {
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, sizes[j][0], sizes[j][1], modes[i]);
+            ok(hr == S_OK, "%u: Initialize error %#x\n", modes[i], hr);
+
+            hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+            ok(hr == S_OK, "GetSize error %#x\n", hr);
+            ok(width == sizes[j][0] && height == sizes[j][1], "got %ux%u\n", width, height);
+
+            hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+            ok(hr == S_OK, "GetPixelFormat error %#x\n", hr);
+            ok(IsEqualGUID(&format, &GUID_WICPixelFormat32bppBGRA), "got format %s\n", debugstr_guid(&format));
+
+            /* a solid color stays the same, when copying everything or one scanline at a time */
+            memset(data, 0, sizeof(data));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, sizeof(data), data);
+            ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+            for (k = 0; k < width * height * 4; k++)
+                ok(data[k] == src_data[k % 4], "%u %ux%u: %u: expected %#x, got %#x\n",
+                   modes[i], width, height, k, src_data[k % 4], data[k]);
+
+            rc.X = 0;
+            rc.Width = width;
+            rc.Height = 1;
+            for (rc.Y = 0; rc.Y < height; rc.Y++)
+            {
+                memset(data, 0, sizeof(data));
+                hr = IWICBitmapScaler_CopyPixels(scaler, &rc, width * 4, width * 4, data);
+                ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+                ok(!memcmp(data, src_data, 4) && !memcmp(data + (width - 1) * 4, src_data, 4),
+                   "%u %ux%u: row %d: got %08x\n", modes[i], width, height, rc.Y, *(DWORD *)data);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+        }
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* blue is a horizontal and green a vertical gradient, so each filter's weights show up
+     * in the first row and column; scanlines and tiles must match the full frame exactly */
+    for (i = 0; i < 4 * 2; i++)
+    {
+        src_data[i * 4] = 0x20 + (i % 4) * 0x40;
+        src_data[i * 4 + 1] = i < 4 ? 0x40 : 0xc0;
+        src_data[i * 4 + 2] = 0x80;
+        src_data[i * 4 + 3] = 0xff;
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 2, &GUID_WICPixelFormat32bppBGRA,
+                                                   16, sizeof(src_data), src_data, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(gradient) / sizeof(gradient[0]); i++)
+    {
+        BYTE full[8 * 4 * 4];
+
+        width = gradient[i].width;
+        height = gradient[i].height;
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, width, height, gradient[i].mode);
+        ok(hr == S_OK, "%u: Initialize error %#x\n", gradient[i].mode, hr);
+
+        memset(full, 0, sizeof(full));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, sizeof(full), full);
+        ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+        for (k = 0; k < width * height; k++)
+        {
+            const BYTE *pixel = full + k * 4;
+            BYTE blue = gradient[i].blue[k % width], green = gradient[i].green[k / width];
+
+            ok(abs(pixel[0] - blue) <= 1 && abs(pixel[1] - green) <= 1 && pixel[2] == 0x80 && pixel[3] == 0xff,
+               "%u %ux%u: pixel %u,%u: expected ff80%02x%02x, got %08x\n", gradient[i].mode, width, height,
+               k % width, k / width, green, blue, *(const DWORD *)pixel);
+        }
+
+        rc.X = 0;
+        rc.Width = width;
+        rc.Height = 1;
+        for (rc.Y = 0; rc.Y < height; rc.Y++)
+        {
+            memset(data, 0, sizeof(data));
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rc, width * 4, width * 4, data);
+            ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+            ok(!memcmp(data, full + rc.Y * width * 4, width * 4), "%u %ux%u: row %d differs\n",
+               gradient[i].mode, width, height, rc.Y);
+        }
+
+        /* 2x2 tiles, copied into place in reverse order */
+        memset(data, 0, sizeof(data));
+        for (j = (width + 1) / 2 * ((height + 1) / 2); j-- > 0;)
+        {
+            rc.X = j % ((width + 1) / 2) * 2;
+            rc.Y = j / ((width + 1) / 2) * 2;
+            rc.Width = min(2, width - rc.X);
+            rc.Height = min(2, height - rc.Y);
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rc, width * 4, sizeof(data) - (rc.Y * width + rc.X) * 4,
+                                             data + (rc.Y * width + rc.X) * 4);
+            ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+        }
+        for (k = 0; k < height; k++)
+            ok(!memcmp(data + k * width * 4, full + k * width * 4, width * 4), "%u %ux%u: tiled row %u differs\n",
+               gradient[i].mode, width, height, k);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* formats the filters can't handle directly keep their pixel format */
+    for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        UINT stride = 4 * formats[i].bpp / 8;
+
+        hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 2, formats[i].format,
+                                                       stride, stride * 2, src_data, &bitmap);
+        ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 1, WICBitmapInterpolationModeFant);
+        ok(hr == S_OK, "Initialize error %#x\n", hr);
+
+        hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+        ok(hr == S_OK, "GetPixelFormat error %#x\n", hr);
+        ok(IsEqualGUID(&format, formats[i].format), "expected %s, got %s\n",
+           debugstr_guid(formats[i].format), debugstr_guid(&format));
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2 * formats[i].bpp / 8, 2 * formats[i].bpp / 8, data);
+        ok(hr == S_OK, "%s: CopyPixels error %#x\n", debugstr_guid(formats[i].format), hr);
+
+        IWICBitmapScaler_Release(scaler);
+        IWICBitmap_Release(bitmap);
+    }
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -784,6 +984,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromMemory();
     test_CreateBitmapFromHICON();
     test_CreateBitmapFromHBITMAP();
+    test_bitmap_scaler();
 
     IWICImagingFactory_Release(factory);
 
@@ -295,6 +295,18 @@ static const BYTE bits_32bppBGRA[] = {
 static const struct bitmap_data testdata_32bppBGRA = {
     &GUID_WICPixelFormat32bppBGRA, 32, bits_32bppBGRA, 4, 2, 96.0, 96.0};
 
+static const BYTE bits_8bppGray[] = {
+    255,0,255,0,
+    0,255,0,255};
+static const struct bitmap_data testdata_8bppGray = {
+    &GUID_WICPixelFormat8bppGray, 8, bits_8bppGray, 4, 2, 96.0, 96.0};
+
+static const BYTE bits_24bppBGR_gray[] = {
+    255,255,255, 0,0,0, 255,255,255, 0,0,0,
+    0,0,0, 255,255,255, 0,0,0, 255,255,255};
+static const struct bitmap_data testdata_24bppBGR_gray = {
+    &GUID_WICPixelFormat24bppBGR, 24, bits_24bppBGR_gray, 4, 2, 96.0, 96.0};
+
 static void test_conversion(const struct bitmap_data *src, const struct bitmap_data *dst, const char *name, BOOL todo)
 {
     BitmapTestSrc *src_obj;
@@ -660,6 +672,8 @@ START_TEST(converter)
     test_conversion(&testdata_32bppBGR, &testdata_24bppRGB, "32bppBGR -> 24bppRGB", 0);
     test_conversion(&testdata_24bppRGB, &testdata_32bppBGR, "24bppRGB -> 32bppBGR", 0);
 
+    test_conversion(&testdata_8bppGray, &testdata_24bppBGR_gray, "8bppGray -> 24bppBGR", 0);
+
     test_invalid_conversion();
     test_default_converter();
 
@@ -19,9 +19,50 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "wine/unicode.h"
 
+/* copy the leading 7-bit ASCII chars of src to dst, return the number of chars copied */
+unsigned int ascii_mbstowcs( const unsigned char *src, unsigned int srclen, WCHAR *dst )
+{
+    unsigned int pos = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for ( ; pos + 16 <= srclen; pos += 16)
+    {
+        __m128i chars = _mm_loadu_si128( (const __m128i *)(src + pos) );
+        if (_mm_movemask_epi8( chars )) break;
+        _mm_storeu_si128( (__m128i *)(dst + pos), _mm_unpacklo_epi8( chars, zero ));
+        _mm_storeu_si128( (__m128i *)(dst + pos + 8), _mm_unpackhi_epi8( chars, zero ));
+    }
+#endif
+    while (pos < srclen && src[pos] < 0x80)
+    {
+        dst[pos] = src[pos];
+        pos++;
+    }
+    return pos;
+}
+
+/* check whether a code page maps 7-bit ASCII to the same Unicode chars */
+static int is_ascii_cp2uni( const WCHAR *cp2uni, const unsigned char *leadbytes )
+{
+    static const WCHAR *cache[4];  /* recently checked tables that passed */
+    static unsigned int next;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cache)/sizeof(cache[0]); i++) if (cache[i] == cp2uni) return 1;
+    for (i = 0; i < 0x80; i++)
+        if (cp2uni[i] != i || (leadbytes && leadbytes[i])) return 0;
+    cache[next++ % (sizeof(cache)/sizeof(cache[0]))] = cp2uni;
+    return 1;
+}
+
 /* get the decomposition of a Unicode char */
 static int get_decomposition( WCHAR src, WCHAR *dst, unsigned int dstlen )
 {
@@ -80,6 +121,19 @@ static inline int mbstowcs_sbcs( const struct sbcs_table *table, int flags,
         ret = -1;
     }
 
+    if (is_ascii_cp2uni( cp2uni, NULL ))
+    {
+        while (srclen)
+        {
+            unsigned int len = ascii_mbstowcs( src, srclen, dst );
+            src += len;
+            dst += len;
+            srclen -= len;
+            for ( ; srclen && *src >= 0x80; srclen--) *dst++ = cp2uni[*src++];
+        }
+        return ret;
+    }
+
     for (;;)
     {
         switch(srclen)
@@ -191,14 +245,25 @@ static inline int mbstowcs_dbcs( const struct dbcs_table *table,
 {
     const WCHAR * const cp2uni = table->cp2uni;
     const unsigned char * const cp2uni_lb = table->cp2uni_leadbytes;
+    const int ascii = is_ascii_cp2uni( cp2uni, cp2uni_lb );
     unsigned int len;
 
     if (!dstlen) return get_length_dbcs( table, src, srclen );
 
     for (len = dstlen; srclen && len; len--, srclen--, src++, dst++)
     {
-        unsigned char off = cp2uni_lb[*src];
-        if (off)
+        unsigned char off;
+
+        if (ascii && *src < 0x80)
+        {
+            unsigned int count = ascii_mbstowcs( src, min( srclen, len ), dst );
+            src += count - 1;
+            dst += count - 1;
+            srclen -= count - 1;
+            len -= count - 1;
+            continue;
+        }
+        if ((off = cp2uni_lb[*src]))
         {
             if (!--srclen) break;  /* partial char, ignore it */
             src++;
@@ -22,6 +22,16 @@
 extern int get_decomposition(WCHAR src, WCHAR *dst, unsigned int dstlen);
 extern const unsigned int collation_table[];
 
+static inline unsigned int get_weight(WCHAR ch)
+{
+    return collation_table[collation_table[ch >> 8] + (ch & 0xff)];
+}
+
+static inline int is_symbol(WCHAR ch)
+{
+    return get_char_typeW(ch) & (C1_PUNCT | C1_SPACE);
+}
+
 /*
  * flags - normalization NORM_* flags
  *
@@ -52,12 +62,12 @@ int wine_get_sortkey(int flags, const WCHAR *src, int srclen, char *dst, int dst
                  * and skips white space and punctuation characters for
                  * NORM_IGNORESYMBOLS.
                  */
-                if ((flags & NORM_IGNORESYMBOLS) && (get_char_typeW(wch) & (C1_PUNCT | C1_SPACE)))
+                if ((flags & NORM_IGNORESYMBOLS) && is_symbol(wch))
                     continue;
 
                 if (flags & NORM_IGNORECASE) wch = tolowerW(wch);
 
-                ce = collation_table[collation_table[wch >> 8] + (wch & 0xff)];
+                ce = get_weight(wch);
                 if (ce != (unsigned int)-1)
                 {
                     if (ce >> 16) key_len[0] += 2;
@@ -110,12 +120,12 @@ int wine_get_sortkey(int flags, const WCHAR *src, int srclen, char *dst, int dst
                  * and skips white space and punctuation characters for
                  * NORM_IGNORESYMBOLS.
                  */
-                if ((flags & NORM_IGNORESYMBOLS) && (get_char_typeW(wch) & (C1_PUNCT | C1_SPACE)))
+                if ((flags & NORM_IGNORESYMBOLS) && is_symbol(wch))
                     continue;
 
                 if (flags & NORM_IGNORECASE) wch = tolowerW(wch);
 
-                ce = collation_table[collation_table[wch >> 8] + (wch & 0xff)];
+                ce = get_weight(wch);
                 if (ce != (unsigned int)-1)
                 {
                     WCHAR key;
@@ -155,29 +165,49 @@ int wine_get_sortkey(int flags, const WCHAR *src, int srclen, char *dst, int dst
     return key_ptr[3] - dst;
 }
 
-static inline int compare_unicode_weights(int flags, const WCHAR *str1, int len1,
-                                          const WCHAR *str2, int len2)
+/* Compares the unicode weights and, while both strings are walked the same
+ * way the diacritic and case passes would walk them, also records the first
+ * diacritic and case weight differences. The separate passes are then only
+ * needed on a tie after hyphens or apostrophes were skipped.
+ */
+static inline int compare_weights(int flags, const WCHAR *str1, int len1,
+                                  const WCHAR *str2, int len2,
+                                  int *in_step, int *diacritic, int *case_weight)
 {
     unsigned int ce1, ce2;
     int ret;
 
+    *in_step = 1;
+    *diacritic = *case_weight = 0;
+
     /* 32-bit collation element table format:
      * unicode weight - high 16 bit, diacritic weight - high 8 bit of low 16 bit,
      * case weight - high 4 bit of low 8 bit.
      */
     while (len1 > 0 && len2 > 0)
     {
+        /* identical characters have identical weights, and are either both
+         * skipped or both compared in every pass */
+        if (*str1 == *str2)
+        {
+            str1++;
+            str2++;
+            len1--;
+            len2--;
+            continue;
+        }
+
         if (flags & NORM_IGNORESYMBOLS)
         {
             int skip = 0;
             /* FIXME: not tested */
-            if (get_char_typeW(*str1) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str1))
             {
                 str1++;
                 len1--;
                 skip = 1;
             }
-            if (get_char_typeW(*str2) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str2))
             {
                 str2++;
                 len2--;
@@ -197,6 +227,7 @@ static inline int compare_unicode_weights(int flags, const WCHAR *str1, int len1
                 {
                     str1++;
                     len1--;
+                    *in_step = 0;
                     continue;
                 }
             }
@@ -204,19 +235,20 @@ static inline int compare_unicode_weights(int flags, const WCHAR *str1, int len1
             {
                 str2++;
                 len2--;
+                *in_step = 0;
                 continue;
             }
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_weight(*str1);
+        ce2 = get_weight(*str2);
 
-        if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
-            ret = (ce1 >> 16) - (ce2 >> 16);
-        else
-            ret = *str1 - *str2;
+        if (ce1 == (unsigned int)-1 || ce2 == (unsigned int)-1)
+            return *str1 - *str2;
 
-        if (ret) return ret;
+        if ((ret = (ce1 >> 16) - (ce2 >> 16))) return ret;
+        if (!*diacritic) *diacritic = ((ce1 >> 8) & 0xff) - ((ce2 >> 8) & 0xff);
+        if (!*case_weight) *case_weight = ((ce1 >> 4) & 0x0f) - ((ce2 >> 4) & 0x0f);
 
         str1++;
         str2++;
@@ -242,13 +274,13 @@ static inline int compare_diacritic_weights(int flags, const WCHAR *str1, int le
         {
             int skip = 0;
             /* FIXME: not tested */
-            if (get_char_typeW(*str1) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str1))
             {
                 str1++;
                 len1--;
                 skip = 1;
             }
-            if (get_char_typeW(*str2) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str2))
             {
                 str2++;
                 len2--;
@@ -257,8 +289,8 @@ static inline int compare_diacritic_weights(int flags, const WCHAR *str1, int le
             if (skip) continue;
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_weight(*str1);
+        ce2 = get_weight(*str2);
 
         if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
             ret = ((ce1 >> 8) & 0xff) - ((ce2 >> 8) & 0xff);
@@ -291,13 +323,13 @@ static inline int compare_case_weights(int flags, const WCHAR *str1, int len1,
         {
             int skip = 0;
             /* FIXME: not tested */
-            if (get_char_typeW(*str1) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str1))
             {
                 str1++;
                 len1--;
                 skip = 1;
             }
-            if (get_char_typeW(*str2) & (C1_PUNCT | C1_SPACE))
+            if (is_symbol(*str2))
             {
                 str2++;
                 len2--;
@@ -306,8 +338,8 @@ static inline int compare_case_weights(int flags, const WCHAR *str1, int len1,
             if (skip) continue;
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_weight(*str1);
+        ce2 = get_weight(*str2);
 
         if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
             ret = ((ce1 >> 4) & 0x0f) - ((ce2 >> 4) & 0x0f);
@@ -333,18 +365,18 @@ static inline int real_length(const WCHAR *str, int len)
 int wine_compare_string(int flags, const WCHAR *str1, int len1,
                         const WCHAR *str2, int len2)
 {
-    int ret;
+    int ret, in_step, diacritic, case_weight;
 
     len1 = real_length(str1, len1);
     len2 = real_length(str2, len2);
 
-    ret = compare_unicode_weights(flags, str1, len1, str2, len2);
+    ret = compare_weights(flags, str1, len1, str2, len2, &in_step, &diacritic, &case_weight);
     if (!ret)
     {
         if (!(flags & NORM_IGNORENONSPACE))
-            ret = compare_diacritic_weights(flags, str1, len1, str2, len2);
+            ret = in_step ? diacritic : compare_diacritic_weights(flags, str1, len1, str2, len2);
         if (!ret && !(flags & NORM_IGNORECASE))
-            ret = compare_case_weights(flags, str1, len1, str2, len2);
+            ret = in_step ? case_weight : compare_case_weights(flags, str1, len1, str2, len2);
     }
     return ret;
 }
@@ -21,16 +21,54 @@
 #include <assert.h>
 #include <limits.h>
 #include <stdio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define WINE_UNICODE_INLINE  /* nothing */
 #include "wine/unicode.h"
 
+/* lower case a char, without table lookups for 7-bit ASCII */
+static inline WCHAR fold_char( WCHAR ch )
+{
+    if (ch < 0x80) return (ch >= 'A' && ch <= 'Z') ? ch + 'a' - 'A' : ch;
+    return tolowerW( ch );
+}
+
+#ifdef __SSE2__
+/* check that an unaligned 16-byte load at ptr doesn't cross a page boundary */
+static inline int can_load_16( const void *ptr )
+{
+    return ((ULONG_PTR)ptr & 0xfff) <= 0x1000 - 16;
+}
+
+/* check whether the next 8 chars are identical in both strings and contain no terminator */
+static inline int equal_block( const WCHAR *str1, const WCHAR *str2 )
+{
+    __m128i chars1 = _mm_loadu_si128( (const __m128i *)str1 );
+    __m128i chars2 = _mm_loadu_si128( (const __m128i *)str2 );
+
+    return _mm_movemask_epi8( _mm_cmpeq_epi16( chars1, chars2 )) == 0xffff &&
+           !_mm_movemask_epi8( _mm_cmpeq_epi16( chars1, _mm_setzero_si128() ));
+}
+#endif
+
 int strcmpiW( const WCHAR *str1, const WCHAR *str2 )
 {
     for (;;)
     {
-        int ret = tolowerW(*str1) - tolowerW(*str2);
-        if (ret || !*str1) return ret;
+        int ret;
+
+#ifdef __SSE2__
+        if (can_load_16( str1 ) && can_load_16( str2 ) && equal_block( str1, str2 ))
+        {
+            str1 += 8;
+            str2 += 8;
+            continue;
+        }
+#endif
+        if (*str1 != *str2 && (ret = fold_char(*str1) - fold_char(*str2))) return ret;
+        if (!*str1) return 0;
         str1++;
         str2++;
     }
@@ -39,16 +77,41 @@ int strcmpiW( const WCHAR *str1, const WCHAR *str2 )
 int strncmpiW( const WCHAR *str1, const WCHAR *str2, int n )
 {
     int ret = 0;
-    for ( ; n > 0; n--, str1++, str2++)
-        if ((ret = tolowerW(*str1) - tolowerW(*str2)) || !*str1) break;
+
+    while (n > 0)
+    {
+#ifdef __SSE2__
+        if (n >= 8 && can_load_16( str1 ) && can_load_16( str2 ) && equal_block( str1, str2 ))
+        {
+            str1 += 8;
+            str2 += 8;
+            n -= 8;
+            continue;
+        }
+#endif
+        if (*str1 != *str2 && (ret = fold_char(*str1) - fold_char(*str2))) break;
+        if (!*str1) break;
+        str1++;
+        str2++;
+        n--;
+    }
     return ret;
 }
 
 int memicmpW( const WCHAR *str1, const WCHAR *str2, int n )
 {
     int ret = 0;
+
+#ifdef __SSE2__
+    for ( ; n >= 8; n -= 8, str1 += 8, str2 += 8)
+    {
+        __m128i chars1 = _mm_loadu_si128( (const __m128i *)str1 );
+        __m128i chars2 = _mm_loadu_si128( (const __m128i *)str2 );
+        if (_mm_movemask_epi8( _mm_cmpeq_epi16( chars1, chars2 )) != 0xffff) break;
+    }
+#endif
     for ( ; n > 0; n--, str1++, str2++)
-        if ((ret = tolowerW(*str1) - tolowerW(*str2))) break;
+        if (*str1 != *str2 && (ret = fold_char(*str1) - fold_char(*str2))) break;
     return ret;
 }
 
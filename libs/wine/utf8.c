@@ -23,6 +23,8 @@
 #include "wine/unicode.h"
 
 extern WCHAR compose( const WCHAR *str );
+extern unsigned int ascii_mbstowcs( const unsigned char *src, unsigned int srclen, WCHAR *dst );
+extern unsigned int ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst );
 
 /* number of following bytes in sequence based on first byte value (for bytes above 0x7f) */
 static const char utf8_length[128] =
@@ -106,10 +108,16 @@ int wine_utf8_wcstombs( int flags, const WCHAR *src, int srclen, char *dst, int
         WCHAR ch = *src;
         unsigned int val;
 
-        if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
+        if (ch < 0x80)  /* 0x00-0x7f: 1 byte, copy the whole ASCII run at once */
         {
-            if (!len--) return -1;  /* overflow */
-            *dst++ = ch;
+            unsigned int count;
+
+            if (!len) return -1;  /* overflow */
+            count = ascii_wcstombs( src, min( srclen, len ), dst );
+            dst += count;
+            len -= count;
+            src += count - 1;
+            srclen -= count - 1;
             continue;
         }
 
@@ -313,12 +321,16 @@ int wine_utf8_mbstowcs( int flags, const char *src, int srclen, WCHAR *dst, int
 
     while ((dst < dstend) && (src < srcend))
     {
-        unsigned char ch = *src++;
-        if (ch < 0x80)  /* special fast case for 7-bit ASCII */
+        unsigned char ch = *src;
+        if (ch < 0x80)  /* special fast case for 7-bit ASCII, copy the whole run at once */
         {
-            *dst++ = ch;
+            unsigned int count = ascii_mbstowcs( (const unsigned char *)src,
+                                                 min( srcend - src, dstend - dst ), dst );
+            src += count;
+            dst += count;
             continue;
         }
+        src++;
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
         {
             *dst++ = res;
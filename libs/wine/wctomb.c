@@ -19,9 +19,38 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "wine/unicode.h"
 
+/* copy the leading 7-bit ASCII chars of src to dst, return the number of chars copied */
+unsigned int ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst )
+{
+    unsigned int pos = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16( (short)0xff80 );
+
+    for ( ; pos + 16 <= srclen; pos += 16)
+    {
+        __m128i lo = _mm_loadu_si128( (const __m128i *)(src + pos) );
+        __m128i hi = _mm_loadu_si128( (const __m128i *)(src + pos + 8) );
+        __m128i high_bits = _mm_and_si128( _mm_or_si128( lo, hi ), mask );
+        if (_mm_movemask_epi8( _mm_cmpeq_epi16( high_bits, zero )) != 0xffff) break;
+        _mm_storeu_si128( (__m128i *)(dst + pos), _mm_packus_epi16( lo, hi ));
+    }
+#endif
+    while (pos < srclen && src[pos] < 0x80)
+    {
+        dst[pos] = src[pos];
+        pos++;
+    }
+    return pos;
+}
+
 /* search for a character in the unicode_compose_table; helper for compose() */
 static inline int binary_search( WCHAR ch, int low, int high )
 {
@@ -65,6 +94,20 @@ WCHAR compose( const WCHAR *str )
 /****************************************************************/
 /* sbcs support */
 
+/* check whether a code page maps 7-bit ASCII chars to themselves */
+static int is_ascii_uni2cp_sbcs( const struct sbcs_table *table )
+{
+    static const unsigned char *cache[4];  /* recently checked tables that passed */
+    static unsigned int next;
+    const unsigned char *uni2cp = table->uni2cp_low + table->uni2cp_high[0];
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cache)/sizeof(cache[0]); i++) if (cache[i] == uni2cp) return 1;
+    for (i = 0; i < 0x80; i++) if (uni2cp[i] != i) return 0;
+    cache[next++ % (sizeof(cache)/sizeof(cache[0]))] = uni2cp;
+    return 1;
+}
+
 /* check if 'ch' is an acceptable sbcs mapping for 'wch' */
 static inline int is_valid_sbcs_mapping( const struct sbcs_table *table, int flags,
                                          WCHAR wch, unsigned char ch )
@@ -142,6 +185,20 @@ static inline int wcstombs_sbcs( const struct sbcs_table *table,
         ret = -1;
     }
 
+    if (is_ascii_uni2cp_sbcs( table ))
+    {
+        while (srclen)
+        {
+            unsigned int len = ascii_wcstombs( src, srclen, dst );
+            src += len;
+            dst += len;
+            srclen -= len;
+            for ( ; srclen && *src >= 0x80; srclen--, src++)
+                *dst++ = uni2cp_low[uni2cp_high[*src >> 8] + (*src & 0xff)];
+        }
+        return ret;
+    }
+
     while (srclen >= 16)
     {
         dst[0]  = uni2cp_low[uni2cp_high[src[0]  >> 8] + (src[0]  & 0xff)];
@@ -258,6 +315,20 @@ static int wcstombs_sbcs_slow( const struct sbcs_table *table, int flags,
 /****************************************************************/
 /* dbcs support */
 
+/* check whether a code page maps 7-bit ASCII chars to themselves */
+static int is_ascii_uni2cp_dbcs( const struct dbcs_table *table )
+{
+    static const unsigned short *cache[4];  /* recently checked tables that passed */
+    static unsigned int next;
+    const unsigned short *uni2cp = table->uni2cp_low + table->uni2cp_high[0];
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cache)/sizeof(cache[0]); i++) if (cache[i] == uni2cp) return 1;
+    for (i = 0; i < 0x80; i++) if (uni2cp[i] != i) return 0;
+    cache[next++ % (sizeof(cache)/sizeof(cache[0]))] = uni2cp;
+    return 1;
+}
+
 /* check if 'ch' is an acceptable dbcs mapping for 'wch' */
 static inline int is_valid_dbcs_mapping( const struct dbcs_table *table, int flags,
                                          WCHAR wch, unsigned short ch )
@@ -351,11 +422,23 @@ static inline int wcstombs_dbcs( const struct dbcs_table *table,
 {
     const unsigned short * const uni2cp_low = table->uni2cp_low;
     const unsigned short * const uni2cp_high = table->uni2cp_high;
+    const int ascii = is_ascii_uni2cp_dbcs( table );
     int len;
 
     for (len = dstlen; srclen && len; len--, srclen--, src++)
     {
-        unsigned short res = uni2cp_low[uni2cp_high[*src >> 8] + (*src & 0xff)];
+        unsigned short res;
+
+        if (ascii && *src < 0x80)
+        {
+            unsigned int count = ascii_wcstombs( src, min( srclen, (unsigned int)len ), dst );
+            src += count - 1;
+            dst += count;
+            srclen -= count - 1;
+            len -= count - 1;
+            continue;
+        }
+        res = uni2cp_low[uni2cp_high[*src >> 8] + (*src & 0xff)];
         if (res & 0xff00)
         {
             if (len == 1) break;  /* do not output a partial char */